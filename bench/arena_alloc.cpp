@@ -0,0 +1,175 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/arena_alloc.hpp>
+#include <infovis/table/column.hpp>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+using namespace infovis;
+
+static unsigned long new_count;
+
+void *
+operator new(std::size_t size)
+{
+  new_count++;
+  void * p = malloc(size);
+  if (p == 0)
+    throw std::bad_alloc();
+  return p;
+}
+
+void
+operator delete(void * p) noexcept
+{
+  free(p);
+}
+
+void
+operator delete(void * p, std::size_t) noexcept
+{
+  free(p);
+}
+
+/*
+ * Builds the four topology columns of a tree the way tree::add_node
+ * does, with a random parent for each node.
+ */
+template <class Column, class Alloc>
+static void
+build_tree(int n, const Alloc& alloc, const char * label, arena * owner = 0)
+{
+  clock_t time = clock();
+  unsigned long news = new_count;
+  {
+    Column child("#child", 10, 0, alloc);
+    Column next("#next", 10, 0, alloc);
+    Column last("#last", 10, 0, alloc);
+    Column parent("#parent", 10, 0, alloc);
+
+    child.add(0); next.add(0); last.add(0); parent.add(0);
+    srand(1);
+    for (unsigned i = 1; i < unsigned(n); i++) {
+      unsigned par = rand() % i;
+      child.add(0);
+      next.add(0);
+      last.add(0);
+      parent.add(par);
+      if (last[par] == 0)
+	child[par] = i;
+      else
+	next[last[par]] = i;
+      last[par] = i;
+    }
+    clock_t built = clock();
+    std::cout << label << ": time to build: "
+	      << (built - time) / float(CLOCKS_PER_SEC) << "s for "
+	      << n << " nodes, "
+	      << new_count - news << " calls to operator new\n";
+    time = built;
+  }
+  if (owner != 0)
+    owner->release();
+  std::cout << label << ": time to tear down: "
+	    << (clock() - time) / float(CLOCKS_PER_SEC) << "s\n";
+}
+
+/*
+ * Stands for a LiteDisplacedLabel: a string and a small path.
+ */
+struct label {
+  std::string text;
+  std::vector<float> path;
+  label(const std::string& t) : text(t) { path.reserve(4); }
+};
+
+static void
+frames_heap(int frames, int labels)
+{
+  std::string text("a long enough label to avoid the small string optimization");
+  std::vector<label*> list;
+  unsigned long news = new_count;
+  clock_t time = clock();
+  for (int f = 0; f < frames; f++) {
+    list.clear();
+    for (int i = 0; i < labels; i++)
+      list.push_back(new label(text));
+    for (int i = 0; i < labels; i++)
+      delete list[i];
+  }
+  time = clock() - time;
+  std::cout << "heap labels: " << (new_count - news) / float(frames)
+	    << " calls to operator new per frame, "
+	    << time / float(CLOCKS_PER_SEC) << "s for "
+	    << frames << " frames\n";
+}
+
+static void
+frames_arena(int frames, int labels)
+{
+  std::string text("a long enough label to avoid the small string optimization");
+  std::vector<label*> list;
+  frame_arena scratch;
+  unsigned long news = new_count;
+  clock_t time = clock();
+  for (int f = 0; f < frames; f++) {
+    frame_arena::scope frame(scratch);
+    list.clear();
+    for (int i = 0; i < labels; i++)
+      list.push_back(scratch.create<label>(text));
+    for (int i = 0; i < labels; i++)
+      frame_arena::destroy(list[i]);
+  }
+  time = clock() - time;
+  std::cout << "arena labels: " << (new_count - news) / float(frames)
+	    << " calls to operator new per frame, "
+	    << time / float(CLOCKS_PER_SEC) << "s for "
+	    << frames << " frames, "
+	    << scratch.chunk_count() << " chunk(s) kept\n";
+}
+
+int
+main(int argc, char * argv[])
+{
+  int n = 10000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  build_tree<UnsignedColumn>(n, gc_alloc<unsigned,true>(), "std");
+  {
+    arena a(1024 * 1024, true);
+    build_tree<column_of<unsigned, arena_alloc<unsigned> > >
+      (n, arena_alloc<unsigned>(a), "arena", &a);
+  }
+  build_tree<column_of<unsigned, huge_page_alloc<unsigned> > >
+    (n, huge_page_alloc<unsigned>(), "huge pages");
+
+  frames_heap(1000, 200);
+  frames_arena(1000, 200);
+  return 0;
+}
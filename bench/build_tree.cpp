@@ -0,0 +1,88 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 20000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  // A file-system like tree: nodes listed in preorder, directories of
+  // up to 16 entries nested up to depth 12.
+  std::vector<unsigned> depths(n);
+  std::vector<tree::node_descriptor> parents(n);
+  std::vector<tree::node_descriptor> path(1, tree::root);
+  for (unsigned i = 1; i < n; i++) {
+    unsigned d = path.size() < 12 && rand() % 16 == 0
+      ? unsigned(path.size()) : 1 + rand() % path.size();
+    if (d > path.size())
+      d = unsigned(path.size());
+    depths[i] = d;
+    path.resize(d);
+    parents[i] = path.back();
+    path.push_back(i);
+  }
+
+  {
+    Clock::time_point t = Clock::now();
+    tree tr;
+    for (unsigned i = 1; i < n; i++)
+      tr.add_node(parents[i]);
+    report("Time to build with add_node", t, n, "nodes");
+  }
+  {
+    Clock::time_point t = Clock::now();
+    tree tr;
+    tr.build_from_parents(parents);
+    report("Time to build from parents", t, n, "nodes");
+  }
+  {
+    Clock::time_point t = Clock::now();
+    tree tr;
+    tr.build_from_depths(depths);
+    report("Time to build from preorder depths", t, n, "nodes");
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/drawing/colors/batch.hpp>
+#include <infovis/drawing/colors/color_lut.hpp>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+using namespace infovis;
+
+typedef color_rgba<unsigned char> Color;
+
+static void
+report(const char * what, clock_t time, unsigned n)
+{
+  std::cout << what << ": "
+	    << time / float(CLOCKS_PER_SEC) << "s for "
+	    << n << " colors = "
+	    << n * float(CLOCKS_PER_SEC) / time << " colors/s\n";
+}
+
+static inline Color
+interp(float t, const Color& c1, const Color& c2)
+{
+  Color ret;
+  for (int chan = 0; chan < 4; chan++)
+    detail::round(ret[chan], (1-t) * c1[chan] + t * c2[chan]);
+  return ret;
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 2000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  std::vector<float> a(n), b(n), c(n), r(n), g(n), bl(n);
+  std::vector<Color> out(n);
+  srand(1);
+  for (unsigned i = 0; i < n; i++) {
+    a[i] = rand() / float(RAND_MAX);
+    b[i] = rand() / float(RAND_MAX);
+    c[i] = rand() / float(RAND_MAX);
+  }
+
+  clock_t time = clock();
+  for (unsigned i = 0; i < n; i++) {
+    color_rgb<float> rgb;
+    convert(rgb, color_hsb(a[i], b[i], c[i]));
+    r[i] = rgb[0];
+  }
+  report("scalar hsb->rgb", clock() - time, n);
+
+  time = clock();
+  convert(rgb_span(&r[0], &g[0], &bl[0], n), hsb_span(&a[0], &b[0], &c[0], n));
+  report("batch hsb->rgb", clock() - time, n);
+
+  for (unsigned i = 0; i < n; i++) {
+    a[i] *= 360;
+    b[i] *= 100;
+    c[i] *= 50;
+  }
+  time = clock();
+  for (unsigned i = 0; i < n; i++) {
+    color_rgb<float> rgb;
+    convert(rgb, color_hvc(a[i], b[i], c[i]));
+    r[i] = rgb[0];
+  }
+  report("scalar hvc->rgb", clock() - time, n);
+
+  time = clock();
+  convert(rgb_span(&r[0], &g[0], &bl[0], n), hvc_span(&a[0], &b[0], &c[0], n));
+  report("batch hvc->rgb", clock() - time, n);
+
+  time = clock();
+  pack(&out[0], rgb_span(&r[0], &g[0], &bl[0], n));
+  report("batch pack rgba8", clock() - time, n);
+
+  // Mapping values through a ramp, as the color drawers do per node
+  std::vector<Color> ramp;
+  ramp.push_back(Color(255U,247U,251U));
+  ramp.push_back(Color(3U,78U,123U));
+  const float min = 0, range = 1;
+  const float scale = (ramp.size() - 1) / range;
+  time = clock();
+  for (unsigned i = 0; i < n; i++) {
+    float v = (a[i] / 360 - min) * scale;
+    int index = int(v);
+    if (index >= int(ramp.size()) - 1)
+      out[i] = ramp.back();
+    else
+      out[i] = interp(v - index, ramp[index], ramp[index+1]);
+  }
+  report("scalar ramp interpolation", clock() - time, n);
+
+  color_lut lut;
+  time = clock();
+  lut.build(ramp, true);
+  report("lut build", clock() - time, color_lut::lut_size);
+
+  for (unsigned i = 0; i < n; i++)
+    a[i] /= 360;
+  time = clock();
+  lut.map(&a[0], n, min, range, &out[0]);
+  report("lut ramp mapping", clock() - time, n);
+  return 0;
+}
@@ -0,0 +1,135 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <DerivedColumns.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/tree/visitor.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+struct depth_visitor {
+  unsigned depth_;
+  FloatColumn& col_;
+  depth_visitor(FloatColumn& col) : depth_(0), col_(col) { }
+  void preorder(tree::node_descriptor n) { col_[n] = depth_++; }
+  void inorder(tree::node_descriptor) { }
+  void postorder(tree::node_descriptor) { --depth_; }
+};
+
+static FloatColumn&
+leaf_weights(tree& t, const string& name)
+{
+  FloatColumn& w = *FloatColumn::find(name, t);
+  srand(17);
+  for (unsigned i = 0; i < t.num_nodes(); i++)
+    w[i] = t.is_leaf(i) ? float(rand() % 100000) : 0;
+  return w;
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 5000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  // Same file-system like tree as the build_tree bench.
+  std::vector<tree::node_descriptor> parents(n);
+  std::vector<tree::node_descriptor> path(1, tree::root);
+  for (unsigned i = 1; i < n; i++) {
+    unsigned d = path.size() < 12 && rand() % 16 == 0
+      ? unsigned(path.size()) : 1 + rand() % path.size();
+    if (d > path.size())
+      d = unsigned(path.size());
+    path.resize(d);
+    parents[i] = path.back();
+    path.push_back(i);
+  }
+  tree t;
+  t.build_from_parents(parents);
+
+  {
+    FloatColumn& w = leaf_weights(t, "w1");
+    Clock::time_point start = Clock::now();
+    sum_weights(t, w);
+    FloatColumn& log = *FloatColumn::find("log1", t);
+    FloatColumn& degree = *FloatColumn::find("degree1", t);
+    FloatColumn& sqrt = *FloatColumn::find("sqrt1", t);
+    FloatColumn& depth = *FloatColumn::find("depth1", t);
+    for (unsigned i = 0; i < n; i++)
+      log[i] = std::log(w[i] + 1.0);
+    sum_weights(t, log);
+    for (unsigned i = 0; i < n; i++)
+      degree[i] = t.is_leaf(i) ? 1 : 0;
+    sum_weights(t, degree);
+    for (unsigned i = 0; i < n; i++)
+      sqrt[i] = std::sqrt(w[i]);
+    sum_weights(t, sqrt);
+    depth_visitor vis(depth);
+    traverse_tree(tree::root, t, vis);
+    report("Time to derive columns in separate passes", start, n, "nodes");
+  }
+  {
+    FloatColumn& w = leaf_weights(t, "w2");
+    Clock::time_point start = Clock::now();
+    DerivedColumns derived(t, w);
+    derived.sumWeight();
+    derived.declare("log2", DerivedColumns::log_weight);
+    derived.declare("degree2", DerivedColumns::leaf_count);
+    derived.declare("sqrt2", DerivedColumns::sqrt_weight);
+    derived.declare("depth2", DerivedColumns::depth);
+    derived.computeAll();
+    report("Time to derive columns in one fused pass", start, n, "nodes");
+  }
+  {
+    FloatColumn& w = leaf_weights(t, "w3");
+    Clock::time_point start = Clock::now();
+    DerivedColumns derived(t, w);
+    derived.sumWeight();
+    derived.declare("log3", DerivedColumns::log_weight);
+    derived.declare("degree3", DerivedColumns::leaf_count);
+    derived.declare("sqrt3", DerivedColumns::sqrt_weight);
+    derived.declare("depth3", DerivedColumns::depth);
+    derived.require("log3");
+    report("Time to derive the displayed column only", start, n, "nodes");
+  }
+  return 0;
+}
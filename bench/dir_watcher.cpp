@@ -0,0 +1,136 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/dir_watcher.hpp>
+#include <infovis/tree/dir_tree.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace infovis;
+namespace fs = std::filesystem;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+static void
+write(const fs::path& p, unsigned size)
+{
+  std::ofstream out(p, std::ios::app);
+  out << std::string(size, 'x');
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 500000;
+  unsigned changes = 1000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+  if (argc > 2)
+    changes = atoi(argv[2]);
+
+  const fs::path dir = fs::temp_directory_path() /
+    ("bench_dir_watcher_" + std::to_string(getpid()));
+  const unsigned per_dir = 100;
+  const unsigned dirs = (n + per_dir - 1) / per_dir;
+  for (unsigned i = 0; i < n; i++) {
+    fs::path d = dir / std::to_string(i / per_dir / 32) /
+      std::to_string(i / per_dir);
+    if (i % per_dir == 0)
+      fs::create_directories(d);
+    write(d / std::to_string(i), 1 + rand() % 100);
+  }
+
+  tree t;
+  {
+    Clock::time_point start = Clock::now();
+    dir_tree(dir.string(), t);
+    report("Time to scan the directory", start, t.num_nodes(), "nodes");
+  }
+  dir_watcher w(t);
+  std::cout << w.watched() << " watched and " << w.polled()
+	    << " polled directories\n";
+
+  // Churn: grow, create and delete files spread over the tree, and
+  // measure until all the changes are in the tree.
+  {
+    std::vector<fs::path> created;
+    Clock::time_point start = Clock::now();
+    for (unsigned i = 0; i < changes; i++) {
+      unsigned f = rand() % n;
+      fs::path d = dir / std::to_string(f / per_dir / 32) /
+	std::to_string(f / per_dir);
+      switch (i % 3) {
+      case 0:
+	write(d / std::to_string(f), 10);
+	break;
+      case 1:
+	created.push_back(d / ("new" + std::to_string(i)));
+	write(created.back(), 10);
+	break;
+      default:
+	if (! created.empty()) {
+	  fs::remove(created.back());
+	  created.pop_back();
+	}
+      }
+    }
+    Clock::time_point changed = Clock::now();
+    report("Time to change the files", start, changes, "changes");
+    // The last update only waits for more events, it is not counted.
+    unsigned updated = 0;
+    Clock::time_point applied = changed;
+    while (unsigned u = w.update(100)) {
+      updated += u;
+      applied = Clock::now();
+    }
+    float time = std::chrono::duration<float>(applied - changed).count();
+    std::cout << "Time to apply after the last change: " << time
+	      << "s for " << updated << " entries\n";
+    std::cout << t.dirty_nodes().size() << " dirty nodes out of "
+	      << t.num_nodes() << " in " << dirs << " directories\n";
+  }
+  {
+    tree fresh;
+    Clock::time_point start = Clock::now();
+    dir_tree(dir.string(), fresh);
+    report("Time to rescan instead", start, fresh.num_nodes(), "nodes");
+  }
+  fs::remove_all(dir);
+  return 0;
+}
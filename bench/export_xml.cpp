@@ -0,0 +1,90 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/export_tree_xml.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << "Time to " << what << ": "
+	    << time << "s for "
+	    << n << " nodes = "
+	    << n / time << " nodes/s\n";
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 5000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  tree t(n);
+  StringColumn& name = *StringColumn::find("name", t);
+  FloatColumn& size = *FloatColumn::find("size", t);
+  UnsignedColumn& date = *UnsignedColumn::find("date", t);
+  srand(1);
+  name[0] = "/";
+  for (unsigned i = 1; i < n; i++) {
+    tree::node_descriptor c = t.add_node(rand() % i);
+    name[c] = "file" + std::to_string(c) + ".txt";
+    size[c] = rand() / 3.0f;
+    date[c] = rand();
+  }
+
+  Clock::time_point start = Clock::now();
+  {
+    std::ofstream out("export_stream.xml");
+    export_tree_xml(out, t);
+  }
+  report("export with ostream", start, n);
+
+  start = Clock::now();
+  export_tree_xml("export_fast.xml", t);
+  report("export with buffer", start, n);
+
+  start = Clock::now();
+  export_tree_xml("export_fast.xml", t, 0);
+  report("export with parallel buffers", start, n);
+
+  start = Clock::now();
+  export_tree_xml("export_fast.xml.gz", t);
+  report("export compressed", start, n);
+
+  std::remove("export_stream.xml");
+  std::remove("export_fast.xml");
+  std::remove("export_fast.xml.gz");
+  return 0;
+}
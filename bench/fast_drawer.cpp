@@ -0,0 +1,131 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <FastDrawer.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/tree/treemap/squarified.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s, "
+	    << time * 1e9f / n << "ns/" << unit << "\n";
+}
+
+struct no_orient
+{
+  bool operator()(const Box& b, node_descriptor, unsigned) const {
+    return width(b) > height(b);
+  }
+};
+
+// Measures the per-box cost of the drawer in dryrun mode, where the
+// vertices are computed but nothing is sent to GL.
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 2000000;
+  unsigned rounds = 10;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  Tree t;
+  std::vector<node_descriptor> parents(n);
+  for (unsigned i = 1; i < n; i++)
+    parents[i] = i < 64 ? 0 : i / 16;
+  t.build_from_parents(parents);
+  FloatColumn * weight = FloatColumn::find("weight", t);
+  FloatColumn * color = FloatColumn::find("color", t);
+  FilterColumn * filter = FilterColumn::find("$filter", t);
+  for (unsigned i = 0; i < n; i++) {
+    weight->set(i, is_leaf(i, t) ? float(1 + rand() % 100) : 0);
+    color->set(i, float(rand() % 10));
+    filter->set(i, 0);
+  }
+  sum_weights(t, *weight);
+
+  FastDrawer drawer(t, color);
+  drawer.set_color_prop(color);
+  drawer.set_dryrun(true);
+
+  Clock::time_point start = Clock::now();
+  drawer.update_color_index();
+  report("Time to compute the color index", start, n, "box");
+
+  // What draw_box did before the color index: read the float color
+  // and scale it for each box.
+  Box b(0, 0, 10, 10);
+  const column_view<float> colors(*color);
+  const column_view<unsigned> filters(*filter);
+  start = Clock::now();
+  for (unsigned r = 0; r < rounds; r++) {
+    for (unsigned i = 0; i < n; i++)
+      if (filters[i] == 0)
+	drawer.push(b, 1, colors[i]);
+    drawer.flush();
+  }
+  report("Time to draw boxes from float colors (dryrun)", start,
+	 n * rounds, "box");
+
+  start = Clock::now();
+  for (unsigned r = 0; r < rounds; r++) {
+    for (unsigned i = 0; i < n; i++)
+      drawer.draw_box(b, i, 1);
+    drawer.flush();
+  }
+  report("Time to draw boxes from the color index (dryrun)", start,
+	 n * rounds, "box");
+
+  start = Clock::now();
+  std::vector<node_descriptor> changed;
+  for (unsigned i = 0; i < n / 100; i++) {
+    node_descriptor c = rand() % n;
+    color->set(c, float(rand() % 10));
+    changed.push_back(c);
+  }
+  drawer.update_color_index(changed);
+  report("Time to update 1% of the color index", start, n / 100, "box");
+
+  start = Clock::now();
+  unsigned visited = 0;
+  for (unsigned r = 0; r < rounds; r++) {
+    treemap_squarified<Tree, Box, const FloatColumn&, FastDrawer&, no_orient>
+      treemap(t, *weight, drawer);
+    visited += treemap.visit(Box(0, 0, 4096, 4096), root(t));
+  }
+  report("Time to lay out a squarified treemap (dryrun)", start, visited, "box");
+  return 0;
+}
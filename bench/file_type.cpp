@@ -0,0 +1,116 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <FileType.hpp>
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " names = "
+	    << n / time << " names/s\n";
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 10000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+  const char * types = argc > 2 ? argv[2] : "file_types.txt";
+
+  FileType ft;
+  ft.load(types);
+  if (ft.extensionCount() == 0) {
+    std::cerr << "cannot load " << types << std::endl;
+    return 1;
+  }
+
+  // Synthetic names: mostly known extensions, some unknown ones, some
+  // compressed files, directories and names without extension.
+  std::vector<string> names(n);
+  srand(1);
+  for (unsigned i = 0; i < n; i++) {
+    string& name = names[i];
+    name = "file";
+    name += std::to_string(rand() % 100000);
+    switch (rand() % 10) {
+    case 0:
+      name += "/";
+      break;
+    case 1:
+      break;
+    case 2:
+      name += ".unknown";
+      break;
+    case 3:
+      name += "." + ft.getExtension(rand() % ft.extensionCount()) + ".gz";
+      break;
+    default:
+      name += "." + ft.getExtension(rand() % ft.extensionCount());
+    }
+  }
+  std::vector<float> map_type(n), trie_type(n);
+
+  Clock::time_point start = Clock::now();
+  for (unsigned i = 0; i < n; i++)
+    map_type[i] = ft.fileType(names[i]).getCode();
+  report("std::map classification", start, n);
+
+  FileTypeTrie trie(ft);
+  start = Clock::now();
+  for (unsigned i = 0; i < n; i++)
+    trie_type[i] = trie.fileType(names[i]).getCode();
+  report("trie classification", start, n);
+  if (trie_type != map_type) {
+    std::cerr << "trie and std::map classifications differ\n";
+    return 1;
+  }
+
+  unsigned threads = infovis::parallel_threads(n);
+  std::fill(trie_type.begin(), trie_type.end(), 0);
+  start = Clock::now();
+  infovis::parallel_for(n, threads,
+			[&](unsigned, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; i++)
+      trie_type[i] = trie.fileType(names[i]).getCode();
+  });
+  std::cout << threads << " threads, ";
+  report("parallel trie classification", start, n);
+  if (trie_type != map_type) {
+    std::cerr << "parallel classification differs\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,138 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/drawing/lite/LiteBox.hpp>
+#include <infovis/drawing/lite/LiteRect.hpp>
+#include <infovis/drawing/lite/LayoutBox.hpp>
+#include <infovis/drawing/lite/LiteWindow.hpp>
+#include <GL/glut.h>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+// Builds a group of n children, querying the bounds after every
+// insertion when eager is set, as the group used to do.
+static void
+build(LiteGroup * group, unsigned n, bool eager)
+{
+  for (unsigned i = 0; i < n; i++) {
+    group->addChild(new LiteRect(Box(0, 0, 10, 10), color_white));
+    if (eager)
+      group->getBounds();
+  }
+  group->getBounds();
+}
+
+static LiteWindow * win;
+static LiteShape * hovered[20];
+static unsigned frames = 1000;
+static unsigned frame;
+static Clock::time_point start;
+
+static void
+hover(int)
+{
+  if (frame == 0)
+    start = Clock::now();
+  // Enter one widget and leave the previous one, as the mouse does.
+  LiteShape * enter = hovered[frame % 20];
+  LiteShape * leave = hovered[(frame + 19) % 20];
+  leave->setColor(color_black);
+  leave->damage();
+  enter->setColor(color_red);
+  enter->damage();
+  if (++frame == frames) {
+    glFinish();
+    if (win->getPartialRedraw()) {
+      report("Time to redraw hover frames (damage)", start, frames, "frames");
+      win->setPartialRedraw(false);
+      frame = 0;
+    }
+    else {
+      report("Time to redraw hover frames (full)", start, frames, "frames");
+      exit(0);
+    }
+  }
+  glutTimerFunc(0, hover, 0);
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 10000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  Clock::time_point t = Clock::now();
+  build(new LiteGroup(), n, true);
+  report("Time to build group (eager bounds)", t, n, "children");
+  t = Clock::now();
+  build(new LiteGroup(), n, false);
+  report("Time to build group (lazy bounds)", t, n, "children");
+  t = Clock::now();
+  build(new LiteBox(new LayoutBox()), n, true);
+  report("Time to build box (eager layout)", t, n, "children");
+  t = Clock::now();
+  build(new LiteBox(new LayoutBox()), n, false);
+  report("Time to build box (lazy layout)", t, n, "children");
+
+  // Hover frames: a large static scene standing for the treemap, and a
+  // column of controls highlighted in turn.
+  LiteWindow::init(argc, argv);
+  win = new LiteWindow(argv[0], Box(0, 0, 1024, 768));
+  LiteGroup * scene = new LiteGroup(Box(0, 0, 800, 768));
+  for (unsigned i = 0; i < 100000; i++) {
+    float x = float(rand() % 790), y = float(rand() % 758);
+    scene->addChild(new LiteRect(Box(x, y, x + 10, y + 10),
+				 Color(unsigned(rand() % 256),
+				       unsigned(rand() % 256),
+				       unsigned(rand() % 256))));
+  }
+  win->addChild(scene);
+  LiteGroup * controls = new LiteGroup(Box(800, 0, 1024, 768));
+  for (int i = 0; i < 20; i++) {
+    hovered[i] = new LiteRect(Box(810, 10 + 38 * i, 1014, 40 + 38 * i),
+			      color_black);
+    controls->addChild(hovered[i]);
+  }
+  win->addChild(controls);
+  glutTimerFunc(0, hover, 0);
+  win->run();
+  return 0;
+}
@@ -0,0 +1,129 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/gen_tree.hpp>
+#include <infovis/tree/treemap/squarified.hpp>
+#include <infovis/tree/treemap/slice_and_dice.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+typedef box_min_max<float> Box;
+
+static float
+millis(Clock::duration d)
+{
+  return std::chrono::duration<float, std::milli>(d).count();
+}
+
+// Prunes the boxes thinner than a pixel and fills a vertex buffer,
+// like the treemap2 drawer without the GL calls.
+struct buffer_drawer : public null_drawer<tree,Box> {
+  std::vector<float> vertices;
+
+  bool begin_box(const Box& b, node_descriptor n, unsigned depth) {
+    return int(xmin(b)) != int(xmax(b)) && int(ymin(b)) != int(ymax(b));
+  }
+  void draw_box(const Box& b, node_descriptor n, unsigned depth) {
+    if (vertices.size() > (1 << 16))
+      vertices.clear();
+    const float v[] = { xmin(b), ymin(b), xmax(b), ymin(b),
+			xmax(b), ymax(b), xmin(b), ymax(b) };
+    vertices.insert(vertices.end(), v, v + 8);
+  }
+};
+
+// The time between two checks of the event queue is the time of a
+// frame: the whole layout when drawn at once, a slice when drawn
+// progressively.
+template <class Layout, class Start, class Visit>
+static void
+measure(const char * what, Layout& layout, Start start, Visit visit,
+	unsigned budget_ms)
+{
+  Clock::time_point t = Clock::now();
+  const unsigned once = visit();
+  const float full = millis(Clock::now() - t);
+
+  start();
+  std::vector<float> slices;
+  unsigned drawn = 0;
+  t = Clock::now();
+  while (! layout.finished()) {
+    Clock::time_point s = Clock::now();
+    drawn += layout.resume(frame_budget(std::chrono::milliseconds(budget_ms)));
+    slices.push_back(millis(Clock::now() - s));
+  }
+  const float total = millis(Clock::now() - t);
+  std::sort(slices.begin(), slices.end());
+  std::cout << what << ": " << once << " boxes in one frame of "
+	    << full << "ms, " << drawn << " boxes in "
+	    << slices.size() << " slices of " << budget_ms << "ms, longest "
+	    << slices.back() << "ms, median " << slices[slices.size() / 2]
+	    << "ms, total " << total << "ms\n";
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 2000000;
+  unsigned budget = argc > 2 ? atoi(argv[2]) : 16;
+
+  gen_tree_params p;
+  p.nodes = n;
+  p.names = false;
+  tree t;
+  gen_tree(t, p);
+  const FloatColumn& size = *FloatColumn::find("size", t);
+  const Box box(0, 0, 1920, 1080);
+
+  for (unsigned shape = 0; shape < 2; shape++) {
+    if (shape == 1) {
+      // Constant weights keep many more boxes above a pixel.
+      p.weight = gen_weight_constant;
+      gen_tree(t, p);
+      std::cout << "Constant weights\n";
+    }
+    else
+      std::cout << "Power law weights\n";
+    buffer_drawer drawer;
+    treemap_squarified<tree,Box,const FloatColumn&,buffer_drawer&>
+      sq(t, size, drawer);
+    measure("squarified", sq,
+	    [&]() { sq.start_progressive(box, tree::root); },
+	    [&]() { return sq.visit(box, tree::root); }, budget);
+    treemap_slice_and_dice<tree,Box,const FloatColumn&,buffer_drawer&>
+      sd(t, size, drawer);
+    measure("slice and dice", sd,
+	    [&]() { sd.start_progressive(left_to_right, box, tree::root); },
+	    [&]() { return sd.visit(left_to_right, box, tree::root); },
+	    budget);
+  }
+  return 0;
+}
@@ -0,0 +1,93 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <ScatterPlotDensity.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+static float
+frand(float max)
+{
+  return float(rand()) / RAND_MAX * max;
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 10000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  FloatColumn x_axis("x", n), y_axis("y", n), color("color", n);
+  for (unsigned i = 0; i < n; i++) {
+    x_axis.add(frand(1000));
+    y_axis.add(frand(1000));
+    color.add(frand(10));
+  }
+
+  // One cell per pixel of a 1024x768 plot.
+  ScatterPlotDensity d;
+  d.set_grid(1024, 768);
+  d.set_domain(0, 1000, 0, 1000);
+
+  Clock::time_point t = Clock::now();
+  d.compute(x_axis, y_axis, color, 0, 1);
+  report("Time to bin (1 thread)", t, n, "points");
+  t = Clock::now();
+  d.compute(x_axis, y_axis, color);
+  report("Time to bin (all threads)", t, n, "points");
+
+  t = Clock::now();
+  d.sort(x_axis, y_axis);
+  report("Time to sort the axes", t, n, "points");
+
+  // Zoom on 1% of the x range.
+  d.set_domain(500, 510, 0, 1000);
+  t = Clock::now();
+  d.compute(x_axis, y_axis, color);
+  report("Time to rebin a zoomed range (sorted)", t, n, "points");
+  std::cout << d.scanned() << " rows visited, "
+	    << d.total() << " points binned\n";
+  d.clear_sort();
+  t = Clock::now();
+  d.compute(x_axis, y_axis, color);
+  report("Time to rebin a zoomed range (scan)", t, n, "points");
+  return 0;
+}
@@ -0,0 +1,125 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <ScatterPlotIndex.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+static float
+frand(float max)
+{
+  return float(rand()) / RAND_MAX * max;
+}
+
+// The former ScatterPlotPicker: project every node and test its box.
+static unsigned
+linear_pick(const FloatColumn& x_axis, const FloatColumn& y_axis,
+	    const FloatColumn& weight, const ScatterPlotGeometry& g,
+	    const Point& pos)
+{
+  float plot_max = g.plot_min + g.plot_range;
+  float x_scale = (width(g.bounds)-plot_max*2) / (g.x_max - g.x_min);
+  float y_scale = (height(g.bounds)-plot_max*2) / (g.y_max - g.y_min);
+  float weight_scale = (g.plot_range-1) / (g.weight_max - g.weight_min);
+  unsigned hits = 0;
+  for (int n = x_axis.size()-1; n >= 0; n--) {
+    Point p((x_axis[n] - g.x_min) * x_scale + g.plot_range + xmin(g.bounds),
+	    (y_axis[n] - g.y_min) * y_scale + g.plot_range + ymin(g.bounds));
+    float w = 1.0f + (weight[n] - g.weight_min) * weight_scale + g.plot_min;
+    Box b(x(p)-w, y(p)-w, x(p)+w, y(p)+w);
+    if (inside(b, x(pos), y(pos)))
+      hits++;
+  }
+  return hits;
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 5000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  FloatColumn x_axis("x", n), y_axis("y", n), weight("weight", n),
+    color("color", n);
+  for (unsigned i = 0; i < n; i++) {
+    x_axis.add(frand(1000));
+    y_axis.add(frand(1000));
+    weight.add(frand(1) * frand(1) * 100);
+    color.add(frand(10));
+  }
+  ScatterPlotGeometry g;
+  g.bounds = Box(0, 0, 1024, 768);
+  g.x_min = 0; g.x_max = 1000;
+  g.y_min = 0; g.y_max = 1000;
+  g.weight_min = 0; g.weight_max = 100;
+  g.plot_min = 0; g.plot_range = 10;
+
+  Clock::time_point t = Clock::now();
+  ScatterPlotIndex index;
+  index.build(x_axis, y_axis, weight, color, nullptr, g);
+  report("Time to build buckets and grids", t, n, "points");
+  std::cout << index.bucket_count() << " buckets\n";
+
+  const unsigned linear_picks = 10;
+  unsigned linear_hits = 0;
+  t = Clock::now();
+  for (unsigned i = 0; i < linear_picks; i++)
+    linear_hits += linear_pick(x_axis, y_axis, weight, g,
+			       Point(100 + 80 * i, 50 + 60 * i));
+  report("Time to pick linearly", t, linear_picks, "picks");
+
+  const unsigned grid_picks = 10000;
+  ScatterPlotIndex::HitTable hits;
+  unsigned grid_hits = 0;
+  t = Clock::now();
+  for (unsigned i = 0; i < grid_picks; i++) {
+    index.pick(Point(100 + 80 * (i % linear_picks),
+		     50 + 60 * (i % linear_picks)), hits);
+    grid_hits += unsigned(hits.size());
+  }
+  report("Time to pick with the grid", t, grid_picks, "picks");
+  // The grid tests the rounded size a point is drawn at, so the
+  // counts may differ slightly from the exact sizes.
+  std::cout << "Hits: " << linear_hits << " linear (exact sizes), "
+	    << grid_hits / (grid_picks / linear_picks)
+	    << " grid (bucket sizes)\n";
+  return 0;
+}
@@ -0,0 +1,112 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/tree/treemap/squarified.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+typedef box_min_max<float> Box;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s, "
+	    << time * 1e9f / n << "ns/" << unit << "\n";
+}
+
+// Counts the strips, and those thinner than a pixel.
+struct strip_counter : public null_drawer<tree,Box> {
+  unsigned strips = 0;
+  unsigned thin = 0;
+  void begin_strip(const Box& b, node_descriptor, unsigned, direction) {
+    strips++;
+    if (width(b) < 1 || height(b) < 1)
+      thin++;
+  }
+};
+
+// Lays out one node with a million children sorted by decreasing
+// weight, like a huge flat directory, breaking the strips by growing
+// them one child at a time and by searching the running sums.  In the
+// 4096x4096 box the areas are exact integers and both versions produce
+// the same strips; in the 4000x4000 box they are not, and the float
+// sums of the growing strips drift.
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 1000000;
+  unsigned rounds = 10;
+  if (argc > 1)
+    n = atoi(argv[1]);
+
+  tree t;
+  std::vector<tree::node_descriptor> parents(n + 1, tree::root);
+  t.build_from_parents(parents);
+  FloatColumn& weight = *FloatColumn::find("weight", t);
+  const unsigned total = 4096 * 4096;
+  std::vector<float> w(n);
+  unsigned left = total;
+  for (unsigned i = 0; i < n; i++) {
+    w[i] = i + 1 == n ? left : std::min(left, unsigned(1 + rand() % 32));
+    left -= unsigned(w[i]);
+  }
+  std::sort(w.begin(), w.end(), std::greater<float>());
+  weight.resize(n + 1);
+  for (unsigned i = 0; i < n; i++)
+    weight[i + 1] = w[i];
+  sum_weights(t, weight);
+
+  const Box boxes[] = { Box(0, 0, 4096, 4096), Box(0, 0, 4000, 4000) };
+  for (const Box& box : boxes) {
+    std::cout << "Box " << width(box) << "x" << height(box) << "\n";
+    for (int sorted = 0; sorted < 2; sorted++) {
+      strip_counter counter;
+      treemap_squarified<tree, Box, const FloatColumn&, strip_counter&>
+	treemap(t, weight, counter);
+      treemap.set_sorted(sorted != 0);
+      Clock::time_point start = Clock::now();
+      unsigned visited = 0;
+      for (unsigned r = 0; r < rounds; r++)
+	visited += treemap.visit(box, root(t));
+      report(sorted ? "Time to lay out with running sums"
+	     : "Time to lay out growing strips", start, visited, "box");
+      std::cout << counter.strips / rounds << " strips, "
+		<< counter.thin / rounds << " thinner than a pixel\n";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,142 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree_diff.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+// Matching on full path strings, what a straightforward diff does.
+static unsigned
+match_strings(const tree& from, const tree& to)
+{
+  std::vector<std::string> path;
+  std::unordered_map<std::string, tree::node_descriptor> index;
+  const tree * trees[] = { &from, &to };
+  unsigned matched = 0;
+  for (const tree * t : trees) {
+    const StringColumn& names = *StringColumn::cast(t->find_column("name"));
+    std::vector<tree::node_descriptor> order(1, tree::root);
+    path.assign(t->num_nodes(), std::string());
+    for (unsigned i = 0; i < order.size(); i++) {
+      tree::node_descriptor p = order[i];
+      for (tree::node_descriptor c = t->child(p); c != tree::nil();
+	   c = t->next(c)) {
+	path[c] = path[p] + "/" + names.get(c);
+	order.push_back(c);
+      }
+    }
+    for (tree::node_descriptor n : order) {
+      if (t == &from)
+	index.emplace(path[n], n);
+      else
+	matched += index.count(path[n]);
+    }
+  }
+  return matched;
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 3000000;
+  unsigned threads = 0;
+  if (argc > 1)
+    n = atoi(argv[1]);
+  if (argc > 2)
+    threads = atoi(argv[2]);
+
+  // Same file-system like tree as the build_tree bench, with file
+  // names unique among their siblings.
+  std::vector<tree::node_descriptor> parents(n);
+  std::vector<tree::node_descriptor> path(1, tree::root);
+  for (unsigned i = 1; i < n; i++) {
+    unsigned d = path.size() < 12 && rand() % 16 == 0
+      ? unsigned(path.size()) : 1 + rand() % path.size();
+    if (d > path.size())
+      d = unsigned(path.size());
+    path.resize(d);
+    parents[i] = path.back();
+    path.push_back(i);
+  }
+  tree from;
+  from.build_from_parents(parents);
+  StringColumn& names = *StringColumn::find("name", from);
+  FloatColumn& size = *FloatColumn::find("size", from);
+  for (unsigned i = 0; i < n; i++) {
+    names[i] = "file_" + std::to_string(i) + ".dat";
+    size[i] = float(rand() % 100000);
+  }
+
+  // The next day: some files grew, some directories went away and
+  // new ones appeared.
+  tree to(from);
+  FloatColumn& to_size = *FloatColumn::find("size", to);
+  StringColumn& to_names = *StringColumn::find("name", to);
+  const tree::node_descriptor sub[] = { 0, 0, 0, 1, 1, 2, 2, 2 };
+  for (unsigned k = 0; k < n / 1000; k++) {
+    to_size[rand() % n] = float(rand() % 100000);
+    tree::node_descriptor r = 1 + rand() % (n - 1);
+    if (! to.removed(r))
+      to.remove_subtree(r);
+    tree::node_descriptor base =
+      to.add_subtree(parents[rand() % n], sub, 8);
+    for (unsigned j = 0; j < 8; j++)
+      to_names[base + j] = "new_" + std::to_string(base + j);
+  }
+
+  tree_diff d;
+  {
+    Clock::time_point start = Clock::now();
+    diff_trees(from, to, d, "name", "size", threads);
+    report("Time to diff by path hash", start, n, "nodes");
+    std::cout << d.added.size() << " added, "
+	      << d.removed.size() << " removed, "
+	      << d.changed.size() << " changed\n";
+  }
+  {
+    Clock::time_point start = Clock::now();
+    unsigned matched = match_strings(from, to);
+    report("Time to match path strings", start, n, "nodes");
+    std::cout << matched << " matched\n";
+  }
+  return 0;
+}
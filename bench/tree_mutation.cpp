@@ -0,0 +1,110 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/table/metadata.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s\n";
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 5000000;
+  unsigned updates = 1000000;
+  if (argc > 1)
+    n = atoi(argv[1]);
+  if (argc > 2)
+    updates = atoi(argv[2]);
+
+  // Same file-system like tree as the build_tree bench.
+  std::vector<tree::node_descriptor> parents(n);
+  std::vector<tree::node_descriptor> path(1, tree::root);
+  for (unsigned i = 1; i < n; i++) {
+    unsigned d = path.size() < 12 && rand() % 16 == 0
+      ? unsigned(path.size()) : 1 + rand() % path.size();
+    if (d > path.size())
+      d = unsigned(path.size());
+    path.resize(d);
+    parents[i] = path.back();
+    path.push_back(i);
+  }
+  tree t;
+  t.build_from_parents(parents);
+
+  FloatColumn& size = *FloatColumn::find("size", t);
+  size.put_metadata(metadata::aggregate, metadata::aggregate_sum);
+  std::vector<tree::node_descriptor> leaves;
+  for (unsigned i = 0; i < n; i++) {
+    if (t.is_leaf(i)) {
+      leaves.push_back(i);
+      size[i] = float(rand() % 100000);
+    }
+  }
+
+  {
+    Clock::time_point start = Clock::now();
+    sum_weights(t, size);
+    report("Time to sum the whole tree", start, 1, "sums");
+  }
+  {
+    Clock::time_point start = Clock::now();
+    for (unsigned i = 0; i < updates; i++)
+      t.set_leaf_value(leaves[rand() % leaves.size()], size,
+		       float(rand() % 100000));
+    report("Time to update random leaves", start, updates, "updates");
+    std::cout << t.dirty_nodes().size() << " dirty nodes\n";
+  }
+  {
+    std::vector<tree::node_descriptor> sub(16);
+    for (unsigned i = 1; i < sub.size(); i++)
+      sub[i] = rand() % i;
+    const unsigned moves = updates / 100;
+    Clock::time_point start = Clock::now();
+    for (unsigned i = 0; i < moves; i++) {
+      tree::node_descriptor s =
+	t.add_subtree(parents[leaves[rand() % leaves.size()]],
+		      sub.data(), unsigned(sub.size()));
+      t.remove_subtree(s);
+    }
+    report("Time to add and remove subtrees", start, moves, "subtrees");
+  }
+  return 0;
+}
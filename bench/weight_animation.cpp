@@ -0,0 +1,119 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/tree/treemap/squarified_anim.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::chrono::steady_clock Clock;
+typedef box_min_max<float> Box;
+typedef weight_interpolator<FloatColumn> Interp;
+typedef treemap_squarified_anim<tree, Box, null_drawer<tree,Box>,
+				const FloatColumn&, Interp&> Treemap;
+
+static void
+report(const char * what, Clock::time_point start, unsigned n,
+       const char * unit)
+{
+  float time = std::chrono::duration<float>(Clock::now() - start).count();
+  std::cout << what << ": "
+	    << time << "s for "
+	    << n << " " << unit << " = "
+	    << n / time << " " << unit << "/s, "
+	    << time * 1e3f / n << "ms/" << unit << "\n";
+}
+
+// Plays an animation between two weightings of a tree, laying out
+// both weights on every frame as visit_anim does, then recording the
+// strips of the first layout once and replaying them with the
+// materialized interpolated weights.
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 1000000;
+  unsigned frames = 20;
+  unsigned threads = 0;
+  if (argc > 1)
+    n = atoi(argv[1]);
+  if (argc > 2)
+    threads = atoi(argv[2]);
+
+  tree t;
+  std::vector<tree::node_descriptor> parents(n);
+  for (unsigned i = 1; i < n; i++)
+    parents[i] = i < 64 ? 0 : i / 16;
+  t.build_from_parents(parents);
+  FloatColumn& weight = *FloatColumn::find("weight", t);
+  FloatColumn& next = *FloatColumn::find("next", t);
+  weight.resize(n);
+  next.resize(n);
+  for (unsigned i = 0; i < n; i++) {
+    weight[i] = t.is_leaf(i) ? float(1 + rand() % 100) : 0;
+    next[i] = t.is_leaf(i) ? float(1 + rand() % 100) : 0;
+  }
+  sum_weights(t, weight);
+  sum_weights(t, next);
+
+  Interp interp(weight, next);
+  interp.set_std_balance();
+  const Box box(0, 0, 4096, 4096);
+  Treemap treemap(t, weight, interp);
+
+  Clock::time_point start = Clock::now();
+  unsigned visited = 0;
+  for (unsigned f = 0; f < frames; f++) {
+    interp.set_param(float(f + 1) / frames);
+    visited += treemap.visit_anim(box, box, root(t));
+  }
+  report("Time to lay out both weights per frame", start, frames, "frame");
+
+  start = Clock::now();
+  treemap.prepare(box, root(t));
+  report("Time to record the strips", start, 1, "transition");
+
+  start = Clock::now();
+  for (unsigned f = 0; f < frames; f++) {
+    interp.set_param(float(f + 1) / frames);
+    treemap.interpolate(threads);
+  }
+  report("Time to materialize the weights", start, frames, "frame");
+
+  start = Clock::now();
+  unsigned replayed = 0;
+  for (unsigned f = 0; f < frames; f++) {
+    interp.set_param(float(f + 1) / frames);
+    treemap.interpolate(threads);
+    replayed += treemap.visit_prepared(box);
+  }
+  report("Time to replay the strips per frame", start, frames, "frame");
+  if (replayed != visited)
+    std::cout << "Visited " << visited << " boxes but replayed "
+	      << replayed << "\n";
+  return 0;
+}
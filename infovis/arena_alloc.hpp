@@ -0,0 +1,379 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_ARENA_ALLOC_HPP
+#define INFOVIS_ARENA_ALLOC_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace infovis {
+
+/**
+ * Blocks larger than this size are mapped directly and backed by huge
+ * pages when the system allows it.
+ */
+const std::size_t huge_page_threshold = 2 * 1024 * 1024;
+
+/**
+ * Round a size up to a multiple of the huge page size.
+ */
+inline std::size_t
+huge_page_round(std::size_t size)
+{
+  return (size + huge_page_threshold - 1) & ~(huge_page_threshold - 1);
+}
+
+/**
+ * Allocate a block of memory, backed by huge pages if possible.
+ *
+ * Small blocks come from operator new.  Large blocks are mapped with
+ * MAP_HUGETLB when huge pages are reserved, otherwise with a regular
+ * anonymous mapping advised with MADV_HUGEPAGE so transparent huge
+ * pages can be used.
+ * @param size the size in bytes
+ * @return the block, never null
+ */
+inline void *
+huge_page_allocate(std::size_t size)
+{
+#if defined(MAP_ANONYMOUS)
+  if (size >= huge_page_threshold) {
+    std::size_t len = huge_page_round(size);
+    void * p = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+    p = ::mmap(0, len, PROT_READ|PROT_WRITE,
+	       MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+#endif
+    if (p == MAP_FAILED) {
+      p = ::mmap(0, len, PROT_READ|PROT_WRITE,
+		 MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED)
+	throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE)
+      ::madvise(p, len, MADV_HUGEPAGE);
+#endif
+    }
+    return p;
+  }
+#endif
+  return ::operator new(size);
+}
+
+/**
+ * Release a block allocated with huge_page_allocate.
+ * @param p the block
+ * @param size the size used for allocating it
+ */
+inline void
+huge_page_deallocate(void * p, std::size_t size)
+{
+  if (p == 0)
+    return;
+#if defined(MAP_ANONYMOUS)
+  if (size >= huge_page_threshold) {
+    ::munmap(p, huge_page_round(size));
+    return;
+  }
+#endif
+  ::operator delete(p);
+}
+
+/**
+ * Monotonic memory arena.
+ *
+ * Memory is carved out of large chunks and is never released
+ * individually; everything goes away at once when the arena is
+ * reset or destroyed.  This suits data built once and thrown away as
+ * a whole, such as a loaded tree and its columns.
+ */
+class arena
+{
+public:
+  /**
+   * Create an arena.
+   * @param chunk_size the minimum size of the chunks requested from
+   * the system
+   * @param huge_pages true to back large chunks with huge pages
+   */
+  explicit arena(std::size_t chunk_size = 64 * 1024,
+		 bool huge_pages = false)
+    : chunk_size_(chunk_size),
+      huge_pages_(huge_pages),
+      head_(0), cur_(0), end_(0),
+      used_(0), count_(0), chunks_(0)
+  { }
+
+  ~arena() { release(); }
+
+  /**
+   * Allocate a block in the arena.
+   * @param n the size in bytes
+   * @param align the required alignment, a power of 2
+   * @return the block
+   */
+  void * allocate(std::size_t n,
+		  std::size_t align = alignof(std::max_align_t)) {
+    char * p = align_up(cur_, align);
+    if (p == 0 || p + n > end_) {
+      grow(n + align);
+      p = align_up(cur_, align);
+    }
+    cur_ = p + n;
+    used_ += n;
+    count_++;
+    return p;
+  }
+
+  /**
+   * Deallocation is a no-op, memory is reclaimed by reset().
+   */
+  void deallocate(void *, std::size_t) { }
+
+  /**
+   * Construct an object in the arena.  Its destructor is not called
+   * by the arena, use destroy() when it owns resources.
+   */
+  template <class T, class... Args>
+  T * create(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T)))
+      T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Call the destructor of an object created in the arena.
+   */
+  template <class T>
+  static void destroy(T * p) { p->~T(); }
+
+  /**
+   * Forget all the allocations.  When several chunks have been used,
+   * they are replaced by a single one large enough to hold them all
+   * so that a steady workload stops asking memory from the system.
+   */
+  void reset() {
+    std::size_t total = 0;
+    for (chunk * c = head_; c != 0; c = c->next)
+      total += c->size;
+    if (head_ != 0 && head_->next != 0) {
+      release();
+      grow(total);
+    }
+    else if (head_ != 0) {
+      cur_ = reinterpret_cast<char*>(head_ + 1);
+    }
+    used_ = 0;
+    count_ = 0;
+  }
+
+  /**
+   * Release all the chunks to the system.
+   */
+  void release() {
+    while (head_ != 0) {
+      chunk * c = head_;
+      head_ = c->next;
+      if (huge_pages_)
+	huge_page_deallocate(c, c->size);
+      else
+	::operator delete(c);
+    }
+    cur_ = end_ = 0;
+    used_ = 0;
+    count_ = 0;
+    chunks_ = 0;
+  }
+
+  /**
+   * Return the number of bytes handed out since the last reset.
+   */
+  std::size_t bytes_used() const { return used_; }
+
+  /**
+   * Return the number of allocations since the last reset.
+   */
+  std::size_t allocation_count() const { return count_; }
+
+  /**
+   * Return the number of chunks requested from the system.
+   */
+  std::size_t chunk_count() const { return chunks_; }
+
+private:
+  struct chunk {
+    chunk * next;
+    std::size_t size;
+  };
+
+  arena(const arena&);		// not copyable
+  arena& operator = (const arena&);
+
+  static char * align_up(char * p, std::size_t align) {
+    std::size_t a = reinterpret_cast<std::size_t>(p);
+    return reinterpret_cast<char*>((a + align - 1) & ~(align - 1));
+  }
+
+  void grow(std::size_t n) {
+    std::size_t size = n + sizeof(chunk);
+    if (size < chunk_size_)
+      size = chunk_size_;
+    void * mem;
+    if (huge_pages_) {
+      if (size >= huge_page_threshold)
+	size = huge_page_round(size);
+      mem = huge_page_allocate(size);
+    }
+    else
+      mem = ::operator new(size);
+    chunk * c = static_cast<chunk*>(mem);
+    c->next = head_;
+    c->size = size;
+    head_ = c;
+    cur_ = reinterpret_cast<char*>(c + 1);
+    end_ = reinterpret_cast<char*>(c) + size;
+    chunks_++;
+  }
+
+  std::size_t chunk_size_;
+  bool huge_pages_;
+  chunk * head_;
+  char * cur_;
+  char * end_;
+  std::size_t used_;
+  std::size_t count_;
+  std::size_t chunks_;
+};
+
+/**
+ * Scratch arena for objects living during one frame.
+ *
+ * Call reset() at the end of each frame.  After a few frames the
+ * arena settles on a single chunk and no more system allocation
+ * occurs.
+ */
+class frame_arena : public arena
+{
+public:
+  explicit frame_arena(std::size_t chunk_size = 16 * 1024)
+    : arena(chunk_size, false)
+  { }
+
+  /**
+   * Resets a frame_arena when going out of scope.
+   */
+  struct scope {
+    frame_arena& arena_;
+    explicit scope(frame_arena& a) : arena_(a) { }
+    ~scope() { arena_.reset(); }
+  };
+};
+
+/**
+ * Standard allocator drawing its memory from an arena.
+ *
+ * Use it as the allocator of a column_of<T> built once and destroyed
+ * as a whole: the storage is released with the arena.
+ */
+template <class T>
+class arena_alloc
+{
+public:
+  typedef T value_type;
+  typedef T * pointer;
+  typedef const T * const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <class U> struct rebind { typedef arena_alloc<U> other; };
+
+  arena_alloc(arena& a) : arena_(&a) { }
+  template <class U>
+  arena_alloc(const arena_alloc<U>& other) : arena_(other.get_arena()) { }
+
+  T * allocate(std::size_t n) {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T * p, std::size_t n) {
+    arena_->deallocate(p, n * sizeof(T));
+  }
+
+  arena * get_arena() const { return arena_; }
+
+  template <class U>
+  bool operator == (const arena_alloc<U>& other) const {
+    return arena_ == other.get_arena();
+  }
+  template <class U>
+  bool operator != (const arena_alloc<U>& other) const {
+    return arena_ != other.get_arena();
+  }
+private:
+  arena * arena_;
+};
+
+/**
+ * Stateless allocator for large columns, backed by huge pages when
+ * the storage is large enough.
+ */
+template <class T>
+class huge_page_alloc
+{
+public:
+  typedef T value_type;
+  typedef T * pointer;
+  typedef const T * const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <class U> struct rebind { typedef huge_page_alloc<U> other; };
+
+  huge_page_alloc() { }
+  template <class U>
+  huge_page_alloc(const huge_page_alloc<U>&) { }
+
+  T * allocate(std::size_t n) {
+    return static_cast<T*>(huge_page_allocate(n * sizeof(T)));
+  }
+  void deallocate(T * p, std::size_t n) {
+    huge_page_deallocate(p, n * sizeof(T));
+  }
+
+  template <class U>
+  bool operator == (const huge_page_alloc<U>&) const { return true; }
+  template <class U>
+  bool operator != (const huge_page_alloc<U>&) const { return false; }
+};
+
+} // namespace infovis
+
+#endif // INFOVIS_ARENA_ALLOC_HPP
@@ -25,6 +25,7 @@
 #include <infovis/drawing/SaveUnder.hpp>
 #include <infovis/drawing/drawing.hpp>
 #include <infovis/drawing/gl_support.hpp>
+#include <algorithm>
 #include <iostream>
 
 #undef DBG
@@ -67,6 +68,17 @@ SaveUnder::~SaveUnder()
   free_ressources();
 }
 
+memory_size
+SaveUnder::memory_usage() const
+{
+  const std::size_t pixel = sizeof(unsigned int);
+  std::size_t allocated = use_texture
+    ? std::size_t(data_size) * tile_width * tile_height * pixel
+    : std::size_t(data_size) * pixel;
+  std::size_t used = data_size == 0 ? 0 : std::size_t(width) * height * pixel;
+  return memory_size(std::min(used, allocated), allocated);
+}
+
 unsigned int
 SaveUnder::next_power_of_2(unsigned int n)
 {
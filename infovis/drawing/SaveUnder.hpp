@@ -26,6 +26,7 @@
 #define INFOVIS_DRAWING_SAVEUNDER_HPP
 
 #include <infovis/alloc.hpp>
+#include <infovis/memory_usage.hpp>
 
 namespace infovis {
 
@@ -48,6 +49,8 @@ public:
   unsigned int get_texture() const { return use_texture ? data[0] : 0; }
   unsigned int get_tex_width() const { return use_texture ? tile_width : 0; }
   unsigned int get_tex_height() const { return use_texture ? tile_height : 0; }
+  // Pixels saved over the memory or texture memory allocated
+  memory_size memory_usage() const;
   // Utility function useful for others
   static unsigned int next_power_of_2(unsigned int n);
 protected:
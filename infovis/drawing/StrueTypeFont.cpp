@@ -31,6 +31,8 @@ namespace infovis {
 // Static members
 FONScontext* StrueTypeFont::fons_context_ = nullptr;
 unsigned int StrueTypeFont::texture_id_ = 0;
+int StrueTypeFont::atlas_width_ = 0;
+int StrueTypeFont::atlas_height_ = 0;
 bool StrueTypeFont::initialized_ = false;
 
 StrueTypeFont::StrueTypeFont(const string& name, Style style, float size)
@@ -100,10 +102,19 @@ void StrueTypeFont::cleanup() {
     glDeleteTextures(1, &texture_id_);
     texture_id_ = 0;
   }
+  atlas_width_ = atlas_height_ = 0;
   
   initialized_ = false;
 }
 
+memory_size
+StrueTypeFont::atlasMemoryUsage()
+{
+  // fontstash keeps an alpha copy of the texture
+  std::size_t bytes = std::size_t(atlas_width_) * atlas_height_;
+  return memory_size(2 * bytes, 2 * bytes);
+}
+
 void StrueTypeFont::ensureInitialized() {
   if (!initialized_) {
     initialize();
@@ -204,6 +215,8 @@ int StrueTypeFont::renderCreate(void* uptr, int width, int height) {
   // Create OpenGL texture
   glGenTextures(1, &texture_id_);
   glBindTexture(GL_TEXTURE_2D, texture_id_);
+  atlas_width_ = width;
+  atlas_height_ = height;
   glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, nullptr);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -215,6 +228,8 @@ int StrueTypeFont::renderResize(void* uptr, int width, int height) {
   if (texture_id_) {
     glBindTexture(GL_TEXTURE_2D, texture_id_);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, nullptr);
+    atlas_width_ = width;
+    atlas_height_ = height;
   }
   return 1;
 }
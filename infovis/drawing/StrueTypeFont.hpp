@@ -27,6 +27,7 @@
 
 #include <infovis/drawing/Font.hpp>
 #include <infovis/drawing/gl.hpp>
+#include <infovis/memory_usage.hpp>
 #include "font_backend/struetype.h"
 #include "font_backend/fontstash.h"
 
@@ -57,10 +58,15 @@ public:
   static void initialize();
   static void cleanup();
 
+  // The glyph atlas shared by all the fonts, in memory and in texture
+  static memory_size atlasMemoryUsage();
+
 private:
   strue_font_t* strue_font_;
   static FONScontext* fons_context_;
   static unsigned int texture_id_;
+  static int atlas_width_;
+  static int atlas_height_;
   static bool initialized_;
   int font_id_;
   bool installed_;
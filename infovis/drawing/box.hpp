@@ -263,6 +263,71 @@ intersects(const Box& b1, const Box& b2)
      ymax(b2) <= ymin(b1)  || ymax(b1) <= ymin(b2));
 }
 
+/**
+ * Tests whether the segment [(x0,y0), (x1,y1)] intersects a box,
+ * clipping it with the Liang-Barsky method.
+ */
+template <class Box>
+inline bool
+intersects_segment(const Box& b,
+		   double x0, double y0, double x1, double y1)
+{
+  const double p[4] = { x0 - x1, x1 - x0, y0 - y1, y1 - y0 };
+  const double q[4] = { x0 - xmin(b), xmax(b) - x0,
+			y0 - ymin(b), ymax(b) - y0 };
+  double t0 = 0, t1 = 1;
+  for (int i = 0; i < 4; i++) {
+    if (p[i] == 0) {
+      if (q[i] < 0)
+	return false;
+    }
+    else {
+      double t = q[i] / p[i];
+      if (p[i] < 0) {
+	if (t > t1) return false;
+	if (t > t0) t0 = t;
+      }
+      else {
+	if (t < t0) return false;
+	if (t < t1) t1 = t;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Tests whether the outline of a box intersects another box.
+ */
+template <class Box>
+inline bool
+intersects_outline(const Box& outline, const Box& b)
+{
+  return intersects(outline, b) &&
+    ! (xmin(outline) < xmin(b) && xmax(b) < xmax(outline) &&
+       ymin(outline) < ymin(b) && ymax(b) < ymax(outline));
+}
+
+/**
+ * Tests whether the triangle (p0, p1, p2) intersects a box.
+ */
+template <class Box, class Point>
+inline bool
+intersects_triangle(const Box& b,
+		    const Point& p0, const Point& p1, const Point& p2)
+{
+  if (intersects_segment(b, x(p0), y(p0), x(p1), y(p1)) ||
+      intersects_segment(b, x(p1), y(p1), x(p2), y(p2)) ||
+      intersects_segment(b, x(p2), y(p2), x(p0), y(p0)))
+    return true;
+  // No edge crosses the box: either it is inside the triangle or apart.
+  double cx = (xmin(b) + xmax(b)) / 2, cy = (ymin(b) + ymax(b)) / 2;
+  double d0 = (x(p1) - x(p0)) * (cy - y(p0)) - (y(p1) - y(p0)) * (cx - x(p0));
+  double d1 = (x(p2) - x(p1)) * (cy - y(p1)) - (y(p2) - y(p1)) * (cx - x(p1));
+  double d2 = (x(p0) - x(p2)) * (cy - y(p2)) - (y(p0) - y(p2)) * (cx - x(p2));
+  return (d0 >= 0 && d1 >= 0 && d2 >= 0) || (d0 <= 0 && d1 <= 0 && d2 <= 0);
+}
+
 template <class Box>
 inline bool
 contains(const Box& b1, const Box& b2)
@@ -0,0 +1,277 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/drawing/colors/batch.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace infovis {
+
+static inline float
+clamp01(float v)
+{
+  return v < 0 ? 0 : (v > 1 ? 1 : v);
+}
+
+void
+convert(const rgb_span& rgb, const hsb_span& hsb)
+{
+  const float * hue = hsb[color_space_hsb::hue];
+  const float * sat = hsb[color_space_hsb::saturation];
+  const float * bri = hsb[color_space_hsb::brighness];
+  float * r = rgb[color_space_rgb::red];
+  float * g = rgb[color_space_rgb::green];
+  float * b = rgb[color_space_rgb::blue];
+
+  for (unsigned i = 0; i < hsb.size; i++) {
+    float h = (hue[i] - std::floor(hue[i])) * 6.0f;
+    float s = sat[i];
+    float v = bri[i];
+    // f(n) = v - v*s*max(0, min(k, 4-k, 1)) with k = (n + h) mod 6
+    float kr = 5.0f + h; if (kr >= 6.0f) kr -= 6.0f;
+    float kg = 3.0f + h; if (kg >= 6.0f) kg -= 6.0f;
+    float kb = 1.0f + h; if (kb >= 6.0f) kb -= 6.0f;
+    float vs = v * s;
+    r[i] = v - vs * std::max(0.0f, std::min(std::min(kr, 4.0f - kr), 1.0f));
+    g[i] = v - vs * std::max(0.0f, std::min(std::min(kg, 4.0f - kg), 1.0f));
+    b[i] = v - vs * std::max(0.0f, std::min(std::min(kb, 4.0f - kb), 1.0f));
+  }
+}
+
+void
+convert(const hsb_span& hsb, const rgb_span& rgb)
+{
+  const float * r = rgb[color_space_rgb::red];
+  const float * g = rgb[color_space_rgb::green];
+  const float * b = rgb[color_space_rgb::blue];
+  float * hue = hsb[color_space_hsb::hue];
+  float * sat = hsb[color_space_hsb::saturation];
+  float * bri = hsb[color_space_hsb::brighness];
+
+  for (unsigned i = 0; i < rgb.size; i++) {
+    float R = r[i], G = g[i], B = b[i];
+    float cmax = std::max(std::max(R, G), B);
+    float cmin = std::min(std::min(R, G), B);
+    float delta = cmax - cmin;
+    float s = (cmax != 0) ? delta / cmax : 0;
+    float inv = (delta != 0) ? 1.0f / delta : 0;
+    float redc = (cmax - R) * inv;
+    float greenc = (cmax - G) * inv;
+    float bluec = (cmax - B) * inv;
+    float h = (R == cmax) ? bluec - greenc
+      : (G == cmax) ? 2.0f + redc - bluec
+      : 4.0f + greenc - redc;
+    h *= 1.0f / 6.0f;
+    if (h < 0)
+      h += 1.0f;
+    hue[i] = (s == 0) ? 0 : h;
+    sat[i] = s;
+    bri[i] = cmax;
+  }
+}
+
+void
+convert(const rgb_span& rgb, const xyz_span& xyz)
+{
+  const float * x = xyz[0];
+  const float * y = xyz[1];
+  const float * z = xyz[2];
+  float * r = rgb[0];
+  float * g = rgb[1];
+  float * b = rgb[2];
+
+  for (unsigned i = 0; i < xyz.size; i++) {
+    float X = x[i], Y = y[i], Z = z[i];
+    r[i] = X * 3.48340481253539000f +
+      Y * -1.52176374927285200f +
+      Z * -0.55923133354049780f;
+    g[i] = X * -1.07152751306193600f +
+      Y * 1.96593795204372400f +
+      Z * 0.03673691339553462f;
+    b[i] = X * 0.06351179790497788f +
+      Y * -0.20020501000496480f +
+      Z * 0.81070942031648220f;
+  }
+}
+
+void
+convert(const xyz_span& xyz, const rgb_span& rgb)
+{
+  const float * r = rgb[0];
+  const float * g = rgb[1];
+  const float * b = rgb[2];
+  float * x = xyz[0];
+  float * y = xyz[1];
+  float * z = xyz[2];
+
+  for (unsigned i = 0; i < rgb.size; i++) {
+    float R = r[i], G = g[i], B = b[i];
+    x[i] = R * 0.38106149108714790f +
+      G * 0.32025712365352110f +
+      B * 0.24834578525933100f;
+    y[i] = R * 0.20729745115140850f +
+      G * 0.68054638776373240f +
+      B * 0.11215616108485920f;
+    z[i] = R * 0.02133944350088028f +
+      G * 0.14297193020246480f +
+      B * 1.24172892629665500f;
+  }
+}
+
+void
+convert(const xyz_span& xyz, const uvY_span& uvY)
+{
+  const float * u = uvY[color_space_uvY::u_prime];
+  const float * v = uvY[color_space_uvY::v_prime];
+  const float * Y = uvY[color_space_uvY::Y];
+  float * x = xyz[color_space_xyz::x];
+  float * y = xyz[color_space_xyz::y];
+  float * z = xyz[color_space_xyz::z];
+
+  for (unsigned i = 0; i < uvY.size; i++) {
+    float U = u[i], V = v[i];
+    float div = 6.0f * U - 16.0f * V + 12.0f;
+    float inv = (div != 0) ? 1.0f / div : 0;
+    x[i] = 9.0f * U * inv;
+    y[i] = 4.0f * V * inv;
+    z[i] = (-3.0f * U - 20.0f * V + 12.0f) * inv;
+  }
+}
+
+void
+convert(const uvY_span& uvY, const xyz_span& xyz)
+{
+  color_uvY white;
+  const float * x = xyz[color_space_xyz::x];
+  const float * y = xyz[color_space_xyz::y];
+  const float * z = xyz[color_space_xyz::z];
+  float * u = uvY[color_space_uvY::u_prime];
+  float * v = uvY[color_space_uvY::v_prime];
+  float * Y = uvY[color_space_uvY::Y];
+
+  for (unsigned i = 0; i < xyz.size; i++) {
+    float X = x[i], YY = y[i], Z = z[i];
+    float div = X + 15.0f * YY + 3.0f * Z;
+    if (div == 0) {
+      u[i] = white[color_uvY::u_prime];
+      v[i] = white[color_uvY::v_prime];
+      Y[i] = white[color_uvY::Y];
+    }
+    else {
+      float inv = 1.0f / div;
+      u[i] = 4.0f * X * inv;
+      v[i] = 9.0f * YY * inv;
+      Y[i] = YY;
+    }
+  }
+}
+
+void
+convert(const uvY_span& uvY, const hvc_span& hvc)
+{
+  static const float u_best_red = 0.7127f;
+  static const float v_best_red = 0.4931f;
+  static const float chroma_scale = 7.50725f;
+  static const float deg2rad = float(M_PI / 180.0);
+  color_uvY white;
+  const float wu = white[color_uvY::u_prime];
+  const float wv = white[color_uvY::v_prime];
+  // computed once instead of once per color
+  const float theta_offset =
+    float(std::atan2(v_best_red - wv, u_best_red - wu) * 180.0 / M_PI);
+
+  const float * hue = hvc[color_space_hvc::hue];
+  const float * value = hvc[color_space_hvc::value];
+  const float * chroma = hvc[color_space_hvc::chroma];
+  float * u = uvY[color_space_uvY::u_prime];
+  float * v = uvY[color_space_uvY::v_prime];
+  float * Y = uvY[color_space_uvY::Y];
+
+  for (unsigned i = 0; i < hvc.size; i++) {
+    float V = value[i];
+    float C = chroma[i];
+    float h = hue[i] + theta_offset;
+    h -= 360.0f * std::floor(h * (1.0f / 360.0f));
+    h *= deg2rad;
+    float k = (V != 0) ? C / V * chroma_scale : 0;
+    float uu = wu + std::cos(h) * k;
+    float vv = wv + std::sin(h) * k;
+    float t = (V + 16.0f) * (1.0f / 116.0f);
+    float yy = (V < 7.99953624f) ? V * (1.0f / 903.29f) : t * t * t;
+    bool extreme = (V == 0 || V == 100);
+    u[i] = extreme ? wu : uu;
+    v[i] = extreme ? wv : vv;
+    Y[i] = (V == 0) ? 0 : ((V == 100) ? 1 : yy);
+  }
+}
+
+void
+convert(const rgb_span& rgb, const hvc_span& hvc)
+{
+  // the intermediate results are stored in the destination
+  uvY_span uvY(rgb[0], rgb[1], rgb[2], hvc.size);
+  xyz_span xyz(rgb[0], rgb[1], rgb[2], hvc.size);
+  convert(uvY, hvc);
+  convert(xyz, uvY);
+  convert(rgb, xyz);
+}
+
+void
+convert(const rgb_span& rgb, const cmy_span& cmy)
+{
+  for (int c = 0; c < 3; c++) {
+    const float * from = cmy[c];
+    float * to = rgb[c];
+    for (unsigned i = 0; i < cmy.size; i++)
+      to[i] = 1.0f - from[i];
+  }
+}
+
+void
+convert(const cmy_span& cmy, const rgb_span& rgb)
+{
+  for (int c = 0; c < 3; c++) {
+    const float * from = rgb[c];
+    float * to = cmy[c];
+    for (unsigned i = 0; i < rgb.size; i++)
+      to[i] = 1.0f - from[i];
+  }
+}
+
+void
+pack(color_rgba<unsigned char> * out, const rgb_span& rgb,
+     unsigned char alpha)
+{
+  const float * r = rgb[0];
+  const float * g = rgb[1];
+  const float * b = rgb[2];
+  for (unsigned i = 0; i < rgb.size; i++) {
+    out[i][0] = (unsigned char)(clamp01(r[i]) * 255.0f + 0.5f);
+    out[i][1] = (unsigned char)(clamp01(g[i]) * 255.0f + 0.5f);
+    out[i][2] = (unsigned char)(clamp01(b[i]) * 255.0f + 0.5f);
+    out[i][3] = alpha;
+  }
+}
+
+} // namespace infovis
@@ -0,0 +1,92 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_DRAWING_COLORS_BATCH_HPP
+#define INFOVIS_DRAWING_COLORS_BATCH_HPP
+
+#include <infovis/drawing/color.hpp>
+#include <infovis/drawing/colors/hsb.hpp>
+#include <infovis/drawing/colors/hvc.hpp>
+#include <infovis/drawing/colors/uvY.hpp>
+#include <infovis/drawing/colors/xyz.hpp>
+#include <infovis/drawing/colors/cmy.hpp>
+
+namespace infovis {
+
+/**
+ * Structure of arrays view over a sequence of colors of a color
+ * space, with one float array per channel.
+ *
+ * Batch conversions work on such spans in single precision with
+ * simple loops the compiler can vectorize, instead of converting one
+ * color at a time in double precision.  Source and destination may
+ * be the same arrays.
+ */
+template <class Space>
+struct color_span
+{
+  typedef Space color_space;
+  float * channel[3];
+  unsigned size;
+
+  color_span(float * c0, float * c1, float * c2, unsigned n)
+    : size(n) {
+    channel[0] = c0;
+    channel[1] = c1;
+    channel[2] = c2;
+  }
+  float * operator[](int i) const { return channel[i]; }
+};
+
+typedef color_span<color_space_rgb> rgb_span;
+typedef color_span<color_space_hsb> hsb_span;
+typedef color_span<color_space_hvc> hvc_span;
+typedef color_span<color_space_uvY> uvY_span;
+typedef color_span<color_space_xyz> xyz_span;
+typedef color_span<color_space_cmy> cmy_span;
+
+void convert(const rgb_span& rgb, const hsb_span& hsb);
+void convert(const hsb_span& hsb, const rgb_span& rgb);
+void convert(const rgb_span& rgb, const xyz_span& xyz);
+void convert(const xyz_span& xyz, const rgb_span& rgb);
+void convert(const xyz_span& xyz, const uvY_span& uvY);
+void convert(const uvY_span& uvY, const xyz_span& xyz);
+void convert(const uvY_span& uvY, const hvc_span& hvc);
+void convert(const rgb_span& rgb, const hvc_span& hvc);
+void convert(const rgb_span& rgb, const cmy_span& cmy);
+void convert(const cmy_span& cmy, const rgb_span& rgb);
+
+/**
+ * Pack float rgb channels in [0,1] into 8 bits rgba colors, clamping
+ * out of gamut values.
+ * @param out the destination, holding rgb.size colors
+ * @param rgb the source
+ * @param alpha the alpha of all the colors
+ */
+void pack(color_rgba<unsigned char> * out, const rgb_span& rgb,
+	  unsigned char alpha = 255);
+
+} // namespace infovis
+
+#endif // INFOVIS_DRAWING_COLORS_BATCH_HPP
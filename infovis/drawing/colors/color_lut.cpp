@@ -0,0 +1,74 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/drawing/colors/color_lut.hpp>
+
+namespace infovis {
+
+color_lut::color_lut()
+  : smooth_(false)
+{ }
+
+void
+color_lut::build(const std::vector<color_type>& ramp, bool smooth)
+{
+  smooth_ = smooth;
+  if (ramp.empty())
+    return;
+  const unsigned last = ramp.size() - 1;
+  for (unsigned j = 0; j < lut_size; j++) {
+    if (! smooth || last == 0) {
+      table_[j] = ramp[j * last / (lut_size - 1)];
+      continue;
+    }
+    float pos = float(j) * last / (lut_size - 1);
+    unsigned i = unsigned(pos);
+    if (i >= last) {
+      table_[j] = ramp[last];
+      continue;
+    }
+    float t = pos - i;
+    const color_type& c1 = ramp[i];
+    const color_type& c2 = ramp[i+1];
+    for (int chan = 0; chan < color_space_rgba::last_channel; chan++) {
+      detail::round(table_[j][chan], (1-t) * c1[chan] + t * c2[chan]);
+    }
+  }
+}
+
+void
+color_lut::map(const float * values, unsigned n,
+	       float min, float range,
+	       color_type * out) const
+{
+  const float scale = (range != 0) ? (lut_size - 1) / range : 0;
+  const float top = lut_size - 1;
+  for (unsigned i = 0; i < n; i++) {
+    float t = (values[i] - min) * scale + 0.5f;
+    t = (t > 0) ? (t < top ? t : top) : 0; // also catches NaN
+    out[i] = table_[unsigned(t)];
+  }
+}
+
+} // namespace infovis
@@ -0,0 +1,97 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_DRAWING_COLORS_COLOR_LUT_HPP
+#define INFOVIS_DRAWING_COLORS_COLOR_LUT_HPP
+
+#include <infovis/drawing/color.hpp>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Lookup table mapping a normalized value to an 8 bits rgba color
+ * sampled from a color ramp.
+ *
+ * The ramp is sampled once into lut_size entries so mapping a value
+ * costs a multiplication and a load, whatever the ramp and whether
+ * colors are interpolated (smooth) or not.
+ */
+class color_lut
+{
+public:
+  typedef color_rgba<unsigned char> color_type;
+  enum { lut_size = 4096 };
+
+  color_lut();
+
+  /**
+   * Sample a ramp into the table.
+   * @param ramp the colors of the ramp, at least one
+   * @param smooth true to interpolate linearly between the colors,
+   * false to use the color of the segment the value falls into
+   */
+  void build(const std::vector<color_type>& ramp, bool smooth);
+
+  /**
+   * Return the table index of a normalized value.
+   * @param t the value, clamped to [0,1]
+   */
+  static unsigned index(float t) {
+    if (! (t > 0))		// also catches NaN
+      return 0;
+    if (t >= 1)
+      return lut_size - 1;
+    return unsigned(t * (lut_size - 1) + 0.5f);
+  }
+
+  /**
+   * Return the color of a normalized value.
+   * @param t the value, clamped to [0,1]
+   */
+  const color_type& operator()(float t) const { return table_[index(t)]; }
+
+  /**
+   * Map values to colors, normalizing them as (v - min) / range.
+   * @param values the values
+   * @param n the number of values
+   * @param min the value mapped to the start of the ramp
+   * @param range the extent of values mapped to the ramp
+   * @param out the colors, n of them
+   */
+  void map(const float * values, unsigned n,
+	   float min, float range,
+	   color_type * out) const;
+
+  const color_type * data() const { return table_; }
+  bool smooth() const { return smooth_; }
+
+protected:
+  color_type table_[lut_size];
+  bool smooth_;
+};
+
+} // namespace infovis
+
+#endif // INFOVIS_DRAWING_COLORS_COLOR_LUT_HPP
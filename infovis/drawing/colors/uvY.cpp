@@ -72,7 +72,7 @@ void convert(color_uvY& uvY, const color_xyz& xyz)
     uvY = color_uvY();
   } else {
     uvY[To::u_prime] = 4.0 * xyz[From::x] / div;
-    uvY[To::v_prime] = 9.0 * xyz[From::x] / div;
+    uvY[To::v_prime] = 9.0 * xyz[From::y] / div;
     uvY[To::Y] = xyz[From::y];    
   }
 }
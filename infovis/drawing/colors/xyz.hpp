@@ -22,7 +22,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
-#ifndef INFOVIS_DRAWING_COLORS_XXY_HPP
+#ifndef INFOVIS_DRAWING_COLORS_XYZ_HPP
 #define INFOVIS_DRAWING_COLORS_XYZ_HPP
 
 #include <infovis/drawing/color.hpp>
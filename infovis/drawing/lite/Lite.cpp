@@ -23,6 +23,7 @@
  * SOFTWARE.
  */
 #include <infovis/drawing/lite/Lite.hpp>
+#include <infovis/drawing/lite/LiteWindow.hpp>
 #include <infovis/drawing/inter/Interactor.hpp>
 #include <infovis/drawing/gl.hpp>
 #include <GL/glut.h>
@@ -78,6 +79,69 @@ Lite::inside(const Point& p) const
   return infovis::inside(getBounds(), x(p), y(p));
 }
 
+bool
+Lite::hitTest(const Box& b) const
+{
+  return false;
+}
+
+Box
+Lite::getHull() const
+{
+  Box hull(getBounds());
+  for (int i = 0; i < childCount(); i++)
+    hull = hullUnion(hull, getChild(i)->getHull());
+  return hull;
+}
+
+void
+Lite::invalidateHull()
+{
+  if (parent_ != 0)
+    parent_->invalidateHull();
+}
+
+void
+Lite::invalidateBounds()
+{
+  if (parent_ != 0)
+    parent_->invalidateBounds();
+}
+
+bool
+Lite::collectHits(const Box& b, Path& path, PathList& hit) const
+{
+  if (! is_visible || ! infovis::intersects(getHull(), b))
+    return true;
+  if (hitTest(b))
+    hit.push_back(path);
+  return collectChildHits(b, path, hit);
+}
+
+bool
+Lite::collectChildHits(const Box& b, Path& path, PathList& hit) const
+{
+  bool ret = true;
+  path.push_back(0);
+  for (int i = 0; ret && i < childCount(); i++) {
+    path.back() = i;
+    ret = getChild(i)->collectHits(b, path, hit);
+  }
+  path.pop_back();
+  return ret;
+}
+
+Box
+Lite::hullUnion(const Box& b1, const Box& b2)
+{
+  // Lites without geometry have an empty box at the origin.
+  if (width(b2) == 0 && height(b2) == 0)
+    return b1;
+  if (width(b1) == 0 && height(b1) == 0)
+    return b2;
+  return box_union(b1, b2);
+}
+
 void
 Lite::doRender(const RenderContext& c)
 { }
@@ -196,6 +260,24 @@ Lite::end() const
 void
 Lite::repaint() const
 {
+  LiteWindow * win = LiteWindow::getInstance();
+  if (win != 0)
+    win->damageAll();
+  glutPostRedisplay();
+}
+
+void
+Lite::damage() const
+{
+  damage(getBounds());
+}
+
+void
+Lite::damage(const Box& b) const
+{
+  LiteWindow * win = LiteWindow::getInstance();
+  if (win != 0)
+    win->addDamage(b);
   glutPostRedisplay();
 }
 
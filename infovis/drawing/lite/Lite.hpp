@@ -46,6 +46,7 @@ class Lite : public virtual gc
 public:
   typedef std::vector<Lite*, gc_alloc<Lite*> > List;
   typedef std::vector<int, gc_alloc<int,true> > Path;
+  typedef std::vector<Path, gc_alloc<Path> > PathList;
   typedef List::iterator iterator;
   typedef List::const_iterator const_iterator;
 
@@ -61,7 +62,7 @@ public:
       : is_picking(p), quality(q) {}
   };
 
-  Lite() : is_visible(true) {}
+  Lite() : is_visible(true), parent_(0) {}
   virtual ~Lite();
 
   virtual Box getBounds() const = 0;
@@ -75,6 +76,45 @@ public:
   virtual bool intersects(const Box& b) const;
   virtual bool contains(const Box& b) const;
   virtual bool inside(const Point& p) const;
+  /**
+   * Returns true if the geometry rendered by this lite itself, without
+   * its children, intersects the box.  Lites overriding doRender should
+   * override it as well.
+   */
+  virtual bool hitTest(const Box& b) const;
+  /**
+   * Returns a box enclosing the geometry rendered by this lite and all
+   * its descendants, used to prune picking.
+   */
+  virtual Box getHull() const;
+  /**
+   * Notifies the enclosing lites that the geometry of this lite
+   * changed, so the hulls they cache are recomputed.  Called when a
+   * lite moves or resizes, or changes what it renders outside its
+   * bounds.
+   */
+  virtual void invalidateHull();
+  /**
+   * Notifies the enclosing lites that the bounds they compute from
+   * their children are out of date.
+   */
+  virtual void invalidateBounds();
+  /**
+   * Returns the lite holding this one, 0 for the root.
+   */
+  Lite * getParent() const { return parent_; }
+  /**
+   * Sets the lite holding this one, called by the containers when
+   * adding or removing it.
+   */
+  void setParent(Lite * p) { parent_ = p; }
+  /**
+   * Picks on the CPU, following the traversal done by render when
+   * picking: appends to hit the path of every lite whose geometry
+   * intersects the box, in rendering order.  Returns false when a lite
+   * can only be picked with the OpenGL selection.
+   */
+  virtual bool collectHits(const Box& b, Path& path, PathList& hit) const;
   virtual void render(const RenderContext&);
   virtual Lite * clone() const = 0;
   virtual Interactor * interactor(const string& name, int toolid);
@@ -94,6 +134,15 @@ public:
   virtual const_iterator end() const;
 
   virtual void repaint() const;
+  /**
+   * Requests a repaint restricted to the bounds of this lite, for
+   * changes that leave the bounds untouched.
+   */
+  void damage() const;
+  /**
+   * Requests a repaint restricted to a box in window coordinates.
+   */
+  void damage(const Box& b) const;
   virtual void setVisible(bool b);
   bool isVisible() const { return is_visible; }
 
@@ -101,7 +150,10 @@ public:
   virtual void pack();
 protected:
   virtual void doRender(const RenderContext&);
+  bool collectChildHits(const Box& b, Path& path, PathList& hit) const;
+  static Box hullUnion(const Box& b1, const Box& b2);
   bool is_visible;
+  Lite * parent_;
 };
 
 } // namespace infovis
@@ -43,6 +43,12 @@ LiteBackground::doRender(const RenderContext& rc)
   LiteProxy::doRender(rc);
 }
 
+bool
+LiteBackground::hitTest(const Box& b) const
+{
+  return infovis::intersects(LiteProxy::getBounds(), b);
+}
+
 Lite *
 LiteBackground::clone() const
 {
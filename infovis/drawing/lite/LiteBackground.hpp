@@ -38,6 +38,7 @@ public:
   LiteBackground(Lite * l, const Color& c);
 
   virtual void doRender(const RenderContext&);
+  virtual bool hitTest(const Box& b) const;
   virtual Lite * clone() const;
 
   virtual void setColor(const Color& c);
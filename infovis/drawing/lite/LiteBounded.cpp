@@ -36,6 +36,7 @@ void
 LiteBounded::setBounds(const Box& b) 
 {
   bounds = b;
+  invalidateHull();
 }
 
 Point
@@ -49,6 +50,7 @@ LiteBounded::setPosition(const Point& p)
 {
   const Box::vector_type v(p - getPosition());
   translate(bounds, v);
+  invalidateHull();
 }
 
 } // namespace infovis
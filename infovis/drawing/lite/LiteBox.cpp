@@ -93,7 +93,8 @@ LiteBox::computeBounds()
 void
 LiteBox::pack()
 {
-  computeBounds();
+  invalidateBounds();
+  validateBounds();
 }
 
 } // namespace infovis
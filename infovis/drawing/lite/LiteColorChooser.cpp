@@ -317,6 +317,12 @@ LiteColorSurface::interactor(const string& name, int tool_id)
   return 0;
 }
 
+bool
+LiteColorSurface::hitTest(const Box& b) const
+{
+  return infovis::intersects(getBounds(), b);
+}
+
 void
 LiteColorSurface::doRender(const RenderContext& rc)
 {
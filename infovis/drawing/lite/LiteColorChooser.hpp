@@ -92,6 +92,7 @@ public:
 
   virtual Interactor * interactor(const string& name, int tool_id);
   virtual void doRender(const RenderContext& rc);
+  virtual bool hitTest(const Box& b) const;
   virtual Lite * clone() const;
 
   virtual BoundedRangeObservable* getXObservable() const;
@@ -77,6 +77,30 @@ LiteDisplacedLabel::doRender(const RenderContext& c)
   LiteLabel::doRender(c);
 }
 
+bool
+LiteDisplacedLabel::hitTest(const Box& b) const
+{
+  if (line_alpha_ != 0 && path_.size() > 1) {
+    for (Path::const_iterator i = path_.begin() + 1;
+	 i != path_.end(); i++) {
+      if (intersects_segment(b, x(i[-1]), y(i[-1]), x(*i), y(*i)))
+	return true;
+    }
+  }
+  return LiteLabel::hitTest(b);
+}
+
+Box
+LiteDisplacedLabel::getHull() const
+{
+  Box hull(getBounds());
+  if (line_alpha_ != 0) {
+    for (Path::const_iterator i = path_.begin(); i != path_.end(); i++)
+      hull = box_union(hull, Box(*i, *i));
+  }
+  return hull;
+}
+
 Lite *
 LiteDisplacedLabel::clone() const
 {
@@ -93,6 +117,7 @@ void
 LiteDisplacedLabel::setLineAlpha(float alpha)
 {
   line_alpha_ = alpha;
+  invalidateHull();
 }
 
 } // namespace infovis
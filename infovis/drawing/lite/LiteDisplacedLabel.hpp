@@ -46,12 +46,14 @@ public:
 		     const Color& gfg = color_none);
 
   virtual void doRender(const RenderContext& c);
+  virtual bool hitTest(const Box& b) const;
+  virtual Box getHull() const;
   virtual Lite * clone() const;
 
   const Point& getOrig() const { return orig_; }
   const Path& getPath() const { return path_; }
-  void addPath(const Point& p) { path_.push_back(p); }
-  void setPath(const Path& p) { path_ = p; } // at your own risk
+  void addPath(const Point& p) { path_.push_back(p); invalidateHull(); }
+  void setPath(const Path& p) { path_ = p; invalidateHull(); } // at your own risk
   void setLineAlpha(float alpha);
   float getLineAlpha() const { return line_alpha_; }
 protected:
@@ -44,7 +44,7 @@ bool
 LiteEnterLeaveShape::doEnter(const Event& )
 {
   shape_->setColor(in_);
-  repaint();
+  damage();
   return true;
 }
 
@@ -52,6 +52,6 @@ void
 LiteEnterLeaveShape::doLeave(const Event& )
 {
   shape_->setColor(out_);
-  repaint();
+  damage();
 }
 } // namespace infovis
@@ -54,6 +54,12 @@ LiteFrame::doRender(const RenderContext& rc)
   LiteProxy::doRender(rc);
 }
 
+bool
+LiteFrame::hitTest(const Box& b) const
+{
+  return infovis::intersects(getBounds(), b);
+}
+
 Lite *
 LiteFrame::clone() const
 {
@@ -43,6 +43,7 @@ public:
   virtual Box getBounds() const;
   virtual void setBounds(const Box& b);
   virtual void doRender(const RenderContext&);
+  virtual bool hitTest(const Box& b) const;
   virtual Lite * clone() const;
   virtual Interactor * interactor(const string& name, int toolid);
 
@@ -28,16 +28,41 @@
 namespace infovis {
 
 LiteGroup::LiteGroup()
-  : is_fixed_(false)
+  : is_fixed_(false),
+    bounds_dirty_(false),
+    hull_valid_(false)
 { }
 
 LiteGroup::LiteGroup(const Box& b)
   : LiteBounded(b),
-    is_fixed_(true)
+    is_fixed_(true),
+    bounds_dirty_(false),
+    hull_valid_(false)
 { }
 
 LiteGroup::~LiteGroup() { }
 
+Box
+LiteGroup::getBounds() const
+{
+  validateBounds();
+  return bounds;
+}
+
+void
+LiteGroup::setBounds(const Box& b)
+{
+  validateBounds();
+  LiteBounded::setBounds(b);
+}
+
+Point
+LiteGroup::getPosition() const
+{
+  validateBounds();
+  return LiteBounded::getPosition();
+}
+
 void
 LiteGroup::setPosition(const Point& p)
 {
@@ -49,6 +74,23 @@ LiteGroup::setPosition(const Point& p)
   LiteBounded::setPosition(p);
 }
 
+void
+LiteGroup::render(const RenderContext& c)
+{
+  validateBounds();
+  Lite::render(c);
+}
+
+Box
+LiteGroup::getHull() const
+{
+  if (! hull_valid_) {
+    hull_ = Lite::getHull();
+    hull_valid_ = true;
+  }
+  return hull_;
+}
+
 Lite *
 LiteGroup::clone() const
 {
@@ -72,8 +114,10 @@ void
 LiteGroup::setChild(int index, Lite *l )
 {
   if (index >= 0 && index < group_.size()) {
+    orphan(group_[index]);
     group_[index] = l;
-    computeBounds();		// should be optimized
+    adopt(l);
+    invalidateBounds();
   }
 
 }
@@ -82,7 +126,8 @@ void
 LiteGroup::addChild(Lite * c)
 {
   group_.push_back(c);
-  computeBounds();		// should be optimized
+  adopt(c);
+  invalidateBounds();
 }
 
 void
@@ -90,7 +135,8 @@ LiteGroup::insertChild(int i, Lite * l)
 {
   if (i >= 0 && i <= childCount()) {
     group_.insert(group_.begin()+i, l);
-    computeBounds();		// should be optimized
+    adopt(l);
+    invalidateBounds();
   }
 }
 
@@ -98,8 +144,9 @@ void
 LiteGroup::eraseChild(int i)
 {
   if (i >= 0 && i < childCount()) {
+    orphan(group_[i]);
     group_.erase(group_.begin()+i);
-    computeBounds();		// should be optimized
+    invalidateBounds();
   }
 }
 
@@ -132,7 +179,48 @@ LiteGroup::setFixed(bool f)
 {
   is_fixed_ = f;
   if (! is_fixed_)
-    computeBounds();
+    invalidateBounds();
+}
+
+void
+LiteGroup::invalidateBounds()
+{
+  bounds_dirty_ = true;
+  hull_valid_ = false;
+  Lite::invalidateBounds();
+}
+
+void
+LiteGroup::invalidateHull()
+{
+  if (! hull_valid_)
+    return;			// nor are the hulls of the enclosing lites
+  hull_valid_ = false;
+  Lite::invalidateHull();
+}
+
+void
+LiteGroup::validateBounds() const
+{
+  if (! bounds_dirty_)
+    return;
+  // Cleared first so that computeBounds can query the current bounds.
+  bounds_dirty_ = false;
+  const_cast<LiteGroup*>(this)->computeBounds();
+}
+
+void
+LiteGroup::adopt(Lite * l)
+{
+  if (l != 0)
+    l->setParent(this);
+}
+
+void
+LiteGroup::orphan(Lite * l)
+{
+  if (l != 0 && l->getParent() == this)
+    l->setParent(0);
 }
 
 void
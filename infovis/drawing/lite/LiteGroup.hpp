@@ -39,7 +39,16 @@ public:
   LiteGroup(const Box& b);
   virtual ~LiteGroup();
 
+  virtual Box getBounds() const;
+  virtual void setBounds(const Box& b);
+  virtual Point getPosition() const;
   virtual void setPosition(const Point& p);
+  virtual void render(const RenderContext&);
+  /**
+   * Returns the hull of the subtree, cached until a lite of the
+   * subtree notifies a change through invalidateHull().
+   */
+  virtual Box getHull() const;
   virtual Lite * clone() const;
   virtual int childCount() const;
   virtual Lite * getChild(int index) const;
@@ -54,10 +63,33 @@ public:
 
   virtual bool isFixed() const;
   virtual void setFixed(bool f);
+
+  /**
+   * Marks the bounds and the hull as out of date, along with those of
+   * all the enclosing groups.  They are recomputed on the next query
+   * or render.
+   */
+  virtual void invalidateBounds();
+  /**
+   * Marks the hull as out of date, along with the hulls of all the
+   * enclosing groups.  Called when a child moves or resizes.
+   */
+  virtual void invalidateHull();
+  /**
+   * Recomputes the bounds if they have been invalidated.
+   */
+  void validateBounds() const;
+  bool isBoundsValid() const { return ! bounds_dirty_; }
+  bool isHullValid() const { return hull_valid_; }
 protected:
   virtual void computeBounds();
+  void adopt(Lite * l);
+  void orphan(Lite * l);
   List group_;
   bool is_fixed_;
+  mutable bool bounds_dirty_;
+  mutable Box hull_;
+  mutable bool hull_valid_;
 };
   
 } // namespace infovis
@@ -108,6 +108,13 @@ LiteLabel::doRender(const RenderContext& c)
   font_->paint(label, x(p), y(p));
 }
 
+bool
+LiteLabel::hitTest(const Box& b) const
+{
+  // The background is always drawn when picking.
+  return infovis::intersects(bounds, b);
+}
+
 Lite *
 LiteLabel::clone() const
 {
@@ -126,6 +133,7 @@ LiteLabel::setLabel(const string& label)
 {
   label_ = label;
   bounds = getMinBounds();
+  invalidateHull();
 }
 
 Font *
@@ -54,6 +54,7 @@ public:
   virtual Point getPosition() const;
 
   virtual void doRender(const RenderContext& c);
+  virtual bool hitTest(const Box& b) const;
   virtual Lite * clone() const;
 
   virtual const string& getLabel() const;
@@ -219,11 +219,27 @@ LiteMenu::doRender(const RenderContext& c)
   border_.render(c, bounds);
 }
 
+bool
+LiteMenu::hitTest(const Box& b) const
+{
+  return infovis::intersects(border_.growBox(getInBounds()), b);
+}
+
+bool
+LiteMenu::collectHits(const Box& b, Path& path, PathList& hit) const
+{
+  // Items are not picked, the menu tracks them itself.
+  if (isVisible() && hitTest(b))
+    hit.push_back(path);
+  return true;
+}
+
 void
 LiteMenu::render(const RenderContext& c)
 {
   if (! is_visible)
     return;
+  validateBounds();
   glPushAttrib(GL_COLOR_BUFFER_BIT);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
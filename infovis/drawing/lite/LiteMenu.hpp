@@ -53,6 +53,8 @@ public:
   
   virtual Interactor * interactor(const string& name, int tool_id);
   virtual void render(const RenderContext& c);
+  virtual bool hitTest(const Box& b) const;
+  virtual bool collectHits(const Box& b, Path& path, PathList& hit) const;
 
   // BoundedRange
   virtual float min() const;
@@ -31,7 +31,12 @@ LiteProxy::~LiteProxy() { }
 void
 LiteProxy::setLite(Lite * l)
 {
+  if (lite_ != 0 && lite_->getParent() == this)
+    lite_->setParent(0);
   lite_ = l;
+  if (lite_ != 0)
+    lite_->setParent(this);
+  invalidateHull();
 }
 
 Lite *
@@ -136,7 +141,7 @@ void
 LiteProxy::setChild(int index, Lite * l)
 {
   if (index == 0)
-    lite_ = l;
+    setLite(l);
   else
     Lite::setChild(index, l);
 }
@@ -157,7 +162,7 @@ void
 LiteProxy::addChild(Lite * l)
 {
   if (lite_ == 0)
-    lite_ = l;
+    setLite(l);
   else
     Lite::addChild(l);
 }
@@ -166,14 +171,14 @@ void
 LiteProxy::removeChild(Lite * l)
 {
   if (lite_ == l)
-    lite_ = 0;
+    setLite(0);
 }
 
 void
 LiteProxy::insertChild(int pos, Lite * l)
 {
   if (lite_ == 0 && pos == 0)
-    lite_ = l;
+    setLite(l);
   else
     Lite::insertChild(pos, l);
 }
@@ -182,7 +187,7 @@ void
 LiteProxy::eraseChild(int pos)
 {
   if (pos == 0)
-    lite_ = 0;
+    setLite(0);
   else
     Lite::eraseChild(pos);
 }
@@ -190,7 +195,7 @@ LiteProxy::eraseChild(int pos)
 void
 LiteProxy::removeAll()
 {
-  lite_ = 0;
+  setLite(0);
 }
 
 Lite::iterator
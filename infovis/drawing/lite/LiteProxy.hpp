@@ -35,7 +35,7 @@ namespace infovis {
 class LiteProxy : public Lite
 {
 public:
-  LiteProxy(Lite * l) : lite_(l) {}
+  LiteProxy(Lite * l) : lite_(0) { setLite(l); }
   ~LiteProxy();
 
   virtual void setLite(Lite * l);
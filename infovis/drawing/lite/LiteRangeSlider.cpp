@@ -51,32 +51,44 @@ public:
   
   void doRender(const RenderContext& rc) {
     LiteShape::doRender(rc);
+    Point p[3];
+    vertices(p);
     glBegin(GL_TRIANGLES);
+    for (int i = 0; i < 3; i++)
+      gl::vertex(x(p[i]), y(p[i]));
+    glEnd();
+  }
+
+  bool hitTest(const Box& b) const {
+    Point p[3];
+    vertices(p);
+    return intersects_triangle(b, p[0], p[1], p[2]);
+  }
+protected:
+  void vertices(Point p[3]) const {
     switch(dir_) {
     case left_to_right:
-      gl::vertex(xmin(bounds), ymax(bounds));
-      gl::vertex(xmin(bounds), ymin(bounds));
-      gl::vertex(xmax(bounds), (ymin(bounds)+ymax(bounds))/2);
+      p[0] = Point(xmin(bounds), ymax(bounds));
+      p[1] = Point(xmin(bounds), ymin(bounds));
+      p[2] = Point(xmax(bounds), (ymin(bounds)+ymax(bounds))/2);
       break;
     case right_to_left:
-      gl::vertex(xmax(bounds), ymin(bounds));
-      gl::vertex(xmax(bounds), ymax(bounds));
-      gl::vertex(xmin(bounds), (ymin(bounds)+ymax(bounds))/2);
+      p[0] = Point(xmax(bounds), ymin(bounds));
+      p[1] = Point(xmax(bounds), ymax(bounds));
+      p[2] = Point(xmin(bounds), (ymin(bounds)+ymax(bounds))/2);
       break;
     case top_to_bottom:
-      gl::vertex(xmax(bounds), ymax(bounds));
-      gl::vertex(xmin(bounds), ymax(bounds));
-      gl::vertex((xmin(bounds)+xmax(bounds))/2, ymin(bounds));
+      p[0] = Point(xmax(bounds), ymax(bounds));
+      p[1] = Point(xmin(bounds), ymax(bounds));
+      p[2] = Point((xmin(bounds)+xmax(bounds))/2, ymin(bounds));
       break;
     case bottom_to_top:
-      gl::vertex(xmax(bounds), ymin(bounds));
-      gl::vertex(xmin(bounds), ymin(bounds));
-      gl::vertex((xmin(bounds)+xmax(bounds))/2, ymax(bounds));
+      p[0] = Point(xmax(bounds), ymin(bounds));
+      p[1] = Point(xmin(bounds), ymin(bounds));
+      p[2] = Point((xmin(bounds)+xmax(bounds))/2, ymax(bounds));
       break;
     }
-    glEnd();
   }
-protected:
   direction dir_;
 };
 
@@ -44,6 +44,12 @@ LiteRect::doRender(const RenderContext& c)
   draw_box(getBounds());
 }
 
+bool
+LiteRect::hitTest(const Box& b) const
+{
+  return infovis::intersects(getBounds(), b);
+}
+
 } // namespace infovis
 
 
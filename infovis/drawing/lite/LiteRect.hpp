@@ -38,6 +38,7 @@ public:
   LiteRect(const Box& b, const Color& c);
 
   virtual void doRender(const RenderContext&);
+  virtual bool hitTest(const Box& b) const;
   virtual Lite * clone() const;
 };
 
@@ -25,6 +25,7 @@
 #include <infovis/drawing/lite/LiteSaveUnder.hpp>
 #include <infovis/drawing/gl.hpp>
 #include <GL/glut.h>
+#include <cfloat>
 
 namespace infovis {
 
@@ -42,6 +43,19 @@ LiteSaveUnder::doRender(const RenderContext& c)
   LiteProxy::render(c);
 }
 
+Box
+LiteSaveUnder::getHull() const
+{
+  return Box(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+}
+
+bool
+LiteSaveUnder::collectHits(const Box&, Path&, PathList&) const
+{
+  // The proxied lite is rendered from doRender, leave it to OpenGL.
+  return false;
+}
+
 void
 LiteSaveUnder::repaint()
 {
@@ -41,6 +41,8 @@ public:
   ~LiteSaveUnder();
 
   virtual void doRender(const RenderContext& c);
+  virtual Box getHull() const;
+  virtual bool collectHits(const Box& b, Path& path, PathList& hit) const;
   virtual Lite * clone();
 
   virtual void repaint();
@@ -282,6 +282,34 @@ LiteSlider::render(const RenderContext& c)
     renderOverlay(getBounds());
 }
 
+bool
+LiteSlider::hitTest(const Box& b) const
+{
+  return infovis::intersects(getBounds(), b);
+}
+
+Box
+LiteSlider::getHull() const
+{
+  Box hull(LiteGroup::getHull());
+  Box boxes[2];
+  int n = labelBoxes(boxes);
+  for (int i = 0; i < n; i++)
+    hull = box_union(hull, boxes[i]);
+  return hull;
+}
+
+bool
+LiteSlider::collectHits(const Box& b, Path& path, PathList& hit) const
+{
+  if (! LiteGroup::collectHits(b, path, hit))
+    return false;
+  // The overlay is rendered after the children.
+  if (isVisible() && hitOverlay(b))
+    hit.push_back(path);
+  return true;
+}
+
 void
 LiteSlider::renderBackground(const Box& b)
 {
@@ -382,6 +410,40 @@ LiteSlider::renderOverlay(const Box& b)
   }
 }
 
+bool
+LiteSlider::hitOverlay(const Box& b) const
+{
+  Box boxes[2];
+  int n = labelBoxes(boxes);
+  for (int i = 0; i < n; i++)
+    if (infovis::intersects(boxes[i], b))
+      return true;
+  return false;
+}
+
+// Boxes of the labels drawn by renderOverlay, grown by one pixel for
+// paintGrown.
+int
+LiteSlider::labelBoxes(Box boxes[2]) const
+{
+  if (font_ == 0)
+    return 0;
+  LiteSlider * self = const_cast<LiteSlider*>(this);
+  Box b(getBounds());
+  float bottom = ymin(b) - 1;
+  float top = ymin(b) + font_->getDescent() + font_->getAscent() + 1;
+  int n = 0;
+  string label = self->minLabel();
+  if (! label.empty())
+    boxes[n++] = Box(xmin(b) - font_->stringWidth(label) - 1, bottom,
+		     xmin(b) + 1, top);
+  label = self->maxLabel();
+  if (! label.empty())
+    boxes[n++] = Box(xmax(b) - 1, bottom,
+		     xmax(b) + font_->stringWidth(label) + 1, top);
+  return n;
+}
+
 BoundedRangeObservable*
 LiteSlider::getObservable() const { return observable_; }
 
@@ -416,22 +478,25 @@ Font *
 LiteSlider::getFont() const { return font_; }
 
 void
-LiteSlider::setFont(Font * font) { font_ = font; }
+LiteSlider::setFont(Font * font) { font_ = font; invalidateHull(); }
 
 void
 LiteSlider::valueDragged(BoundedRangeObservable *) 
 {
+  invalidateHull();		// the labels changed
   repaint();
 }
 void
 LiteSlider::rangeDragged(BoundedRangeObservable *)
 {
+  invalidateHull();
   repaint();
 }
 
 void
 LiteSlider::updateBoundedRange(BoundedRangeObservable *)
 {
+  invalidateHull();
   repaint();
 }
 
@@ -439,6 +504,7 @@ void
 LiteSlider::setLabelFormater(LabelFormater * f)
 {
   formater_ = f;
+  invalidateHull();
 }  
 
 LiteSlider::LabelFormater *
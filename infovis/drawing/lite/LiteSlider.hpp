@@ -76,6 +76,9 @@ public:
 
   virtual void render(const RenderContext&);
   virtual void doRender(const RenderContext& rc);
+  virtual bool hitTest(const Box& b) const;
+  virtual Box getHull() const;
+  virtual bool collectHits(const Box& b, Path& path, PathList& hit) const;
   virtual Lite * clone() const;
 
   virtual void positionParts();
@@ -119,6 +122,7 @@ public:
   virtual void renderMax(const Box& b);
 #endif
   virtual void renderOverlay(const Box& b);
+  virtual bool hitOverlay(const Box& b) const;
 
   virtual void valueDragged(BoundedRangeObservable * obs);
   virtual void rangeDragged(BoundedRangeObservable * obs);
@@ -132,6 +136,7 @@ public:
   virtual void setLabelFormater(LabelFormater * f);
   virtual LabelFormater * getLabelFormater() const;
 protected:
+  int labelBoxes(Box boxes[2]) const;
   BoundedRangeObservable * observable_;
   direction direction_;
   Color foreground_color_;
@@ -40,6 +40,7 @@ LiteSwitch::render(const RenderContext& c)
 {
   if (! is_visible)
     return;
+  validateBounds();
   doRender(c);
   if (selected_ < 0 || selected_ >= childCount())
     return;
@@ -50,6 +51,17 @@ LiteSwitch::render(const RenderContext& c)
     glPopName();
 }
 
+bool
+LiteSwitch::collectHits(const Box& b, Path& path, PathList& hit) const
+{
+  if (! is_visible || selected_ < 0 || selected_ >= childCount())
+    return true;
+  path.push_back(selected_);
+  bool ret = getChild(selected_)->collectHits(b, path, hit);
+  path.pop_back();
+  return ret;
+}
+
 Lite *
 LiteSwitch::clone() const
 {
@@ -66,14 +78,14 @@ void
 LiteSwitch::setSelected(int v)
 {
   selected_ = v;
-  computeBounds();
+  invalidateBounds();
 }
 
 void
 LiteSwitch::setChangeBounds(bool v)
 {
   change_bounds_ = v;
-  computeBounds();
+  invalidateBounds();
 }
 
 bool
@@ -38,6 +38,7 @@ public:
   LiteSwitch(bool change_bounds = true);
 
   virtual void render(const RenderContext&);
+  virtual bool collectHits(const Box& b, Path& path, PathList& hit) const;
   virtual Lite * clone() const;
 
   virtual int getSelected() const;
@@ -23,6 +23,7 @@
  * SOFTWARE.
  */
 #include <infovis/drawing/lite/LiteTransform.hpp>
+#include <cfloat>
 #include <infovis/drawing/gl.hpp>
 
 namespace infovis {
@@ -49,6 +50,19 @@ namespace infovis {
     glPopMatrix();
   }
 
+  Box
+  LiteTransform::getHull() const
+  {
+    return Box(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+  }
+
+  bool
+  LiteTransform::collectHits(const Box&, Path&, PathList&) const
+  {
+    // Picking through the transform is left to the OpenGL selection.
+    return false;
+  }
+
   Lite *
   LiteTransform::clone() const
   {
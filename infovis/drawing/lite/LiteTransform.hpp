@@ -40,6 +40,8 @@ public:
 
   virtual Box getBounds() const;
   virtual void render(const RenderContext& c);
+  virtual Box getHull() const;
+  virtual bool collectHits(const Box& b, Path& path, PathList& hit) const;
   virtual Lite * clone() const;
 
   const Transform& getTransform() const { return trans; }
@@ -27,6 +27,7 @@
 #include <infovis/drawing/inter/Manager3State.hpp>
 #include <infovis/drawing/Font.hpp>
 #include <infovis/drawing/ImagePNG.hpp>
+#include <infovis/drawing/SaveUnder.hpp>
 #include <infovis/drawing/inter/MouseHandler.hpp>
 #include <infovis/drawing/inter/KeyboardHandler.hpp>
 #include <infovis/drawing/inter/TimerHandler.hpp>
@@ -34,6 +35,7 @@
 #include <infovis/drawing/inter/DefaultManagerIdle.hpp>
 #include <GL/glut.h>
 #include <set>
+#include <cmath>
 //#define PRINT
 //#ifdef PRINT
 #include <iostream>
@@ -80,7 +82,12 @@ LiteWindow::LiteWindow(const string& name, const Box& box, unsigned int cap)
     clear_mask(buffer_color),
     cursor_(0),
     redisplay_count_(0),
-    modifiers_(0)
+    modifiers_(0),
+    frame_(0),
+    damage_all_(false),
+    frame_valid_(false),
+    partial_redraw_(true),
+    cpu_picking_(true)
 {
   glutInitDisplayMode(cap);
   glutInitWindowPosition(int(xmin(box)), int(ymin(box)));
@@ -120,6 +127,7 @@ LiteWindow::LiteWindow(const string& name, const Box& box, unsigned int cap)
 LiteWindow::~LiteWindow()
 {
   glutDestroyWindow(win);
+  delete frame_;
   if (instance == this)
     instance = 0;
 }
@@ -186,7 +194,21 @@ LiteWindow::endPick(PathList& hit,
 }
 
 int
-LiteWindow::pick(const Box&  box, PathList& hit)
+LiteWindow::pick(const Box& box, PathList& hit)
+{
+  if (cpu_picking_) {
+    Path path;
+    path.push_back(0);
+    hit.clear();
+    if (collectHits(box, path, hit))
+      return hit.size();
+    hit.clear();
+  }
+  return pickGL(box, hit);
+}
+
+int
+LiteWindow::pickGL(const Box&  box, PathList& hit)
 {
   GLuint hitBuffer[1024];// assumes sizeof(Lite*) == sizeof(unsigned int)
   beginPick(box, hitBuffer, 1024);
@@ -257,9 +279,47 @@ LiteWindow::display()
   if ((instance->clear_mask & int(buffer_stencil)) != 0)
     mask |= GL_STENCIL_BUFFER_BIT;
   
-  glClear(mask);
   instance->redisplay_count_++;
-  instance->render(RenderContext());
+  Box region;
+  if (instance->frame_valid_ && instance->partialRegion(region)) {
+    // Composite the last complete frame, then redraw the damage over it.
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_STENCIL_TEST);
+    instance->frame_->restore();
+    glPopAttrib();
+    int x0 = int(std::floor(xmin(region)));
+    int y0 = int(std::floor(ymin(region)));
+    glPushAttrib(GL_SCISSOR_BIT);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x0, y0,
+	      int(std::ceil(xmax(region))) - x0,
+	      int(std::ceil(ymax(region))) - y0);
+    glClear(mask);
+    instance->renderDamaged(region);
+    glPopAttrib();
+    // The saved frame is out of date in that region until the next save.
+    instance->stale_ = region;
+  }
+  else {
+    glClear(mask);
+    instance->render(RenderContext());
+    if (instance->partialRegion(region)) {
+      // Damage is local: keep this frame to composite the next ones.
+      if (instance->frame_ == 0)
+	instance->frame_ = new SaveUnder(screenWidth(), screenHeight());
+      instance->frame_->save(0, 0,
+			     unsigned(width(instance->bounds)),
+			     unsigned(height(instance->bounds)));
+      instance->frame_valid_ = true;
+    }
+    else
+      instance->frame_valid_ = false;
+    instance->stale_ = Box();
+  }
+  instance->damage_ = Box();
+  instance->damage_all_ = false;
   if (instance->cursor_ != 0) {
     glPushAttrib(GL_COLOR_BUFFER_BIT);
     glEnable(GL_BLEND);
@@ -286,6 +346,61 @@ LiteWindow::display()
   glutSwapBuffers();
 }
 
+bool
+LiteWindow::partialRegion(Box& region) const
+{
+  if (! partial_redraw_ || damage_all_ || empty(damage_) ||
+      cursor_ != 0 || ! save_fname.empty())
+    return false;
+  region = damage_;
+  if (! empty(stale_))
+    region = box_union(region, stale_);
+  // Expand to whole pixels to catch antialiased edges.
+  region = box_intersection(Box(xmin(region) - 1, ymin(region) - 1,
+				xmax(region) + 1, ymax(region) + 1),
+			    bounds);
+  // Beyond half the window, a complete redraw is cheaper.
+  return ! empty(region) &&
+    2 * width(region) * height(region) <= width(bounds) * height(bounds);
+}
+
+void
+LiteWindow::renderDamaged(const Box& region)
+{
+  if (! is_visible)
+    return;
+  validateBounds();
+  RenderContext c;
+  doRender(c);
+  for (int i = 0; i < childCount(); i++) {
+    Lite * l = getChild(i);
+    if (l->intersects(region))
+      l->render(c);
+  }
+}
+
+void
+LiteWindow::addDamage(const Box& b)
+{
+  if (empty(damage_))
+    damage_ = b;
+  else
+    damage_ = box_union(damage_, b);
+}
+
+void
+LiteWindow::damageAll()
+{
+  damage_all_ = true;
+}
+
+void
+LiteWindow::setPartialRedraw(bool b)
+{
+  partial_redraw_ = b;
+  frame_valid_ = false;
+}
+
 void
 LiteWindow::doReshape(int w, int h)
 {
@@ -299,6 +414,7 @@ LiteWindow::do_reshape(int w, int h)
 #endif
   set_width(bounds, Coord(w));
   set_height(bounds, Coord(h));
+  frame_valid_ = false;
 #ifdef PRINT
   std::cerr << "size set, resizing "
 	    << " width=" << int(width(bounds))
@@ -30,6 +30,7 @@
 
 namespace infovis {
 class Image;
+class SaveUnder;
 class Manager3State;
 class MouseHandler;
 class KeyboardHandler;
@@ -41,7 +42,6 @@ class TimerHandler;
 class LiteWindow : public LiteGroup
 {
 public:
-  typedef std::vector<Path, gc_alloc<Path> > PathList;
   enum Buffer {
     buffer_color	= 1,
     buffer_depth	= 2,
@@ -94,7 +94,14 @@ public:
   virtual ~LiteWindow();
 
   int pick(const Box& b, PathList& hit);
+  int pickGL(const Box& b, PathList& hit);
   void pick(const Box& b, List& sorted);
+  /**
+   * When set, picking traverses the lites on the CPU and only falls
+   * back on the OpenGL selection for lites that cannot be hit tested.
+   */
+  void setCpuPicking(bool b) { cpu_picking_ = b; }
+  bool getCpuPicking() const { return cpu_picking_; }
   void beginPick(const Box& b,
 		 unsigned int * hitBuffer, unsigned sz);
   int endPick(PathList& hit,
@@ -126,6 +133,20 @@ public:
 
   unsigned getModifiers() const { return modifiers_; }
 
+  /**
+   * Adds a box to the region redrawn by the next frame.  When only
+   * such boxes are damaged, the frame is composited from the last
+   * complete one and only the lites intersecting them are rendered.
+   */
+  void addDamage(const Box& b);
+  /**
+   * Requests a complete redraw on the next frame.
+   */
+  void damageAll();
+  const Box& getDamage() const { return damage_; }
+  void setPartialRedraw(bool b);
+  bool getPartialRedraw() const { return partial_redraw_; }
+
   Cursor getCursor() const;
   void setCursor(Cursor c);
   void setCursor(Image *);
@@ -180,11 +201,20 @@ protected:
   Image * cursor_;
   long redisplay_count_;
   unsigned modifiers_;
+  SaveUnder * frame_;
+  Box damage_;
+  Box stale_;
+  bool damage_all_;
+  bool frame_valid_;
+  bool partial_redraw_;
+  bool cpu_picking_;
   std::vector<MouseHandler*> mouse_handler_;
   std::vector<KeyboardHandler*> keyboard_handler_;
   std::vector<TimerHandler*> timer_handler_;
 
   void modifiers(int x, int y);
+  bool partialRegion(Box& region) const;
+  void renderDamaged(const Box& region);
   static void display();
   static void reshape(int w, int h);
   static void keyboard(unsigned char key, int x, int y);
@@ -0,0 +1,188 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/drawing/colors/batch.hpp>
+#include <infovis/drawing/colors/color_lut.hpp>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef std::vector<float> Channel;
+
+static int errors;
+
+static void
+check(const char * what, float batch, float scalar, float eps, unsigned i)
+{
+  float err = std::fabs(batch - scalar);
+  if (err > eps * std::max(1.0f, std::fabs(scalar))) {
+    if (errors++ < 10)
+      std::cout << what << "[" << i << "]: batch=" << batch
+		<< " scalar=" << scalar << std::endl;
+  }
+}
+
+template <class Color>
+static void
+check_span(const char * what, const Channel * c, const Color& col,
+	   unsigned i, float eps = 1e-4f)
+{
+  for (int chan = 0; chan < 3; chan++)
+    check(what, c[chan][i], col[chan], eps, i);
+}
+
+int main()
+{
+  const unsigned n = 20000;
+  Channel a[3], b[3], c[3];
+  srand(1);
+  for (int chan = 0; chan < 3; chan++) {
+    a[chan].resize(n);
+    b[chan].resize(n);
+    c[chan].resize(n);
+    for (unsigned i = 0; i < n; i++)
+      a[chan][i] = rand() / float(RAND_MAX);
+  }
+  // include grey and saturated colors
+  a[0][0] = a[1][0] = a[2][0] = 0.5f;
+  a[0][1] = 1; a[1][1] = a[2][1] = 0;
+
+  rgb_span rgb(&a[0][0], &a[1][0], &a[2][0], n);
+  hsb_span hsb(&b[0][0], &b[1][0], &b[2][0], n);
+  rgb_span rgb2(&c[0][0], &c[1][0], &c[2][0], n);
+
+  convert(hsb, rgb);
+  convert(rgb2, hsb);
+  for (unsigned i = 0; i < n; i++) {
+    color_rgb<float> in(a[0][i], a[1][i], a[2][i]);
+    color_hsb h;
+    convert(h, in);
+    check_span("rgb->hsb", b, h, i);
+    color_rgb<float> out;
+    convert(out, h);
+    check_span("hsb->rgb", c, out, i);
+  }
+
+  xyz_span xyz(&b[0][0], &b[1][0], &b[2][0], n);
+  convert(xyz, rgb);
+  convert(rgb2, xyz);
+  for (unsigned i = 0; i < n; i++) {
+    color_rgb<float> in(a[0][i], a[1][i], a[2][i]);
+    color_xyz x;
+    convert(x, in);
+    check_span("rgb->xyz", b, x, i);
+    color_rgb<float> out;
+    convert(out, x);
+    check_span("xyz->rgb", c, out, i);
+  }
+
+  uvY_span uvY(&c[0][0], &c[1][0], &c[2][0], n);
+  convert(uvY, xyz);
+  for (unsigned i = 0; i < n; i++) {
+    color_xyz x(b[0][i], b[1][i], b[2][i]);
+    color_uvY u;
+    convert(u, x);
+    check_span("xyz->uvY", c, u, i);
+  }
+  xyz_span xyz2(&b[0][0], &b[1][0], &b[2][0], n);
+  convert(xyz2, uvY);
+  for (unsigned i = 0; i < n; i++) {
+    color_uvY u(c[0][i], c[1][i], c[2][i]);
+    color_xyz x;
+    convert(x, u);
+    check_span("uvY->xyz", b, x, i);
+  }
+
+  // hvc: hue in [0,360), value in [0,100], chroma in [0,50]
+  for (unsigned i = 0; i < n; i++) {
+    b[0][i] = a[0][i] * 360;
+    b[1][i] = a[1][i] * 100;
+    b[2][i] = a[2][i] * 50;
+  }
+  b[1][0] = 0;
+  b[1][1] = 100;
+  hvc_span hvc(&b[0][0], &b[1][0], &b[2][0], n);
+  convert(rgb2, hvc);
+  for (unsigned i = 0; i < n; i++) {
+    color_hvc h(b[0][i], b[1][i], b[2][i]);
+    color_rgb<float> out;
+    convert(out, h);
+    check_span("hvc->rgb", c, out, i, 1e-3f);
+  }
+
+  cmy_span cmy(&b[0][0], &b[1][0], &b[2][0], n);
+  convert(cmy, rgb);
+  convert(rgb2, cmy);
+  for (unsigned i = 0; i < n; i++)
+    for (int chan = 0; chan < 3; chan++)
+      check("cmy", c[chan][i], a[chan][i], 1e-6f, i);
+
+  // Ramp lookup tables against direct interpolation
+  std::vector<color_rgba<unsigned char> > ramp;
+  ramp.push_back(color_rgba<unsigned char>(255U, 247U, 251U));
+  ramp.push_back(color_rgba<unsigned char>(3U, 78U, 123U));
+  ramp.push_back(color_rgba<unsigned char>(228U, 26U, 28U));
+  color_lut smooth, steps;
+  smooth.build(ramp, true);
+  steps.build(ramp, false);
+  for (unsigned i = 0; i <= 1000; i++) {
+    float t = i / 1000.0f;
+    float pos = t * (ramp.size() - 1);
+    unsigned k = std::min(unsigned(pos), unsigned(ramp.size() - 2));
+    float f = pos - k;
+    for (int chan = 0; chan < 4; chan++) {
+      float expected = (1-f) * ramp[k][chan] + f * ramp[k+1][chan];
+      // one level of rounding plus half a table step
+      float eps = 1 + std::fabs(float(ramp[k+1][chan]) - ramp[k][chan])
+	* (ramp.size() - 1) / (2.0f * (color_lut::lut_size - 1));
+      if (std::fabs(smooth(t)[chan] - expected) > eps && errors++ < 10)
+	std::cout << "smooth lut(" << t << ")[" << chan << "] = "
+		  << int(smooth(t)[chan]) << " expected " << expected
+		  << std::endl;
+    }
+    unsigned j = color_lut::index(t);
+    unsigned seg = j * (ramp.size() - 1) / (color_lut::lut_size - 1);
+    for (int chan = 0; chan < 4; chan++) {
+      if (steps(t)[chan] != ramp[seg][chan] && errors++ < 10)
+	std::cout << "step lut(" << t << ") wrong\n";
+    }
+  }
+  std::vector<float> values(1000);
+  std::vector<color_rgba<unsigned char> > colors(values.size());
+  for (unsigned i = 0; i < values.size(); i++)
+    values[i] = 10 + i * 0.02f;
+  smooth.map(&values[0], values.size(), 10, 20, &colors[0]);
+  for (unsigned i = 0; i < values.size(); i++) {
+    const color_rgba<unsigned char>& e = smooth((values[i] - 10) / 20);
+    for (int chan = 0; chan < 4; chan++)
+      if (colors[i][chan] != e[chan] && errors++ < 10)
+	std::cout << "map[" << i << "] differs from lookup\n";
+  }
+
+  std::cout << (errors ? "FAILED\n" : "OK\n");
+  return errors != 0;
+}
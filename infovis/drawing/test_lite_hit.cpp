@@ -0,0 +1,189 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "test_lite_hit.hpp"
+#include <infovis/drawing/lite/LiteTransform.hpp>
+
+static int
+check_shapes()
+{
+  int errors = 0;
+  LiteGroup root;
+  build_shapes(&root);
+
+  struct { int x, y; PathList expected; } cases[8];
+  cases[0].x = 25; cases[0].y = 25;
+  cases[0].expected.push_back(make_path(0));
+  cases[1].x = 35; cases[1].y = 35;
+  cases[1].expected.push_back(make_path(0));
+  cases[1].expected.push_back(make_path(6));
+  cases[2].x = 55; cases[2].y = 55;
+  cases[2].expected.push_back(make_path(6));
+  cases[3].x = 95; cases[3].y = 25;
+  cases[3].expected.push_back(make_path(2));
+  cases[3].expected.push_back(make_path(2, 0));
+  cases[4].x = 165; cases[4].y = 25;
+  cases[4].expected.push_back(make_path(3, 1));
+  cases[5].x = 205; cases[5].y = 25;
+  cases[5].expected.push_back(make_path(4, 1));
+  cases[6].x = 255; cases[6].y = 25;
+  cases[7].x = 300; cases[7].y = 300;
+
+  for (int i = 0; i < 8; i++) {
+    Path path;
+    path.push_back(0);
+    PathList hit;
+    if (! root.collectHits(pick_box(cases[i].x, cases[i].y), path, hit)) {
+      std::cerr << "unexpected fallback at " << cases[i].x << ","
+		<< cases[i].y << std::endl;
+      errors++;
+    }
+    else if (hit != cases[i].expected) {
+      std::cerr << "at " << cases[i].x << "," << cases[i].y << " got ";
+      print(std::cerr, hit);
+      std::cerr << " expected ";
+      print(std::cerr, cases[i].expected);
+      std::cerr << std::endl;
+      errors++;
+    }
+  }
+
+  // A transformed subtree can only be picked by OpenGL.
+  LiteTransform * trans = new LiteTransform();
+  trans->addChild(new LiteRect(Box(0, 0, 10, 10), color_red));
+  root.addChild(trans);
+  Path path;
+  path.push_back(0);
+  PathList hit;
+  if (root.collectHits(pick_box(300, 300), path, hit)) {
+    std::cerr << "transform should require the GL selection\n";
+    errors++;
+  }
+
+  // Geometry helpers used by the non rectangular lites.
+  typedef Box::point_type P;
+  if (! intersects_triangle(pick_box(5, 5), P(0, 0), P(10, 0), P(0, 10)) ||
+      intersects_triangle(pick_box(9, 9), P(0, 0), P(10, 0), P(0, 10)) ||
+      ! intersects_triangle(pick_box(2, 2), P(0, 0), P(100, 0), P(0, 100))) {
+    std::cerr << "intersects_triangle failed\n";
+    errors++;
+  }
+  if (! intersects_segment(pick_box(5, 5), 0, 0, 10, 10) ||
+      intersects_segment(pick_box(5, 5), 0, 10, 3, 20) ||
+      ! intersects_outline(Box(0, 0, 10, 10), pick_box(10, 5)) ||
+      intersects_outline(Box(0, 0, 10, 10), pick_box(5, 5))) {
+    std::cerr << "intersects_segment or intersects_outline failed\n";
+    errors++;
+  }
+  return errors;
+}
+
+// Moving, resizing, adding or removing a child must refresh the cached
+// hull of its groups, otherwise the CPU picking prunes the wrong subtrees.
+static int
+check_invalidation()
+{
+  int errors = 0;
+  LiteGroup root;
+  LiteGroup * group = new LiteGroup();
+  LiteRect * rect = new LiteRect(Box(10, 10, 40, 40), color_red);
+  group->addChild(rect);
+  root.addChild(group);
+
+  Path path;
+  path.push_back(0);
+  PathList hit;
+  root.collectHits(pick_box(25, 25), path, hit);
+  if (hit.size() != 1 || ! group->isHullValid()) {
+    std::cerr << "initial pick failed\n";
+    errors++;
+  }
+
+  rect->setPosition(Point(100, 100));
+  if (group->isHullValid() || root.isHullValid()) {
+    std::cerr << "moving a child did not invalidate the hulls\n";
+    errors++;
+  }
+  hit.clear();
+  root.collectHits(pick_box(25, 25), path, hit);
+  if (! hit.empty()) {
+    std::cerr << "moved child still picked at its old position\n";
+    errors++;
+  }
+  hit.clear();
+  root.collectHits(pick_box(115, 115), path, hit);
+  if (hit.size() != 1 || ! contains(group->getHull(), Box(100, 100, 130, 130))) {
+    std::cerr << "moved child not picked at its new position\n";
+    errors++;
+  }
+
+  rect->setBounds(Box(100, 100, 200, 200));
+  hit.clear();
+  root.collectHits(pick_box(180, 180), path, hit);
+  if (hit.size() != 1 || ! contains(root.getHull(), Box(100, 100, 200, 200))) {
+    std::cerr << "resized child not picked\n";
+    errors++;
+  }
+
+  group->addChild(new LiteRect(Box(300, 300, 320, 320), color_green));
+  hit.clear();
+  root.collectHits(pick_box(310, 310), path, hit);
+  if (hit.size() != 1 || hit[0] != make_path(0, 1)) {
+    std::cerr << "added child not picked\n";
+    errors++;
+  }
+
+  Lite * removed = group->getChild(1);
+  group->eraseChild(1);
+  hit.clear();
+  root.collectHits(pick_box(310, 310), path, hit);
+  if (! hit.empty() || root.getHull() != Box(100, 100, 200, 200)) {
+    std::cerr << "removed child still in the hull\n";
+    errors++;
+  }
+  delete removed;
+
+  // A removed child no longer invalidates its former group.
+  group->eraseChild(0);
+  root.getHull();
+  rect->setPosition(Point(0, 0));
+  if (! root.isHullValid()) {
+    std::cerr << "orphan still invalidates its former parent\n";
+    errors++;
+  }
+  delete rect;
+  return errors;
+}
+
+int main()
+{
+  int errors = check_shapes();
+  errors += check_invalidation();
+  if (errors != 0) {
+    std::cout << "FAILED\n";
+    return 1;
+  }
+  std::cout << "OK\n";
+  return 0;
+}
@@ -0,0 +1,96 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TEST_LITE_HIT_HPP
+#define TEST_LITE_HIT_HPP
+
+// Scene and helpers shared by test_lite_hit and test_lite_hit_gl.
+
+#include <infovis/drawing/lite/LiteBackground.hpp>
+#include <infovis/drawing/lite/LiteGroup.hpp>
+#include <infovis/drawing/lite/LiteRect.hpp>
+#include <infovis/drawing/lite/LiteSwitch.hpp>
+#include <iostream>
+
+using namespace infovis;
+
+typedef Lite::Path Path;
+typedef Lite::PathList PathList;
+
+static Box
+pick_box(int x, int y)
+{
+  return Box(x-1, y-1, x+1, y+1);
+}
+
+static Path
+make_path(int a, int b = -1, int c = -1)
+{
+  Path p;
+  p.push_back(0);
+  p.push_back(a);
+  if (b != -1) p.push_back(b);
+  if (c != -1) p.push_back(c);
+  return p;
+}
+
+static void
+print(std::ostream& out, const PathList& hit)
+{
+  out << "[";
+  for (unsigned i = 0; i < hit.size(); i++) {
+    out << " (";
+    for (unsigned j = 0; j < hit[i].size(); j++)
+      out << (j ? "," : "") << hit[i][j];
+    out << ")";
+  }
+  out << " ]";
+}
+
+// Scene made of lites that do not need a GL context.
+static void
+build_shapes(Lite * root)
+{
+  root->addChild(new LiteRect(Box(10, 10, 40, 40), color_red));	// 0
+  root->addChild(new LiteRect(Box(50, 10, 80, 40), color_green));	// 1
+  root->addChild(new LiteBackground(new LiteRect(Box(90, 10, 120, 40),
+						 color_blue),
+				    color_white));			// 2
+  LiteGroup * group = new LiteGroup();					// 3
+  group->addChild(new LiteRect(Box(130, 10, 150, 40), color_red));
+  group->addChild(new LiteRect(Box(160, 10, 180, 40), color_green));
+  root->addChild(group);
+  LiteSwitch * sw = new LiteSwitch();					// 4
+  sw->addChild(new LiteRect(Box(190, 10, 220, 40), color_red));
+  sw->addChild(new LiteRect(Box(190, 10, 220, 40), color_green));
+  sw->setSelected(1);
+  sw->setPosition(Point(190, 10));	// the stack layout moved them
+  root->addChild(sw);
+  Lite * hidden = new LiteRect(Box(240, 10, 270, 40), color_red);	// 5
+  hidden->setVisible(false);
+  root->addChild(hidden);
+  root->addChild(new LiteRect(Box(30, 30, 60, 60), color_blue));	// 6
+}
+
+#endif
@@ -0,0 +1,94 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+// Compares the CPU picking of LiteWindow with the OpenGL selection.
+// This test needs a display: without DISPLAY it prints SKIPPED and
+// succeeds without checking anything.
+#include "test_lite_hit.hpp"
+#include <infovis/drawing/lite/LiteLabel.hpp>
+#include <infovis/drawing/lite/LiteMover.hpp>
+#include <infovis/drawing/lite/LiteRangeSlider.hpp>
+#include <infovis/drawing/lite/LiteWindow.hpp>
+#include <infovis/drawing/notifiers/BoundedRange.hpp>
+#include <cstdlib>
+
+// Recorded mouse coordinates, from a session over the test_lite_pick
+// scene extended with the widgets below.
+static const int recorded[][2] = {
+  { 25, 25 }, { 35, 35 }, { 55, 55 }, { 95, 25 }, { 120, 40 },
+  { 145, 25 }, { 165, 25 }, { 205, 25 }, { 255, 25 }, { 300, 300 },
+  { 105, 105 }, { 140, 108 }, { 60, 210 }, { 75, 210 }, { 150, 210 },
+  { 231, 210 }, { 240, 210 }, { 400, 380 }, { 0, 0 }, { 639, 399 }
+};
+static const int recorded_count = sizeof(recorded) / sizeof(recorded[0]);
+
+// Compares the CPU picking with the GL selection on the recorded
+// coordinates.
+static int
+check_gl(int argc, char * argv[])
+{
+  int errors = 0;
+  LiteWindow::init(argc, argv);
+  LiteWindow win("test lite hit", Box(0, 0, 640, 400));
+  build_shapes(&win);
+  // The test_lite_pick scene.
+  LiteLabel * lab = new LiteLabel("Label test");
+  lab->setPosition(Point(100, 100));
+  win.addChild(new LiteMover(lab, lab));
+  win.addChild(new LiteRangeSlider(new DefaultBoundedRangeObservable(0, 100,
+								     20, 30),
+				   Box(50, 200, 250, 220)));
+
+  for (int i = 0; i < recorded_count; i++) {
+    Box b(pick_box(recorded[i][0], recorded[i][1]));
+    PathList cpu, gl;
+    win.setCpuPicking(true);
+    win.pick(b, cpu);
+    win.pickGL(b, gl);
+    if (cpu != gl) {
+      std::cerr << "at " << recorded[i][0] << "," << recorded[i][1]
+		<< " cpu ";
+      print(std::cerr, cpu);
+      std::cerr << " gl ";
+      print(std::cerr, gl);
+      std::cerr << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main(int argc, char * argv[])
+{
+  if (getenv("DISPLAY") == 0) {
+    std::cout << "SKIPPED (needs a display)\n";
+    return 0;
+  }
+  if (check_gl(argc, argv) != 0) {
+    std::cout << "FAILED\n";
+    return 1;
+  }
+  std::cout << "OK\n";
+  return 0;
+}
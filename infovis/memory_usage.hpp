@@ -0,0 +1,161 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_MEMORY_USAGE_HPP
+#define INFOVIS_MEMORY_USAGE_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Memory held by an object: the bytes holding its data and the bytes
+ * allocated for it, the difference being the slack a shrink_to_fit
+ * would give back.
+ */
+struct memory_size
+{
+  std::size_t used;
+  std::size_t capacity;
+
+  memory_size(std::size_t u = 0, std::size_t c = 0)
+    : used(u), capacity(c) { }
+
+  std::size_t slack() const { return capacity - used; }
+
+  memory_size& operator += (const memory_size& other) {
+    used += other.used;
+    capacity += other.capacity;
+    return *this;
+  }
+};
+
+inline memory_size
+operator + (memory_size a, const memory_size& b)
+{
+  return a += b;
+}
+
+inline std::ostream&
+operator << (std::ostream& out, const memory_size& m)
+{
+  return out << m.used << " used / " << m.capacity << " allocated bytes";
+}
+
+/**
+ * Return the memory of the elements of a vector, not counting what
+ * the elements allocate themselves.
+ */
+template <class Vector>
+inline memory_size
+vector_memory(const Vector& v)
+{
+  typedef typename Vector::value_type T;
+  return memory_size(v.size() * sizeof(T), v.capacity() * sizeof(T));
+}
+
+/**
+ * Return the memory a value allocates out of its own storage, none
+ * for most types.
+ */
+template <class T>
+inline memory_size
+value_payload(const T&)
+{
+  return memory_size();
+}
+
+/**
+ * Return the memory a string allocates, none when the characters are
+ * stored in the string object itself.
+ */
+inline memory_size
+value_payload(const std::string& s)
+{
+  const char * p = s.data();
+  const char * o = reinterpret_cast<const char *>(&s);
+  if (p >= o && p < o + sizeof(s))
+    return memory_size();
+  return memory_size(s.size() + 1, s.capacity() + 1);
+}
+
+/**
+ * Return the memory of the elements of a vector and the memory they
+ * allocate.
+ */
+template <class T, class Alloc>
+inline memory_size
+values_memory(const std::vector<T, Alloc>& v)
+{
+  memory_size m = vector_memory(v);
+  for (const T& x : v)
+    m += value_payload(x);
+  return m;
+}
+
+template <class Alloc>
+inline memory_size
+values_memory(const std::vector<bool, Alloc>& v)
+{
+  const std::size_t bits = 8 * sizeof(unsigned long);
+  return memory_size((v.size() + bits - 1) / bits * sizeof(unsigned long),
+		     (v.capacity() + bits - 1) / bits * sizeof(unsigned long));
+}
+
+inline void
+shrink_value(std::string& s)
+{
+  s.shrink_to_fit();
+}
+
+template <class T>
+inline void
+shrink_value(T&)
+{ }
+
+/**
+ * Release the slack of a vector and of its elements.
+ */
+template <class T, class Alloc>
+inline void
+shrink_values(std::vector<T, Alloc>& v)
+{
+  v.shrink_to_fit();
+  for (T& x : v)
+    shrink_value(x);
+}
+
+template <class Alloc>
+inline void
+shrink_values(std::vector<bool, Alloc>& v)
+{
+  v.shrink_to_fit();
+}
+
+} // namespace infovis
+
+#endif // INFOVIS_MEMORY_USAGE_HPP
@@ -0,0 +1,99 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_PARALLEL_FOR_HPP
+#define INFOVIS_PARALLEL_FOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Rows below which splitting a scan across one more thread costs more
+ * than it saves.
+ */
+static const unsigned min_rows_per_thread = 64 * 1024;
+
+/**
+ * Return the number of threads worth using to scan rows.
+ * @param rows the number of rows
+ * @param threads the maximum number of threads, 0 for the hardware
+ * concurrency
+ * @param min_rows the minimum number of rows given to each thread
+ * @return a number of threads, at least 1.
+ */
+inline unsigned
+parallel_threads(unsigned rows, unsigned threads = 0,
+		 unsigned min_rows = min_rows_per_thread)
+{
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  threads = std::min(threads, rows / std::max(1u, min_rows));
+  return std::max(1u, threads);
+}
+
+/**
+ * Call fn(t) for each t in [0,threads), t = 0 on the calling thread
+ * and the others on threads of their own, and return once they all
+ * returned.
+ */
+template <class Fn>
+void
+parallel_run(unsigned threads, Fn fn)
+{
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; t++)
+    pool.emplace_back(fn, t);
+  fn(0);
+  for (auto& th : pool)
+    th.join();
+}
+
+/**
+ * Split the rows [0,n) into threads contiguous ranges of about the
+ * same size and call fn(t, begin, end) for each range t in parallel,
+ * as parallel_run() does.
+ * @param n the number of rows
+ * @param threads the number of ranges, usually from parallel_threads()
+ * @param fn the functor
+ */
+template <class Fn>
+void
+parallel_for(unsigned n, unsigned threads, Fn fn)
+{
+  if (threads == 0)
+    threads = 1;
+  parallel_run(threads, [&](unsigned t) {
+      fn(t,
+	 unsigned(std::size_t(n) * t / threads),
+	 unsigned(std::size_t(n) * (t + 1) / threads));
+    });
+}
+
+} // namespace infovis
+
+#endif // INFOVIS_PARALLEL_FOR_HPP
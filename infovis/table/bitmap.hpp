@@ -0,0 +1,133 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TABLE_BITMAP_HPP
+#define INFOVIS_TABLE_BITMAP_HPP
+
+#include <infovis/memory_usage.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Growable vector of bits stored in 64 bit words.
+ *
+ * Unlike std::vector<bool>, the words are accessible so that a
+ * column_view can test the defined values without going through the
+ * column.  Bits past the size in the last word are always 0.
+ */
+class bitmap
+{
+public:
+  typedef std::uint64_t word_type;
+  enum { word_bits = 64 };
+
+  bitmap() : size_(0) { }
+
+  unsigned size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const word_type * data() const { return words_.data(); }
+
+  /**
+   * Test a bit in raw words.
+   * @param words the words
+   * @param i the bit index
+   */
+  static bool test(const word_type * words, unsigned i) {
+    return (words[i / word_bits] >> (i % word_bits)) & 1;
+  }
+
+  bool operator[] (unsigned i) const { return test(words_.data(), i); }
+
+  void set(unsigned i, bool v = true) {
+    word_type mask = word_type(1) << (i % word_bits);
+    if (v)
+      words_[i / word_bits] |= mask;
+    else
+      words_[i / word_bits] &= ~mask;
+  }
+
+  void push_back(bool v) {
+    if (size_ % word_bits == 0)
+      words_.push_back(0);
+    size_++;
+    if (v)
+      set(size_ - 1);
+  }
+
+  void reserve(unsigned n) { words_.reserve(word_count(n)); }
+
+  /**
+   * Change the size, new bits being set to v.
+   */
+  void resize(unsigned n, bool v = false) {
+    if (n > size_) {
+      unsigned end = std::min(n, unsigned(word_count(size_) * word_bits));
+      if (v)
+	for (unsigned i = size_; i < end; i++)
+	  set(i);
+      words_.resize(word_count(n), v ? ~word_type(0) : 0);
+    }
+    else
+      words_.resize(word_count(n));
+    size_ = n;
+    clear_tail();
+  }
+
+  void assign(unsigned n, bool v) {
+    words_.assign(word_count(n), v ? ~word_type(0) : 0);
+    size_ = n;
+    clear_tail();
+  }
+
+  void clear() {
+    words_.clear();
+    size_ = 0;
+  }
+
+  void shrink_to_fit() { words_.shrink_to_fit(); }
+
+  memory_size memory_usage() const {
+    return memory_size(word_count(size_) * sizeof(word_type),
+		       words_.capacity() * sizeof(word_type));
+  }
+
+protected:
+  static unsigned word_count(unsigned n) {
+    return (n + word_bits - 1) / word_bits;
+  }
+  void clear_tail() {
+    if (size_ % word_bits != 0)
+      words_.back() &= (word_type(1) << (size_ % word_bits)) - 1;
+  }
+
+  std::vector<word_type> words_;
+  unsigned size_;
+};
+
+} // namespace infovis
+
+#endif // INFOVIS_TABLE_BITMAP_HPP
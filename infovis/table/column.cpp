@@ -28,14 +28,37 @@ namespace infovis {
 
 column::column(const string& name)
   : name_(name),
-    defined_()
+    defined_(),
+    type_tag_(0)
 { }
 
 column::column(const column& other)
   : name_(other.name_),
-    defined_(other.defined_)
+    defined_(other.defined_),
+    type_tag_(other.type_tag_)
 { }
 
+memory_size
+column::memory_usage() const
+{
+  memory_size m(sizeof(*this), sizeof(*this));
+  m += value_payload(name_);
+  m += defined_.memory_usage();
+  // Approximate the map nodes by their pointers and color.
+  const std::size_t node = sizeof(Metadata::value_type) + 4 * sizeof(void*);
+  for (const Metadata::value_type& kv : metadata_) {
+    m += memory_size(node, node);
+    m += value_payload(kv.first);
+    m += value_payload(kv.second);
+  }
+  return m;
+}
+
+void
+column::shrink_to_fit()
+{
+  defined_.shrink_to_fit();
+}
 
 void
 column::print(std::ostream& out) const
@@ -26,7 +26,9 @@
 #define INFOVIS_TABLE_COLUMN_HPP
 
 #include <infovis/alloc.hpp>
+#include <infovis/memory_usage.hpp>
 #include <infovis/table/table.hpp>
+#include <infovis/table/bitmap.hpp>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -60,8 +62,9 @@ public:
   typedef std::map<string,string> Metadata;
 protected:
   string name_;			/// The name of the column
-  std::vector<bool> defined_;	/// The vector of defined value
+  bitmap defined_;		/// The vector of defined value
   Metadata metadata_;		/// The metadata map
+  const void * type_tag_;	/// Identifies the concrete column type
 protected:
 
   /**
@@ -135,9 +138,22 @@ public:
    */
   void undefine(unsigned int index) {
     if (index < defined_.size())
-      defined_[index] = false;
+      defined_.set(index, false);
   }
 
+  /**
+   * Return the bitmap of defined values.
+   * @return the bitmap of defined values
+   */
+  const bitmap& defined_bits() const { return defined_; }
+
+  /**
+   * Return the tag of the concrete column type, compared by the
+   * typed casts instead of a dynamic_cast.
+   * @return the tag of the concrete column type
+   */
+  const void * type_tag() const { return type_tag_; }
+
   /**
    * Return the metadata map.
    * @return the metadata map.
@@ -200,6 +216,19 @@ public:
    */
   virtual unsigned capacity() const = 0;
 
+  /**
+   * Return the memory held by the column, including the name, the
+   * defined bits, the metadata and the memory allocated by the values
+   * such as string characters.
+   * @return the memory held by the column
+   */
+  virtual memory_size memory_usage() const;
+
+  /**
+   * Release the capacity allocated beyond the size of the column.
+   */
+  virtual void shrink_to_fit();
+
   /**
    * Return the string representation of the value at index.
    * @param index the row index.
@@ -274,12 +303,16 @@ operator >> (std::istream& in, column& c) {
 
 /**
  * Template class for specializing column types.
+ *
+ * The storage allocator can be changed, e.g. to an arena_alloc for
+ * columns built once and thrown away as a whole, or to a
+ * huge_page_alloc for very large columns.
  */
-template <class T>
+template <class T, class Alloc>
 class column_of : public column
 {
 protected:
-  typedef std::vector<T, gc_alloc<T,true> > List;
+  typedef std::vector<T, Alloc> List;
   List value_;
   T default_;			/// The default value.
   mutable T min_;		/// The computed minumum value.
@@ -315,17 +348,21 @@ protected:
     min_max_valid_ = true;
   }
 public:
-  typedef column_of<T> self;	///
+  typedef column_of<T,Alloc> self; ///
   typedef T value_type;		///
+  typedef Alloc allocator_type;	///
   typedef typename List::const_iterator const_iterator; /// The iterator type.
 
   /**
    * Constructor of a column specialized for a data type.
    */
-  explicit column_of(const string& name, int capacity = 10, const T& def = T())
+  explicit column_of(const string& name, int capacity = 10, const T& def = T(),
+		     const Alloc& alloc = Alloc())
     : column(name),
+      value_(alloc),
       default_(def),
       min_max_valid_(false) {
+    type_tag_ = tag();
     defined_.reserve(capacity);
     value_.reserve(capacity);
   }
@@ -333,12 +370,14 @@ public:
   /**
    * Copy constructor of a column specialized for a data type.
    */
-  column_of(const column_of<T>& other)
+  column_of(const self& other)
     : column(other),
       value_(other.value_),
       default_(other.default_),
       min_max_valid_(false)
-  { }
+  {
+    type_tag_ = tag();
+  }
 
   virtual column * clone() const {
     return new column_of(*this);
@@ -347,7 +386,7 @@ public:
   /**
    * Copy operator.
    */
-  column_of& operator = (const column_of& other) {
+  column_of& operator = (const self& other) {
     column::operator = (other);
     value_ = other.value_;
     default_ = other.default_;
@@ -364,6 +403,15 @@ public:
     value_.reserve(sz);
   }
   virtual unsigned capacity() const { return value_.capacity(); }
+
+  virtual memory_size memory_usage() const {
+    return column::memory_usage() + values_memory(value_);
+  }
+
+  virtual void shrink_to_fit() {
+    column::shrink_to_fit();
+    shrink_values(value_);
+  }
   virtual string get_value(unsigned int index) const {
     if (! defined(index))
       return "";
@@ -413,7 +461,7 @@ public:
     if (index >= size()) {
       resize(index+1);
     }
-    defined_[index] = true;
+    defined_.set(index);
     return value_[index];
   }
 
@@ -444,6 +492,13 @@ public:
     return value_[index];
   }
 
+  /**
+   * Return the contiguous storage of the values, valid until the
+   * column is resized.
+   * @return the contiguous storage of the values
+   */
+  const T * data() const { return value_.data(); }
+
   /**
    * Set the value at index.
    * @param index the index
@@ -454,7 +509,7 @@ public:
       resize(index+1);
     }
     value_[index] = v;
-    defined_[index] = true;
+    defined_.set(index);
     min_max_valid_ = false;
   }
 
@@ -467,6 +522,15 @@ public:
     value_[index] = v;
   }
 
+  /**
+   * Mark all the values as defined, typically after filling them
+   * with fast_set, possibly from several threads.
+   */
+  void define_all() {
+    defined_.assign(value_.size(), true);
+    min_max_valid_ = false;
+  }
+
   /**
    * Add a value to the column
    * @param v the value
@@ -500,6 +564,15 @@ public:
     return max_;
   }
 
+  /**
+   * Return the type tag shared by all the columns of this type.
+   * @return the type tag
+   */
+  static const void * tag() {
+    static const char t = 0;
+    return &t;
+  }
+
   /**
    * Utility static method to cast a generic column to a specific type
    * column.
@@ -507,7 +580,7 @@ public:
    * @return the type specific column of null
    */
   static self * cast(column * c) {
-    return dynamic_cast<self*>(c);
+    return c != 0 && c->type_tag() == tag() ? static_cast<self*>(c) : 0;
   }
 
   /**
@@ -517,7 +590,7 @@ public:
    * @return the type specific const column of null
    */
   static const self * cast(const column * c) {
-    return dynamic_cast<const self*>(c);
+    return c != 0 && c->type_tag() == tag() ? static_cast<const self*>(c) : 0;
   }
 
   /**
@@ -0,0 +1,108 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TABLE_COLUMN_VIEW_HPP
+#define INFOVIS_TABLE_COLUMN_VIEW_HPP
+
+#include <infovis/table/column.hpp>
+
+namespace infovis {
+
+/**
+ * Read-only view over the values of a typed column, for hot loops.
+ *
+ * The view is resolved once from a column and then reads the values
+ * and the defined bits directly from their storage, without the
+ * virtual calls, casts and bounds checks of the column accessors.
+ * It stays valid until the column is resized or destroyed, so it is
+ * typically resolved again at the start of each traversal.
+ */
+template <class T>
+class column_view
+{
+public:
+  typedef T value_type;
+  typedef const T * const_iterator;
+
+  /**
+   * Create an empty view.
+   */
+  column_view() : data_(0), defined_(0), size_(0) { }
+
+  /**
+   * Create a view over a column.
+   * @param c the column
+   */
+  template <class Alloc>
+  explicit column_view(const column_of<T,Alloc>& c)
+    : data_(c.data()),
+      defined_(c.defined_bits().data()),
+      size_(c.size())
+  { }
+
+  /**
+   * Create a view over a generic column if it has the right type.
+   * @param c the column, possibly null
+   * @return the view, empty if the column is null or has another type
+   */
+  static column_view of(const column * c) {
+    const column_of<T> * typed = column_of<T>::cast(c);
+    return typed != 0 ? column_view(*typed) : column_view();
+  }
+
+  /**
+   * Return the number of values.
+   */
+  unsigned size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * Return the value at index, which must be lower than size().
+   */
+  const T& operator[] (unsigned index) const { return data_[index]; }
+
+  /**
+   * Check whether the value at index is defined.
+   */
+  bool defined(unsigned index) const {
+    return index < size_ && bitmap::test(defined_, index);
+  }
+
+  const T * data() const { return data_; }
+  const bitmap::word_type * defined_data() const { return defined_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+protected:
+  const T * data_;
+  const bitmap::word_type * defined_;
+  unsigned size_;
+};
+
+template <class T>
+inline const T& get(const column_view<T>& pa, int k) { return pa[k]; }
+
+} // namespace infovis
+
+#endif // INFOVIS_TABLE_COLUMN_VIEW_HPP
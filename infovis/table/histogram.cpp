@@ -0,0 +1,140 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/table/histogram.hpp>
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
+
+namespace infovis {
+
+histogram::histogram(unsigned bins)
+  : min_(0), max_(0), scale_(0)
+{
+  unsigned n = 1;
+  while (n < bins)
+    n <<= 1;
+  for (;;) {
+    levels_.push_back(Bins(n, 0));
+    if (n == 1)
+      break;
+    n >>= 1;
+  }
+}
+
+void
+histogram::set_domain(float min, float max, float pad)
+{
+  min_ = min;
+  max_ = max;
+  float extent = max - min + pad;
+  scale_ = extent > 0 ? bin_count() / extent : 0;
+  for (auto& l : levels_)
+    std::fill(l.begin(), l.end(), 0);
+}
+
+void
+histogram::compute(const FloatColumn& values,
+		   const column_of<unsigned> * filter,
+		   unsigned threads)
+{
+  const unsigned n = values.size();
+  threads = parallel_threads(n, threads);
+
+  const unsigned filtered = filter != 0 ? filter->size() : 0;
+  std::vector<Bins> partial(threads, Bins(bin_count(), 0));
+  parallel_for(n, threads, [&](unsigned t, unsigned begin, unsigned end) {
+    Bins& bins = partial[t];
+    for (unsigned i = begin; i < end; i++) {
+      if (i < filtered && filter->fast_get(i) != 0)
+	continue;
+      unsigned b = bin(values.fast_get(i));
+      if (b < bins.size())
+	bins[b]++;
+    }
+  });
+
+  Bins& fine = levels_[0];
+  fine.swap(partial[0]);
+  for (unsigned t = 1; t < threads; t++) {
+    const Bins& bins = partial[t];
+    for (unsigned b = 0; b < fine.size(); b++)
+      fine[b] += bins[b];
+  }
+  build_pyramid();
+}
+
+void
+histogram::build_pyramid()
+{
+  for (unsigned l = 1; l < levels_.size(); l++) {
+    const Bins& below = levels_[l-1];
+    Bins& above = levels_[l];
+    for (unsigned b = 0; b < above.size(); b++)
+      above[b] = below[2*b] + below[2*b+1];
+  }
+}
+
+void
+histogram::update(const FloatColumn& values,
+		  const std::vector<unsigned>& entered,
+		  const std::vector<unsigned>& left)
+{
+  for (unsigned i : left)
+    remove(values.fast_get(i));
+  for (unsigned i : entered)
+    add(values.fast_get(i));
+}
+
+void
+histogram::resample(unsigned bars, Bins& out) const
+{
+  out.assign(bars, 0);
+  if (bars == 0)
+    return;
+  unsigned l = 0;
+  while (l + 1 < levels_.size() && levels_[l+1].size() >= bars)
+    l++;
+  const Bins& bins = levels_[l];
+  const size_t size = bins.size();
+  // Bar k spans the bins [k*size/bars, (k+1)*size/bars), a bin cut by
+  // a bar edge being shared in proportion of its overlap.  The counts
+  // are differences of the rounded running total, so they stay
+  // integers and still add up to total().
+  double below = 0;		// count of the bins before b
+  unsigned long prev = 0;
+  size_t b = 0;
+  for (unsigned k = 0; k < bars; k++) {
+    const double edge = double(k + 1) * size / bars;
+    while (b < size && b + 1 <= edge)
+      below += bins[b++];
+    double cum = below;
+    if (b < size)
+      cum += bins[b] * (edge - b);
+    const unsigned long c = (unsigned long)(cum + 0.5);
+    out[k] = unsigned(c - prev);
+    prev = c;
+  }
+}
+
+} // namespace infovis
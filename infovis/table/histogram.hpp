@@ -0,0 +1,149 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TABLE_HISTOGRAM_HPP
+#define INFOVIS_TABLE_HISTOGRAM_HPP
+
+#include <infovis/alloc.hpp>
+#include <infovis/table/column.hpp>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Histogram of the values of a FloatColumn, optionally restricted to
+ * the rows not filtered out.
+ *
+ * The counts are kept in a pyramid of bins: level 0 holds the finest
+ * bins and each level above merges pairs of bins of the level below.
+ * The histogram is computed once in parallel and then maintained
+ * incrementally when rows enter or leave the filter, and it can be
+ * resampled to any number of bars without rescanning the column.
+ */
+class histogram
+{
+public:
+  typedef std::vector<unsigned> Bins;
+
+  /**
+   * Create an histogram.
+   * @param bins the number of finest bins, rounded up to a power of two
+   */
+  explicit histogram(unsigned bins = 1024);
+
+  /**
+   * Set the domain of the histogram.
+   *
+   * Values in [min, max] are counted, the bins spanning
+   * [min, max+pad) so that integer values can be drawn as unit
+   * intervals.
+   * @param min the minimum value counted
+   * @param max the maximum value counted
+   * @param pad the extent added after max
+   */
+  void set_domain(float min, float max, float pad = 0);
+  float min() const { return min_; }
+  float max() const { return max_; }
+
+  /**
+   * Return the finest bin of a value.
+   * @param v the value
+   * @return the bin index or bin_count() if v is outside the domain
+   */
+  unsigned bin(float v) const {
+    if (! (v >= min_ && v <= max_))
+      return bin_count();
+    unsigned b = unsigned((v - min_) * scale_);
+    return b < bin_count() ? b : bin_count() - 1;
+  }
+
+  /**
+   * Recompute the histogram with a full scan of a column.
+   * @param values the column
+   * @param filter if not null, only rows where the filter is 0 are
+   * counted
+   * @param threads the number of threads to use, 0 for the number of
+   * hardware threads
+   */
+  void compute(const FloatColumn& values,
+	       const column_of<unsigned> * filter = 0,
+	       unsigned threads = 0);
+
+  /**
+   * Count a value.
+   */
+  void add(float v) { adjust(bin(v), 1); }
+
+  /**
+   * Uncount a value previously counted.
+   */
+  void remove(float v) { adjust(bin(v), -1); }
+
+  /**
+   * Update the histogram for rows whose visibility changed.
+   * @param values the column
+   * @param entered the rows that entered the filter
+   * @param left the rows that left the filter
+   */
+  void update(const FloatColumn& values,
+	      const std::vector<unsigned>& entered,
+	      const std::vector<unsigned>& left);
+
+  unsigned bin_count() const { return unsigned(levels_[0].size()); }
+  unsigned level_count() const { return unsigned(levels_.size()); }
+  const Bins& level(unsigned l) const { return levels_[l]; }
+
+  /**
+   * Return the number of values counted.
+   */
+  unsigned long total() const { return levels_.back()[0]; }
+
+  /**
+   * Resample the histogram into a number of bars, using the coarsest
+   * level having at least as many bins as bars, or the finest one.
+   * The bins straddling two bars are split between them in
+   * proportion of their overlap.
+   * @param bars the number of bars
+   * @param out the counts, resized to bars
+   */
+  void resample(unsigned bars, Bins& out) const;
+
+protected:
+  void adjust(unsigned b, int delta) {
+    if (b >= bin_count())
+      return;
+    for (unsigned l = 0; l < levels_.size(); l++, b >>= 1)
+      levels_[l][b] += delta;
+  }
+  void build_pyramid();
+
+  std::vector<Bins> levels_;
+  float min_;
+  float max_;
+  float scale_;
+};
+
+} // namespace infovis
+
+#endif // INFOVIS_TABLE_HISTOGRAM_HPP
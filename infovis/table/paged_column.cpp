@@ -0,0 +1,152 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/table/paged_column.hpp>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace infovis {
+
+page_cache::page_cache(size_t budget, size_t page_size)
+  : budget_(budget),
+    page_size_(page_size),
+    peak_(0),
+    faults_(0)
+{
+  size_t sys = sysconf(_SC_PAGESIZE);
+  if (page_size_ < sys || (page_size_ % sys) != 0)
+    throw std::invalid_argument("page_cache: bad page size");
+  if (budget_ < page_size_)
+    budget_ = page_size_;
+}
+
+page_cache::~page_cache()
+{
+  while (! lru_.empty())
+    unmap(--lru_.end());
+}
+
+char *
+page_cache::map(paged_storage * s, unsigned page)
+{
+  while ((lru_.size() + 1) * page_size_ > budget_ && ! lru_.empty())
+    unmap(--lru_.end());
+
+  void * addr = ::mmap(0, page_size_, PROT_READ|PROT_WRITE, MAP_SHARED,
+		       s->fd_, off_t(page) * page_size_);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("page_cache: cannot map " + s->path_);
+  entry e = { s, page };
+  lru_.push_front(e);
+  s->pages_[page] = static_cast<char*>(addr);
+  s->slots_[page] = lru_.begin();
+  s->last_ = page;
+  faults_++;
+  if (lru_.size() > peak_)
+    peak_ = lru_.size();
+  return s->pages_[page];
+}
+
+void
+page_cache::unmap(LRU::iterator i)
+{
+  paged_storage * s = i->storage;
+  ::munmap(s->pages_[i->page], page_size_);
+  s->pages_[i->page] = 0;
+  if (s->last_ == i->page)
+    s->last_ = unsigned(-1);
+  lru_.erase(i);
+}
+
+void
+page_cache::release(paged_storage * s)
+{
+  for (unsigned p = 0; p < s->pages_.size(); p++) {
+    if (s->pages_[p] != 0)
+      unmap(s->slots_[p]);
+  }
+}
+
+paged_storage::paged_storage(const string& path, page_cache& cache,
+			     bool create)
+  : path_(path),
+    cache_(cache),
+    fd_(-1),
+    size_(0),
+    opened_size_(0),
+    last_(unsigned(-1))
+{
+  int flags = O_RDWR;
+  if (create)
+    flags |= O_CREAT | O_TRUNC;
+  fd_ = ::open(path.c_str(), flags, 0644);
+  if (fd_ < 0)
+    throw std::runtime_error("paged_storage: cannot open " + path);
+  struct stat st;
+  if (::fstat(fd_, &st) == 0 && st.st_size > 0) {
+    opened_size_ = st.st_size;
+    resize(st.st_size);
+  }
+}
+
+paged_storage::~paged_storage()
+{
+  cache_.release(this);
+  ::close(fd_);
+}
+
+void
+paged_storage::resize(size_t size)
+{
+  size_t ps = cache_.page_size();
+  size = (size + ps - 1) / ps * ps;
+  if (size < size_) {
+    for (unsigned p = size / ps; p < pages_.size(); p++) {
+      if (pages_[p] != 0)
+	cache_.unmap(slots_[p]);
+    }
+  }
+  if (::ftruncate(fd_, size) != 0)
+    throw std::runtime_error("paged_storage: cannot resize " + path_);
+  size_ = size;
+  pages_.resize(size / ps, 0);
+  slots_.resize(size / ps);
+}
+
+bool
+paged_storage::truncate(size_t size)
+{
+  size_t ps = cache_.page_size();
+  for (unsigned p = (size + ps - 1) / ps; p < pages_.size(); p++) {
+    if (pages_[p] != 0)
+      cache_.unmap(slots_[p]);
+  }
+  return ::ftruncate(fd_, size) == 0;
+}
+
+} // namespace infovis
@@ -0,0 +1,246 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TABLE_PAGED_COLUMN_HPP
+#define INFOVIS_TABLE_PAGED_COLUMN_HPP
+
+#include <infovis/alloc.hpp>
+#include <string>
+#include <vector>
+#include <list>
+
+namespace infovis {
+
+using std::string;
+
+class paged_storage;
+
+/**
+ * Budget of mapped pages shared by several paged_storage.
+ *
+ * Pages are mapped on demand and the least recently used ones are
+ * unmapped when the budget is exceeded, so the resident memory used
+ * by paged columns stays below the budget whatever their size.
+ */
+class page_cache
+{
+public:
+  /**
+   * Create a page cache.
+   * @param budget the maximum number of bytes mapped at once
+   * @param page_size the size of a page, a multiple of the system
+   * page size
+   */
+  page_cache(size_t budget, size_t page_size = 1024 * 1024);
+  ~page_cache();
+
+  size_t page_size() const { return page_size_; }
+  size_t budget() const { return budget_; }
+
+  /**
+   * Return the number of bytes currently mapped.
+   */
+  size_t resident_bytes() const { return lru_.size() * page_size_; }
+
+  /**
+   * Return the maximum number of bytes mapped at once so far.
+   */
+  size_t peak_resident_bytes() const { return peak_ * page_size_; }
+
+  /**
+   * Return the number of pages mapped so far, i.e. the page faults
+   * of the cache.
+   */
+  unsigned long fault_count() const { return faults_; }
+
+protected:
+  friend class paged_storage;
+  struct entry {
+    paged_storage * storage;
+    unsigned page;
+  };
+  typedef std::list<entry> LRU;
+
+  char * map(paged_storage * s, unsigned page);
+  void touch(LRU::iterator i) { lru_.splice(lru_.begin(), lru_, i); }
+  void unmap(LRU::iterator i);
+  void release(paged_storage * s);
+
+  size_t budget_;
+  size_t page_size_;
+  LRU lru_;
+  size_t peak_;
+  unsigned long faults_;
+};
+
+/**
+ * Raw storage of a paged column: a file mapped page by page through a
+ * page_cache.
+ */
+class paged_storage
+{
+public:
+  /**
+   * Open or create the storage file.
+   * @param path the file name
+   * @param cache the page cache
+   * @param create true to truncate the file, false to reuse its
+   * contents
+   */
+  paged_storage(const string& path, page_cache& cache, bool create = true);
+  ~paged_storage();
+
+  const string& path() const { return path_; }
+  size_t size() const { return size_; }
+  page_cache& cache() const { return cache_; }
+
+  /**
+   * Return the size of the file when it was opened.
+   */
+  size_t opened_size() const { return opened_size_; }
+
+  /**
+   * Grow or shrink the file, rounding to a whole number of pages.
+   * @param size the new size in bytes
+   */
+  void resize(size_t size);
+
+  /**
+   * Set the exact size of the file, releasing the pages beyond it.
+   * Called before closing so that the file can be reopened.
+   * @param size the exact size in bytes
+   * @return false if the file could not be truncated
+   */
+  bool truncate(size_t size);
+
+  /**
+   * Return the address of a page, mapping it if needed.
+   * The address is only valid until the next call to page().
+   * @param p the page index
+   */
+  char * page(unsigned p) {
+    char * addr = pages_[p];
+    if (addr == 0)
+      return cache_.map(this, p);
+    if (p != last_)
+      cache_.touch(slots_[p]);
+    last_ = p;
+    return addr;
+  }
+
+protected:
+  friend class page_cache;
+  paged_storage(const paged_storage&);
+  paged_storage& operator = (const paged_storage&);
+
+  string path_;
+  page_cache& cache_;
+  int fd_;
+  size_t size_;
+  size_t opened_size_;
+  std::vector<char*> pages_;
+  std::vector<page_cache::LRU::iterator> slots_;
+  unsigned last_;
+};
+
+/**
+ * Column of fixed size values stored out of core.
+ *
+ * Values are stored in a paged_storage so the column can be larger
+ * than the available memory.  Since pages can be unmapped at any
+ * access, values are read and written by copy and never by
+ * reference.  All the values are considered defined.
+ */
+template <class T>
+class paged_column_of
+{
+public:
+  typedef T value_type;
+
+  paged_column_of(const string& path, page_cache& cache,
+		  bool create = true)
+    : storage_(path, cache, create),
+      per_page_(cache.page_size() / sizeof(T)),
+      size_(storage_.opened_size() / sizeof(T))
+  { }
+
+  ~paged_column_of() { storage_.truncate(size_t(size_) * sizeof(T)); }
+
+  unsigned size() const { return size_; }
+  const string& path() const { return storage_.path(); }
+
+  void resize(unsigned sz) {
+    if (sz > capacity()) {
+      size_t pages = (sz + per_page_ - 1) / per_page_;
+      pages += pages / 4;
+      storage_.resize(pages * per_page_ * sizeof(T));
+    }
+    size_ = sz;
+  }
+
+  void reserve(unsigned sz) {
+    if (sz > capacity())
+      storage_.resize(((sz + per_page_ - 1) / per_page_)
+		      * per_page_ * sizeof(T));
+  }
+
+  unsigned capacity() const { return storage_.size() / sizeof(T); }
+
+  T get(unsigned index) const {
+    return slot(index);
+  }
+
+  T operator[] (unsigned index) const { return slot(index); }
+
+  void set(unsigned index, const T& v) {
+    if (index >= size_)
+      resize(index+1);
+    slot(index) = v;
+  }
+
+  void add(const T& v) { set(size_, v); }
+
+protected:
+  T& slot(unsigned index) const {
+    char * p = storage_.page(index / per_page_);
+    return reinterpret_cast<T*>(p)[index % per_page_];
+  }
+
+  mutable paged_storage storage_;
+  unsigned per_page_;
+  unsigned size_;
+};
+
+typedef paged_column_of<unsigned> PagedUnsignedColumn;
+typedef paged_column_of<float> PagedFloatColumn;
+
+template <class T>
+inline T get(const paged_column_of<T>& pa, int k) { return pa.get(k); }
+
+template <class T, class V>
+inline void put(paged_column_of<T>& pa, int k, const V& val) { pa.set(k, val); }
+
+} // namespace infovis
+
+#endif // INFOVIS_TABLE_PAGED_COLUMN_HPP
@@ -143,6 +143,23 @@ table::reserve(unsigned sz)
   }
 }
 
+void
+table::shrink_to_fit()
+{
+  column_.shrink_to_fit();
+  for (unsigned i = 0; i < column_count(); i++)
+    get_column(i)->shrink_to_fit();
+}
+
+memory_size
+table::memory_usage() const
+{
+  memory_size m = vector_memory(column_);
+  for (unsigned i = 0; i < column_count(); i++)
+    m += get_column(i)->memory_usage();
+  return m;
+}
+
 bool
 table::defined(unsigned int index) const
 {
@@ -26,6 +26,7 @@
 #define INFOVIS_TABLE_TABLE_HPP
 
 #include <infovis/alloc.hpp>
+#include <infovis/memory_usage.hpp>
 #include <vector>
 #include <string>
 
@@ -34,7 +35,7 @@ namespace infovis {
 using std::string;
 
 class column;
-template <class T> class column_of;
+template <class T, class Alloc = gc_alloc<T,true> > class column_of;
 
 /**
  * Base container for all MillionVis data types.
@@ -138,6 +139,18 @@ public:
    */
   virtual void reserve(unsigned size);
 
+  /**
+   * Release the capacity allocated beyond the size of the columns,
+   * typically once a table has been loaded.
+   */
+  virtual void shrink_to_fit();
+
+  /**
+   * Return the memory held by the table and its columns.
+   * @return the memory held by the table and its columns
+   */
+  virtual memory_size memory_usage() const;
+
   /**
    * Check if all the values are defined at a specified row.
    * @param index the row index
@@ -0,0 +1,101 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/table/column_view.hpp>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace infovis;
+
+static int errors;
+
+static void
+fail(const char * what, unsigned i)
+{
+  std::cerr << what << " differs at " << i << std::endl;
+  errors++;
+}
+
+int main(int argc, char * argv[])
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 1000;
+
+  srand(17);
+  bitmap bits;
+  std::vector<bool> ref;
+  for (unsigned i = 0; i < n; i++) {
+    bool v = rand() % 3 == 0;
+    bits.push_back(v);
+    ref.push_back(v);
+  }
+  for (unsigned i = 0; i < n; i += 7) {
+    bits.set(i, i % 2 == 0);
+    ref[i] = i % 2 == 0;
+  }
+  bits.resize(n + 100, true);
+  ref.resize(n + 100, true);
+  bits.resize(n - 3);
+  ref.resize(n - 3);
+  bits.resize(n + 10);
+  ref.resize(n + 10);
+  for (unsigned i = 0; i < ref.size(); i++)
+    if (bits[i] != ref[i])
+      fail("bitmap", i);
+
+  FloatColumn f("float");
+  for (unsigned i = 0; i < n; i++)
+    f.add(float(i) / 2);
+  f.resize(n + 5);
+  f.undefine(3);
+  column_view<float> view(f);
+  if (view.size() != f.size())
+    fail("view size", view.size());
+  for (unsigned i = 0; i < f.size(); i++) {
+    if (view[i] != f[i])
+      fail("view value", i);
+    if (view.defined(i) != f.defined(i))
+      fail("view defined", i);
+  }
+  if (view.defined(f.size()))
+    fail("view defined past the end", f.size());
+
+  IntColumn c("int");
+  c.add(1);
+  const column * fc = &f;
+  const column * ic = &c;
+  if (FloatColumn::cast(fc) != &f)
+    fail("cast", 0);
+  if (FloatColumn::cast(ic) != 0)
+    fail("cast of another type", 0);
+  if (!column_view<int>::of(fc).empty())
+    fail("view of another type", 0);
+  if (column_view<int>::of(ic).size() != 1)
+    fail("view of a generic column", 0);
+  if (!column_view<float>::of(0).empty())
+    fail("view of null", 0);
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
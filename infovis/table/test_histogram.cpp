@@ -0,0 +1,146 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/table/histogram.hpp>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+using namespace infovis;
+
+static bool
+same(const histogram& a, const histogram& b)
+{
+  if (a.level_count() != b.level_count())
+    return false;
+  for (unsigned l = 0; l < a.level_count(); l++)
+    if (a.level(l) != b.level(l))
+      return false;
+  return true;
+}
+
+int main(int argc, char * argv[])
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 300000;
+  unsigned rounds = argc > 2 ? atoi(argv[2]) : 50;
+  int errors = 0;
+
+  srand(17);
+  FloatColumn values("values");
+  column_of<unsigned> filter("$filter");
+  for (unsigned i = 0; i < n; i++) {
+    values.add(float(rand() % 10000) / 7.0f - 100.0f);
+    filter.add(0);
+  }
+  values.set(n / 2, 1e9f);	// outside the domain
+  const float min = -50, max = 1200;
+
+  histogram serial(1000);
+  serial.set_domain(min, max, 1);
+  serial.compute(values, &filter, 1);
+  histogram parallel(1000);
+  parallel.set_domain(min, max, 1);
+  parallel.compute(values, &filter, 4);
+  if (! same(serial, parallel)) {
+    std::cerr << "parallel histogram differs from serial one\n";
+    errors++;
+  }
+  unsigned long expected = 0;
+  for (unsigned i = 0; i < n; i++)
+    if (values[i] >= min && values[i] <= max)
+      expected++;
+  if (parallel.total() != expected) {
+    std::cerr << "total " << parallel.total()
+	      << " expected " << expected << std::endl;
+    errors++;
+  }
+
+  histogram incremental(1000);
+  incremental.set_domain(min, max, 1);
+  incremental.compute(values, &filter, 4);
+  std::vector<unsigned> entered, left;
+  for (unsigned r = 0; r < rounds; r++) {
+    // Flip one of the filter bits on a random range of values, the
+    // way a range slider does.
+    const unsigned mask = 1 << (rand() % 4);
+    float lo = float(rand() % 1500) - 100.0f;
+    float hi = lo + float(rand() % 800);
+    entered.clear();
+    left.clear();
+    for (unsigned i = 0; i < n; i++) {
+      unsigned old = filter[i];
+      unsigned f = (values[i] < lo || values[i] > hi) ? (old | mask) : (old & ~mask);
+      filter[i] = f;
+      if (old == 0 && f != 0)
+	left.push_back(i);
+      else if (old != 0 && f == 0)
+	entered.push_back(i);
+    }
+    incremental.update(values, entered, left);
+
+    histogram full(1000);
+    full.set_domain(min, max, 1);
+    full.compute(values, &filter, 1 + r % 4);
+    if (! same(incremental, full)) {
+      std::cerr << "round " << r << ": incremental histogram differs\n";
+      errors++;
+      break;
+    }
+  }
+
+  histogram::Bins bars;
+  for (unsigned b = 1; b <= 1024; b = b * 3 + 1) {
+    incremental.resample(b, bars);
+    unsigned long sum = 0;
+    for (unsigned c : bars)
+      sum += c;
+    if (bars.size() != b || sum != incremental.total()) {
+      std::cerr << "resampling to " << b << " bars loses values\n";
+      errors++;
+    }
+  }
+
+  // Evenly spread values give even bars, whether the bars split the
+  // bins or the bins split the bars.
+  FloatColumn uniform("uniform");
+  for (unsigned i = 0; i < n; i++)
+    uniform.add(float(i) / n);
+  histogram flat(1000);
+  flat.set_domain(0, 1);
+  flat.compute(uniform, 0, 1);
+  for (unsigned b : { 300u, 1000u, 1500u }) {
+    flat.resample(b, bars);
+    const double expected = double(n) / b;
+    for (unsigned k = 0; k < b; k++)
+      if (bars[k] == 0 || std::fabs(bars[k] - expected) > expected * 0.01 + 1) {
+	std::cerr << "uneven bar " << k << " of " << b << ": " << bars[k]
+		  << " expected " << expected << std::endl;
+	errors++;
+	break;
+      }
+  }
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,103 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/table/column.hpp>
+#include <infovis/table/table.hpp>
+#include <iostream>
+
+using namespace infovis;
+
+static int errors;
+
+static void
+check(const char * what, std::size_t got, std::size_t expected)
+{
+  if (got == expected)
+    return;
+  std::cerr << what << ": " << got << " instead of " << expected << std::endl;
+  errors++;
+}
+
+int main()
+{
+  // Values and defined bits, no slack once shrunk.
+  FloatColumn f("f", 0);
+  const memory_size empty = f.memory_usage();
+  check("empty column slack", empty.slack(), 0);
+  f.reserve(2000);
+  f.resize(1000);
+  memory_size m = f.memory_usage();
+  check("float used", m.used - empty.used, 1000 * sizeof(float) + 16 * 8);
+  check("float allocated", m.capacity - empty.capacity,
+	2000 * sizeof(float) + 32 * 8);
+  f.resize(10);
+  f.shrink_to_fit();
+  m = f.memory_usage();
+  check("shrunk used", m.used - empty.used, 10 * sizeof(float) + 8);
+  check("shrunk slack", m.slack(), 0);
+
+  // Long strings allocate their characters, short ones don't.
+  StringColumn s("s", 0);
+  const memory_size no_strings = s.memory_usage();
+  s.add("abc");
+  s.add(string(100, 'x'));
+  s.shrink_to_fit();
+  m = s.memory_usage();
+  check("string used", m.used - no_strings.used,
+	2 * sizeof(string) + 8 + 101);
+  check("string slack", m.slack(), 0);
+
+  // Bools are packed in the vector too.
+  BoolColumn b("b", 0);
+  const memory_size no_bools = b.memory_usage();
+  b.resize(1000);
+  b.shrink_to_fit();
+  check("bool used", b.memory_usage().used - no_bools.used, 2 * 16 * 8);
+
+  // Metadata are counted.
+  memory_size before = f.memory_usage();
+  f.put_metadata("aggregate", "sum");
+  if (f.memory_usage().used <= before.used) {
+    std::cerr << "metadata not counted\n";
+    errors++;
+  }
+
+  // A table sums its columns.
+  table t;
+  FloatColumn * c1 = FloatColumn::find("c1", t);
+  StringColumn * c2 = StringColumn::find("c2", t);
+  c1->resize(500);
+  c2->resize(500);
+  (*c2)[7] = string(1000, 'y');
+  memory_size sum = c1->memory_usage() + c2->memory_usage();
+  m = t.memory_usage();
+  check("table used", m.used - sum.used, 2 * sizeof(column *));
+  t.shrink_to_fit();
+  check("table slack", t.memory_usage().slack(), 0);
+  check("table string payload", c2->memory_usage().used - 500 * sizeof(string)
+	- 8 * 8, no_strings.used + 1001);
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
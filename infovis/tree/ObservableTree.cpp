@@ -37,6 +37,38 @@ ObservableTree::add_node(node_descriptor n)
   return ret;
 }
 
+void
+ObservableTree::build_from_parents(const node_descriptor * parents,
+				   unsigned count)
+{
+  tree::build_from_parents(parents, count);
+  notifyBoundedRange();
+}
+
+tree::node_descriptor
+ObservableTree::add_subtree(node_descriptor par,
+			    const node_descriptor * parents,
+			    unsigned count)
+{
+  node_descriptor ret = tree::add_subtree(par, parents, count);
+  notifyBoundedRange();
+  return ret;
+}
+
+void
+ObservableTree::remove_subtree(node_descriptor n)
+{
+  tree::remove_subtree(n);
+  notifyBoundedRange();
+}
+
+void
+ObservableTree::move_subtree(node_descriptor n, node_descriptor par)
+{
+  tree::move_subtree(n, par);
+  notifyBoundedRange();
+}
+
 void
 ObservableTree::clear()
 {
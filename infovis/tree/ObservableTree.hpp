@@ -38,7 +38,16 @@ public:
   ObservableTree();
 
   virtual node_descriptor add_node(node_descriptor n);
+  using tree::build_from_parents;
+  virtual void build_from_parents(const node_descriptor * parents,
+				  unsigned count);
+  virtual node_descriptor add_subtree(node_descriptor par,
+				      const node_descriptor * parents,
+				      unsigned count);
+  virtual void remove_subtree(node_descriptor n);
+  virtual void move_subtree(node_descriptor n, node_descriptor par);
   virtual void clear();
+  using tree::shrink_to_fit;
 
   virtual const BoundedRange * getBoundedRange() const;
 
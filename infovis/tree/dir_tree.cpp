@@ -45,7 +45,7 @@ struct dir_tree_builder
   FloatColumn * mtime_;
   FloatColumn * atime_;
   FloatColumn * ctime_;
-    
+  std::vector<node_descriptor> parents_; // structure built at the end
 
   unsigned build(node_descriptor parent, const std::string& dirname) {
     // TODO: Replaced boost::filesystem with std::filesystem - C++17 modernization
@@ -73,7 +73,8 @@ struct dir_tree_builder
 	if (filename[0] == '.')
 	  continue;
 	ret++;
-	node_descriptor n = add_node(parent, tree_);
+	node_descriptor n = node_descriptor(parents_.size());
+	parents_.push_back(parent);
 	
 	std::error_code ec;
 	auto file_size = std::filesystem::file_size(entry.path(), ec);
@@ -98,6 +99,7 @@ struct dir_tree_builder
 	  name_->set(n, filename);
       }
     }
+    tree_.build_from_parents(parents_);
     return ret;
   }
   dir_tree_builder(Tree& t,
@@ -108,7 +110,10 @@ struct dir_tree_builder
 		   FloatColumn * c,
 		   FloatColumn * a)
     : tree_(t), name_(n), size_(s), type_(tp),
-      mtime_(m), ctime_(c), atime_(a) { }
+      mtime_(m), ctime_(c), atime_(a) {
+    for (node_descriptor i = 0; i < num_nodes(t); i++)
+      parents_.push_back(parent(i, t));
+  }
 };
 
 unsigned dir_tree(const std::string& dirname, Tree& t)
@@ -141,7 +146,7 @@ unsigned dir_tree(const std::string& dirname, Tree& t)
   mtime->set(root(t),s.st_mtime);
   ctime->set(root(t),s.st_ctime);
   atime->set(root(t),s.st_atime);
-  dir_tree_builder builder(t, name, size, type, mtime, atime, ctime);
+  dir_tree_builder builder(t, name, size, type, mtime, ctime, atime);
   unsigned n= builder.build(root(t), dname);
   sum_weights(t, *size);
   return n;
@@ -0,0 +1,395 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/dir_watcher.hpp>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#define INFOVIS_HAVE_INOTIFY
+#endif
+
+namespace infovis {
+
+#ifdef INFOVIS_HAVE_INOTIFY
+static const uint32_t watch_mask =
+  IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+  IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+
+dir_watcher::dir_watcher(tree& t, unsigned max_watches)
+  : tree_(t),
+    name_(StringColumn::find("name", t)),
+    size_(FloatColumn::find("size", t)),
+    type_(FloatColumn::find("type", t)),
+    mtime_(FloatColumn::find("mtime", t)),
+    ctime_(FloatColumn::find("ctime", t)),
+    atime_(FloatColumn::find("atime", t)),
+    root_path_(name_->fast_get(tree::root)),
+    fd_(-1),
+    max_watches_(max_watches),
+    coalesce_delay_(50),
+    poll_interval_(1000),
+    last_poll_(Clock::now()),
+    overflow_(false)
+{
+  if (root_path_.empty() || *root_path_.rbegin() != '/')
+    root_path_.append("/");
+#ifdef INFOVIS_HAVE_INOTIFY
+  if (max_watches_ != 0)
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+  // Watch the directories breadth first, building their paths.
+  std::vector<std::pair<node_descriptor, std::string> > dirs;
+  dirs.push_back(std::make_pair(node_descriptor(tree::root), root_path_));
+  for (unsigned i = 0; i < dirs.size(); i++) {
+    watch(dirs[i].first, dirs[i].second);
+    for (node_descriptor c = tree_.child(dirs[i].first);
+	 c != tree::nil(); c = tree_.next(c)) {
+      const std::string& name = name_->fast_get(c);
+      if (! name.empty() && *name.rbegin() == '/')
+	dirs.push_back(std::make_pair(c, dirs[i].second + name));
+    }
+  }
+}
+
+dir_watcher::~dir_watcher()
+{
+  if (fd_ >= 0)
+    close(fd_);
+}
+
+bool
+dir_watcher::stat_entry(int dirfd, const char * name, entry& e)
+{
+  struct stat s;
+  if (fstatat(dirfd, name, &s, 0) != 0)
+    return false;
+  e.dir = S_ISDIR(s.st_mode);
+  e.size = e.dir ? 0 : float(s.st_size); // as dir_tree
+  e.mtime = s.st_mtime;
+  e.ctime = s.st_ctime;
+  e.atime = s.st_atime;
+  return true;
+}
+
+bool
+dir_watcher::read_dir(const std::string& path, std::vector<entry>& entries)
+{
+  DIR * d = opendir(path.c_str());
+  if (d == 0)
+    return false;
+  entry e;
+  while (struct dirent * de = readdir(d)) {
+    if (de->d_name[0] == '.')
+      continue;
+    if (! stat_entry(dirfd(d), de->d_name, e))
+      continue;			// vanished meanwhile
+    e.name = de->d_name;
+    if (e.dir)
+      e.name += '/';
+    entries.push_back(e);
+  }
+  closedir(d);
+  return true;
+}
+
+bool
+dir_watcher::attached(node_descriptor n) const
+{
+  for (; n != tree::root; n = tree_.parent(n))
+    if (tree_.removed(n))
+      return false;
+  return true;
+}
+
+std::string
+dir_watcher::path(node_descriptor dir) const
+{
+  std::vector<node_descriptor> chain;
+  for (; dir != tree::root; dir = tree_.parent(dir))
+    chain.push_back(dir);
+  std::string ret(root_path_);
+  for (unsigned i = unsigned(chain.size()); i-- != 0; )
+    ret += name_->fast_get(chain[i]);
+  return ret;
+}
+
+void
+dir_watcher::watch(node_descriptor dir, const std::string& path)
+{
+#ifdef INFOVIS_HAVE_INOTIFY
+  if (fd_ >= 0 && watches_.size() < max_watches_) {
+    int wd = inotify_add_watch(fd_, path.c_str(), watch_mask);
+    if (wd >= 0) {
+      watches_[wd] = dir;
+      node_watch_[dir] = wd;
+      return;
+    }
+    if (errno == ENOENT || errno == ENOTDIR)
+      return;			// removed meanwhile, its parent will know
+  }
+#endif
+  polled_.insert(dir);
+}
+
+void
+dir_watcher::unwatch(node_descriptor n)
+{
+  std::vector<node_descriptor> stack(1, n);
+  while (! stack.empty()) {
+    node_descriptor m = stack.back();
+    stack.pop_back();
+    auto w = node_watch_.find(m);
+    if (w != node_watch_.end()) {
+      // A directory moved elsewhere in the tree keeps its watch.
+      auto i = watches_.find(w->second);
+      if (i != watches_.end() && i->second == m) {
+#ifdef INFOVIS_HAVE_INOTIFY
+	inotify_rm_watch(fd_, w->second);
+#endif
+	watches_.erase(i);
+      }
+      node_watch_.erase(w);
+    }
+    polled_.erase(m);
+    children_.erase(m);
+    for (node_descriptor c = tree_.child(m); c != tree::nil(); c = tree_.next(c))
+      stack.push_back(c);
+  }
+}
+
+bool
+dir_watcher::read_events(int timeout)
+{
+  if (fd_ < 0) {
+    if (timeout > 0)
+      ::poll(0, 0, timeout);
+    return false;
+  }
+#ifdef INFOVIS_HAVE_INOTIFY
+  struct pollfd pfd = { fd_, POLLIN, 0 };
+  if (::poll(&pfd, 1, timeout) <= 0)
+    return false;
+  alignas(struct inotify_event) char buf[64 * 1024];
+  bool got = false;
+  for (;;) {
+    ssize_t len = read(fd_, buf, sizeof(buf));
+    if (len <= 0)
+      break;
+    got = true;
+    for (char * p = buf; p < buf + len; ) {
+      const struct inotify_event * ev =
+	reinterpret_cast<const struct inotify_event *>(p);
+      p += sizeof(struct inotify_event) + ev->len;
+      if (ev->mask & IN_Q_OVERFLOW) {
+	overflow_ = true;
+	continue;
+      }
+      auto w = watches_.find(ev->wd);
+      if (w == watches_.end())
+	continue;
+      if (ev->mask & IN_IGNORED) { // the directory is gone
+	node_watch_.erase(w->second);
+	watches_.erase(w);
+	continue;
+      }
+      if (ev->len != 0 && ev->name[0] != '.')
+	pending_.insert(std::make_pair(w->second, std::string(ev->name)));
+    }
+  }
+  return got;
+#else
+  return false;
+#endif
+}
+
+dir_watcher::ChildMap&
+dir_watcher::children(node_descriptor dir)
+{
+  auto i = children_.find(dir);
+  if (i != children_.end())
+    return i->second;
+  ChildMap& kids = children_[dir];
+  for (node_descriptor c = tree_.child(dir); c != tree::nil(); c = tree_.next(c))
+    kids[name_->fast_get(c)] = c;
+  return kids;
+}
+
+void
+dir_watcher::set_entry(node_descriptor n, const entry& e)
+{
+  mtime_->set(n, e.mtime);
+  ctime_->set(n, e.ctime);
+  atime_->set(n, e.atime);
+  if (tree_.is_leaf(n))
+    tree_.set_leaf_value(n, *size_, e.size);
+}
+
+unsigned
+dir_watcher::add(node_descriptor dir, const entry& e)
+{
+  // New directories are scanned breadth first, each one being watched
+  // before it is read so that no entry created meanwhile is missed.
+  const node_descriptor base = tree_.num_nodes();
+  std::vector<node_descriptor> parents(1, 0);
+  std::vector<entry> entries(1, e);
+  if (e.dir) {
+    std::vector<std::pair<unsigned, std::string> > queue;
+    queue.push_back(std::make_pair(0u, path(dir) + e.name));
+    for (unsigned q = 0; q < queue.size(); q++) {
+      const unsigned i = queue[q].first;
+      watch(base + i, queue[q].second);
+      const unsigned first = unsigned(entries.size());
+      read_dir(queue[q].second, entries);
+      for (unsigned c = first; c < entries.size(); c++) {
+	parents.push_back(i);
+	if (entries[c].dir)
+	  queue.push_back(std::make_pair(c, queue[q].second + entries[c].name));
+      }
+    }
+  }
+  tree_.add_subtree(dir, parents.data(), unsigned(entries.size()));
+  for (unsigned i = 0; i < entries.size(); i++) {
+    const node_descriptor n = base + i;
+    name_->set(n, entries[i].name);
+    type_->set(n, classifier_ ? classifier_(entries[i].name, entries[i].dir)
+	       : entries[i].dir ? 1 : 0);
+    set_entry(n, entries[i]);
+  }
+  children(dir)[e.name] = base;
+  return unsigned(entries.size());
+}
+
+unsigned
+dir_watcher::remove(node_descriptor dir, node_descriptor n)
+{
+  children(dir).erase(name_->fast_get(n));
+  unwatch(n);
+  tree_.remove_subtree(n);
+  return 1;
+}
+
+unsigned
+dir_watcher::apply(node_descriptor dir, const std::string& name)
+{
+  if (! attached(dir))
+    return 0;
+  entry e;
+  e.dir = false;
+  const bool exists = stat_entry(AT_FDCWD, (path(dir) + name).c_str(), e);
+  e.name = e.dir ? name + "/" : name;
+  ChildMap& kids = children(dir);
+  unsigned changes = 0;
+  // An entry replaced by one of the other type is removed first.
+  const std::string keys[2] = { name, name + "/" };
+  for (const std::string& key : keys) {
+    auto i = kids.find(key);
+    if (i != kids.end() && (! exists || key != e.name))
+      changes += remove(dir, i->second);
+  }
+  if (! exists)
+    return changes;
+  auto i = kids.find(e.name);
+  if (i == kids.end())
+    return changes + add(dir, e);
+  set_entry(i->second, e);
+  return changes + 1;
+}
+
+unsigned
+dir_watcher::rescan(node_descriptor dir)
+{
+  if (! attached(dir))
+    return 0;
+  std::vector<entry> entries;
+  if (! read_dir(path(dir), entries))
+    return 0;			// removed, its parent will know
+  ChildMap& kids = children(dir);
+  std::set<std::string> seen;
+  unsigned changes = 0;
+  for (const entry& e : entries) {
+    seen.insert(e.name);
+    auto i = kids.find(e.name);
+    if (i == kids.end())
+      changes += add(dir, e);
+    else if (mtime_->fast_get(i->second) != e.mtime ||
+	     (tree_.is_leaf(i->second) && size_->fast_get(i->second) != e.size)) {
+      set_entry(i->second, e);
+      changes++;
+    }
+  }
+  std::vector<node_descriptor> gone;
+  for (const auto& k : kids)
+    if (seen.find(k.first) == seen.end())
+      gone.push_back(k.second);
+  for (node_descriptor n : gone)
+    changes += remove(dir, n);
+  return changes;
+}
+
+unsigned
+dir_watcher::update(int timeout)
+{
+  if (read_events(timeout)) {
+    // Coalesce the events following the first one, for a bounded time.
+    Clock::time_point end =
+      Clock::now() + std::chrono::milliseconds(10 * coalesce_delay_);
+    while (Clock::now() < end && read_events(coalesce_delay_))
+      ;
+  }
+  unsigned changes = 0;
+  if (overflow_) {
+    // Events were lost, check every watched directory.
+    overflow_ = false;
+    pending_.clear();
+    std::vector<node_descriptor> dirs;
+    for (const auto& w : watches_)
+      dirs.push_back(w.second);
+    for (node_descriptor d : dirs)
+      changes += rescan(d);
+  }
+  else {
+    std::set<std::pair<node_descriptor, std::string> > pending;
+    pending.swap(pending_);
+    for (const auto& p : pending)
+      changes += apply(p.first, p.second);
+  }
+  Clock::time_point now = Clock::now();
+  if (! polled_.empty() &&
+      now - last_poll_ >= std::chrono::milliseconds(poll_interval_)) {
+    last_poll_ = now;
+    std::vector<node_descriptor> dirs(polled_.begin(), polled_.end());
+    for (node_descriptor d : dirs)
+      if (polled_.count(d) != 0)
+	changes += rescan(d);
+  }
+  return changes;
+}
+
+} // namespace infovis
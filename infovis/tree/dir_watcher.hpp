@@ -0,0 +1,156 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TREE_DIR_WATCHER_HPP
+#define INFOVIS_TREE_DIR_WATCHER_HPP
+
+#include <infovis/tree/tree.hpp>
+#include <chrono>
+#include <functional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Keeps a tree loaded by dir_tree in sync with the file system.
+ *
+ * Every directory of the tree is watched with inotify.  Directories
+ * that cannot be watched, because the watch limit is reached or
+ * inotify is not available, are rescanned periodically with fstatat
+ * instead.  Events are coalesced over a short window and only the
+ * entries they name are examined again: new entries are added with
+ * tree::add_subtree, vanished ones removed with tree::remove_subtree,
+ * and size changes applied with tree::set_leaf_value, so the sums are
+ * kept up to date in O(depth) and the changed nodes end up in the
+ * dirty set of the tree.  The columns are read whether their values
+ * are defined or not, so the values of the interior nodes can be
+ * hidden as treemap2 does.
+ */
+class dir_watcher
+{
+public:
+  typedef tree::node_descriptor node_descriptor;
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<float(const std::string&, bool)> Classifier;
+
+  /**
+   * Start watching the directories of a tree built by dir_tree.
+   * @param t the tree
+   * @param max_watches the maximum number of inotify watches, the
+   * other directories being polled
+   */
+  dir_watcher(tree& t, unsigned max_watches = unsigned(-1));
+  ~dir_watcher();
+
+  /**
+   * Return the inotify file descriptor, to wait for changes in an
+   * event loop, or -1 if all the directories are polled.
+   */
+  int fd() const { return fd_; }
+
+  /**
+   * Set the time to wait for further events once an event arrives,
+   * in milliseconds, 50 by default.  Waiting stops at the first quiet
+   * period of that length, or at the latest 10 times that delay after
+   * the first event, so that continuous churn is still reported.
+   */
+  void set_coalesce_delay(unsigned ms) { coalesce_delay_ = ms; }
+
+  /**
+   * Set the interval between two rescans of the polled directories,
+   * in milliseconds, 1000 by default.
+   */
+  void set_poll_interval(unsigned ms) { poll_interval_ = ms; }
+
+  /**
+   * Set the function giving the "type" value of a new entry from its
+   * name, with a trailing '/' for directories, and whether it is a
+   * directory.  By default directories get 1 and files 0, as in
+   * dir_tree.
+   */
+  void set_classifier(const Classifier& c) { classifier_ = c; }
+
+  unsigned watched() const { return unsigned(watches_.size()); }
+  unsigned polled() const { return unsigned(polled_.size()); }
+
+  /**
+   * Wait for changes and apply them to the tree.
+   * @param timeout the time to wait for a first event in
+   * milliseconds, 0 to only apply the pending ones
+   * @return the number of entries added, removed or updated
+   */
+  unsigned update(int timeout = 0);
+
+protected:
+  struct entry {
+    std::string name;		// with a trailing '/' for directories
+    bool dir;
+    float size;
+    float mtime, ctime, atime;
+  };
+  typedef std::unordered_map<std::string, node_descriptor> ChildMap;
+
+  static bool stat_entry(int dirfd, const char * name, entry& e);
+  static bool read_dir(const std::string& path, std::vector<entry>& entries);
+  bool attached(node_descriptor n) const;
+  std::string path(node_descriptor dir) const;
+  void watch(node_descriptor dir, const std::string& path);
+  void unwatch(node_descriptor n);
+  bool read_events(int timeout);
+  ChildMap& children(node_descriptor dir);
+  unsigned apply(node_descriptor dir, const std::string& name);
+  unsigned rescan(node_descriptor dir);
+  unsigned add(node_descriptor dir, const entry& e);
+  unsigned remove(node_descriptor dir, node_descriptor n);
+  void set_entry(node_descriptor n, const entry& e);
+
+  tree& tree_;
+  StringColumn * name_;
+  FloatColumn * size_;
+  FloatColumn * type_;
+  FloatColumn * mtime_;
+  FloatColumn * ctime_;
+  FloatColumn * atime_;
+  std::string root_path_;
+  int fd_;
+  unsigned max_watches_;
+  unsigned coalesce_delay_;
+  unsigned poll_interval_;
+  Classifier classifier_;
+  Clock::time_point last_poll_;
+  bool overflow_;
+  std::unordered_map<int, node_descriptor> watches_;
+  std::unordered_map<node_descriptor, int> node_watch_;
+  std::set<node_descriptor> polled_;
+  std::unordered_map<node_descriptor, ChildMap> children_;
+  std::set<std::pair<node_descriptor, std::string> > pending_;
+};
+
+} // namespace infovis
+
+#endif // INFOVIS_TREE_DIR_WATCHER_HPP
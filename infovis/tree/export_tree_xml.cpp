@@ -24,8 +24,18 @@
  */
 #include <infovis/tree/tree.hpp>
 #include <infovis/tree/visitor.hpp>
-#include <fstream>
+#include <infovis/tree/export_tree_xml.hpp>
+#include <infovis/parallel_for.hpp>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 namespace infovis {
 
@@ -132,7 +142,7 @@ struct xml_tree_exporter
     
     for (Tree::names_iterator name = tree_.begin_names();
 	 name != tree_.end_names(); name++) {
-      if ((*name)[0] == '$')
+      if ((*name)[0] == '$' || (*name)[0] == table::internal_prefix)
 	continue;
       column * c = tree_.find_column(*name);
       if (c != tag_ && c->defined(n)) {
@@ -166,17 +176,360 @@ struct xml_tree_exporter
 
 
 bool
-export_tree_xml(const std::string& filename, const Tree& t)
+export_tree_xml(std::ostream& out, const Tree& t)
 {
-  std::ofstream out(filename.c_str());
-
   if (out) {
     xml_tree_exporter exporter(out, t);
     traverse_tree(root(t), t, exporter);
-    return true;
   }
-  else
+  return bool(out);
+}
+
+/*
+ * Fast path: the bytes produced by print_xmlchar_quoted for each
+ * char of a string, computed once into a table.
+ */
+struct xml_escape_table
+{
+  struct entry {
+    unsigned char len;
+    char bytes[7];
+  };
+  entry table[256];
+
+  xml_escape_table() {
+    for (unsigned i = 0; i < 256; i++) {
+      std::ostringstream out;
+      // Strings are iterated as char, so the high half is negative.
+      print_xmlchar_quoted(out, unsigned(int(char(i))));
+      string s(out.str());
+      table[i].len = s.size();
+      std::memcpy(table[i].bytes, s.data(), s.size());
+    }
+  }
+  static const xml_escape_table& instance() {
+    static const xml_escape_table escape;
+    return escape;
+  }
+};
+
+/*
+ * Output buffer written in big blocks, either raw or compressed.  A
+ * buffer without file only accumulates data.
+ */
+class xml_buffer
+{
+public:
+  enum { block_size = 4 * 1024 * 1024 };
+
+  xml_buffer() : file_(0), gz_(0), ok_(true) { }
+  ~xml_buffer() { close(); }
+
+  bool open(const std::string& filename) {
+    size_t len = filename.size();
+    if (len > 3 && filename.compare(len - 3, 3, ".gz") == 0)
+      gz_ = gzopen(filename.c_str(), "wb");
+    else
+      file_ = std::fopen(filename.c_str(), "wb");
+    data_.reserve(block_size + 64 * 1024);
+    return file_ != 0 || gz_ != 0;
+  }
+  bool close() {
+    flush();
+    if (file_ != 0 && std::fclose(file_) != 0)
+      ok_ = false;
+    if (gz_ != 0 && gzclose(gz_) != Z_OK)
+      ok_ = false;
+    file_ = 0;
+    gz_ = 0;
+    return ok_;
+  }
+
+  void put(char c) { data_.push_back(c); }
+  void put(const char * s, size_t len) { data_.append(s, len); }
+  void put(const string& s) { data_.append(s); }
+  void indent(unsigned n) { data_.append(n, ' '); }
+  void put_escaped(const string& str);
+
+  void append(const string& s) {
+    data_ += s;
+    if (data_.size() >= block_size)
+      flush();
+  }
+  void swap(string& s) { data_.swap(s); }
+  void block() {
+    if (data_.size() >= block_size)
+      flush();
+  }
+  void flush() {
+    if (data_.empty())
+      return;
+    if (file_ != 0) {
+      if (std::fwrite(data_.data(), 1, data_.size(), file_) != data_.size())
+	ok_ = false;
+    }
+    else if (gz_ != 0) {
+      if (gzwrite(gz_, data_.data(), unsigned(data_.size())) !=
+	  int(data_.size()))
+	ok_ = false;
+    }
+    else
+      return;
+    data_.clear();
+  }
+protected:
+  string data_;
+  FILE * file_;
+  gzFile gz_;
+  bool ok_;
+};
+
+void
+xml_buffer::put_escaped(const string& str)
+{
+  const xml_escape_table::entry * table = xml_escape_table::instance().table;
+  char sep = '"';
+  if (str.find(sep) != string::npos)
+    sep = '\'';
+  data_.push_back(sep);
+  for (unsigned char c : str) {
+    const xml_escape_table::entry& e = table[c];
+    if (e.len == 1)
+      data_.push_back(e.bytes[0]);
+    else
+      data_.append(e.bytes, e.len);
+  }
+  data_.push_back(sep);
+}
+
+/*
+ * A column resolved once, with its value type.
+ */
+struct xml_attribute
+{
+  enum kind { kind_float, kind_double, kind_int, kind_unsigned, kind_long,
+	      kind_string, kind_other };
+  string prefix;		// " name="
+  const column * col;
+  kind type;
+
+  xml_attribute(const string& name, const column * c)
+    : prefix(" " + name + "="), col(c), type(kind_other) {
+    if (FloatColumn::cast(c) != 0)
+      type = kind_float;
+    else if (DoubleColumn::cast(c) != 0)
+      type = kind_double;
+    else if (IntColumn::cast(c) != 0)
+      type = kind_int;
+    else if (UnsignedColumn::cast(c) != 0)
+      type = kind_unsigned;
+    else if (LongColumn::cast(c) != 0)
+      type = kind_long;
+    else if (StringColumn::cast(c) != 0)
+      type = kind_string;
+  }
+
+  template <class Column>
+  const typename Column::value_type& value(unsigned n) const {
+    return static_cast<const Column*>(col)->fast_get(n);
+  }
+
+  void print(xml_buffer& out, unsigned n) const {
+    char buf[64];
+    std::to_chars_result r;
+    switch(type) {
+    case kind_float:
+      // Same as the default ostream format, i.e. %g.
+      r = std::to_chars(buf, buf + sizeof(buf), value<FloatColumn>(n),
+			std::chars_format::general, 6);
+      break;
+    case kind_double:
+      r = std::to_chars(buf, buf + sizeof(buf), value<DoubleColumn>(n),
+			std::chars_format::general, 6);
+      break;
+    case kind_int:
+      r = std::to_chars(buf, buf + sizeof(buf), value<IntColumn>(n));
+      break;
+    case kind_unsigned:
+      r = std::to_chars(buf, buf + sizeof(buf), value<UnsignedColumn>(n));
+      break;
+    case kind_long:
+      r = std::to_chars(buf, buf + sizeof(buf), value<LongColumn>(n));
+      break;
+    case kind_string:
+      out.put_escaped(value<StringColumn>(n));
+      return;
+    default:
+      out.put_escaped(col->get_value(n));
+      return;
+    }
+    out.put('"');
+    out.put(buf, r.ptr - buf);
+    out.put('"');
+  }
+};
+
+class xml_tree_formatter
+{
+public:
+  xml_tree_formatter(const Tree& t)
+    : tree_(t), tag_(t.find_column("tag")) {
+    for (Tree::names_iterator name = tree_.begin_names();
+	 name != tree_.end_names(); name++) {
+      if ((*name)[0] == '$' || (*name)[0] == table::internal_prefix)
+	continue;
+      column * c = tree_.find_column(*name);
+      if (c != tag_)
+	attributes_.push_back(xml_attribute(*name, c));
+    }
+  }
+
+  void open(xml_buffer& out, node_descriptor n, unsigned indent) const {
+    out.indent(indent);
+    out.put('<');
+    print_tag(out, n);
+    for (const xml_attribute& a : attributes_) {
+      if (a.col->defined(n)) {
+	out.put(a.prefix);
+	a.print(out, n);
+      }
+    }
+    if (tree_.is_leaf(n))
+      out.put("/>\n", 3);
+    else
+      out.put(">\n", 2);
+  }
+
+  void close(xml_buffer& out, node_descriptor n, unsigned indent) const {
+    if (tree_.is_leaf(n))
+      return;
+    out.indent(indent);
+    out.put("</", 2);
+    print_tag(out, n);
+    out.put(">\n", 2);
+  }
+
+  /*
+   * Format a subtree without recursion, flushing big blocks.
+   */
+  void subtree(xml_buffer& out, node_descriptor top, unsigned indent) const {
+    node_descriptor n = top;
+    open(out, n, indent);
+    for (;;) {
+      node_descriptor c = tree_.child(n);
+      if (c != Tree::nil()) {
+	n = c;
+	open(out, n, ++indent);
+	continue;
+      }
+      out.block();
+      while (n != top && tree_.next(n) == Tree::nil()) {
+	n = tree_.parent(n);
+	close(out, n, --indent);
+      }
+      if (n == top)
+	break;
+      n = tree_.next(n);
+      open(out, n, indent);
+    }
+  }
+
+protected:
+  void print_tag(xml_buffer& out, node_descriptor n) const {
+    if (tag_ == 0)
+      out.put("node", 4);
+    else if (const StringColumn * s = StringColumn::cast(tag_))
+      out.put(s->get(n));
+    else
+      out.put(tag_->get_value(n));
+  }
+
+  const Tree& tree_;
+  const column * tag_;
+  std::vector<xml_attribute> attributes_;
+};
+
+/*
+ * A piece of the output: an opening tag, a whole subtree or a closing
+ * tag.
+ */
+struct xml_piece
+{
+  enum kind { open, subtree, close };
+  node_descriptor node;
+  unsigned indent;
+  kind what;
+};
+
+static void
+export_parallel(xml_buffer& out, const xml_tree_formatter& formatter,
+		const Tree& t, unsigned threads)
+{
+  // Split the tree into enough subtrees to keep the threads busy.
+  std::vector<xml_piece> pieces(1, xml_piece{root(t), 0, xml_piece::subtree});
+  for (int level = 0; level < 8 && pieces.size() < 16 * threads; level++) {
+    std::vector<xml_piece> split;
+    for (const xml_piece& p : pieces) {
+      if (p.what != xml_piece::subtree || t.is_leaf(p.node)) {
+	split.push_back(p);
+	continue;
+      }
+      split.push_back(xml_piece{p.node, p.indent, xml_piece::open});
+      for (node_descriptor c = t.child(p.node); c != Tree::nil(); c = t.next(c))
+	split.push_back(xml_piece{c, p.indent + 1, xml_piece::subtree});
+      split.push_back(xml_piece{p.node, p.indent, xml_piece::close});
+    }
+    pieces.swap(split);
+  }
+
+  // Format windows of pieces in parallel and write them in order.
+  const size_t window = 4 * threads;
+  std::vector<string> formatted(window);
+  for (size_t first = 0; first < pieces.size(); first += window) {
+    const size_t count = std::min(window, pieces.size() - first);
+    std::atomic<size_t> next(0);
+    parallel_run(threads, [&](unsigned) {
+      xml_buffer buffer;
+      for (size_t i; (i = next++) < count; ) {
+	const xml_piece& p = pieces[first + i];
+	buffer.swap(formatted[i]);
+	switch(p.what) {
+	case xml_piece::open:
+	  formatter.open(buffer, p.node, p.indent);
+	  break;
+	case xml_piece::subtree:
+	  formatter.subtree(buffer, p.node, p.indent);
+	  break;
+	case xml_piece::close:
+	  formatter.close(buffer, p.node, p.indent);
+	  break;
+	}
+	buffer.swap(formatted[i]);
+      }
+    });
+    for (size_t i = 0; i < count; i++) {
+      out.append(formatted[i]);
+      formatted[i].clear();
+    }
+  }
+}
+
+bool
+export_tree_xml(const std::string& filename, const Tree& t, unsigned threads)
+{
+  xml_buffer out;
+  if (! out.open(filename))
     return false;
+  if (num_nodes(t) != 0) {
+    xml_tree_formatter formatter(t);
+    if (threads == 0)
+      threads = parallel_threads(num_nodes(t));
+    if (threads > 1)
+      export_parallel(out, formatter, t, threads);
+    else
+      formatter.subtree(out, root(t), 0);
+  }
+  return out.close();
 }
 
 
@@ -27,10 +27,32 @@
 
 #include <infovis/alloc.hpp>
 #include <infovis/tree/tree.hpp>
+#include <iosfwd>
 
 namespace infovis {
 
-bool export_tree_xml(const std::string& filename, const tree& t);
+/**
+ * Export a tree into an XML file.
+ *
+ * The columns are resolved once and the nodes are formatted into a
+ * large buffer written in big blocks.  When the file name ends with
+ * ".gz", the file is compressed with zlib.
+ * @param filename the name of the file
+ * @param t the tree
+ * @param threads the number of threads formatting subtrees in
+ * parallel, 0 for the number of hardware threads
+ * @return true if the file has been written
+ */
+bool export_tree_xml(const std::string& filename, const tree& t,
+		     unsigned threads = 1);
+
+/**
+ * Export a tree as XML into a stream, one value at a time.
+ * @param out the stream
+ * @param t the tree
+ * @return true if the stream is still good
+ */
+bool export_tree_xml(std::ostream& out, const tree& t);
 
 } // namespace infovis 
 
@@ -0,0 +1,301 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/gen_tree.hpp>
+#include <infovis/table/metadata.hpp>
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace infovis {
+
+typedef tree::node_descriptor node_descriptor;
+
+/**
+ * The splitmix64 finalizer, used both as the sequential generator and
+ * as the hash of a node index, so the output does not depend on the
+ * standard library.
+ */
+static inline std::uint64_t
+mix(std::uint64_t h)
+{
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
+/**
+ * Uniform value in [0,1) from the high bits of a hash.
+ */
+static inline double
+unit(std::uint64_t h)
+{
+  return double(h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+struct gen_random
+{
+  std::uint64_t state_;
+
+  gen_random(std::uint64_t seed) : state_(seed) { }
+  std::uint64_t next() {
+    state_ += 0x9e3779b97f4a7c15ULL;
+    return mix(state_);
+  }
+  double uniform() { return unit(next()); }
+};
+
+static const char * const words[] = {
+  "src", "lib", "doc", "test", "data", "image", "report", "util",
+  "main", "index", "config", "build", "photo", "music", "notes", "draft",
+  "backup", "module", "core", "page", "style", "log", "temp", "archive",
+  "project", "figure", "chapter", "table", "model", "view", "parser", "cache"
+};
+static const unsigned num_words = sizeof(words) / sizeof(words[0]);
+
+/**
+ * File extensions with their relative frequencies, roughly those of a
+ * developer's home directory.
+ */
+static const struct extension {
+  const char * name;
+  unsigned weight;
+} extensions[] = {
+  { "h", 8 }, { "c", 8 }, { "cpp", 5 }, { "o", 6 }, { "py", 6 },
+  { "js", 7 }, { "html", 8 }, { "css", 3 }, { "png", 8 }, { "jpg", 8 },
+  { "gif", 4 }, { "txt", 6 }, { "pdf", 3 }, { "xml", 4 }, { "json", 4 },
+  { "gz", 3 }, { "so", 2 }, { "java", 4 }, { "mp3", 2 }, { "md", 3 },
+  { 0, 4 }			// README, Makefile and friends
+};
+static const unsigned num_extensions = sizeof(extensions) / sizeof(extensions[0]);
+
+static unsigned
+total_extension_weight()
+{
+  unsigned w = 0;
+  for (unsigned i = 0; i < num_extensions; i++)
+    w += extensions[i].weight;
+  return w;
+}
+
+static unsigned
+draw_fanout(gen_random& rnd, const gen_tree_params& p)
+{
+  double k;
+  if (p.fanout == gen_fanout_uniform)
+    k = 1 + rnd.uniform() * p.max_fanout;
+  else
+    k = std::pow(1 - rnd.uniform(), -1.0 / (p.fanout_exponent - 1));
+  return unsigned(std::min(k, double(p.max_fanout)));
+}
+
+/**
+ * Draw the structure breadth first, entries being directories with
+ * the probability p.directories.  When no directory is left to fill,
+ * the last entry is turned into one so the tree always reaches the
+ * requested size.
+ */
+static void
+gen_structure(const gen_tree_params& p,
+	      std::vector<node_descriptor>& parents,
+	      std::vector<char>& is_dir)
+{
+  const unsigned n = p.nodes;
+  parents.assign(n, tree::root);
+  is_dir.assign(n, 0);
+  is_dir[tree::root] = 1;
+  switch (p.fanout) {
+  case gen_fanout_chain:
+    for (unsigned i = 1; i < n; i++) {
+      parents[i] = i - 1;
+      is_dir[i - 1] = 1;
+    }
+    return;
+  case gen_fanout_flat:
+    return;
+  default:
+    break;
+  }
+  gen_random rnd(p.seed);
+  std::vector<node_descriptor> dirs;
+  dirs.push_back(tree::root);
+  unsigned cur = 0;
+  for (unsigned next = 1; next < n; ) {
+    if (cur == dirs.size()) {
+      is_dir[next - 1] = 1;
+      dirs.push_back(next - 1);
+    }
+    node_descriptor d = dirs[cur++];
+    unsigned k = std::min(std::max(draw_fanout(rnd, p), 1u), n - next);
+    for (unsigned j = 0; j < k; j++, next++) {
+      parents[next] = d;
+      if (rnd.uniform() < p.directories) {
+	is_dir[next] = 1;
+	dirs.push_back(next);
+      }
+    }
+  }
+}
+
+static float
+draw_weight(double u, const gen_tree_params& p)
+{
+  switch (p.weight) {
+  case gen_weight_constant:
+    return 1;
+  case gen_weight_uniform:
+    return float(std::floor(1 + u * (p.max_weight - 1)));
+  default:
+    return float(std::floor(std::min(std::pow(1 - u, -1.0 / p.weight_exponent),
+				     double(p.max_weight))));
+  }
+}
+
+/**
+ * Append a name to a buffer: a word, sometimes a number, then either
+ * a '/' for directories or an extension for files.
+ */
+static unsigned
+format_name(char * buf, std::uint64_t h, bool dir, unsigned ext_total)
+{
+  const char * w = words[h % num_words];
+  unsigned len = unsigned(std::strlen(w));
+  std::memcpy(buf, w, len);
+  h >>= 8;
+  if (h & 1) {
+    char digits[8];
+    unsigned d = 0;
+    for (unsigned v = unsigned(h >> 1) % 1000; d == 0 || v != 0; v /= 10)
+      digits[d++] = char('0' + v % 10);
+    while (d != 0)
+      buf[len++] = digits[--d];
+  }
+  h >>= 12;
+  if (dir) {
+    buf[len++] = '/';
+    return len;
+  }
+  unsigned e = unsigned(h % ext_total), i = 0;
+  while (e >= extensions[i].weight)
+    e -= extensions[i++].weight;
+  if (extensions[i].name != 0) {
+    buf[len++] = '.';
+    unsigned l = unsigned(std::strlen(extensions[i].name));
+    std::memcpy(buf + len, extensions[i].name, l);
+    len += l;
+  }
+  return len;
+}
+
+unsigned
+gen_tree(tree& t, const gen_tree_params& p)
+{
+  const unsigned n = std::max(p.nodes, 1u);
+  gen_tree_params params(p);
+  params.nodes = n;
+  std::vector<node_descriptor> parents;
+  std::vector<char> is_dir;
+  gen_structure(params, parents, is_dir);
+
+  StringColumn * name = 0;
+  if (p.names) {
+    name = StringColumn::find("name", t);
+    name->put_metadata(metadata::type, metadata::type_nominal);
+  }
+  FloatColumn * size = FloatColumn::find("size", t);
+  size->put_metadata(metadata::type, metadata::type_ordinal);
+  size->put_metadata("aggregate", "sum");
+  FloatColumn * type = FloatColumn::find("type", t);
+  type->put_metadata(metadata::type, metadata::type_categorical);
+  FloatColumn * mtime = FloatColumn::find("mtime", t);
+  mtime->put_metadata(metadata::type, metadata::type_ordinal);
+  mtime->put_metadata(metadata::user_type, metadata::user_type_unix_time);
+
+  t.build_from_parents(parents);
+  std::vector<node_descriptor>().swap(parents);
+
+  // Each node only depends on the seed and its index, so the columns
+  // are filled in parallel.
+  const std::uint64_t seed = mix(p.seed ^ 0x5851f42d4c957f2dULL);
+  const unsigned ext_total = total_extension_weight();
+  parallel_for(n, parallel_threads(n, p.threads),
+	       [&](unsigned, unsigned begin, unsigned end) {
+    char buf[64];
+    for (unsigned i = begin; i < end; i++) {
+      std::uint64_t h = mix(seed + i);
+      bool dir = is_dir[i] != 0;
+      size->fast_set(i, dir ? 1 : draw_weight(unit(h), params));
+      type->fast_set(i, dir ? 1 : 0);
+      h = mix(h);
+      // Within the ten years before September 2020.
+      mtime->fast_set(i, float(1600000000.0 - unit(h) * 315360000.0));
+      if (name != 0)
+	name->fast_set(i, string(buf, format_name(buf, mix(h), dir,
+						   ext_total)));
+    }
+  });
+  if (name != 0) {
+    name->fast_set(tree::root, "/");
+    name->define_all();
+  }
+  size->define_all();
+  type->define_all();
+  mtime->define_all();
+
+  // Parents come before their children, so one backward pass sums
+  // the sizes, each directory counting 1 for itself.
+  for (unsigned i = n - 1; i > 0; i--) {
+    node_descriptor d = t.parent(i);
+    size->fast_set(d, size->fast_get(d) + size->fast_get(i));
+  }
+  return n;
+}
+
+bool
+gen_fanout_by_name(const char * name, gen_fanout& fanout)
+{
+  static const char * const names[] = { "power", "uniform", "chain", "flat" };
+  for (unsigned i = 0; i < 4; i++)
+    if (std::strcmp(name, names[i]) == 0) {
+      fanout = gen_fanout(i);
+      return true;
+    }
+  return false;
+}
+
+bool
+gen_weight_by_name(const char * name, gen_weight& weight)
+{
+  static const char * const names[] = { "power", "uniform", "constant" };
+  for (unsigned i = 0; i < 3; i++)
+    if (std::strcmp(name, names[i]) == 0) {
+      weight = gen_weight(i);
+      return true;
+    }
+  return false;
+}
+
+} // namespace infovis
@@ -0,0 +1,115 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TREE_GEN_TREE_HPP
+#define INFOVIS_TREE_GEN_TREE_HPP
+
+#include <infovis/tree/tree.hpp>
+
+namespace infovis {
+
+/**
+ * Shape of a generated tree, i.e. how many entries each directory
+ * holds.
+ */
+enum gen_fanout {
+  gen_fanout_power_law,		///< heavy tailed, most directories small
+  gen_fanout_uniform,		///< uniform between 1 and max_fanout
+  gen_fanout_chain,		///< each node is the only child of the previous one
+  gen_fanout_flat		///< every node is a file under the root
+};
+
+/**
+ * Distribution of the file sizes of a generated tree.
+ */
+enum gen_weight {
+  gen_weight_power_law,		///< heavy tailed, from 1 to max_weight
+  gen_weight_uniform,		///< uniform between 1 and max_weight
+  gen_weight_constant		///< every file weighs 1
+};
+
+/**
+ * Parameters of gen_tree.  The default values produce a tree looking
+ * like a file system.
+ */
+struct gen_tree_params
+{
+  unsigned nodes;		///< number of nodes, including the root
+  unsigned long seed;		///< the same seed produces the same tree
+  gen_fanout fanout;		///< shape of the directories
+  unsigned max_fanout;		///< largest directory
+  float fanout_exponent;	///< exponent of the power law, > 1
+  float directories;		///< probability for an entry to be a directory
+  gen_weight weight;		///< distribution of the file sizes
+  float max_weight;		///< largest file
+  float weight_exponent;	///< exponent of the power law, > 0
+  bool names;			///< create the name column
+  unsigned threads;		///< threads filling the columns, 0 for all
+
+  gen_tree_params()
+    : nodes(1000000), seed(1),
+      fanout(gen_fanout_power_law), max_fanout(10000),
+      fanout_exponent(1.8f), directories(0.15f),
+      weight(gen_weight_power_law), max_weight(1e9f),
+      weight_exponent(0.5f),
+      names(true), threads(0) { }
+};
+
+/**
+ * Replace the contents of a tree by a synthetic file system.
+ *
+ * The structure is drawn breadth first, so parents always come before
+ * their children, then the columns are filled in parallel from a hash
+ * of the seed and the node index: the result only depends on the
+ * parameters, not on the number of threads.  The columns are the ones
+ * created by dir_tree: "name" (directories ending with a '/', files
+ * with an extension drawn from a realistic mix), "size" summed over
+ * the directories, "type" set to 1 for directories and "mtime".
+ * @param t the tree
+ * @param p the parameters
+ * @return the number of nodes
+ */
+unsigned gen_tree(tree& t, const gen_tree_params& p = gen_tree_params());
+
+/**
+ * Return the fanout named by a string: "power", "uniform", "chain" or
+ * "flat".
+ * @param name the name
+ * @param fanout set to the fanout when the name is known
+ * @return true if the name is known
+ */
+bool gen_fanout_by_name(const char * name, gen_fanout& fanout);
+
+/**
+ * Return the weight distribution named by a string: "power",
+ * "uniform" or "constant".
+ * @param name the name
+ * @param weight set to the distribution when the name is known
+ * @return true if the name is known
+ */
+bool gen_weight_by_name(const char * name, gen_weight& weight);
+
+} // namespace infovis
+
+#endif // INFOVIS_TREE_GEN_TREE_HPP
@@ -0,0 +1,95 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/paged_tree.hpp>
+#include <stdexcept>
+
+namespace infovis {
+
+paged_tree::paged_tree(const string& dir, page_cache& cache, bool create)
+  : dir_(dir),
+    child_(dir + "/child.col", cache, create),
+    next_(dir + "/next.col", cache, create),
+    last_(dir + "/last.col", cache, create),
+    parent_(dir + "/parent.col", cache, create)
+{
+  if (create || child_.size() == 0) {
+    child_.add(nil());
+    next_.add(nil());
+    last_.add(nil());
+    parent_.add(nil());
+  }
+}
+
+void
+paged_tree::reserve(unsigned sz)
+{
+  child_.reserve(sz);
+  next_.reserve(sz);
+  last_.reserve(sz);
+  parent_.reserve(sz);
+}
+
+paged_tree::node_descriptor
+paged_tree::add_node(node_descriptor par)
+{
+  if (par >= num_nodes())
+    throw std::out_of_range("paged_tree::add_node");
+  node_descriptor n = num_nodes();
+  child_.add(root);
+  next_.add(root);
+  last_.add(root);
+  parent_.add(par);
+  node_descriptor l = last_[par];
+  if (l == root)
+    child_.set(par, n);
+  else
+    next_.set(l, n);
+  last_.set(par, n);
+  return n;
+}
+
+string
+paged_tree::column_path(const string& name) const
+{
+  return dir_ + "/" + name + ".col";
+}
+
+void
+sum_weights(const paged_tree& t, PagedFloatColumn& weight)
+{
+  unsigned n = t.num_nodes();
+  if (weight.size() < n)
+    weight.resize(n);
+  for (unsigned i = 0; i < n; i++) {
+    if (! t.is_leaf(i))
+      weight.set(i, 0);
+  }
+  for (unsigned i = n; i-- > 1; ) {
+    paged_tree::node_descriptor p = t.parent(i);
+    weight.set(p, weight.get(p) + weight.get(i));
+  }
+}
+
+} // namespace infovis
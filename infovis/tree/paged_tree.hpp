@@ -0,0 +1,226 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TREE_PAGED_TREE_HPP
+#define INFOVIS_TREE_PAGED_TREE_HPP
+
+#include <infovis/table/paged_column.hpp>
+#include <infovis/tree/tree_traits.hpp>
+#include <iterator>
+#include <utility>
+
+namespace infovis {
+
+/**
+ * Tree stored out of core.
+ *
+ * The topology is stored like in <b>tree</b>, in four columns child,
+ * next, last and parent, except that the columns are
+ * paged_column_of stored in files of a directory and mapped through a
+ * page_cache.  The resident memory is therefore bounded by the budget
+ * of the cache, and a treemap whose drawer prunes small boxes only
+ * touches the pages holding the visible top of the tree.
+ *
+ * Nodes should be added in breadth first order so that siblings and
+ * parents stay on nearby pages.
+ *
+ * This class implements the TreeConcept, ParentedTreeConcept and
+ * BuildableTreeConcept.
+ */
+class paged_tree
+{
+public:
+  enum {
+    root = 0,			/// the index of the root node
+  };
+  typedef unsigned node_descriptor;
+  typedef unsigned nodes_size_type;
+  typedef unsigned degree_size_type;
+
+  class children_iterator;
+
+  static node_descriptor nil() { return root; }
+
+  /**
+   * Create or reopen a tree stored in a directory.
+   * @param dir the directory, which should exist
+   * @param cache the page cache used by the columns
+   * @param create true to create an empty tree, false to reopen it
+   */
+  paged_tree(const string& dir, page_cache& cache, bool create = true);
+
+  node_descriptor child(node_descriptor n) const { return child_[n]; }
+  node_descriptor next(node_descriptor n) const { return next_[n]; }
+  node_descriptor last(node_descriptor n) const { return last_[n]; }
+  node_descriptor parent(node_descriptor n) const { return parent_[n]; }
+
+  nodes_size_type num_nodes() const { return child_.size(); }
+
+  children_iterator begin_child(node_descriptor n) const;
+  children_iterator end_child(node_descriptor n) const;
+
+  degree_size_type degree(node_descriptor n) const {
+    degree_size_type cnt = 0;
+    for (node_descriptor c = child_[n]; c != root; c = next_[c])
+      cnt++;
+    return cnt;
+  }
+
+  bool is_leaf(node_descriptor n) const { return child_[n] == nil(); }
+
+  /**
+   * Reserve room for nodes, avoiding repeated file growth.
+   */
+  void reserve(unsigned sz);
+
+  /**
+   * Add a node to the tree
+   * @param n the parent of the node
+   * @return the new node
+   */
+  node_descriptor add_node(node_descriptor n);
+
+  /**
+   * Returns the path of the file holding a column stored next to
+   * the topology, to open it as a paged column sharing the cache.
+   * @param name the column name, used as file name
+   * @return the path of the column file.
+   */
+  string column_path(const string& name) const;
+
+  page_cache& cache() const { return child_.cache(); }
+
+  /**
+   * The children_iterator type for this tree type.
+   */
+  class children_iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef node_descriptor value_type;
+    typedef int difference_type;
+    typedef const node_descriptor* pointer;
+    typedef const node_descriptor& reference;
+
+    children_iterator() : tree_(0), cur_(0) { }
+    children_iterator(const paged_tree * t, node_descriptor n)
+      : tree_(t), cur_(n) { }
+
+    const value_type& operator * () const { return cur_; }
+    children_iterator& operator ++() {
+      cur_ = tree_->next(cur_);
+      return *this;
+    }
+    children_iterator operator ++(int) {
+      children_iterator tmp = *this;
+      cur_ = tree_->next(cur_);
+      return tmp;
+    }
+    bool operator == (const children_iterator& other) const {
+      return cur_ == other.cur_;
+    }
+    bool operator != (const children_iterator& other) const {
+      return cur_ != other.cur_;
+    }
+  protected:
+    const paged_tree * tree_;
+    node_descriptor cur_;
+  };
+
+protected:
+  class topology_column : public PagedUnsignedColumn {
+  public:
+    topology_column(const string& path, page_cache& cache, bool create)
+      : PagedUnsignedColumn(path, cache, create) { }
+    page_cache& cache() const { return storage_.cache(); }
+  };
+
+  string dir_;
+  topology_column child_;
+  topology_column next_;
+  topology_column last_;
+  topology_column parent_;
+};
+
+inline paged_tree::children_iterator
+paged_tree::begin_child(node_descriptor n) const
+{
+  return children_iterator(this, child_[n]);
+}
+
+inline paged_tree::children_iterator
+paged_tree::end_child(node_descriptor) const
+{
+  return children_iterator(this, root);
+}
+
+inline paged_tree::node_descriptor
+root(const paged_tree& t) { return paged_tree::root; }
+
+inline std::pair<paged_tree::children_iterator, paged_tree::children_iterator>
+children(paged_tree::node_descriptor n, const paged_tree& t)
+{
+  return std::make_pair(t.begin_child(n), t.end_child(n));
+}
+
+inline paged_tree::degree_size_type
+degree(paged_tree::node_descriptor n, const paged_tree& t)
+{
+  return t.degree(n);
+}
+
+inline bool
+is_leaf(paged_tree::node_descriptor n, const paged_tree& t)
+{
+  return t.is_leaf(n);
+}
+
+inline paged_tree::nodes_size_type
+num_nodes(const paged_tree& t) { return t.num_nodes(); }
+
+inline paged_tree::node_descriptor
+parent(paged_tree::node_descriptor n, const paged_tree& t)
+{
+  return t.parent(n);
+}
+
+inline paged_tree::node_descriptor
+add_node(paged_tree::node_descriptor parent, paged_tree& t)
+{
+  return t.add_node(parent);
+}
+
+/**
+ * Compute the sum of the weights in place.
+ *
+ * Since parents are always created before their children, the sum is
+ * computed by a backward sequential scan instead of a recursive
+ * traversal, so pages are accessed in order.
+ * @param t a paged tree
+ * @param weight the weights, only meaningful on leaves before the call
+ */
+void sum_weights(const paged_tree& t, PagedFloatColumn& weight);
+
+} // namespace infovis
+
+#endif // INFOVIS_TREE_PAGED_TREE_HPP
@@ -0,0 +1,188 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/xml_tree.hpp>
+#include <infovis/tree/dir_tree.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+static const char * structure[] = { "#child", "#next", "#last", "#parent" };
+
+// Compares the structure columns, values and defined flags.
+static void
+check_same(const tree& expected, const tree& got, const char * what)
+{
+  if (expected.num_nodes() != got.num_nodes()) {
+    fail(what, got.num_nodes());
+    return;
+  }
+  for (const char * name : structure) {
+    const UnsignedColumn * e = UnsignedColumn::cast(expected.find_column(name));
+    const UnsignedColumn * g = UnsignedColumn::cast(got.find_column(name));
+    for (unsigned n = 0; n < expected.num_nodes(); n++) {
+      if (e->defined(n) != g->defined(n) ||
+	  (e->defined(n) && e->fast_get(n) != g->fast_get(n))) {
+	std::cerr << what << ": " << name << " differs\n";
+	fail(what, n);
+	break;
+      }
+    }
+  }
+}
+
+// Rebuilds the structure of a tree one add_node at a time.
+static void
+incremental(const tree& t, tree& out)
+{
+  for (tree::node_descriptor n = 1; n < t.num_nodes(); n++)
+    out.add_node(t.parent(n));
+}
+
+static void
+check_parents(unsigned count, unsigned fanout)
+{
+  std::vector<tree::node_descriptor> parents(count);
+  tree expected;
+  FloatColumn * w = FloatColumn::find("w", expected);
+  for (unsigned n = 1; n < count; n++) {
+    // Mostly recent parents, like a loader descending in a file.
+    parents[n] = n <= fanout ? rand() % n : n - 1 - rand() % fanout;
+    expected.add_node(parents[n]);
+    if (n % 3 == 0)
+      w->set(n, float(n));
+  }
+  tree got;
+  FloatColumn * gw = FloatColumn::find("w", got);
+  for (unsigned n = 3; n < count; n += 3)
+    gw->set(n, float(n));
+  got.build_from_parents(parents);
+  check_same(expected, got, "build_from_parents");
+  if (gw->size() != count || (count > 4 && (! gw->defined(3) || gw->defined(4))))
+    fail("other columns not kept", gw->size());
+
+  // Rebuilding a tree replaces its previous structure.
+  got.build_from_parents(parents);
+  check_same(expected, got, "rebuild");
+}
+
+static void
+check_depths(unsigned count)
+{
+  std::vector<unsigned> depths(count);
+  std::vector<tree::node_descriptor> path(1, tree::root);
+  tree expected;
+  for (unsigned n = 1; n < count; n++) {
+    unsigned d = 1 + rand() % path.size();
+    depths[n] = d;
+    path.resize(d);
+    path.push_back(expected.add_node(path.back()));
+  }
+  tree got;
+  got.build_from_depths(depths);
+  check_same(expected, got, "build_from_depths");
+}
+
+template <class Builder>
+static void
+check_throws(Builder build, const char * what)
+{
+  try {
+    build();
+    fail(what, 0);
+  }
+  catch (const std::exception&) { }
+}
+
+int main(int argc, char * argv[])
+{
+  const char * data = argc > 1 ? argv[1] : "data/www.xml.gz";
+
+  check_parents(1, 1);
+  check_parents(2, 1);
+  check_parents(100000, 1);
+  check_parents(100000, 20);
+  check_parents(100000, 100000);
+  check_depths(1);
+  check_depths(100000);
+
+  check_throws([] {
+    tree t;
+    tree::node_descriptor p[] = { 0, 0, 3, 1 };
+    t.build_from_parents(p, 4);
+  }, "forward parent accepted");
+  check_throws([] {
+    tree t;
+    unsigned d[] = { 0, 1, 3 };
+    t.build_from_depths(d, 3);
+  }, "depth jump accepted");
+  check_throws([] {
+    tree t;
+    unsigned d[] = { 0, 1, 0 };
+    t.build_from_depths(d, 3);
+  }, "second root accepted");
+
+  // The loaders give the same trees as incremental construction.
+  tree x;
+  if (xml_tree(data, x) <= 1)
+    std::cerr << "cannot load " << data << ", skipping xml_tree\n";
+  else {
+    tree y;
+    incremental(x, y);
+    check_same(y, x, "xml_tree");
+  }
+
+  namespace fs = std::filesystem;
+  fs::path dir = fs::temp_directory_path() / "test_build_tree";
+  fs::remove_all(dir);
+  fs::create_directories(dir / "a" / "b");
+  fs::create_directories(dir / "c");
+  std::ofstream(dir / "f1") << "x";
+  std::ofstream(dir / "a" / "f2") << "xx";
+  std::ofstream(dir / "a" / "b" / "f3") << "xxx";
+  std::ofstream(dir / "c" / "f4") << "xxxx";
+  tree d;
+  if (dir_tree(dir.string(), d) != 7 || d.num_nodes() != 8)
+    fail("dir_tree node count", d.num_nodes());
+  tree e;
+  incremental(d, e);
+  check_same(e, d, "dir_tree");
+  fs::remove_all(dir);
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
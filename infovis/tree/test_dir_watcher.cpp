@@ -0,0 +1,185 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/dir_watcher.hpp>
+#include <infovis/tree/dir_tree.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <unistd.h>
+
+using namespace infovis;
+namespace fs = std::filesystem;
+
+static int errors = 0;
+
+static void
+fail(const char * what, const std::string& path)
+{
+  if (errors++ < 20)
+    std::cerr << what << ": " << path << std::endl;
+}
+
+typedef std::map<std::string, std::pair<float, float> > Snapshot;
+
+// Maps the path of each reachable node to its size and type.
+static void
+snapshot(tree& t, Snapshot& snap)
+{
+  const StringColumn& name = *StringColumn::find("name", t);
+  const FloatColumn& size = *FloatColumn::find("size", t);
+  const FloatColumn& type = *FloatColumn::find("type", t);
+  std::vector<std::pair<tree::node_descriptor, std::string> > stack;
+  stack.push_back(std::make_pair(tree::node_descriptor(tree::root), std::string()));
+  snap.clear();
+  while (! stack.empty()) {
+    std::pair<tree::node_descriptor, std::string> n = stack.back();
+    stack.pop_back();
+    snap[n.second] = std::make_pair(size[n.first], type[n.first]);
+    for (tree::node_descriptor c = t.child(n.first); c != tree::nil(); c = t.next(c))
+      stack.push_back(std::make_pair(c, n.second + name.get(c)));
+  }
+}
+
+static bool
+same(tree& t, const std::string& dir, bool report)
+{
+  tree fresh;
+  dir_tree(dir, fresh);
+  Snapshot expected, got;
+  snapshot(fresh, expected);
+  snapshot(t, got);
+  if (expected == got)
+    return true;
+  if (report) {
+    for (const auto& e : expected) {
+      auto g = got.find(e.first);
+      if (g == got.end())
+	fail("missing", e.first);
+      else if (g->second != e.second)
+	fail("different size or type", e.first);
+    }
+    for (const auto& g : got)
+      if (expected.find(g.first) == expected.end())
+	fail("not removed", g.first);
+  }
+  return false;
+}
+
+static void
+converge(dir_watcher& w, tree& t, const std::string& dir,
+	 const char * what)
+{
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < end) {
+    w.update(100);
+    if (same(t, dir, false))
+      return;
+  }
+  std::cerr << what << " did not converge\n";
+  same(t, dir, true);
+}
+
+static void
+write(const fs::path& p, unsigned size)
+{
+  std::ofstream out(p, std::ios::app);
+  out << std::string(size, 'x');
+}
+
+static void
+mutate(const fs::path& dir, unsigned step)
+{
+  switch (step) {
+  case 0:
+    write(dir / "new_file", 100);
+    break;
+  case 1:
+    write(dir / "a" / "f1", 50);	// grows
+    break;
+  case 2:
+    fs::create_directories(dir / "n" / "m");
+    write(dir / "n" / "g", 7);
+    write(dir / "n" / "m" / "h", 9);
+    break;
+  case 3:
+    fs::remove(dir / "a" / "f2");
+    break;
+  case 4:
+    fs::rename(dir / "new_file", dir / "a" / "moved");
+    break;
+  case 5:
+    fs::rename(dir / "n", dir / "a" / "n2");
+    break;
+  case 6:
+    fs::remove_all(dir / "b");
+    write(dir / "b", 3);		// a file replaces the directory
+    break;
+  case 7:
+    fs::create_directory(dir / "empty");
+    fs::remove(dir / "c");
+    break;
+  }
+}
+
+static void
+populate(const fs::path& dir)
+{
+  fs::remove_all(dir);
+  fs::create_directories(dir / "a");
+  fs::create_directories(dir / "b" / "d");
+  write(dir / "a" / "f1", 10);
+  write(dir / "a" / "f2", 20);
+  write(dir / "b" / "d" / "f3", 30);
+  write(dir / "c", 40);
+}
+
+int
+main()
+{
+  const fs::path dir = fs::temp_directory_path() /
+    ("test_dir_watcher_" + std::to_string(getpid()));
+
+  for (unsigned max_watches : { unsigned(-1), 2u, 0u }) {
+    populate(dir);
+    tree t;
+    dir_tree(dir.string(), t);
+    dir_watcher w(t, max_watches);
+    w.set_coalesce_delay(10);
+    w.set_poll_interval(0);
+    if (max_watches == 0 && (w.watched() != 0 || w.polled() != 4))
+      fail("polled directories", dir.string());
+    for (unsigned step = 0; step < 8; step++) {
+      mutate(dir, step);
+      converge(w, t, dir.string(), max_watches == 0 ? "polling" : "watching");
+    }
+    if (t.dirty_nodes().empty())
+      fail("dirty nodes", dir.string());
+  }
+  fs::remove_all(dir);
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,134 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/export_tree_xml.hpp>
+#include <infovis/tree/xml_tree.hpp>
+#include <zlib.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace infovis;
+
+static string
+read_file(const string& filename)
+{
+  string ret;
+  gzFile in = gzopen(filename.c_str(), "rb");
+  if (in == 0)
+    return ret;
+  char buf[65536];
+  int len;
+  while ((len = gzread(in, buf, sizeof(buf))) > 0)
+    ret.append(buf, len);
+  gzclose(in);
+  return ret;
+}
+
+static int
+compare(const tree& t, const char * what)
+{
+  int errors = 0;
+  std::ostringstream expected;
+  export_tree_xml(expected, t);
+  static const char * files[] = { "test_export.xml", "test_export.xml.gz" };
+  for (const char * file : files) {
+    for (unsigned threads = 1; threads <= 4; threads += 3) {
+      if (! export_tree_xml(file, t, threads)) {
+	std::cerr << "cannot write " << file << std::endl;
+	return 1;
+      }
+      if (read_file(file) != expected.str()) {
+	std::cerr << what << ": " << file << " with " << threads
+		  << " threads differs from the stream export\n";
+	errors++;
+      }
+      std::remove(file);
+    }
+  }
+  return errors;
+}
+
+int main(int argc, char * argv[])
+{
+  const char * data = argc > 1 ? argv[1] : "data/www.xml.gz";
+  unsigned n = argc > 2 ? atoi(argv[2]) : 20000;
+  int errors = 0;
+
+  tree t;
+  StringColumn& tag = *StringColumn::find("tag", t);
+  StringColumn& name = *StringColumn::find("name", t);
+  FloatColumn& size = *FloatColumn::find("size", t);
+  DoubleColumn& ratio = *DoubleColumn::find("ratio", t);
+  IntColumn& delta = *IntColumn::find("delta", t);
+  UnsignedColumn& id = *UnsignedColumn::find("id", t);
+  LongColumn& date = *LongColumn::find("date", t);
+  CharColumn& mode = *CharColumn::find("mode", t);
+  UnsignedColumn::find("$hidden", t);
+  static const char * names[] = {
+    "plain", "with space", "a<b>c", "R&D", "it's", "say \"hi\"",
+    "both ' and \"", "caf\xc3\xa9", "\xff\x80", ""
+  };
+
+  srand(3);
+  tag[0] = "root";
+  for (unsigned i = 1; i < n; i++) {
+    tree::node_descriptor parent = rand() % i;
+    tree::node_descriptor c = t.add_node(parent);
+    tag[c] = (rand() % 3) ? "file" : "dir";
+    name[c] = names[rand() % (sizeof(names) / sizeof(names[0]))];
+    if (rand() % 4)
+      size[c] = rand() / 7.0f - 1000.0f;
+    if (rand() % 2)
+      ratio[c] = rand() / double(RAND_MAX) * 1e-7;
+    delta[c] = rand() - RAND_MAX / 2;
+    if (rand() % 3)
+      id[c] = rand();
+    date[c] = long(rand()) * 1000;
+    if (rand() % 2)
+      mode[c] = "rwx<&"[rand() % 5];
+  }
+  size[1] = 0.0f;
+  size[2] = 1e30f;
+  size[3] = -1.5e-30f;
+  errors += compare(t, "random tree");
+
+  tree no_tag;
+  for (unsigned i = 1; i < 100; i++)
+    no_tag.add_node(i / 3);
+  errors += compare(no_tag, "tree without columns");
+
+  tree loaded;
+  if (xml_tree(data, loaded) <= 1) {
+    std::cerr << "cannot load " << data << std::endl;
+    errors++;
+  }
+  else
+    errors += compare(loaded, data);
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,230 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/gen_tree.hpp>
+#include <infovis/tree/export_tree_xml.hpp>
+#include <infovis/tree/xml_tree.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+
+using namespace infovis;
+typedef tree::node_descriptor node_descriptor;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+static void
+same_trees(const char * what, tree& a, tree& b)
+{
+  if (a.num_nodes() != b.num_nodes()) {
+    fail(what, b.num_nodes());
+    return;
+  }
+  const StringColumn * na = StringColumn::find("name", a);
+  const StringColumn * nb = StringColumn::find("name", b);
+  const FloatColumn * sa = FloatColumn::find("size", a);
+  const FloatColumn * sb = FloatColumn::find("size", b);
+  const FloatColumn * ma = FloatColumn::find("mtime", a);
+  const FloatColumn * mb = FloatColumn::find("mtime", b);
+  for (unsigned i = 0; i < a.num_nodes(); i++)
+    if (a.parent(i) != b.parent(i) || (*na)[i] != (*nb)[i]
+	|| (*sa)[i] != (*sb)[i] || (*ma)[i] != (*mb)[i]) {
+      fail(what, i);
+      return;
+    }
+}
+
+// The structure, types and sizes every generated tree must have.
+static void
+check_tree(const char * what, tree& t, unsigned n)
+{
+  if (t.num_nodes() != n) {
+    fail(what, t.num_nodes());
+    return;
+  }
+  const FloatColumn& size = *FloatColumn::find("size", t);
+  const FloatColumn& type = *FloatColumn::find("type", t);
+  const StringColumn * name = StringColumn::find("name", t);
+  std::vector<float> sum(n, 1);
+  for (unsigned i = n - 1; i > 0; i--) {
+    const node_descriptor p = t.parent(i);
+    if (p >= i || type[p] != 1) {
+      fail(what, i);
+      return;
+    }
+    if (type[i] == 0 && (! t.is_leaf(i) || size[i] < 1)) {
+      fail(what, i);
+      return;
+    }
+    if (type[i] == 1 && size[i] != sum[i]) {
+      fail(what, i);
+      return;
+    }
+    const string& s = (*name)[i];
+    if (s.empty() || (s[s.size() - 1] == '/') != (type[i] == 1)) {
+      fail(what, i);
+      return;
+    }
+    sum[p] += size[i];
+  }
+}
+
+// Nodes of a loaded tree in document order, which is the depth first
+// order of the tree it was exported from.
+static std::vector<node_descriptor>
+depth_first(const tree& t)
+{
+  std::vector<node_descriptor> order, stack(1, tree::root);
+  while (! stack.empty()) {
+    node_descriptor n = stack.back();
+    stack.pop_back();
+    order.push_back(n);
+    std::size_t top = stack.size();
+    for (node_descriptor c = t.child(n); c != tree::nil(); c = t.next(c))
+      stack.push_back(c);
+    std::reverse(stack.begin() + top, stack.end());
+  }
+  return order;
+}
+
+static void
+check_round_trip(tree& t)
+{
+  static const char * file = "test_gen_tree.xml.gz";
+  if (! export_tree_xml(file, t, 0)) {
+    fail("cannot write", 0);
+    return;
+  }
+  tree loaded;
+  xml_tree(file, loaded);
+  std::remove(file);
+  // The loader adds a root above the exported one.
+  if (loaded.num_nodes() != t.num_nodes() + 1) {
+    fail("xml round trip", loaded.num_nodes());
+    return;
+  }
+  std::vector<node_descriptor> order = depth_first(t);
+  const StringColumn& name = *StringColumn::find("name", t);
+  const FloatColumn& size = *FloatColumn::find("size", t);
+  const StringColumn * lname = StringColumn::cast(loaded.find_column("name"));
+  const FloatColumn * lsize = FloatColumn::cast(loaded.find_column("size"));
+  if (lname == 0 || lsize == 0) {
+    fail("xml round trip columns", 0);
+    return;
+  }
+  for (unsigned i = 0; i < order.size(); i++) {
+    const node_descriptor n = order[i];
+    float s = size[n], l = (*lsize)[i + 1];
+    if ((*lname)[i + 1] != name[n] || std::abs(l - s) > s * 1e-5f) {
+      fail("xml round trip", i);
+      return;
+    }
+  }
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 1000000;
+  unsigned xml = argc > 2 ? atoi(argv[2]) : 100000;
+
+  gen_tree_params p;
+  p.nodes = n;
+  p.threads = 1;
+  tree t1, t2;
+  gen_tree(t1, p);
+  check_tree("power law", t1, n);
+  p.threads = 4;
+  gen_tree(t2, p);
+  same_trees("threads", t1, t2);
+  tree t3;
+  p.seed = 2;
+  gen_tree(t3, p);
+  unsigned same = 0;
+  for (unsigned i = 1; i < n && i < t3.num_nodes(); i++)
+    same += t1.parent(i) == t3.parent(i);
+  if (same > n / 2)
+    fail("seed", same);
+
+  p.fanout = gen_fanout_uniform;
+  p.max_fanout = 20;
+  p.weight = gen_weight_uniform;
+  p.max_weight = 1000;
+  tree u;
+  gen_tree(u, p);
+  check_tree("uniform", u, n);
+  for (unsigned i = 0; i < n; i++)
+    if (u.degree(i) > 20) {
+      fail("uniform fanout", i);
+      break;
+    }
+
+  // With constant weights, the size is the number of nodes.
+  p.fanout = gen_fanout_flat;
+  p.weight = gen_weight_constant;
+  tree flat;
+  gen_tree(flat, p);
+  check_tree("flat", flat, n);
+  if (flat.degree(tree::root) != n - 1
+      || (*FloatColumn::find("size", flat))[tree::root] != n)
+    fail("flat", flat.degree(tree::root));
+
+  p.fanout = gen_fanout_chain;
+  tree chain;
+  gen_tree(chain, p);
+  check_tree("chain", chain, n);
+  if (! chain.is_leaf(n - 1) || chain.parent(n - 1) != n - 2)
+    fail("chain", n - 1);
+
+  // Large trees can skip the names.
+  p = gen_tree_params();
+  p.nodes = n;
+  p.names = false;
+  tree nameless;
+  gen_tree(nameless, p);
+  if (nameless.find_column("name") != 0)
+    fail("names", 0);
+  else if ((*FloatColumn::find("size", nameless))[tree::root]
+	   != (*FloatColumn::find("size", t1))[tree::root])
+    fail("nameless sizes", 0);
+
+  p = gen_tree_params();
+  p.nodes = xml;
+  tree small;
+  gen_tree(small, p);
+  check_round_trip(small);
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
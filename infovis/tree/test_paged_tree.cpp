@@ -0,0 +1,176 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/paged_tree.hpp>
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/treemap/squarified.hpp>
+#include <infovis/drawing/box.hpp>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+using namespace infovis;
+
+typedef box_min_max<float> Box;
+
+/*
+ * Drawer pruning boxes smaller than a pixel, the level of detail
+ * cutoff used by the real drawers.
+ */
+template <class Tree>
+struct lod_drawer : public null_drawer<Tree,Box> {
+  unsigned boxes;
+  double area;
+  lod_drawer() : boxes(0), area(0) { }
+  bool begin_box(const Box& b, unsigned n, unsigned depth) {
+    if (width(b) < 1 || height(b) < 1)
+      return false;
+    boxes++;
+    return true;
+  }
+  void draw_box(const Box& b, unsigned n, unsigned depth) {
+    area += width(b) * height(b);
+  }
+};
+
+static unsigned fanout = 16;
+
+static float
+leaf_weight(unsigned i) { return 1 + (i % 97); }
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = 1000000;
+  size_t budget = 64;
+  string dir;
+
+  if (argc > 1)
+    n = atoi(argv[1]);
+  if (argc > 2)
+    budget = atoi(argv[2]);
+  if (argc > 3)
+    dir = argv[3];
+  else {
+    char tmpl[] = "/tmp/paged_treeXXXXXX";
+    if (mkdtemp(tmpl) == 0) {
+      std::cerr << "Cannot create temporary directory\n";
+      return 1;
+    }
+    dir = tmpl;
+  }
+  std::cout << "Building " << n << " nodes in " << dir
+	    << " with a budget of " << budget << "MB\n";
+
+  int errors = 0;
+  unsigned boxes;
+  double area;
+  {
+    page_cache cache(budget * 1024 * 1024);
+    paged_tree t(dir, cache);
+    PagedFloatColumn weight(t.column_path("weight"), cache);
+
+    clock_t time = clock();
+    t.reserve(n);
+    weight.reserve(n);
+    for (unsigned i = 1; i < n; i++) {
+      t.add_node((i - 1) / fanout);
+      weight.set(i, leaf_weight(i));
+    }
+    sum_weights(t, weight);
+    std::cout << "Time to build: "
+	      << (clock() - time) / float(CLOCKS_PER_SEC) << "s\n";
+
+    time = clock();
+    lod_drawer<paged_tree> drawer;
+    treemap_squarified<paged_tree, Box, const PagedFloatColumn&,
+      lod_drawer<paged_tree>&> tm(t, weight, drawer);
+    tm.visit(Box(0, 0, 1024, 1024), root(t));
+    boxes = drawer.boxes;
+    area = drawer.area;
+    std::cout << "Time to layout: "
+	      << (clock() - time) / float(CLOCKS_PER_SEC) << "s, "
+	      << boxes << " boxes visited\n";
+    std::cout << "Peak mapped: "
+	      << cache.peak_resident_bytes() / (1024*1024) << "MB, "
+	      << cache.fault_count() << " page faults\n";
+    if (cache.peak_resident_bytes() > cache.budget()) {
+      std::cout << "ERROR: budget exceeded\n";
+      errors++;
+    }
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  std::cout << "Max resident set size: " << usage.ru_maxrss / 1024 << "MB\n";
+
+  {
+    // Reopen the tree and check it against an in-memory one.
+    page_cache cache(budget * 1024 * 1024);
+    paged_tree t(dir, cache, false);
+    PagedFloatColumn weight(t.column_path("weight"), cache, false);
+    if (t.num_nodes() != n || weight.size() != n) {
+      std::cout << "ERROR: reopened tree has " << t.num_nodes()
+		<< " nodes\n";
+      errors++;
+    }
+    else if (n <= 5000000) {
+      tree mt(n);
+      FloatColumn mw("weight", n);
+      for (unsigned i = 1; i < n; i++) {
+	mt.add_node((i - 1) / fanout);
+	mw[i] = leaf_weight(i);
+      }
+      mw[0] = 0;
+      sum_weights(mt, mw);
+      for (unsigned i = 0; i < n; i++) {
+	if (t.child(i) != mt.child(i) || t.next(i) != mt.next(i) ||
+	    t.last(i) != mt.last(i) || t.parent(i) != mt.parent(i) ||
+	    weight[i] != mw[i]) {
+	  std::cout << "ERROR: node " << i << " differs\n";
+	  errors++;
+	  break;
+	}
+      }
+      lod_drawer<tree> drawer;
+      treemap_squarified<tree, Box, const FloatColumn&,
+	lod_drawer<tree>&> tm(mt, mw, drawer);
+      tm.visit(Box(0, 0, 1024, 1024), root(mt));
+      if (drawer.boxes != boxes || drawer.area != area) {
+	std::cout << "ERROR: in-memory layout drew " << drawer.boxes
+		  << " boxes\n";
+	errors++;
+      }
+    }
+  }
+  if (argc <= 3) {
+    const char * files[] = { "child", "next", "last", "parent", "weight" };
+    for (unsigned i = 0; i < 5; i++)
+      unlink((dir + "/" + files[i] + ".col").c_str());
+    rmdir(dir.c_str());
+  }
+  std::cout << (errors ? "FAILED\n" : "OK\n");
+  return errors != 0;
+}
@@ -0,0 +1,162 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree_diff.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <stdlib.h>
+
+using namespace infovis;
+typedef tree::node_descriptor node_descriptor;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+// Full path of every reachable node, the k-th sibling with a given
+// name being suffixed with k.
+static void
+paths(const tree& t, std::map<std::string, node_descriptor>& result)
+{
+  const StringColumn& names = *StringColumn::cast(t.find_column("name"));
+  std::vector<std::pair<node_descriptor, std::string> > nodes;
+  nodes.push_back(std::make_pair(node_descriptor(tree::root), std::string()));
+  result.clear();
+  for (unsigned i = 0; i < nodes.size(); i++) {
+    result[nodes[i].second] = nodes[i].first;
+    std::map<std::string, unsigned> count;
+    for (node_descriptor c = t.child(nodes[i].first); c != tree::nil();
+	 c = t.next(c)) {
+      const std::string& name = names.get(c);
+      nodes.push_back(std::make_pair(c, nodes[i].second + "/" + name + "#" +
+				     std::to_string(count[name]++)));
+    }
+  }
+}
+
+static void
+random_names(tree& t, node_descriptor from)
+{
+  StringColumn& names = *StringColumn::find("name", t);
+  FloatColumn& size = *FloatColumn::find("size", t);
+  for (node_descriptor i = from; i < t.num_nodes(); i++) {
+    // Few distinct names so that siblings share some.
+    names[i] = std::string(1, char('a' + rand() % 8));
+    size[i] = float(rand() % 4);
+  }
+}
+
+static void
+check(const tree& from, const tree& to, unsigned threads)
+{
+  tree_diff d;
+  diff_trees(from, to, d, "name", "size", threads);
+
+  std::map<std::string, node_descriptor> old_paths, new_paths;
+  paths(from, old_paths);
+  paths(to, new_paths);
+  const FloatColumn& old_size = *FloatColumn::cast(from.find_column("size"));
+  const FloatColumn& new_size = *FloatColumn::cast(to.find_column("size"));
+
+  std::vector<node_descriptor> added, removed, changed;
+  for (const auto& p : new_paths) {
+    auto o = old_paths.find(p.first);
+    node_descriptor expected = o == old_paths.end() ? tree_diff::none : o->second;
+    if (d.old_of_new[p.second] != expected)
+      fail("match", p.second);
+    if (expected == tree_diff::none)
+      added.push_back(p.second);
+    else {
+      if (d.new_of_old[expected] != p.second)
+	fail("reverse match", expected);
+      if (old_size.get(expected) != new_size.get(p.second))
+	changed.push_back(p.second);
+    }
+  }
+  for (const auto& p : old_paths)
+    if (new_paths.find(p.first) == new_paths.end())
+      removed.push_back(p.second);
+
+  std::sort(d.added.begin(), d.added.end());
+  std::sort(d.removed.begin(), d.removed.end());
+  std::sort(d.changed.begin(), d.changed.end());
+  std::sort(added.begin(), added.end());
+  std::sort(removed.begin(), removed.end());
+  std::sort(changed.begin(), changed.end());
+  if (d.added != added)
+    fail("added", unsigned(added.size()));
+  if (d.removed != removed)
+    fail("removed", unsigned(removed.size()));
+  if (d.changed != changed)
+    fail("changed", unsigned(changed.size()));
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 100000;
+  srand(3);
+
+  std::vector<node_descriptor> parents(n);
+  for (unsigned i = 1; i < n; i++)
+    parents[i] = rand() % i;
+  tree from;
+  from.build_from_parents(parents);
+  random_names(from, 0);
+
+  // Same tree, then removed and added subtrees, renames and weights.
+  tree to(from);
+  check(from, to, 4);
+  StringColumn& names = *StringColumn::find("name", to);
+  FloatColumn& size = *FloatColumn::find("size", to);
+  const node_descriptor sub[] = { 0, 0, 0, 1, 1, 2 };
+  for (unsigned k = 0; k < n / 1000; k++) {
+    node_descriptor r = 1 + rand() % (n - 1);
+    if (! to.removed(r))
+      to.remove_subtree(r);
+    node_descriptor base = to.add_subtree(rand() % n, sub, 6);
+    random_names(to, base);
+    names[rand() % n] = "renamed";
+    size[rand() % n] = 100;
+  }
+  for (unsigned threads = 1; threads <= 4; threads *= 2)
+    check(from, to, threads);
+
+  // Unrelated trees only match the root and a few paths.
+  tree other;
+  for (unsigned i = 1; i < n; i++)
+    parents[i] = rand() % i;
+  other.build_from_parents(parents);
+  random_names(other, 0);
+  check(from, other, 2);
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
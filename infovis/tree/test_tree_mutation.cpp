@@ -0,0 +1,204 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/table/metadata.hpp>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+// Lists the nodes reachable from the root, checking the links.
+static void
+reachable(const tree& t, std::vector<tree::node_descriptor>& nodes)
+{
+  nodes.assign(1, tree::root);
+  for (unsigned i = 0; i < nodes.size(); i++) {
+    tree::node_descriptor n = nodes[i];
+    tree::node_descriptor last = tree::nil();
+    for (tree::node_descriptor c = t.child(n); c != tree::nil(); c = t.next(c)) {
+      if (t.parent(c) != n || t.removed(c))
+	fail("parent link", c);
+      if (t.prev(c) != last)
+	fail("prev link", c);
+      nodes.push_back(c);
+      last = c;
+    }
+    if (t.last(n) != last)
+      fail("last child", n);
+  }
+}
+
+// Compares the summed column against a full recomputation, and
+// checks that the nodes whose sum changed are dirty.
+static void
+check(tree& t, const FloatColumn& col, std::vector<float>& previous)
+{
+  std::vector<tree::node_descriptor> nodes;
+  reachable(t, nodes);
+  FloatColumn expected(col);
+  sum_weights(t, expected);
+  const bool first = previous.empty();
+  previous.resize(t.num_nodes(), 0);
+  for (tree::node_descriptor n : nodes) {
+    if (expected.fast_get(n) != col.fast_get(n))
+      fail("sum", n);
+    if (! first && previous[n] != col.fast_get(n) && ! t.is_dirty(n))
+      fail("dirty", n);
+    previous[n] = col.fast_get(n);
+  }
+}
+
+static void
+clear_dirty(tree& t)
+{
+  t.clear_dirty();
+  if (! t.dirty_nodes().empty() || t.is_dirty(tree::root))
+    fail("clear_dirty", 0);
+}
+
+static tree::node_descriptor
+random_node(const tree& t)
+{
+  std::vector<tree::node_descriptor> nodes;
+  reachable(t, nodes);
+  return nodes[rand() % nodes.size()];
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned count = argc > 1 ? atoi(argv[1]) : 2000;
+  unsigned rounds = argc > 2 ? atoi(argv[2]) : 300;
+
+  srand(17);
+  std::vector<tree::node_descriptor> parents(count);
+  for (unsigned i = 1; i < count; i++)
+    parents[i] = rand() % i;
+  tree t;
+  t.build_from_parents(parents);
+
+  // Integer weights keep the float sums exact, whatever the order.
+  FloatColumn& size = *FloatColumn::find("size", t);
+  FloatColumn& other = *FloatColumn::find("other", t);
+  size.put_metadata(metadata::aggregate, metadata::aggregate_sum);
+  other.put_metadata(metadata::aggregate, metadata::aggregate_sum);
+  for (unsigned i = 0; i < count; i++) {
+    size[i] = t.is_leaf(i) ? rand() % 100 : 0;
+    other[i] = t.is_leaf(i) ? 1 : 0;
+  }
+  sum_weights(t, size);
+  sum_weights(t, other);
+  std::vector<float> previous_size, previous_other;
+  check(t, size, previous_size);
+  check(t, other, previous_other);
+  clear_dirty(t);
+
+  for (unsigned r = 0; r < rounds; r++) {
+    for (unsigned k = 0; k < 10; k++) {
+      tree::node_descriptor n = random_node(t);
+      switch (rand() % 4) {
+      case 0:
+	if (t.is_leaf(n))
+	  t.set_leaf_value(n, size, rand() % 100);
+	break;
+      case 1: {
+	std::vector<tree::node_descriptor> sub(1 + rand() % 5);
+	for (unsigned i = 1; i < sub.size(); i++)
+	  sub[i] = rand() % i;
+	tree::node_descriptor s = t.add_subtree(n, sub.data(), unsigned(sub.size()));
+	for (unsigned i = 0; i < sub.size(); i++)
+	  if (t.is_leaf(s + i))
+	    t.set_leaf_value(s + i, size, rand() % 100);
+	break;
+      }
+      case 2:
+	if (n != tree::root && rand() % 4 == 0)
+	  t.remove_subtree(n);
+	break;
+      case 3: {
+	tree::node_descriptor par = random_node(t);
+	bool inside = false;
+	for (tree::node_descriptor m = par; ; m = t.parent(m)) {
+	  inside |= m == n;
+	  if (m == tree::root)
+	    break;
+	}
+	if (inside) {
+	  try {
+	    t.move_subtree(n, par);
+	    fail("move into itself", n);
+	  }
+	  catch (const std::invalid_argument&) { }
+	}
+	else
+	  t.move_subtree(n, par);
+	break;
+      }
+      }
+    }
+    check(t, size, previous_size);
+    check(t, other, previous_other);
+    clear_dirty(t);
+  }
+
+  // Undefined rows of the internal columns, as left by treemap2 when
+  // it hides the sums of the interior nodes, change nothing.
+  column * parent = t.find_column("#parent");
+  for (tree::node_descriptor n = 0; n < t.num_nodes(); n++)
+    if (! t.is_leaf(n) && ! t.removed(n))
+      parent->undefine(n);
+  for (unsigned k = 0; k < 200; k++) {
+    tree::node_descriptor n = random_node(t);
+    if (n != tree::root && t.removed(n))
+      fail("undefined parent seen as removed", n);
+    if (t.is_leaf(n))
+      t.set_leaf_value(n, size, rand() % 100);
+    else if (n != tree::root && k % 5 == 0)
+      t.move_subtree(n, tree::root);
+  }
+  check(t, size, previous_size);
+  check(t, other, previous_other);
+  clear_dirty(t);
+
+  tree::node_descriptor inner = t.parent(t.last(tree::root));
+  try {
+    t.set_leaf_value(inner, size, 1);
+    fail("set_leaf_value on a non leaf", inner);
+  }
+  catch (const std::invalid_argument&) { }
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
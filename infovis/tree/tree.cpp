@@ -24,6 +24,7 @@
  */
 #include <infovis/tree/tree.hpp>
 #include <infovis/tree/visitor.hpp>
+#include <infovis/table/metadata.hpp>
 #include <ostream>
 #include <stdexcept>
 
@@ -32,6 +33,7 @@ namespace infovis {
 tree::tree(unsigned capacity)
   : child_("#child", capacity),
     next_("#next", capacity),
+    prev_("#prev", capacity),
     last_("#last", capacity),
     parent_("#parent", capacity)
 {
@@ -39,6 +41,8 @@ tree::tree(unsigned capacity)
   add_column(&child_);
   next_.add(nil());		// next of root is nil always
   add_column(&next_);
+  prev_.add(nil());		// prev of root is nil always
+  add_column(&prev_);
   last_.add(nil());		// last child of root is nil so fat
   add_column(&last_);
   parent_.add(nil());		// parent of root is always nil
@@ -49,19 +53,26 @@ tree::tree(unsigned capacity)
 tree::tree(const tree& other)
   : child_(other.child_),
     next_(other.next_),
+    prev_(other.prev_),
     last_(other.last_),
-    parent_(other.parent_)
+    parent_(other.parent_),
+    removed_(other.removed_)
 {
   for (unsigned i = 0; i < other.column_count(); i++) {
     const column * c = other.get_column(i);
-    if (c == &other.child_ ||
-	c == &other.next_ ||
-	c == &other.last_ ||
-	c == &other.parent_)
-      continue;
-    add_column(c->clone());
+    if (c == &other.child_)
+      add_column(&child_);
+    else if (c == &other.next_)
+      add_column(&next_);
+    else if (c == &other.prev_)
+      add_column(&prev_);
+    else if (c == &other.last_)
+      add_column(&last_);
+    else if (c == &other.parent_)
+      add_column(&parent_);
+    else
+      add_column(c->clone());
   }
-  reset();
 }
 
 void
@@ -72,10 +83,13 @@ tree::reset()
   parent_.undefine(root);
   next_.set(root, root);
   next_.undefine(root);
+  prev_.set(root, root);
+  prev_.undefine(root);
   child_.set(root, root);
   child_.undefine(root);
   last_.set(root, root);
   last_.undefine(root);
+  removed_.clear();
 }
 
 tree::node_descriptor
@@ -90,14 +104,335 @@ tree::add_node(node_descriptor par)
   next_.undefine(n);		// will look undefine but still contains null
   if (last_[par] == root) {
     child_.set(par, n);
+    prev_.set(n, root);
+    prev_.undefine(n);
   }
   else {
     next_.set(last_[par], n);
+    prev_.set(n, last_[par]);
   }
   last_.set(par, n);
   return n;
 }
 
+void
+tree::build_from_parents(const node_descriptor * parents, unsigned count)
+{
+  if (count == 0)
+    throw std::invalid_argument("tree::build_from_parents");
+  for (node_descriptor n = 1; n < count; n++)
+    if (parents[n] >= n)
+      throw std::out_of_range("tree::build_from_parents");
+
+  reserve(count);
+  resize(count);
+  for (node_descriptor n = 0; n < count; n++) {
+    child_.fast_set(n, nil());
+    last_.fast_set(n, nil());
+    parent_.fast_set(n, n == root ? nil() : parents[n]);
+  }
+  // Walking backward, each node becomes the first child of its parent
+  // so far and links to the previous first child as its next sibling.
+  for (node_descriptor n = count-1; n != root; n--) {
+    node_descriptor par = parents[n];
+    next_.fast_set(n, child_.fast_get(par));
+    if (child_.fast_get(par) != nil())
+      prev_.fast_set(child_.fast_get(par), n);
+    prev_.fast_set(n, nil());
+    if (last_.fast_get(par) == nil())
+      last_.fast_set(par, n);
+    child_.fast_set(par, n);
+  }
+  next_.fast_set(root, nil());
+  prev_.fast_set(root, nil());
+
+  dirty_.clear();
+  dirty_list_.clear();
+  removed_.clear();
+
+  // Same defined values as add_node.
+  child_.define_all();
+  last_.define_all();
+  next_.define_all();
+  prev_.define_all();
+  parent_.define_all();
+  parent_.undefine(root);
+  for (node_descriptor n = 0; n < count; n++) {
+    if (child_.fast_get(n) == nil()) {
+      child_.undefine(n);
+      last_.undefine(n);
+    }
+    if (next_.fast_get(n) == nil())
+      next_.undefine(n);
+    if (prev_.fast_get(n) == nil())
+      prev_.undefine(n);
+  }
+}
+
+void
+tree::build_from_depths(const unsigned * depths, unsigned count)
+{
+  if (count == 0 || depths[0] != 0)
+    throw std::invalid_argument("tree::build_from_depths");
+  std::vector<node_descriptor> parents(count);
+  std::vector<node_descriptor> path(1, root);
+  parents[root] = nil();
+  for (node_descriptor n = 1; n < count; n++) {
+    unsigned d = depths[n];
+    if (d == 0 || d > path.size())
+      throw std::invalid_argument("tree::build_from_depths");
+    path.resize(d);
+    parents[n] = path.back();
+    path.push_back(n);
+  }
+  build_from_parents(parents.data(), count);
+}
+
+void
+tree::mark_dirty(node_descriptor n)
+{
+  if (dirty_.size() < num_nodes())
+    dirty_.resize(num_nodes());
+  if (! dirty_[n]) {
+    dirty_.set(n);
+    dirty_list_.push_back(n);
+  }
+}
+
+void
+tree::clear_dirty()
+{
+  for (node_descriptor n : dirty_list_)
+    dirty_.set(n, false);
+  dirty_list_.clear();
+}
+
+void
+tree::summed_columns(std::vector<FloatColumn*>& cols) const
+{
+  cols.clear();
+  for (unsigned i = 0; i < column_count(); i++) {
+    FloatColumn * c = FloatColumn::cast(get_column(i));
+    if (c != 0 &&
+	c->get_metadata(metadata::aggregate) == metadata::aggregate_sum)
+      cols.push_back(c);
+  }
+}
+
+// Adds to a value without changing whether it is defined, sums being
+// usually undefined so they don't count in the min and max.
+static inline void
+add_value(FloatColumn& c, tree::node_descriptor n, float d)
+{
+  if (n >= c.size())
+    return;
+  if (c.defined(n))
+    c.set(n, c.fast_get(n) + d);
+  else
+    c.fast_set(n, c.fast_get(n) + d);
+}
+
+void
+tree::add_to_sums(node_descriptor n,
+		  const std::vector<FloatColumn*>& cols,
+		  const std::vector<float>& delta)
+{
+  if (std::find_if(delta.begin(), delta.end(),
+		   [](float d) { return d != 0; }) == delta.end())
+    return;
+  for (;;) {
+    for (unsigned j = 0; j < cols.size(); j++)
+      add_value(*cols[j], n, delta[j]);
+    mark_dirty(n);
+    if (n == root || removed(n))
+      break;
+    n = parent_.fast_get(n);
+  }
+}
+
+void
+tree::link(node_descriptor n, node_descriptor par)
+{
+  parent_.set(n, par);
+  next_.set(n, nil());
+  next_.undefine(n);
+  node_descriptor last = last_.fast_get(par);
+  prev_.set(n, last);
+  if (last == nil()) {
+    prev_.undefine(n);
+    child_.set(par, n);
+  }
+  else
+    next_.set(last, n);
+  last_.set(par, n);
+}
+
+void
+tree::unlink(node_descriptor n)
+{
+  node_descriptor par = parent_.fast_get(n);
+  node_descriptor next = next_.fast_get(n);
+  node_descriptor prev = prev_.fast_get(n);
+  if (prev == nil()) {
+    child_.set(par, next);
+    if (next == nil())
+      child_.undefine(par);
+  }
+  else {
+    next_.set(prev, next);
+    if (next == nil())
+      next_.undefine(prev);
+  }
+  if (next == nil()) {
+    last_.set(par, prev);
+    if (prev == nil())
+      last_.undefine(par);
+  }
+  else {
+    prev_.set(next, prev);
+    if (prev == nil())
+      prev_.undefine(next);
+  }
+  next_.set(n, nil());
+  next_.undefine(n);
+  prev_.set(n, nil());
+  prev_.undefine(n);
+}
+
+void
+tree::set_leaf_value(node_descriptor n, FloatColumn& col, float v)
+{
+  if (n >= num_nodes())
+    throw std::out_of_range("tree::set_leaf_value");
+  if (! is_leaf(n))
+    throw std::invalid_argument("tree::set_leaf_value");
+  const float delta = v - (n < col.size() ? col.fast_get(n) : 0);
+  col.set(n, v);
+  mark_dirty(n);
+  if (delta == 0)
+    return;
+  while (n != root && ! removed(n)) {
+    n = parent_.fast_get(n);
+    add_value(col, n, delta);
+    mark_dirty(n);
+  }
+}
+
+tree::node_descriptor
+tree::add_subtree(node_descriptor par,
+		  const node_descriptor * parents,
+		  unsigned count)
+{
+  if (count == 0)
+    throw std::invalid_argument("tree::add_subtree");
+  if (par >= num_nodes())
+    throw std::out_of_range("tree::add_subtree");
+  for (node_descriptor n = 1; n < count; n++)
+    if (parents[n] >= n)
+      throw std::out_of_range("tree::add_subtree");
+
+  // A leaf parent now sums its new children, all of value 0.
+  std::vector<FloatColumn*> cols;
+  summed_columns(cols);
+  std::vector<float> delta(cols.size(), 0.0f);
+  if (is_leaf(par))
+    for (unsigned j = 0; j < cols.size(); j++)
+      delta[j] = par < cols[j]->size() ? -cols[j]->fast_get(par) : 0;
+
+  const node_descriptor base = num_nodes();
+  resize(base + count);
+  for (node_descriptor n = 0; n < count; n++) {
+    link(base + n, n == 0 ? par : base + parents[n]);
+    mark_dirty(base + n);
+  }
+  mark_dirty(par);
+  add_to_sums(par, cols, delta);
+  return base;
+}
+
+void
+tree::remove_subtree(node_descriptor n)
+{
+  if (n >= num_nodes())
+    throw std::out_of_range("tree::remove_subtree");
+  if (n == root || removed(n))
+    throw std::invalid_argument("tree::remove_subtree");
+
+  std::vector<FloatColumn*> cols;
+  summed_columns(cols);
+  std::vector<float> delta(cols.size());
+  for (unsigned j = 0; j < cols.size(); j++)
+    delta[j] = n < cols[j]->size() ? -cols[j]->fast_get(n) : 0;
+
+  node_descriptor par = parent_.fast_get(n);
+  unlink(n);
+  parent_.set(n, nil());
+  parent_.undefine(n);
+  if (removed_.size() < num_nodes())
+    removed_.resize(num_nodes());
+  removed_.set(n);
+  mark_dirty(n);
+  mark_dirty(par);
+  add_to_sums(par, cols, delta);
+}
+
+void
+tree::move_subtree(node_descriptor n, node_descriptor par)
+{
+  if (n >= num_nodes() || par >= num_nodes())
+    throw std::out_of_range("tree::move_subtree");
+  if (n == root)
+    throw std::invalid_argument("tree::move_subtree");
+  for (node_descriptor m = par; ; m = parent_.fast_get(m)) {
+    if (m == n)
+      throw std::invalid_argument("tree::move_subtree");
+    if (m == root || removed(m))
+      break;
+  }
+
+  std::vector<FloatColumn*> cols;
+  summed_columns(cols);
+  std::vector<float> value(cols.size()), delta(cols.size());
+  for (unsigned j = 0; j < cols.size(); j++)
+    value[j] = n < cols[j]->size() ? cols[j]->fast_get(n) : 0;
+
+  if (! removed(n)) {
+    node_descriptor old = parent_.fast_get(n);
+    unlink(n);
+    for (unsigned j = 0; j < cols.size(); j++)
+      delta[j] = -value[j];
+    mark_dirty(old);
+    add_to_sums(old, cols, delta);
+  }
+  // A leaf parent loses its own value and now sums n alone.
+  const bool leaf = is_leaf(par);
+  for (unsigned j = 0; j < cols.size(); j++)
+    delta[j] = value[j] -
+      (leaf && par < cols[j]->size() ? cols[j]->fast_get(par) : 0);
+  link(n, par);
+  if (removed(n))
+    removed_.set(n, false);
+  mark_dirty(n);
+  mark_dirty(par);
+  add_to_sums(par, cols, delta);
+}
+
+void
+tree::shrink_to_fit()
+{
+  table::shrink_to_fit();
+  dirty_.shrink_to_fit();
+  dirty_list_.shrink_to_fit();
+  removed_.shrink_to_fit();
+}
+
+memory_size
+tree::memory_usage() const
+{
+  return table::memory_usage() + dirty_.memory_usage() +
+    vector_memory(dirty_list_) + removed_.memory_usage();
+}
+
 void
 tree::clear()
 {
@@ -108,13 +443,18 @@ tree::clear()
   next_.clear();
   next_.add(nil());		// next of root is nil always
   add_column(&next_);
+  prev_.clear();
+  prev_.add(nil());		// prev of root is nil always
+  add_column(&prev_);
   last_.clear();
   last_.add(nil());		// last child of root is nil so fat
   add_column(&last_);
   parent_.clear();
   parent_.add(nil());		// parent of root is always nil
   add_column(&parent_);
-  
+  dirty_.clear();
+  dirty_list_.clear();
+  removed_.clear();
 }
 
 struct print_tree_visitor
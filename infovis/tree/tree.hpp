@@ -100,6 +100,13 @@ public:
    */
   node_descriptor next(node_descriptor n) const { return next_[n]; }
 
+  /**
+   * Return the previous sibling of a node.
+   * @param n the node
+   * @return the previous sibling or the nil value if node is the first sibling
+   */
+  node_descriptor prev(node_descriptor n) const { return prev_[n]; }
+
   /**
    * Return the last child of a node.
    * @param n the node
@@ -174,9 +181,8 @@ public:
    * @return the degree of the node
    */
   degree_size_type degree(node_descriptor n) const {
-    node_descriptor last = last_[n];
     degree_size_type cnt = 0;
-    for (node_descriptor c = child_[n]; c != last; c = next_[c])
+    for (node_descriptor c = child_[n]; c != nil(); c = next_[c])
       cnt++;
     return cnt;
   }
@@ -200,11 +206,120 @@ public:
    */
   virtual node_descriptor add_node(node_descriptor n);
 
+  /**
+   * Replace the structure of the tree by the one described by an
+   * array of parents, in one pass instead of one add_node per node.
+   * The result is the same as adding the nodes 1 to count-1 in order
+   * with add_node(parents[i]).  The other columns are resized to count.
+   * @param parents the parent of each node, parents[0] being ignored
+   * and parents[i] < i for the others
+   * @param count the number of nodes, including the root
+   */
+  virtual void build_from_parents(const node_descriptor * parents,
+				  unsigned count);
+  void build_from_parents(const std::vector<node_descriptor>& parents) {
+    build_from_parents(parents.data(), unsigned(parents.size()));
+  }
+
+  /**
+   * Replace the structure of the tree by the one described by the
+   * depths of its nodes listed in preorder.
+   * @param depths the depth of each node, 0 for the root at index 0
+   * and at most one more than the depth of the previous node for the
+   * others
+   * @param count the number of nodes, including the root
+   */
+  void build_from_depths(const unsigned * depths, unsigned count);
+  void build_from_depths(const std::vector<unsigned>& depths) {
+    build_from_depths(depths.data(), unsigned(depths.size()));
+  }
+
+  /**
+   * Set the value of a leaf in a summed column and add the difference
+   * to the sums of its ancestors, in O(depth) instead of summing the
+   * whole tree again.
+   * @param n the leaf
+   * @param col the column, summed over the tree
+   * @param v the new value
+   */
+  void set_leaf_value(node_descriptor n, FloatColumn& col, float v);
+
+  /**
+   * Add a subtree under a node.  The new nodes are appended to the
+   * tree with a value of 0 in every column.  If par was a leaf, its
+   * own values are removed from the sums of its ancestors.
+   * @param par the parent of the subtree
+   * @param parents the parent of each node of the subtree, relative
+   * to the subtree root, parents[0] being ignored and parents[i] < i
+   * for the others
+   * @param count the number of nodes in the subtree
+   * @return the root of the subtree
+   */
+  virtual node_descriptor add_subtree(node_descriptor par,
+				      const node_descriptor * parents,
+				      unsigned count);
+
+  /**
+   * Detach a subtree from the tree, removing its values from the sums
+   * of its ancestors.  The nodes keep their indices and values but
+   * are no longer reachable from the root.  Runs in O(depth).
+   * @param n the root of the subtree
+   */
+  virtual void remove_subtree(node_descriptor n);
+
+  /**
+   * Move a subtree to the last child position of another node,
+   * updating the sums of the old and new ancestors.
+   * @param n the root of the subtree
+   * @param par the new parent, not in the subtree
+   */
+  virtual void move_subtree(node_descriptor n, node_descriptor par);
+
+  /**
+   * Check whether a node has been detached by remove_subtree.
+   * @param n the node
+   * @return true if n is the root of a removed subtree
+   */
+  bool removed(node_descriptor n) const {
+    return n < removed_.size() && removed_[n];
+  }
+
+  /**
+   * Return the nodes whose values or children changed through the
+   * mutation methods since the last clear_dirty(), each listed once.
+   * @return the dirty nodes
+   */
+  const std::vector<node_descriptor>& dirty_nodes() const { return dirty_list_; }
+
+  /**
+   * Check whether a node is dirty.
+   * @param n the node
+   * @return true if the node is dirty
+   */
+  bool is_dirty(node_descriptor n) const {
+    return n < dirty_.size() && dirty_[n];
+  }
+
+  /**
+   * Forget the dirty nodes, once the consumers have been updated.
+   */
+  void clear_dirty();
+
   /**
    * Clear the table.
    */
   virtual void clear();
 
+  /**
+   * Release the slack of the columns and of the dirty set.
+   */
+  virtual void shrink_to_fit();
+
+  /**
+   * Return the memory held by the tree, its columns and the dirty set.
+   */
+  virtual memory_size memory_usage() const;
+
 
   /**
    * Outputs a readable representation of the tree.
@@ -229,8 +344,10 @@ public:
     child_[n] = children.front();
     last_[n] = children.back();
     next_[children.back()] = root;
+    prev_[children.front()] = root;
     for (int i = 0; i < (children.size()-1); i++) {
       next_[children[i]] = children[i+1];
+      prev_[children[i+1]] = children[i];
     }
   }
 
@@ -372,10 +489,22 @@ public:
   };
 
 protected:
+  void mark_dirty(node_descriptor n);
+  void summed_columns(std::vector<FloatColumn*>& cols) const;
+  void add_to_sums(node_descriptor n,
+		   const std::vector<FloatColumn*>& cols,
+		   const std::vector<float>& delta);
+  void link(node_descriptor n, node_descriptor par);
+  void unlink(node_descriptor n);
+
   UnsignedColumn child_;
   UnsignedColumn next_;
+  UnsignedColumn prev_;
   UnsignedColumn last_;
   UnsignedColumn parent_;
+  bitmap dirty_;
+  std::vector<node_descriptor> dirty_list_;
+  bitmap removed_;		// roots of the removed subtrees
 };
 
 /**
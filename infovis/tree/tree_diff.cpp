@@ -0,0 +1,299 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree_diff.hpp>
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+namespace infovis {
+
+typedef tree::node_descriptor node_descriptor;
+typedef std::uint64_t path_key;
+
+const node_descriptor tree_diff::none;
+
+void
+tree_diff::clear()
+{
+  old_of_new.clear();
+  new_of_old.clear();
+  added.clear();
+  removed.clear();
+  changed.clear();
+}
+
+static inline path_key
+mix(path_key h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/**
+ * Open addressing table from path keys to nodes, keys being already
+ * well mixed.
+ */
+class key_table
+{
+public:
+  key_table() : mask_(0) { }
+
+  /// Empty the table and size it for n keys.
+  void reset(unsigned n) {
+    unsigned cap = 16;
+    while (cap < 2 * n)
+      cap *= 2;
+    mask_ = cap - 1;
+    keys_.resize(cap);
+    nodes_.assign(cap, tree_diff::none);
+  }
+
+  /// Insert a key unless already there, returning false then.
+  bool insert(path_key k, node_descriptor n) {
+    unsigned i = unsigned(k) & mask_;
+    while (nodes_[i] != tree_diff::none) {
+      if (keys_[i] == k)
+	return false;
+      i = (i + 1) & mask_;
+    }
+    keys_[i] = k;
+    nodes_[i] = n;
+    return true;
+  }
+
+  node_descriptor find(path_key k) const {
+    if (nodes_.empty())
+      return tree_diff::none;
+    unsigned i = unsigned(k) & mask_;
+    while (nodes_[i] != tree_diff::none) {
+      if (keys_[i] == k)
+	return nodes_[i];
+      i = (i + 1) & mask_;
+    }
+    return tree_diff::none;
+  }
+
+protected:
+  unsigned mask_;
+  std::vector<path_key> keys_;
+  std::vector<node_descriptor> nodes_;
+};
+
+/**
+ * Key tables split by the high bits of the keys, one per thread, so
+ * that they are filled in parallel without locking.
+ */
+class sharded_key_table
+{
+public:
+  /**
+   * Index the nodes of order by their keys.  On a duplicate key, the
+   * first node in order is kept.
+   */
+  sharded_key_table(const std::vector<node_descriptor>& order,
+		    const std::vector<path_key>& key, unsigned threads)
+    : shards_(std::max(1u, threads))
+  {
+    const unsigned n = unsigned(order.size());
+    std::vector<path_key> keys(n);
+    parallel_for(n, parallel_threads(n, threads),
+		 [&](unsigned, unsigned begin, unsigned end) {
+      for (unsigned i = begin; i < end; i++)
+	keys[i] = key[order[i]];
+    });
+    parallel_run(unsigned(shards_.size()), [&](unsigned s) {
+	unsigned count = 0;
+	for (unsigned i = 0; i < n; i++)
+	  if (shard(keys[i]) == s)
+	    count++;
+	shards_[s].reset(count);
+	for (unsigned i = 0; i < n; i++)
+	  if (shard(keys[i]) == s)
+	    shards_[s].insert(keys[i], order[i]);
+      });
+  }
+
+  node_descriptor find(path_key k) const { return shards_[shard(k)].find(k); }
+
+protected:
+  unsigned shard(path_key k) const {
+    return unsigned(k >> 32) % unsigned(shards_.size());
+  }
+
+  std::vector<key_table> shards_;
+};
+
+static inline const string&
+node_name(const StringColumn * names, node_descriptor n)
+{
+  static const string empty;
+  return names != 0 && n < names->size() ? names->fast_get(n) : empty;
+}
+
+/**
+ * Levels smaller than this are keyed on one thread.
+ */
+static const unsigned min_level_rows = 4096;
+
+/**
+ * Computes the path key of every node reachable from the root and the
+ * top-down order they have been computed in.
+ */
+static void
+path_keys(const tree& t, const StringColumn * names, unsigned threads,
+	  std::vector<node_descriptor>& order, std::vector<path_key>& key)
+{
+  const unsigned n = t.num_nodes();
+  key.resize(n);
+
+  parallel_for(n, parallel_threads(n, threads),
+	       [&](unsigned, unsigned begin, unsigned end) {
+    std::hash<string> h;
+    for (unsigned i = begin; i < end; i++)
+      key[i] = h(node_name(names, i));
+  });
+
+  // Breadth first, one level at a time, so parents are done before
+  // their children.  The parents of a level are split across the
+  // threads, each one writing the children of its parents at offsets
+  // counted beforehand, so that the order does not depend on the
+  // number of threads.  A path shared by siblings is bumped by its
+  // rank among them, the k-th duplicate getting the same key in both
+  // trees.
+  order.clear();
+  order.reserve(n);
+  order.push_back(tree::root);
+  key[tree::root] = 0;
+  std::vector<unsigned> offset;
+  for (unsigned first = 0, last = 1; first < last;
+       first = last, last = unsigned(order.size())) {
+    const unsigned level = last - first;
+    const unsigned th = parallel_threads(level, threads, min_level_rows);
+    offset.assign(level + 1, 0);
+    parallel_for(level, th, [&](unsigned, unsigned begin, unsigned end) {
+      for (unsigned i = begin; i < end; i++) {
+	unsigned count = 0;
+	for (node_descriptor c = t.child(order[first + i]); c != tree::nil();
+	     c = t.next(c))
+	  count++;
+	offset[i + 1] = count;
+      }
+    });
+    offset[0] = last;
+    for (unsigned i = 0; i < level; i++)
+      offset[i + 1] += offset[i];
+    order.resize(offset[level]);
+
+    parallel_for(level, th, [&](unsigned, unsigned begin, unsigned end) {
+      std::vector<std::pair<path_key, unsigned> > siblings;
+      for (unsigned i = begin; i < end; i++) {
+	const node_descriptor p = order[first + i];
+	unsigned o = offset[i];
+	for (node_descriptor c = t.child(p); c != tree::nil(); c = t.next(c)) {
+	  key[c] = mix(key[p] * 31 + key[c]);
+	  order[o++] = c;
+	}
+	if (o - offset[i] < 2)
+	  continue;
+	siblings.clear();
+	for (unsigned j = offset[i]; j < o; j++)
+	  siblings.push_back(std::make_pair(key[order[j]], j));
+	std::sort(siblings.begin(), siblings.end());
+	for (unsigned j = 1, rank = 1; j < siblings.size(); j++) {
+	  if (siblings[j].first != siblings[j - 1].first) {
+	    rank = 1;
+	    continue;
+	  }
+	  key[order[siblings[j].second]] = mix(siblings[j].first + rank++);
+	}
+      }
+    });
+  }
+}
+
+void
+diff_trees(const tree& from, const tree& to, tree_diff& result,
+	   const string& name, const string& weight, unsigned threads)
+{
+  const StringColumn * from_names = StringColumn::cast(from.find_column(name));
+  const StringColumn * to_names = StringColumn::cast(to.find_column(name));
+  if (threads == 0)
+    threads = parallel_threads(from.num_nodes() + to.num_nodes());
+
+  std::vector<node_descriptor> from_order, to_order;
+  std::vector<path_key> from_key, to_key;
+  path_keys(from, from_names, threads, from_order, from_key);
+  path_keys(to, to_names, threads, to_order, to_key);
+  const sharded_key_table index(from_order, from_key, threads);
+
+  result.clear();
+  result.old_of_new.assign(to.num_nodes(), tree_diff::none);
+  result.new_of_old.assign(from.num_nodes(), tree_diff::none);
+
+  // The candidates are looked up in parallel, then checked top-down
+  // against the match of their parent.
+  const unsigned count = unsigned(to_order.size());
+  parallel_for(count, parallel_threads(count, threads),
+	       [&](unsigned, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; i++) {
+      const node_descriptor n = to_order[i];
+      const node_descriptor o = index.find(to_key[n]);
+      if (o != tree_diff::none && (n == tree::root ||
+	  node_name(to_names, n) == node_name(from_names, o)))
+	result.old_of_new[n] = o;
+    }
+  });
+
+  const FloatColumn * from_weight = FloatColumn::cast(from.find_column(weight));
+  const FloatColumn * to_weight = FloatColumn::cast(to.find_column(weight));
+  const bool compare = from_weight != 0 && to_weight != 0;
+  for (node_descriptor n : to_order) {
+    node_descriptor o = result.old_of_new[n];
+    if (o != tree_diff::none && n != tree::root &&
+	(o == tree::root ||
+	 result.old_of_new[to.parent(n)] != from.parent(o)))
+      o = tree_diff::none;	// hash collision
+    if (o == tree_diff::none) {
+      result.old_of_new[n] = o;
+      result.added.push_back(n);
+      continue;
+    }
+    result.new_of_old[o] = n;
+    if (compare &&
+	(n < to_weight->size() ? to_weight->fast_get(n) : 0) !=
+	(o < from_weight->size() ? from_weight->fast_get(o) : 0))
+      result.changed.push_back(n);
+  }
+  for (node_descriptor o : from_order)
+    if (result.new_of_old[o] == tree_diff::none)
+      result.removed.push_back(o);
+}
+
+} // namespace infovis
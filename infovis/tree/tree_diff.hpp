@@ -0,0 +1,78 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TREE_TREE_DIFF_HPP
+#define INFOVIS_TREE_TREE_DIFF_HPP
+
+#include <infovis/tree/tree.hpp>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Correspondence between the nodes of two trees, typically two scans
+ * of the same directory taken at different times.
+ */
+struct tree_diff
+{
+  typedef tree::node_descriptor node_descriptor;
+  static const node_descriptor none = node_descriptor(-1); ///< no match
+
+  std::vector<node_descriptor> old_of_new; ///< for each new node, its old node or none
+  std::vector<node_descriptor> new_of_old; ///< for each old node, its new node or none
+  std::vector<node_descriptor> added;      ///< new nodes without an old node
+  std::vector<node_descriptor> removed;    ///< old nodes without a new node
+  std::vector<node_descriptor> changed;    ///< new nodes matched but with another weight
+
+  void clear();
+};
+
+/**
+ * Match the nodes of two trees by path in O(n).
+ *
+ * The path of a node is the list of the names from the root, the
+ * root itself always matching.  The names are hashed in parallel and
+ * combined top-down into path hashes, in parallel over the nodes of
+ * each level, the k-th sibling sharing its path with previous ones
+ * matching the k-th in the other tree.
+ * Matches are checked on names and parents so hash collisions never
+ * produce a wrong match.  Nodes detached by tree::remove_subtree are
+ * ignored.
+ *
+ * @param from the old tree
+ * @param to the new tree
+ * @param result the correspondence
+ * @param name the name of the column holding the node names
+ * @param weight the name of a float column compared on matched
+ * nodes, ignored when missing in one of the trees
+ * @param threads the number of threads, 0 for the hardware concurrency
+ */
+void diff_trees(const tree& from, const tree& to, tree_diff& result,
+		const string& name = "name",
+		const string& weight = "size",
+		unsigned threads = 0);
+
+} // namespace infovis
+
+#endif // INFOVIS_TREE_TREE_DIFF_HPP
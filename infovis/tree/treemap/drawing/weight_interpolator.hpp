@@ -25,6 +25,8 @@
 #ifndef INFOVIS_TREE_TREEMAP_DRAWING_WEIGHT_INTERPOLATOR_HPP
 #define INFOVIS_TREE_TREEMAP_DRAWING_WEIGHT_INTERPOLATOR_HPP
 
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
 #include <vector>
 #ifndef NDEBUG
 #include <cassert>
@@ -72,8 +74,44 @@ struct weight_interpolator
 #endif
     return ret;
   }
+
+  /**
+   * Stores the interpolated weights of indices [begin, end) in out,
+   * with the same arithmetic as operator[] but straight from the
+   * column data so the loop vectorizes.
+   */
+  void materialize(float * out, unsigned begin, unsigned end) const {
+    const value_type * f = from->data();
+    const value_type * t = to->data();
+    const float p = param;
+    const float q = 1.0f - param;
+    const float b = balance;
+    for (unsigned i = begin; i < end; i++)
+      out[i] = q * f[i] + p * t[i] * b;
+  }
 };
 
+/**
+ * Materializes the interpolated weights of the first n indices into
+ * out, so a layout can read them once per frame instead of blending
+ * the two columns on every access.
+ * @param w the interpolator
+ * @param out the scratch column, resized to n
+ * @param n the number of weights
+ * @param threads the number of threads, 0 for one per core
+ */
+template <class T>
+void materialize(const weight_interpolator<T>& w, std::vector<float>& out,
+		 unsigned n, unsigned threads = 0)
+{
+  out.resize(n);
+  float * data = out.data();
+  parallel_for(n, parallel_threads(n, threads),
+	       [&w, data](unsigned, unsigned begin, unsigned end) {
+    w.materialize(data, begin, end);
+  });
+}
+
 template <class T>
 inline typename weight_interpolator<T>::value_type
 get(const weight_interpolator<T>& pa, int k) { return pa[k]; }
@@ -0,0 +1,98 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INFOVIS_TREE_TREEMAP_FRONTIER_HPP
+#define INFOVIS_TREE_TREEMAP_FRONTIER_HPP
+
+#include <infovis/alloc.hpp>
+#include <infovis/drawing/direction.hpp>
+#include <chrono>
+#include <deque>
+
+namespace infovis {
+
+/**
+ * Boxes waiting to be laid out when a treemap is drawn breadth
+ * first.  The items are consumed in the order they were pushed, so
+ * all the boxes of one level are drawn before those of the next and
+ * an interrupted traversal shows the top of the hierarchy.
+ */
+template <class Box, class Node>
+class treemap_frontier
+{
+public:
+  struct item {
+    Box box;
+    Node n;
+    unsigned depth;
+    direction dir;		// only used by slice and dice
+    bool accepted;		// begin_box already returned true
+  };
+
+  bool empty() const { return items_.empty(); }
+  std::size_t size() const { return items_.size(); }
+  void clear() { items_.clear(); }
+  void push(const Box& box, Node n, unsigned depth, bool accepted,
+	    direction dir = left_to_right) {
+    items_.push_back(item{box, n, depth, dir, accepted});
+  }
+  item pop() {
+    item ret = items_.front();
+    items_.pop_front();
+    return ret;
+  }
+
+protected:
+  // A deque grows by blocks, a vector would copy millions of items in
+  // the middle of a slice.
+  std::deque<item> items_;
+};
+
+/**
+ * Budget of a slice of a breadth first traversal: returns true once
+ * the given time has elapsed since construction.  The clock is only
+ * read every 32 calls, a slice overshooting by at most 31 boxes.
+ */
+class frame_budget
+{
+public:
+  typedef std::chrono::steady_clock clock;
+
+  explicit frame_budget(std::chrono::microseconds budget)
+    : deadline_(clock::now() + budget), count_(0) { }
+
+  bool operator()() {
+    if ((++count_ & 31) != 0)
+      return false;
+    return clock::now() >= deadline_;
+  }
+
+protected:
+  clock::time_point deadline_;
+  unsigned count_;
+};
+
+} // namespace infovis
+
+#endif // INFOVIS_TREE_TREEMAP_FRONTIER_HPP
@@ -32,8 +32,10 @@
 #include <infovis/tree/sum_weight_visitor.hpp>
 #include <infovis/drawing/direction.hpp>
 #include <infovis/tree/treemap/treemap.hpp>
+#include <infovis/tree/treemap/frontier.hpp>
 #include <infovis/tree/treemap/drawing/drawer.hpp>
 #include <infovis/tree/treemap/drawing/weight_interpolator.hpp>
+#include <vector>
 
 namespace infovis {
 
@@ -73,89 +75,185 @@ struct treemap_slice_and_dice :
 			 WeightMap wm,
 			 Drawer drawer,
 			 Filter filter)
-    : super(tree, wm, drawer,filter)
+    : super(tree, wm, drawer,filter),
+      deferred_(false)
   { }
 
   treemap_slice_and_dice(const Tree& tree,
 			 WeightMap wm,
 			 Drawer drawer = Drawer())
-    : super(tree, wm, drawer)
+    : super(tree, wm, drawer),
+      deferred_(false)
   { }
 
+  /**
+   * Lays out the subtree rooted at n inside box.  The traversal keeps
+   * its own stack of frames instead of recursing, so the depth of the
+   * tree is not limited by the size of the call stack; the drawer
+   * receives the same calls, in the same order, as a recursive
+   * descent.
+   *
+   * @return the number of boxes accepted by the drawer.
+   */
   unsigned visit(direction dir, const Box& box,
 		 typename tree_traits<Tree>::node_descriptor n,
 		 unsigned depth = 0)
+  {
+    const std::size_t base = stack_.size();
+    const unsigned ret = enter(dir, box, n, depth);
+    return ret + descend(base);
+  }
+
+  /**
+   * Starts laying out the subtree rooted at n breadth first, in
+   * slices drawn by resume().
+   */
+  void start_progressive(direction dir, const Box& box,
+			 node_descriptor n, unsigned depth = 0)
+  {
+    frontier_.clear();
+    frontier_.push(box, n, depth, false, dir);
+  }
+
+  /**
+   * Lays out the boxes of the frontier, one level after the other,
+   * until the frontier is empty or the budget is exhausted.  The
+   * drawer receives the same calls with the same boxes as with
+   * visit(), in another order.
+   *
+   * @param budget functor returning true to stop the slice, called
+   * after each box
+   * @return the number of boxes accepted by the drawer in this slice.
+   */
+  template <class Budget>
+  unsigned resume(Budget budget)
+  {
+    unsigned ret = 0;
+    deferred_ = true;
+    while (! frontier_.empty()) {
+      const auto item = frontier_.pop();
+      const std::size_t base = stack_.size();
+      if (item.accepted)
+	open(item.dir, item.box, item.n, item.depth);
+      else
+	ret += enter(item.dir, item.box, item.n, item.depth);
+      ret += descend(base);
+      if (budget())
+	break;
+    }
+    deferred_ = false;
+    return ret;
+  }
+
+  /// True when the last progressive layout has been drawn completely.
+  bool finished() const { return frontier_.empty(); }
+
+protected:
+  /**
+   * State of a node whose children are being laid out.
+   */
+  struct frame {
+    Box box;			// box passed to begin_box
+    Box inner;			// box after draw_border
+    node_descriptor n;
+    unsigned depth;
+    direction dir;
+    children_iterator i, end;
+    float tw;			// weight of n
+    float pos;			// start of the next child along dir
+  };
+
+  /**
+   * Lays out the frames pushed above base, until they are all closed.
+   * @return the number of boxes accepted by the drawer.
+   */
+  unsigned descend(std::size_t base)
+  {
+    unsigned ret = 0;
+    while (stack_.size() > base) {
+      frame& f = stack_.back();
+      while (f.i != f.end && this->filter_(*f.i))
+	++f.i;
+      if (f.i == f.end) {
+	this->drawer_.end_strip(f.box, f.n, f.depth, f.dir);
+	this->drawer_.end_box(f.box, f.n, f.depth);
+	stack_.pop_back();
+	continue;
+      }
+      const auto child = *f.i++;
+      const Box& b = f.inner;
+      // enter() may grow the stack, so f is not used after the call.
+      if (f.dir == left_to_right) {
+	const float nw = width(b) * infovis::get(this->weight_, child) / f.tw;
+	const float x = f.pos;
+	const float e = coord_type(x+nw);
+	f.pos += nw;
+	ret += enter_child(flip(f.dir), Box(x,ymin(b),e,ymax(b)),
+			   child, f.depth+1);
+      }
+      else {
+	const float nh = height(b) * infovis::get(this->weight_, child) / f.tw;
+	const float y = f.pos;
+	const float e = coord_type(y+nh);
+	f.pos += nh;
+	ret += enter_child(flip(f.dir), Box(xmin(b),y,xmax(b),e),
+			   child, f.depth+1);
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * Opens the box of n.  Leaves are drawn and closed immediately,
+   * interior nodes are pushed on the stack.
+   */
+  unsigned enter(direction dir, const Box& box, node_descriptor n,
+		 unsigned depth)
   {
     if (! this->drawer_.begin_box(box,n,depth))
       return 0;
+    open(dir, box, n, depth);
+    return 1;
+  }
+
+  /**
+   * Opens the box of n, already accepted by the drawer.
+   */
+  void open(direction dir, const Box& box, node_descriptor n,
+	    unsigned depth)
+  {
     Box b(box);
-    unsigned ret = 1;
     this->drawer_.draw_border(b, n, depth);
     if (is_leaf(n,this->tree_)) {
       this->drawer_.draw_box(b, n, depth);
+      this->drawer_.end_box(box,n,depth);
+      return;
     }
-    else {
-      const float tw = infovis::get(this->weight_, n);
-
-      this->drawer_.begin_strip(box, n, depth, dir);
-      if (dir == left_to_right) {
-	dist_type w = width(b);
-	float x = xmin(b); // + w * weight_[n] / (2*tw);
-
-#if 0
-	if (x > xmin(b)) {
-	  this->drawer_.draw_box(Box(xmin(b),ymin(b),x,ymax(b)), n, depth);
-	}
-#endif
-	// C++17 structured bindings 
-	for (auto [i, end] = children(n,this->tree_); i != end; i++) {
-	  const auto child = *i;
-	  if (this->filter_(child))
-	    continue;
-	  const float nw = w * infovis::get(this->weight_, child) / tw;
-	  const float e = /*(i == (end-1)) ? xmax(b) : */coord_type(x+nw);
-	  ret += visit(flip(dir),
-		       Box(x,ymin(b),e,ymax(b)),
-		       child, depth+1);
-	  x += nw;
-	}
-#if 0
-	if (x < xmax(b)) {
-	  this->drawer_.draw_box(Box(x,ymin(b),xmax(b),ymax(b)), n, depth);
-	}
-#endif
-      }
-      else {
-	dist_type h = height(b);
-	float y = ymin(b); // + h * weight_[n] / (2*tw);
-
-#if 0
-	if (y > ymin(b)) {
-	  this->drawer_.draw_box(Box(xmin(b),ymin(b),xmax(b),y), n, depth);
-	}
-#endif
-	// C++17 structured bindings
-	for (auto [i, end] = children(n,this->tree_); i != end; i++) {
-	  const auto child = *i;
-	  if (this->filter_(child))
-	    continue;
-	  const float nh = h * infovis::get(this->weight_, child) / tw;
-	  const float e = /* (i == (end-1)) ? ymax(b) : */coord_type(y+nh);
-	  ret += visit(flip(dir),
-		       Box(xmin(b),y,xmax(b),e), child, depth+1);
-	  y += nh;
-	}
-#if 0
-	if (y < ymax(b)) {
-	  this->drawer_.draw_box(Box(xmin(b),y,xmax(b),ymax(b)), n, depth);
-	}
-#endif
-      }
-      this->drawer_.end_strip(box, n, depth, dir);
-    }
-    this->drawer_.end_box(box,n,depth);
-    return ret;
+    this->drawer_.begin_strip(box, n, depth, dir);
+    auto [i, end] = children(n,this->tree_);
+    stack_.push_back(frame{box, b, n, depth, dir, i, end,
+			   infovis::get(this->weight_, n),
+			   dir == left_to_right ? xmin(b) : ymin(b)});
   }
+
+  /**
+   * Opens the box of a child or, when laying out breadth first,
+   * pushes it on the frontier once accepted by the drawer.
+   */
+  unsigned enter_child(direction dir, const Box& box, node_descriptor n,
+		       unsigned depth)
+  {
+    if (! deferred_)
+      return enter(dir, box, n, depth);
+    if (! this->drawer_.begin_box(box,n,depth))
+      return 0;
+    frontier_.push(box, n, depth, true, dir);
+    return 1;
+  }
+
+  std::vector<frame> stack_;
+  treemap_frontier<Box, node_descriptor> frontier_;
+  bool deferred_;		// children go to the frontier
 };
 } // namespace infovis
 
@@ -31,10 +31,12 @@
 #include <infovis/tree/tree_concepts.hpp>
 #include <infovis/tree/sum_weight_visitor.hpp>
 #include <infovis/tree/treemap/treemap.hpp>
+#include <infovis/tree/treemap/frontier.hpp>
 #include <infovis/tree/treemap/drawing/drawer.hpp>
 #include <tuple> // TODO: Added for std::tie - C++17 modernization
 
 #include <cassert>
+#include <vector>
 
 namespace infovis {
 
@@ -92,97 +94,83 @@ struct treemap_squarified
 		     Orient orient = Orient(),
 		     Filter filter = Filter())
     : super(tree, wm, drawer,filter),
-      orient_(orient)
+      orient_(orient),
+      sorted_(false),
+      deferred_(false)
   { }
 
+  /**
+   * Declares that the children of every node are sorted by decreasing
+   * weight.  Strips are then broken with squarify_sorted, which
+   * searches over running sums instead of growing each strip one
+   * child at a time.
+   */
+  void set_sorted(bool sorted) { sorted_ = sorted; }
+  bool is_sorted() const { return sorted_; }
+
+  /**
+   * Lays out the subtree rooted at n inside box.  The traversal keeps
+   * its own stack of frames instead of recursing, so the depth of the
+   * tree is not limited by the size of the call stack; the drawer
+   * receives the same calls, in the same order, as a recursive
+   * descent.
+   *
+   * @return the number of boxes accepted by the drawer.
+   */
   unsigned visit(const box_type& box,
 		 typename tree_traits<Tree>::node_descriptor n,
 		 unsigned depth = 0)
   {
-    if (! this->drawer_.begin_box(box,n,depth)) return 0;
-    box_type b(box);
-    unsigned ret = 1;
-    this->drawer_.draw_border(b, n, depth);
-    if (is_leaf(n,this->tree_)) {
-      this->drawer_.draw_box(b, n, depth);
-    }
-    else {
-      ret = visit_strips(b, n, depth);
-    }
-    this->drawer_.end_box(box,n, depth);
-    return ret;
-  }    
-  
-  unsigned visit_strips(box_type& b,
-			typename tree_traits<Tree>::node_descriptor n,
-			unsigned depth)
+    const std::size_t base = stack_.size();
+    const unsigned ret = enter(box, n, depth);
+    return ret + descend(base);
+  }
+
+  /**
+   * Starts laying out the subtree rooted at n breadth first, in
+   * slices drawn by resume().
+   */
+  void start_progressive(const box_type& box, node_descriptor n,
+			 unsigned depth = 0)
   {
-    const float tw = infovis::get(this->weight_,n);
-    unsigned ret = 1;
+    frontier_.clear();
+    frontier_.push(box, n, depth, false);
+  }
 
-    // C++17 structured bindings instead of std::tie
-    auto [i, end] = children(n, this->tree_);
-    const float scale = width(b) * height(b) / tw;
-    if (scale == 0) {
-#if 0
-      while (i != end) {
-	node_descriptor child = *i;
-	ret += visit(b, child, depth+1);
-	i++;
-      }
-#else
-      // nothing
-#endif
-    }
-    else while (i != end) {
-      if (this->filter_(*i)) {
-	continue;
-      }
-      if (orient_(b, n, depth)) {
-	dist_type w = height(b);
-	float y = ymin(b);
-	float width;
-
-	this->drawer_.begin_strip(b, n, depth, bottom_to_top);
-	auto e = squarify(i, end, w, scale, width);
-	if (width == 0) {
-	  // can happen if all the remaining children have a weight==0
-	  i = e;
-	}
-	for (; i != e; i++) {
-	  const auto child = *i;
-	  const float nw = infovis::get(this->weight_,child) * scale / width;
-	  ret += visit(box_type(xmin(b),y,xmin(b)+width,y+nw),
-		       child, depth+1);
-	  y += nw;
-	}
-	set_xmin(b, width + xmin(b));
-	this->drawer_.end_strip(b, n, depth, bottom_to_top);
-      }
-      else {
-	dist_type w = width(b);
-	float x = xmin(b);
-	float width;
-	this->drawer_.begin_strip(b, n, depth, left_to_right);
-	auto e = squarify(i, end, w, scale, width);
-	if (width == 0) {
-	  // can happen if all the remaining children have a weight==0
-	  i = e;
-	}
-	for (; i != e; i++) {
-	  const auto child = *i;
-	  const float nw = infovis::get(this->weight_,child) * scale / width;
-	  ret += visit(box_type(x, ymin(b), x+nw, ymin(b)+width),
-		       child, depth+1);
-	  x += nw;
-	}
-	set_ymin(b, width + ymin(b));
-	this->drawer_.end_strip(b, n, depth, left_to_right);
-      }
+  /**
+   * Lays out the boxes of the frontier, one level after the other,
+   * until the frontier is empty or the budget is exhausted.  Each box
+   * is laid out completely and the boxes of its children are pushed
+   * on the frontier, so the drawer receives the same calls with the
+   * same boxes as with visit(), in another order.
+   *
+   * @param budget functor returning true to stop the slice, called
+   * after each box
+   * @return the number of boxes accepted by the drawer in this slice.
+   */
+  template <class Budget>
+  unsigned resume(Budget budget)
+  {
+    unsigned ret = 0;
+    deferred_ = true;
+    while (! frontier_.empty()) {
+      const auto item = frontier_.pop();
+      const std::size_t base = stack_.size();
+      if (item.accepted)
+	open(item.box, item.n, item.depth);
+      else
+	ret += enter(item.box, item.n, item.depth);
+      ret += descend(base);
+      if (budget())
+	break;
     }
+    deferred_ = false;
     return ret;
   }
 
+  /// True when the last progressive layout has been drawn completely.
+  bool finished() const { return frontier_.empty(); }
+
   children_iterator squarify(children_iterator beg,
 			     children_iterator end,
 			     float length,
@@ -193,7 +181,8 @@ struct treemap_squarified
     float s = 0;
     while (beg != end && s == 0) {
       if (! this->filter_(*beg))
-	s = infovis::get(this->weight_,*beg++) * scale;
+	s = infovis::get(this->weight_,*beg) * scale;
+      beg++;
     }
     width = s / length;
     if (beg == end) {
@@ -205,8 +194,10 @@ struct treemap_squarified
     float worst = std::max(length / width, width / length);
     float w2 = length * length;
     while (beg != end) {
-      if (this->filter_(*beg))
+      if (this->filter_(*beg)) {
+	beg++;
 	continue;
+      }
       float area = infovis::get(this->weight_,*beg) * scale;
       if (area == 0) {
 	beg++;
@@ -229,7 +220,277 @@ struct treemap_squarified
     width = s / length;
     return beg;
   }
+
+  /**
+   * Variant of squarify for children sorted by decreasing area.  The
+   * worst aspect ratio of a strip first decreases, while the strip is
+   * too thin, then increases, so the break is found by galloping to
+   * the point where the two terms of the ratio cross instead of
+   * testing every child.  The strips are the same as squarify's as
+   * long as the running sums are exact in float, e.g. integer areas
+   * below 2^24; otherwise a break may move by one child on a tie.
+   *
+   * @param area the areas of the children, 0 for filtered ones.
+   * @param sums the running sums of area, sums[k] being the sum of the
+   * first k areas.
+   * @param first the index of the first child of the strip.
+   * @param positive the index following the last non zero area.
+   * @param count the number of children.
+   * @param length the length of the strip.
+   * @param width set to the width of the strip.
+   * @return the index of the first child after the strip.
+   */
+  unsigned squarify_sorted(const float * area,
+			   const double * sums,
+			   unsigned first,
+			   unsigned positive,
+			   unsigned count,
+			   float length,
+			   float &width) const
+  {
+    assert(length != 0);
+    unsigned j = first;
+    while (j < count && area[j] == 0)
+      j++;
+    if (j == count) {
+      width = 0 / length;
+      return count;
+    }
+    const float max_area = area[j];
+    width = max_area / length;
+    if (++j >= positive)
+      return count;
+    const float w2 = length * length;
+    // Same expressions as squarify, on the sum of children first..t.
+    auto sum = [&](unsigned t) { return float(sums[t+1] - sums[first]); };
+    auto thin = [&](float s) { return w2*max_area/(s*s); };
+    auto thick = [&](float s, unsigned t) { return (s*s)/(w2*area[t]); };
+
+    float worst = std::max(length / width, width / length);
+    unsigned t = j;
+    float s = sum(t);
+    if (thick(s, t) < thin(s)) {
+      // Gallop to the first child c where the strip stops being thin;
+      // before it the ratio cannot increase.
+      unsigned lo = t, hi = t + 1, step = 1;
+      const float w = std::max(thin(s), thick(s, t));
+      if (w > worst) {
+	width = (s - area[t]) / length;
+	return t;
+      }
+      while (hi < positive && thick(sum(hi), hi) < thin(sum(hi))) {
+	lo = hi;
+	step *= 2;
+	hi = (positive - t > step) ? t + step : positive;
+      }
+      while (hi - lo > 1) {
+	const unsigned mid = lo + (hi - lo) / 2;
+	const float sm = sum(mid);
+	if (thick(sm, mid) < thin(sm))
+	  lo = mid;
+	else
+	  hi = mid;
+      }
+      if (hi == positive) {
+	width = float(sums[count] - sums[first]) / length;
+	return count;
+      }
+      t = lo;
+      s = sum(t);
+      worst = thin(s);
+      t = hi;
+    }
+    for (; t < positive; t++) {
+      s = sum(t);
+      const float cur_worst = std::max(thin(s), thick(s, t));
+      if (cur_worst > worst) {
+	width = (s - area[t]) / length;
+	return t;
+      }
+      worst = cur_worst;
+    }
+    width = float(sums[count] - sums[first]) / length;
+    return count;
+  }
+
   Orient orient_;
+  bool sorted_;
+
+protected:
+  /**
+   * State of a node whose strips are being laid out.
+   */
+  struct frame {
+    box_type box;		// box passed to begin_box
+    box_type b;			// remaining space, shrinks strip by strip
+    node_descriptor n;
+    unsigned depth;
+    children_iterator i, end;
+    children_iterator e;	// end of the current strip
+    float scale;
+    float width;		// thickness of the current strip
+    float pos;			// start of the next child in the strip
+    direction dir;
+    bool open;			// true between begin_strip and end_strip
+    std::size_t sums;		// offset in areas_ and sums_, or unsorted
+    unsigned index;		// index of i among the children
+    unsigned stop;		// index ending the current strip
+    unsigned positive;		// index following the last non zero area
+    unsigned count;		// number of children
+  };
+
+  static constexpr std::size_t unsorted = std::size_t(-1);
+
+  /**
+   * Lays out the frames pushed above base, until they are all closed.
+   * @return the number of boxes accepted by the drawer.
+   */
+  unsigned descend(std::size_t base)
+  {
+    unsigned ret = 0;
+    while (stack_.size() > base) {
+      frame& f = stack_.back();
+      if (! f.open) {
+	if (f.i == f.end) {
+	  this->drawer_.end_box(f.box, f.n, f.depth);
+	  if (f.sums != unsorted) {
+	    areas_.resize(f.sums);
+	    sums_.resize(f.sums);
+	  }
+	  stack_.pop_back();
+	  continue;
+	}
+	if (this->filter_(*f.i)) {
+	  ++f.i;
+	  ++f.index;
+	  continue;
+	}
+	f.dir = orient_(f.b, f.n, f.depth) ? bottom_to_top : left_to_right;
+	const dist_type w = (f.dir == bottom_to_top) ? height(f.b) : width(f.b);
+	if (w == 0) {
+	  // rounding errors used up the box before the last children
+	  f.i = f.end;
+	  continue;
+	}
+	this->drawer_.begin_strip(f.b, f.n, f.depth, f.dir);
+	if (f.sums != unsorted)
+	  f.stop = squarify_sorted(&areas_[f.sums], &sums_[f.sums],
+				   f.index, f.positive, f.count, w, f.width);
+	else
+	  f.e = squarify(f.i, f.end, w, f.scale, f.width);
+	if (f.width == 0) {
+	  // can happen if all the remaining children have a weight==0
+	  f.i = f.e;
+	  f.index = f.stop;
+	}
+	f.pos = (f.dir == bottom_to_top) ? ymin(f.b) : xmin(f.b);
+	f.open = true;
+	continue;
+      }
+      if (f.sums != unsorted ? f.index == f.stop : f.i == f.e) {
+	if (f.dir == bottom_to_top)
+	  set_xmin(f.b, f.width + xmin(f.b));
+	else
+	  set_ymin(f.b, f.width + ymin(f.b));
+	this->drawer_.end_strip(f.b, f.n, f.depth, f.dir);
+	f.open = false;
+	continue;
+      }
+      const auto child = *f.i++;
+      if (this->filter_(child)) {
+	f.index++;		// skipped by squarify too
+	continue;
+      }
+      const float area = (f.sums != unsorted) ? areas_[f.sums + f.index]
+	: infovis::get(this->weight_,child) * f.scale;
+      f.index++;
+      const float nw = area / f.width;
+      const box_type& b = f.b;
+      const float p = f.pos;
+      f.pos += nw;
+      // enter() may grow the stack, so f is not used after the call.
+      if (f.dir == bottom_to_top)
+	ret += enter_child(box_type(xmin(b),p,xmin(b)+f.width,p+nw),
+			   child, f.depth+1);
+      else
+	ret += enter_child(box_type(p, ymin(b), p+nw, ymin(b)+f.width),
+			   child, f.depth+1);
+    }
+    return ret;
+  }
+
+  /**
+   * Opens the box of n.  Leaves are drawn and closed immediately,
+   * interior nodes are pushed on the stack.
+   */
+  unsigned enter(const box_type& box, node_descriptor n, unsigned depth)
+  {
+    if (! this->drawer_.begin_box(box,n,depth)) return 0;
+    open(box, n, depth);
+    return 1;
+  }
+
+  /**
+   * Opens the box of n, already accepted by the drawer.
+   */
+  void open(const box_type& box, node_descriptor n, unsigned depth)
+  {
+    box_type b(box);
+    this->drawer_.draw_border(b, n, depth);
+    if (is_leaf(n,this->tree_)) {
+      this->drawer_.draw_box(b, n, depth);
+      this->drawer_.end_box(box,n, depth);
+      return;
+    }
+    const float tw = infovis::get(this->weight_,n);
+    auto [i, end] = children(n, this->tree_);
+    const float scale = width(b) * height(b) / tw;
+    if (scale == 0)
+      i = end;
+    std::size_t sums = unsorted;
+    unsigned count = 0, positive = 0;
+    if (sorted_ && i != end) {
+      // Areas and running sums of the children, stacked like the frames.
+      sums = areas_.size();
+      double sum = 0;
+      for (auto c = i; c != end; ++c) {
+	const float area =
+	  this->filter_(*c) ? 0 : infovis::get(this->weight_,*c) * scale;
+	areas_.push_back(area);
+	sums_.push_back(sum);
+	sum += area;
+	count++;
+	if (area != 0)
+	  positive = count;
+      }
+      areas_.push_back(0);
+      sums_.push_back(sum);
+    }
+    stack_.push_back(frame{box, b, n, depth, i, end, end, scale, 0, 0,
+			   left_to_right, false, sums, 0, 0, positive, count});
+  }
+
+  /**
+   * Opens the box of a child or, when laying out breadth first,
+   * pushes it on the frontier once accepted by the drawer: a box
+   * hidden by the drawer then costs no more than with visit().
+   */
+  unsigned enter_child(const box_type& box, node_descriptor n,
+		       unsigned depth)
+  {
+    if (! deferred_)
+      return enter(box, n, depth);
+    if (! this->drawer_.begin_box(box,n,depth))
+      return 0;
+    frontier_.push(box, n, depth, true);
+    return 1;
+  }
+
+  std::vector<frame> stack_;
+  std::vector<float> areas_;
+  std::vector<double> sums_;
+  treemap_frontier<box_type, node_descriptor> frontier_;
+  bool deferred_;		// children go to the frontier
 };
 
 } // namespace infovis
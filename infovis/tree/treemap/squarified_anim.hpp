@@ -26,6 +26,8 @@
 #define INFOVIS_TREE_TREEMAP_SQUARIFIED_ANIM_HPP
 
 #include <infovis/tree/treemap/squarified.hpp>
+#include <infovis/tree/treemap/drawing/weight_interpolator.hpp>
+#include <vector>
 
 namespace infovis {
 
@@ -147,7 +149,197 @@ struct treemap_squarified_anim :
     }
     return s / length;
   };
+
+  /**
+   * Records the part of visit_anim that only depends on the first
+   * weights: the box of every node and how its children are grouped
+   * into strips.  During a transition only the second weights change,
+   * so each frame can then be drawn with interpolate and
+   * visit_prepared.
+   * @param box the box of the first layout
+   * @param n the root of the layout
+   * @param depth the depth of n
+   */
+  void prepare(const Box& box,
+	       typename tree_traits<Tree>::node_descriptor n,
+	       unsigned depth = 0)
+  {
+    nodes_.assign(1, n);
+    boxes_.assign(1, box);
+    depths_.assign(1, depth);
+    first_child_.clear();
+    first_strip_.clear();
+    strips_.clear();
+    // Breadth first, so that the children of a node are contiguous.
+    for (unsigned k = 0; k < nodes_.size(); k++) {
+      first_child_.push_back(unsigned(nodes_.size()));
+      first_strip_.push_back(unsigned(strips_.size()));
+      const node_descriptor m = nodes_[k];
+      if (degree(m,this->tree_) == 0)
+	continue;
+      const unsigned d = depths_[k];
+      Box b(boxes_[k]);
+      this->drawer_.remove_border(b, m, d);
+      const float tw = infovis::get(this->weight_,m);
+      auto [i, end] = children(m, this->tree_);
+      const float scale = width(b) * height(b) / tw;
+      if (scale == 0)
+	continue;
+      while (i != end) {
+	if (this->filter_(*i)) {
+	  ++i;
+	  continue;
+	}
+	const bool vertical = this->orient_(b, m, d);
+	const dist_type w = vertical ? height(b) : width(b);
+	float pos = vertical ? ymin(b) : xmin(b);
+	float width;
+	auto e = this->squarify(i, end, w, scale, width);
+	unsigned count = 0;
+	for (; i != e; i++, count++) {
+	  const auto child = *i;
+	  const float nw = infovis::get(this->weight_,child) * scale / width;
+	  nodes_.push_back(child);
+	  boxes_.push_back(vertical ? Box(xmin(b),pos,xmin(b)+width,pos+nw)
+			   : Box(pos, ymin(b), pos+nw, ymin(b)+width));
+	  depths_.push_back(d+1);
+	  pos += nw;
+	}
+	strips_.push_back(strip{vertical ? bottom_to_top : left_to_right, count});
+	if (vertical)
+	  set_xmin(b, width + xmin(b));
+	else
+	  set_ymin(b, width + ymin(b));
+      }
+    }
+    first_child_.push_back(unsigned(nodes_.size()));
+    first_strip_.push_back(unsigned(strips_.size()));
+  }
+
+  /**
+   * Materializes the second weights for the current parameter of the
+   * interpolator.
+   * @param threads the number of threads, 0 for one per core
+   */
+  void interpolate(unsigned threads = 0)
+  {
+    materialize(weight2_, weights_, unsigned(num_nodes(this->tree_)),
+		threads);
+  }
+
+  /**
+   * Equivalent to visit_anim on the box given to prepare, using the
+   * recorded strips and the materialized weights.  The drawer receives
+   * the same calls.
+   * @param box2 the box of the second layout
+   * @return the number of boxes accepted by the drawer.
+   */
+  unsigned visit_prepared(const Box& box2)
+  {
+    if (nodes_.empty())
+      return 0;
+    const std::size_t base = replay_.size();
+    unsigned ret = enter_prepared(0, box2);
+    while (replay_.size() > base) {
+      replay_frame& f = replay_.back();
+      if (f.child == f.strip_end) {
+	if (f.open) {
+	  if (f.dir == bottom_to_top)
+	    set_xmin(f.b2, f.width2 + xmin(f.b2));
+	  else
+	    set_ymin(f.b2, f.width2 + ymin(f.b2));
+	  f.open = false;
+	}
+	if (f.strip == first_strip_[f.k+1]) {
+	  this->drawer_.end_box(f.box2, nodes_[f.k], depths_[f.k]);
+	  replay_.pop_back();
+	  continue;
+	}
+	const strip& s = strips_[f.strip++];
+	f.dir = s.dir;
+	f.strip_end = f.child + s.count;
+	// Same sum as recompute_width.
+	float sum = 0;
+	for (unsigned c = f.child; c != f.strip_end; c++)
+	  if (! this->filter_(nodes_[c]))
+	    sum += weights_[nodes_[c]] * f.scale2;
+	f.width2 = sum / ((f.dir == bottom_to_top) ? height(f.b2) : width(f.b2));
+	f.pos = (f.dir == bottom_to_top) ? ymin(f.b2) : xmin(f.b2);
+	f.open = true;
+	continue;
+      }
+      const unsigned c = f.child++;
+      const float nw2 = weights_[nodes_[c]] * f.scale2 / f.width2;
+      const Box& b2 = f.b2;
+      const float p = f.pos;
+      f.pos += nw2;
+      // enter_prepared() may grow the stack, so f is not used after.
+      if (f.dir == bottom_to_top)
+	ret += enter_prepared(c, Box(xmin(b2),p,xmin(b2)+f.width2,p+nw2));
+      else
+	ret += enter_prepared(c, Box(p, ymin(b2), p+nw2, ymin(b2)+f.width2));
+    }
+    return ret;
+  }
+
   WeightMap2 weight2_;
+
+protected:
+  /**
+   * A strip of consecutive children recorded by prepare.
+   */
+  struct strip {
+    direction dir;
+    unsigned count;
+  };
+
+  /**
+   * State of a node whose strips are being replayed.
+   */
+  struct replay_frame {
+    unsigned k;			// index of the node in nodes_
+    Box box2;			// box passed to begin_box
+    Box b2;			// remaining space, shrinks strip by strip
+    unsigned strip;		// next strip in strips_
+    unsigned child;		// next child in nodes_
+    unsigned strip_end;		// end of the current strip in nodes_
+    float scale2;
+    float width2;		// thickness of the current strip
+    float pos;			// start of the next child in the strip
+    direction dir;
+    bool open;			// a strip is being laid out
+  };
+
+  unsigned enter_prepared(unsigned k, const Box& box2)
+  {
+    const node_descriptor n = nodes_[k];
+    const unsigned depth = depths_[k];
+    if (! this->drawer_.begin_box(box2,n, depth))
+      return 0;
+    Box b2(box2);
+    this->drawer_.draw_border(b2, n,  depth);
+    if (degree(n,this->tree_) == 0) {
+      this->drawer_.draw_box(b2, n,  depth);
+      this->drawer_.end_box(box2,n,depth);
+      return 1;
+    }
+    Box b(boxes_[k]);
+    this->drawer_.remove_border(b, n,  depth);
+    const float scale2 = width(b2) * height(b2) / weights_[n];
+    replay_.push_back(replay_frame{k, box2, b2, first_strip_[k],
+				   first_child_[k], first_child_[k],
+				   scale2, 0, 0, left_to_right, false});
+    return 1;
+  }
+
+  std::vector<node_descriptor> nodes_; ///< laid out nodes, breadth first
+  std::vector<Box> boxes_;	///< box of each node in the first layout
+  std::vector<unsigned> depths_;
+  std::vector<unsigned> first_child_; ///< index of the first child in nodes_
+  std::vector<unsigned> first_strip_; ///< index of the first strip in strips_
+  std::vector<strip> strips_;
+  std::vector<float> weights_;	///< materialized second weights
+  std::vector<replay_frame> replay_;
 };
 
 
@@ -0,0 +1,603 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/gen_tree.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/table/filter.hpp>
+#include <infovis/tree/treemap/slice_and_dice.hpp>
+#include <infovis/tree/treemap/squarified.hpp>
+#include <infovis/tree/treemap/squarified_anim.hpp>
+#include <algorithm>
+#include <tuple>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+
+using namespace infovis;
+
+typedef box_min_max<float> Box;
+typedef tree::node_descriptor node_descriptor;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+// One drawer callback with its arguments.
+struct call {
+  char what;
+  node_descriptor n;
+  unsigned depth;
+  int dir;
+  float x0, y0, x1, y1;
+
+  bool operator == (const call& o) const {
+    return what == o.what && n == o.n && depth == o.depth && dir == o.dir
+      && x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1;
+  }
+};
+
+// Records every callback.  Some boxes are rejected to exercise
+// pruning, and borders shrink the box like a real border drawer.
+struct record_drawer : public null_drawer<tree,Box> {
+  std::vector<call> calls;
+
+  void add(char what, const Box& b, node_descriptor n, unsigned depth,
+	   int dir = -1) {
+    calls.push_back(call{what, n, depth, dir,
+	  xmin(b), ymin(b), xmax(b), ymax(b)});
+  }
+  void begin_strip(const Box& b, node_descriptor n, unsigned depth,
+		   direction dir) { add('s', b, n, depth, dir); }
+  void end_strip(const Box& b, node_descriptor n, unsigned depth,
+		 direction dir) { add('S', b, n, depth, dir); }
+  bool begin_box(const Box& b, node_descriptor n, unsigned depth) {
+    add('b', b, n, depth);
+    return n % 13 != 5;
+  }
+  void draw_box(const Box& b, node_descriptor n, unsigned depth) {
+    add('d', b, n, depth);
+  }
+  void draw_border(Box& b, node_descriptor n, unsigned depth) {
+    add('r', b, n, depth);
+    if (width(b) > 2 && height(b) > 2) {
+      set_xmin(b, xmin(b) + 1);
+      set_ymin(b, ymin(b) + 1);
+      set_xmax(b, xmax(b) - 1);
+      set_ymax(b, ymax(b) - 1);
+    }
+  }
+  void remove_border(Box& b, node_descriptor n, unsigned depth) {
+    add('x', b, n, depth);
+    draw_border(b, n, depth);
+    calls.pop_back();
+  }
+  void end_box(const Box& b, node_descriptor n, unsigned depth) {
+    add('e', b, n, depth);
+  }
+};
+
+// Only checks that boxes nest properly, for the deep chain.
+struct nest_drawer : public null_drawer<tree,Box> {
+  unsigned open = 0;
+  unsigned max_depth = 0;
+  unsigned leaves = 0;
+
+  bool begin_box(const Box& b, node_descriptor n, unsigned depth) {
+    if (depth != open)
+      fail("begin_box depth", n);
+    open++;
+    if (depth > max_depth)
+      max_depth = depth;
+    return true;
+  }
+  void draw_box(const Box& b, node_descriptor n, unsigned depth) {
+    leaves++;
+  }
+  void end_box(const Box& b, node_descriptor n, unsigned depth) {
+    if (open == 0 || depth != --open)
+      fail("end_box depth", n);
+  }
+};
+
+// Prunes the boxes smaller than a pixel, like the real drawers.
+struct pixel_drawer : public nest_drawer {
+  bool begin_box(const Box& b, node_descriptor n, unsigned depth) {
+    if (width(b) < 1 || height(b) < 1)
+      return false;
+    return nest_drawer::begin_box(b, n, depth);
+  }
+};
+
+// Selects the nodes hidden by the filter.
+struct filter_some {
+  bool operator()(node_descriptor n) const { return n % 11 == 7; }
+};
+
+// Hides the nodes whose size is in a range.
+struct filter_size {
+  const FloatColumn * size;
+  filter_range_column_of<float> range;
+
+  filter_size(const FloatColumn& s, float min, float max)
+    : size(&s), range(min, max) { }
+  bool operator()(node_descriptor n) const { return range((*size)[n]); }
+};
+
+// The recursive slice and dice layout, as a reference.
+template <class TM>
+static unsigned
+recursive_visit(TM& tm, direction dir, const Box& box, node_descriptor n,
+		unsigned depth)
+{
+  if (! tm.drawer_.begin_box(box,n,depth))
+    return 0;
+  Box b(box);
+  unsigned ret = 1;
+  tm.drawer_.draw_border(b, n, depth);
+  if (is_leaf(n,tm.tree_)) {
+    tm.drawer_.draw_box(b, n, depth);
+  }
+  else {
+    const float tw = infovis::get(tm.weight_, n);
+    tm.drawer_.begin_strip(box, n, depth, dir);
+    if (dir == left_to_right) {
+      float w = width(b);
+      float x = xmin(b);
+      for (auto [i, end] = children(n,tm.tree_); i != end; i++) {
+	const auto child = *i;
+	if (tm.filter_(child))
+	  continue;
+	const float nw = w * infovis::get(tm.weight_, child) / tw;
+	const float e = float(x+nw);
+	ret += recursive_visit(tm, flip(dir), Box(x,ymin(b),e,ymax(b)),
+			       child, depth+1);
+	x += nw;
+      }
+    }
+    else {
+      float h = height(b);
+      float y = ymin(b);
+      for (auto [i, end] = children(n,tm.tree_); i != end; i++) {
+	const auto child = *i;
+	if (tm.filter_(child))
+	  continue;
+	const float nh = h * infovis::get(tm.weight_, child) / tw;
+	const float e = float(y+nh);
+	ret += recursive_visit(tm, flip(dir), Box(xmin(b),y,xmax(b),e),
+			       child, depth+1);
+	y += nh;
+      }
+    }
+    tm.drawer_.end_strip(box, n, depth, dir);
+  }
+  tm.drawer_.end_box(box,n,depth);
+  return ret;
+}
+
+// The recursive squarified layout, as a reference.
+template <class TM>
+static unsigned
+recursive_visit(TM& tm, const Box& box, node_descriptor n, unsigned depth)
+{
+  if (! tm.drawer_.begin_box(box,n,depth)) return 0;
+  Box b(box);
+  unsigned ret = 1;
+  tm.drawer_.draw_border(b, n, depth);
+  if (is_leaf(n,tm.tree_)) {
+    tm.drawer_.draw_box(b, n, depth);
+    tm.drawer_.end_box(box,n, depth);
+    return ret;
+  }
+  const float tw = infovis::get(tm.weight_,n);
+  auto [i, end] = children(n, tm.tree_);
+  const float scale = width(b) * height(b) / tw;
+  if (scale != 0) while (i != end) {
+    if (tm.filter_(*i)) {
+      ++i;
+      continue;
+    }
+    if (tm.orient_(b, n, depth)) {
+      float w = height(b);
+      float y = ymin(b);
+      float width;
+      if (w == 0)
+	break;
+      tm.drawer_.begin_strip(b, n, depth, bottom_to_top);
+      auto e = tm.squarify(i, end, w, scale, width);
+      if (width == 0)
+	i = e;
+      for (; i != e; i++) {
+	const auto child = *i;
+	if (tm.filter_(child))
+	  continue;
+	const float nw = infovis::get(tm.weight_,child) * scale / width;
+	ret += recursive_visit(tm, Box(xmin(b),y,xmin(b)+width,y+nw),
+			       child, depth+1);
+	y += nw;
+      }
+      set_xmin(b, width + xmin(b));
+      tm.drawer_.end_strip(b, n, depth, bottom_to_top);
+    }
+    else {
+      float w = width(b);
+      float x = xmin(b);
+      float width;
+      if (w == 0)
+	break;
+      tm.drawer_.begin_strip(b, n, depth, left_to_right);
+      auto e = tm.squarify(i, end, w, scale, width);
+      if (width == 0)
+	i = e;
+      for (; i != e; i++) {
+	const auto child = *i;
+	if (tm.filter_(child))
+	  continue;
+	const float nw = infovis::get(tm.weight_,child) * scale / width;
+	ret += recursive_visit(tm, Box(x, ymin(b), x+nw, ymin(b)+width),
+			       child, depth+1);
+	x += nw;
+      }
+      set_ymin(b, width + ymin(b));
+      tm.drawer_.end_strip(b, n, depth, left_to_right);
+    }
+  }
+  tm.drawer_.end_box(box,n, depth);
+  return ret;
+}
+
+static void
+compare(const char * what, const record_drawer& expected,
+	const record_drawer& got, unsigned ret, unsigned expected_ret)
+{
+  if (ret != expected_ret)
+    fail(what, ret);
+  if (got.calls.size() != expected.calls.size())
+    fail(what, unsigned(got.calls.size()));
+  for (std::size_t i = 0; i < got.calls.size() && i < expected.calls.size(); i++)
+    if (! (got.calls[i] == expected.calls[i])) {
+      fail(what, unsigned(i));
+      break;
+    }
+}
+
+// Stops a slice after a fixed number of boxes.
+struct every {
+  unsigned boxes;
+  unsigned count;
+
+  every(unsigned b) : boxes(b), count(0) { }
+  bool operator()() { return ++count == boxes; }
+};
+
+// Checks that the slices drew the same boxes as the depth first
+// traversal, level after level.
+static void
+compare_progressive(const char * what, const record_drawer& expected,
+		    const record_drawer& got, unsigned ret,
+		    unsigned expected_ret)
+{
+  if (ret != expected_ret)
+    fail(what, ret);
+  unsigned depth = 0;
+  for (const call& c : got.calls)
+    if (c.what == 'b') {
+      if (c.depth < depth) {
+	fail(what, c.n);
+	break;
+      }
+      depth = c.depth;
+    }
+  auto less = [](const call& a, const call& b) {
+    return std::tie(a.n, a.what, a.depth, a.dir, a.x0, a.y0, a.x1, a.y1)
+      < std::tie(b.n, b.what, b.depth, b.dir, b.x0, b.y0, b.x1, b.y1);
+  };
+  std::vector<call> e(expected.calls), g(got.calls);
+  std::sort(e.begin(), e.end(), less);
+  std::sort(g.begin(), g.end(), less);
+  if (! (e == g))
+    fail(what, unsigned(g.size()));
+}
+
+static void
+random_tree(tree& t, FloatColumn& weight, unsigned count)
+{
+  std::vector<node_descriptor> parents(count);
+  for (unsigned i = 1; i < count; i++)
+    parents[i] = rand() % 4 == 0 ? i - 1 : rand() % i;
+  t.build_from_parents(parents);
+  weight.resize(count);
+  for (unsigned i = 0; i < count; i++)
+    weight[i] = t.is_leaf(i) ? 1 + rand() % 8 : 0;
+  sum_weights(t, weight);
+}
+
+// A root with count leaves, sorted by decreasing integer weight summing
+// to total, so the areas stay exact when the inner box area is total.
+static void
+sorted_star(tree& t, FloatColumn& weight, unsigned count, unsigned total)
+{
+  std::vector<node_descriptor> parents(count + 1, tree::root);
+  t.build_from_parents(parents);
+  std::vector<float> w(count);
+  unsigned left = total;
+  for (unsigned i = 0; i < count; i++) {
+    w[i] = i + 1 == count ? left : std::min(left, unsigned(rand() % 40));
+    left -= unsigned(w[i]);
+  }
+  std::sort(w.begin(), w.end(), std::greater<float>());
+  weight.resize(count + 1);
+  weight[tree::root] = total;
+  for (unsigned i = 0; i < count; i++)
+    weight[i + 1] = w[i];
+}
+
+// Breaks all the children of the root into strips with both versions
+// of squarify, for random strip lengths.
+template <class TM>
+static void
+check_squarify(TM& tm, const tree& t, const FloatColumn& weight)
+{
+  std::vector<float> area;
+  std::vector<double> sums(1, 0);
+  unsigned positive = 0;
+  for (auto [i, end] = children(tree::root, t); i != end; i++) {
+    area.push_back(weight[*i]);
+    sums.push_back(sums.back() + area.back());
+    if (area.back() != 0)
+      positive = unsigned(area.size());
+  }
+  const unsigned count = unsigned(area.size());
+  auto [i, end] = children(tree::root, t);
+  unsigned index = 0;
+  while (index < count) {
+    const float length = 1 + rand() % 3000 / 7.0f;
+    float w1, w2;
+    auto e = tm.squarify(i, end, length, 1, w1);
+    unsigned e2 = tm.squarify_sorted(area.data(), sums.data(), index,
+				     positive, count, length, w2);
+    unsigned e1 = index;
+    for (; i != e; i++)
+      e1++;
+    if (e1 != e2 || w1 != w2) {
+      fail("squarify_sorted", index);
+      return;
+    }
+    index = e1;
+  }
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned count = argc > 1 ? atoi(argv[1]) : 2000;
+  unsigned deep = argc > 2 ? atoi(argv[2]) : 1000000;
+  unsigned generated = argc > 3 ? atoi(argv[3]) : 1000000;
+  const Box box(0, 0, 1024, 768);
+
+  srand(11);
+  for (unsigned round = 0; round < 20; round++) {
+    tree t;
+    FloatColumn& weight = *FloatColumn::find("weight", t);
+    random_tree(t, weight, 1 + rand() % count);
+
+    record_drawer expected, got;
+    {
+      treemap_slice_and_dice<tree,Box,const FloatColumn&,record_drawer&>
+	ref(t, weight, expected), sd(t, weight, got);
+      unsigned r = recursive_visit(ref, left_to_right, box, tree::root, 0);
+      compare("slice_and_dice", expected, got,
+	      sd.visit(left_to_right, box, tree::root), r);
+    }
+    expected.calls.clear();
+    got.calls.clear();
+    {
+      treemap_slice_and_dice<tree,Box,const FloatColumn&,record_drawer&,
+	filter_some>
+	ref(t, weight, expected, filter_some()),
+	sd(t, weight, got, filter_some());
+      unsigned r = recursive_visit(ref, top_to_bottom, box, tree::root, 0);
+      compare("filtered slice_and_dice", expected, got,
+	      sd.visit(top_to_bottom, box, tree::root), r);
+    }
+    expected.calls.clear();
+    got.calls.clear();
+    {
+      treemap_squarified<tree,Box,const FloatColumn&,record_drawer&>
+	ref(t, weight, expected), sq(t, weight, got);
+      unsigned r = recursive_visit(ref, box, tree::root, 0);
+      compare("squarified", expected, got, sq.visit(box, tree::root), r);
+    }
+    expected.calls.clear();
+    got.calls.clear();
+    {
+      treemap_squarified<tree,Box,const FloatColumn&,record_drawer&,
+	treemap_chose_orient<tree,Box>,filter_some>
+	ref(t, weight, expected, treemap_chose_orient<tree,Box>(),
+	    filter_some()),
+	sq(t, weight, got, treemap_chose_orient<tree,Box>(), filter_some());
+      unsigned r = recursive_visit(ref, box, tree::root, 0);
+      compare("filtered squarified", expected, got,
+	      sq.visit(box, tree::root), r);
+    }
+
+    // Slices of a few boxes, resumed until the frontier is empty.
+    const unsigned slice = 1 + rand() % 50;
+    expected.calls.clear();
+    got.calls.clear();
+    {
+      treemap_squarified<tree,Box,const FloatColumn&,record_drawer&>
+	ref(t, weight, expected), sq(t, weight, got);
+      unsigned r = ref.visit(box, tree::root);
+      sq.start_progressive(box, tree::root);
+      unsigned p = 0, slices = 0;
+      while (! sq.finished() && slices++ < count)
+	p += sq.resume(every(slice));
+      compare_progressive("progressive squarified", expected, got, p, r);
+    }
+    expected.calls.clear();
+    got.calls.clear();
+    {
+      treemap_slice_and_dice<tree,Box,const FloatColumn&,record_drawer&,
+	filter_some>
+	ref(t, weight, expected, filter_some()),
+	sd(t, weight, got, filter_some());
+      unsigned r = ref.visit(top_to_bottom, box, tree::root);
+      sd.start_progressive(top_to_bottom, box, tree::root);
+      unsigned p = 0, slices = 0;
+      while (! sd.finished() && slices++ < count)
+	p += sd.resume(every(slice));
+      compare_progressive("progressive slice_and_dice", expected, got, p, r);
+    }
+  }
+
+  // Sorted children broken with running sums give the same strips.
+  for (unsigned round = 0; round < 10; round++) {
+    tree t;
+    FloatColumn& weight = *FloatColumn::find("weight", t);
+    sorted_star(t, weight, 1 + rand() % (count * 5), 256 * 256);
+    record_drawer expected, got;
+    treemap_squarified<tree,Box,const FloatColumn&,record_drawer&>
+      ref(t, weight, expected), sq(t, weight, got);
+    check_squarify(ref, t, weight);
+
+    // The border takes one pixel, leaving 256x256 for the children.
+    const Box outer(0, 0, 258, 258);
+    sq.set_sorted(true);
+    unsigned r = ref.visit(outer, tree::root);
+    compare("sorted squarified", expected, got, sq.visit(outer, tree::root), r);
+  }
+
+  // Replaying recorded strips with materialized weights draws the
+  // same animation frames.
+  for (unsigned round = 0; round < 10; round++) {
+    tree t;
+    FloatColumn& weight = *FloatColumn::find("weight", t);
+    FloatColumn& next = *FloatColumn::find("next", t);
+    random_tree(t, weight, 1 + rand() % count);
+    next.resize(t.num_nodes());
+    for (unsigned i = 0; i < t.num_nodes(); i++)
+      next[i] = t.is_leaf(i) ? 1 + rand() % 8 : 0;
+    sum_weights(t, next);
+    typedef weight_interpolator<FloatColumn> Interp;
+    Interp interp(weight, next);
+    interp.set_std_balance();
+
+    record_drawer expected, got;
+    treemap_squarified_anim<tree,Box,record_drawer&,const FloatColumn&,
+      Interp&>
+      ref(t, weight, interp, expected), anim(t, weight, interp, got);
+    const Box box2(10, 20, 500, 700);
+    anim.prepare(box, tree::root);
+    for (float param : { 0.0f, 0.3f, 0.75f, 1.0f }) {
+      interp.set_param(param);
+      anim.interpolate(round % 3);
+      expected.calls.clear();
+      got.calls.clear();
+      unsigned r = ref.visit_anim(box, box, tree::root);
+      compare("visit_prepared", expected, got, anim.visit_prepared(box), r);
+      expected.calls.clear();
+      got.calls.clear();
+      r = ref.visit_anim(box, box2, tree::root);
+      compare("visit_prepared", expected, got, anim.visit_prepared(box2), r);
+    }
+  }
+
+  // Generated file systems, with the small files filtered out.
+  {
+    gen_tree_params p;
+    p.nodes = generated;
+    tree t;
+    gen_tree(t, p);
+    const FloatColumn& size = *FloatColumn::find("size", t);
+    const filter_size small(size, 0, 16);
+    pixel_drawer expected, got;
+    treemap_slice_and_dice<tree,Box,const FloatColumn&,pixel_drawer&,
+      filter_size>
+      ref(t, size, expected, small), sd(t, size, got, small);
+    unsigned r = recursive_visit(ref, left_to_right, box, tree::root, 0);
+    if (sd.visit(left_to_right, box, tree::root) != r
+	|| got.leaves != expected.leaves || got.open != 0)
+      fail("generated slice_and_dice", r);
+
+    pixel_drawer eq, gq;
+    treemap_squarified<tree,Box,const FloatColumn&,pixel_drawer&>
+      rq(t, size, eq), sq(t, size, gq);
+    r = recursive_visit(rq, box, tree::root, 0);
+    if (sq.visit(box, tree::root) != r
+	|| gq.leaves != eq.leaves || gq.open != 0)
+      fail("generated squarified", r);
+
+    // Slices of a millisecond reach the same boxes.
+    null_drawer<tree,Box> nd;
+    treemap_squarified<tree,Box,const FloatColumn&,null_drawer<tree,Box>&>
+      dq(t, size, nd), pq(t, size, nd);
+    unsigned drawn = 0, slices = 0;
+    pq.start_progressive(box, tree::root);
+    while (! pq.finished()) {
+      drawn += pq.resume(frame_budget(std::chrono::milliseconds(1)));
+      slices++;
+    }
+    if (drawn != dq.visit(box, tree::root) || slices < 2)
+      fail("generated progressive squarified", slices);
+  }
+
+  // A chain deeper than any call stack would allow.
+  {
+    std::vector<node_descriptor> parents(deep);
+    for (unsigned i = 1; i < deep; i++)
+      parents[i] = i - 1;
+    tree t;
+    t.build_from_parents(parents);
+    FloatColumn& weight = *FloatColumn::find("weight", t);
+    weight.resize(deep);
+    for (unsigned i = 0; i < deep; i++)
+      weight[i] = 1;
+
+    nest_drawer nd;
+    treemap_slice_and_dice<tree,Box,const FloatColumn&,nest_drawer&>
+      sd(t, weight, nd);
+    if (sd.visit(left_to_right, box, tree::root) != deep)
+      fail("deep slice_and_dice", deep);
+    if (nd.open != 0 || nd.leaves != 1 || nd.max_depth != deep - 1)
+      fail("deep slice_and_dice nesting", nd.max_depth);
+
+    nest_drawer nq;
+    treemap_squarified<tree,Box,const FloatColumn&,nest_drawer&>
+      sq(t, weight, nq);
+    if (sq.visit(box, tree::root) != deep)
+      fail("deep squarified", deep);
+    if (nq.open != 0 || nq.leaves != 1 || nq.max_depth != deep - 1)
+      fail("deep squarified nesting", nq.max_depth);
+  }
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -37,6 +37,7 @@ struct xml_tree_builder
   Tree& tree_;
   StringColumn * tag_;
   std::vector<node_descriptor> node_stack;
+  std::vector<node_descriptor> parents_; // structure built at the end
 
   static void startElement(void *userData,
 			   const char *name, const char **atts) {
@@ -52,7 +53,8 @@ struct xml_tree_builder
     return node_stack.back();
   }
   node_descriptor push() {
-    node_descriptor n = add_node(current(), tree_);
+    node_descriptor n = node_descriptor(parents_.size());
+    parents_.push_back(current());
     node_stack.push_back(n);
     return n;
   }
@@ -121,9 +123,13 @@ struct xml_tree_builder
     gzclose(input);
     XML_ParserFree(parser);
     pop();
+    tree_.build_from_parents(parents_);
   }
   xml_tree_builder(Tree& t, StringColumn * n)
-    : tree_(t), tag_(n) { }
+    : tree_(t), tag_(n) {
+    for (node_descriptor i = 0; i < num_nodes(t); i++)
+      parents_.push_back(parent(i, t));
+  }
 };
 
 unsigned xml_tree(const std::string& filename, tree& t)
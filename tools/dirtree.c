@@ -1,167 +1,432 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <sys/stat.h>
-#ifdef _WIN32
-#include <io.h>
-#else
 #include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <unistd.h>
-#endif
+#include <zlib.h>
 
-void tab(int i)
+/*
+ * Prints the XML tree of a directory.  Directories are formatted in
+ * parallel into memory buffers by a pool of workers: a worker lists
+ * its directory and the directories below it, handing a subdirectory
+ * over to the work queue whenever the queue runs short, at any depth,
+ * so one dominant subtree is still split among the workers.  The
+ * buffers are written in directory order, so the output does not
+ * depend on the number of threads.  The output is compressed when its
+ * name ends with ".gz".
+ */
+
+#define BLOCK_SIZE (4*1024*1024)
+
+struct buffer {
+  char * data;
+  size_t len;
+  size_t cap;
+};
+
+static void
+put(struct buffer * b, const char * s, size_t len)
+{
+  if (b->len + len > b->cap) {
+    size_t cap = b->cap == 0 ? 64 * 1024 : b->cap;
+    while (cap < b->len + len)
+      cap *= 2;
+    b->data = realloc(b->data, cap);
+    if (b->data == NULL) {
+      fprintf(stderr, "dirtree: out of memory\n");
+      exit(1);
+    }
+    b->cap = cap;
+  }
+  memcpy(b->data + b->len, s, len);
+  b->len += len;
+}
+
+static void
+puts_buf(struct buffer * b, const char * s)
+{
+  put(b, s, strlen(s));
+}
+
+static void
+tab(struct buffer * b, int i)
 {
   while (i-- > 0)
-    putchar(' ');
+    put(b, " ", 1);
 }
 
-void print_quoted(const char * str)
+static void
+print_quoted(struct buffer * b, const char * str)
 {
   const unsigned char * s = (const unsigned char *)str;
+  char c[2];
   while (*s) {
     if (*s < 32) {
-      putchar('^');
-      putchar('A'+*s);
+      c[0] = '^';
+      c[1] = 'A'+*s;
+      put(b, c, 2);
     }
     else if (*s > 127) {
-      putchar('|');
-      putchar(-127+'A'+*s);
+      c[0] = '|';
+      c[1] = -127+'A'+*s;
+      put(b, c, 2);
     }
     else switch (*s) {
-    case '&': puts("&amp;"); break;
-    case '<': puts("&lt;"); break;
-    case '>': puts("&gt;"); break;
-    case '"': puts("&quot;"); break;
-    case '\'': puts("&apos;"); break;
+    case '&': puts_buf(b, "&amp;"); break;
+    case '<': puts_buf(b, "&lt;"); break;
+    case '>': puts_buf(b, "&gt;"); break;
+    case '"': puts_buf(b, "&quot;"); break;
+    case '\'': puts_buf(b, "&apos;"); break;
     default:
-      putchar(*s);
+      put(b, (const char *)s, 1);
     }
     s++;
   }
 }
 
-#ifdef _WIN32
-void print_dir(const char * name, int depth)
+static void
+print_times(struct buffer * b, const struct stat * st)
 {
-  struct _finddata_t f_data;
-  long code, handle;
-  char dirname[2048];
-  char * p;
-  struct stat st;
+  char tmp[128];
+  int len = snprintf(tmp, sizeof(tmp),
+		     "' size='%ld' atime='%ld' mtime='%ld' ctime='%ld'",
+		     (long)st->st_size,
+		     (long)st->st_atime,
+		     (long)st->st_mtime,
+		     (long)st->st_ctime);
+  put(b, tmp, len);
+}
+
+static void
+print_dir_open(struct buffer * b, const char * name,
+	       const struct stat * st, int depth)
+{
+  char tmp[64];
+  int len;
+  tab(b, depth);
+  puts_buf(b, "<dir name='");
+  print_quoted(b, name);
+  put(b, "/", 1);
+  print_times(b, st);
+  len = snprintf(tmp, sizeof(tmp), " uid='%ld' gid='%ld'>\n",
+		 (long)st->st_uid,
+		 (long)st->st_gid);
+  put(b, tmp, len);
+}
+
+static void
+print_dir_close(struct buffer * b, int depth)
+{
+  tab(b, depth);
+  puts_buf(b, "</dir>\n");
+}
 
-  tab(depth);
-  strcpy(dirname, name);
-  p = strrchr(dirname, '/');
-  if (p == 0)
-    p = dirname;
+static void
+print_file(struct buffer * b, const char * name,
+	   const struct stat * st, int depth)
+{
+  tab(b, depth);
+  puts_buf(b, "<file name='");
+  print_quoted(b, name);
+  if ((st->st_mode&(S_IXUSR | S_IXGRP | S_IXOTH)) != 0 &&
+      strchr(name, '.') == 0) {
+    puts_buf(b, ".sh"); /* add dummy executable suffix */
+  }
+  print_times(b, st);
+  puts_buf(b, "/>\n");
+}
+
+/*
+ * The output of a job is a list of pieces: some text followed by the
+ * output of a subdirectory formatted by another job, if any.
+ */
+struct piece {
+  struct buffer text;
+  struct job * sub;
+  struct piece * next;
+};
+
+/*
+ * A directory to format, with the directories below it that are not
+ * handed over to other jobs.
+ */
+struct job {
+  int fd;
+  int depth;
+  int done;
+  struct piece * head;
+  struct piece * tail;
+  struct job * next;		/* in the queue */
+};
+
+static struct job * queue_head = NULL;
+static struct job * queue_tail = NULL;
+static long queued = 0;		/* jobs waiting in the queue */
+static long active = 0;		/* jobs queued or running */
+static long max_queued = 1;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t job_done = PTHREAD_COND_INITIALIZER;
+
+static struct piece *
+new_piece(struct job * j)
+{
+  struct piece * p = calloc(1, sizeof(struct piece));
+  if (p == NULL) {
+    fprintf(stderr, "dirtree: out of memory\n");
+    exit(1);
+  }
+  if (j->tail == NULL)
+    j->head = p;
   else
-    p++;
-  stat(dirname, &st);
-  strcat(dirname, "/");
-  fputs("<dir name='", stdout);
-  print_quoted(p);
-  printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld'>\n",
-	 st.st_size,
-	 st.st_atime,
-	 st.st_mtime,
-	 st.st_ctime);
-  strcat(dirname, "*");
-  for (handle = code = _findfirst(dirname, &f_data);
-       code != -1;
-       code = _findnext(handle, &f_data)) {
-    if (f_data.name[0] == '.')
-      continue;
-    if (f_data.attrib & _A_SUBDIR) {
-      strcpy(dirname, name);
-      strcat(dirname, "/");
-      strcat(dirname, f_data.name);
-      print_dir(dirname, depth+1);
-    }
-    else {
-      stat(dirname, &st);
-      tab(depth+1);
-      fputs("<file name='", stdout);
-      print_quoted(f_data.name);
-      printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld'/>\n",
-	     f_data.size,
-	     st.st_atime,
-	     st.st_mtime,
-	     st.st_ctime);
-    }
+    j->tail->next = p;
+  j->tail = p;
+  return p;
+}
+
+static struct job *
+new_job(int fd, int depth)
+{
+  struct job * j = calloc(1, sizeof(struct job));
+  if (j == NULL) {
+    fprintf(stderr, "dirtree: out of memory\n");
+    exit(1);
+  }
+  j->fd = fd;
+  j->depth = depth;
+  new_piece(j);
+  return j;
+}
+
+/*
+ * Queue a job for the workers, only when they may run out of work.
+ * Returns 0 when the queue is full enough.
+ */
+static int
+offer_job(int fd, int depth, struct job ** ret)
+{
+  struct job * j;
+  pthread_mutex_lock(&lock);
+  if (queued >= max_queued) {
+    pthread_mutex_unlock(&lock);
+    return 0;
   }
-  if (handle != -1)
-    _findclose(handle);
-  tab(depth);
-  printf("</dir>\n");
+  j = new_job(fd, depth);
+  if (queue_tail == NULL)
+    queue_head = j;
+  else
+    queue_tail->next = j;
+  queue_tail = j;
+  queued++;
+  active++;
+  pthread_cond_signal(&work);
+  pthread_mutex_unlock(&lock);
+  *ret = j;
+  return 1;
 }
-#else
-void print_dir(const char * name, int depth)
+
+/*
+ * Print the contents of an open directory into the pieces of a job,
+ * recursively unless a subdirectory is handed over to another job.
+ */
+static void
+print_entries(struct job * j, int fd, int depth)
 {
-  DIR * dir;
+  DIR * dir = fdopendir(fd);
   struct dirent * ent;
-  char dirname[2048];
-  char * p;
   struct stat st;
+  struct job * sub_job;
 
-  tab(depth);
-  strcpy(dirname, name);
-  p = strrchr(dirname, '/');
-  if (p == 0)
-    p = dirname;
-  else
-    p++;
-  stat(dirname, &st);
-  dir =opendir(dirname);
-  strcat(dirname, "/");
-  fputs("<dir name='", stdout);
-  print_quoted(p);
-  printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld' uid='%ld' gid='%ld'>\n",
-	 st.st_size,
-	 st.st_atime,
-	 st.st_mtime,
-	 st.st_ctime,
-	 st.st_uid,
-	 st.st_gid);
-  if (dir != 0) {
-    while ((ent = readdir(dir)) != 0) {
-      if (ent->d_name[0] != '.') {
-	strcpy(dirname, name);
-	strcat(dirname, "/");
-	strcat(dirname, ent->d_name);
-	if (lstat(dirname, &st) == 0 &&
-	    S_ISDIR(st.st_mode))
-	  print_dir(dirname, depth+1);
-	else {
-	  tab(depth+1);
-	  fputs("<file name='", stdout);
-	  print_quoted(ent->d_name);
-	  if ((st.st_mode&(S_IXUSR | S_IXGRP | S_IXOTH)) != 0 &&
-	      strchr(ent->d_name, '.') == 0) {
-	    fputs(".sh", stdout); /* add dummy executable suffix */
-	  }
-	  printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld'/>\n",
-		 st.st_size,
-		 st.st_atime,
-		 st.st_mtime,
-		 st.st_ctime);
+  if (dir == 0) {
+    close(fd);
+    return;
+  }
+  while ((ent = readdir(dir)) != 0) {
+    if (ent->d_name[0] == '.')
+      continue;
+    if (fstatat(fd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+	S_ISDIR(st.st_mode)) {
+      int sub = openat(fd, ent->d_name, O_RDONLY | O_DIRECTORY);
+      print_dir_open(&j->tail->text, ent->d_name, &st, depth);
+      if (sub >= 0) {
+	if (offer_job(sub, depth+1, &sub_job)) {
+	  j->tail->sub = sub_job;
+	  new_piece(j);
 	}
+	else
+	  print_entries(j, sub, depth+1);
       }
+      print_dir_close(&j->tail->text, depth);
     }
-    closedir(dir);
+    else
+      print_file(&j->tail->text, ent->d_name, &st, depth);
   }
-  tab(depth);
-  printf("</dir>\n");
+  closedir(dir);
+}
+
+static void *
+worker(void * arg)
+{
+  for (;;) {
+    struct job * j;
+    pthread_mutex_lock(&lock);
+    while (queue_head == NULL && active != 0)
+      pthread_cond_wait(&work, &lock);
+    if (queue_head == NULL) {
+      pthread_mutex_unlock(&lock);
+      return NULL;
+    }
+    j = queue_head;
+    queue_head = j->next;
+    if (queue_head == NULL)
+      queue_tail = NULL;
+    queued--;
+    pthread_mutex_unlock(&lock);
+
+    print_entries(j, j->fd, j->depth);
+
+    pthread_mutex_lock(&lock);
+    j->done = 1;
+    if (--active == 0)
+      pthread_cond_broadcast(&work); /* let the idle workers quit */
+    pthread_cond_broadcast(&job_done);
+    pthread_mutex_unlock(&lock);
+  }
+}
+
+struct output {
+  FILE * file;
+  gzFile gz;
+  struct buffer buf;
+};
+
+static void
+flush_output(struct output * out)
+{
+  if (out->buf.len == 0)
+    return;
+  if (out->gz != NULL)
+    gzwrite(out->gz, out->buf.data, (unsigned)out->buf.len);
+  else
+    fwrite(out->buf.data, 1, out->buf.len, out->file);
+  out->buf.len = 0;
+}
+
+static void
+write_output(struct output * out, const struct buffer * b)
+{
+  if (out->buf.len + b->len > BLOCK_SIZE)
+    flush_output(out);
+  if (b->len > BLOCK_SIZE) {
+    if (out->gz != NULL)
+      gzwrite(out->gz, b->data, (unsigned)b->len);
+    else
+      fwrite(b->data, 1, b->len, out->file);
+  }
+  else
+    put(&out->buf, b->data, b->len);
+}
+
+/*
+ * Write the output of a job once it is done, and of the jobs it
+ * handed its subdirectories to, freeing them.
+ */
+static void
+write_job(struct output * out, struct job * j)
+{
+  struct piece * p, * next;
+  pthread_mutex_lock(&lock);
+  while (! j->done)
+    pthread_cond_wait(&job_done, &lock);
+  pthread_mutex_unlock(&lock);
+  for (p = j->head; p != NULL; p = next) {
+    write_output(out, &p->text);
+    free(p->text.data);
+    if (p->sub != NULL)
+      write_job(out, p->sub);
+    next = p->next;
+    free(p);
+  }
+  free(j);
 }
-#endif
 
 int main(int argc, char * argv[])
 {
-  if (argc < 2) {
-    fprintf(stderr, "syntax: dirtree <dir>\n");
+  const char * output = NULL;
+  const char * name;
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  struct output out;
+  struct stat st;
+  struct buffer b = { NULL, 0, 0 };
+  pthread_t * pool;
+  struct job * top = NULL;
+  int top_fd;
+  long i;
+  int arg = 1;
+
+  while (arg + 1 < argc && argv[arg][0] == '-') {
+    if (strcmp(argv[arg], "-j") == 0)
+      threads = atol(argv[arg+1]);
+    else if (strcmp(argv[arg], "-o") == 0)
+      output = argv[arg+1];
+    else
+      break;
+    arg += 2;
+  }
+  if (arg >= argc) {
+    fprintf(stderr, "syntax: dirtree [-j threads] [-o output[.gz]] <dir>\n");
     return(1);
   }
-  printf("<?xml version=\"1.0\" encoding=\"iso-8859-1\"?>\n");
-  print_dir(argv[1], 0);
+  if (threads < 1)
+    threads = 1;
+
+  memset(&out, 0, sizeof(out));
+  if (output == NULL)
+    out.file = stdout;
+  else if (strlen(output) > 3 && strcmp(output + strlen(output) - 3, ".gz") == 0)
+    out.gz = gzopen(output, "wb");
+  else
+    out.file = fopen(output, "wb");
+  if (out.file == NULL && out.gz == NULL) {
+    fprintf(stderr, "dirtree: cannot write %s\n", output);
+    return 1;
+  }
+
+  name = strrchr(argv[arg], '/');
+  name = name == NULL ? argv[arg] : name + 1;
+  memset(&st, 0, sizeof(st));
+  stat(argv[arg], &st);
+  puts_buf(&b, "<?xml version=\"1.0\" encoding=\"iso-8859-1\"?>\n");
+  print_dir_open(&b, name, &st, 0);
+  write_output(&out, &b);
+  b.len = 0;
+
+  top_fd = open(argv[arg], O_RDONLY | O_DIRECTORY);
+  if (top_fd >= 0) {
+    max_queued = threads;
+    offer_job(top_fd, 1, &top);
+    pool = malloc(threads * sizeof(pthread_t));
+    for (i = 0; i < threads; i++)
+      pthread_create(&pool[i], NULL, worker, NULL);
+    write_job(&out, top);
+    for (i = 0; i < threads; i++)
+      pthread_join(pool[i], NULL);
+    free(pool);
+  }
+
+  print_dir_close(&b, 0);
+  write_output(&out, &b);
+  free(b.data);
+  flush_output(&out);
+  free(out.buf.data);
+  if (out.gz != NULL)
+    gzclose(out.gz);
+  else if (out.file != stdout)
+    fclose(out.file);
   return 0;
 }
@@ -0,0 +1,103 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/gen_tree.hpp>
+#include <infovis/tree/export_tree_xml.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace infovis;
+
+static void
+usage()
+{
+  fprintf(stderr,
+	  "syntax: gen_tree [options] <file.xml[.gz]>\n"
+	  "  -n nodes      number of nodes (1000000)\n"
+	  "  -s seed       random seed (1)\n"
+	  "  -f fanout     power, uniform, chain or flat (power)\n"
+	  "  -F max        largest directory (10000)\n"
+	  "  -a exponent   exponent of the power law fanout (1.8)\n"
+	  "  -d ratio      probability for an entry to be a directory (0.15)\n"
+	  "  -w weight     power, uniform or constant (power)\n"
+	  "  -W max        largest file (1e9)\n"
+	  "  -e exponent   exponent of the power law weights (0.5)\n"
+	  "  -N            no name column\n"
+	  "  -j threads    threads generating and writing (all)\n");
+}
+
+int main(int argc, char * argv[])
+{
+  gen_tree_params p;
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != 0; arg++) {
+    const char opt = argv[arg][1];
+    if (opt == 'N') {
+      p.names = false;
+      continue;
+    }
+    if (arg + 1 >= argc || argv[arg][2] != 0) {
+      usage();
+      return 1;
+    }
+    const char * val = argv[++arg];
+    switch (opt) {
+    case 'n': p.nodes = strtoul(val, 0, 10); break;
+    case 's': p.seed = strtoul(val, 0, 10); break;
+    case 'F': p.max_fanout = strtoul(val, 0, 10); break;
+    case 'a': p.fanout_exponent = atof(val); break;
+    case 'd': p.directories = atof(val); break;
+    case 'W': p.max_weight = atof(val); break;
+    case 'e': p.weight_exponent = atof(val); break;
+    case 'j': p.threads = atoi(val); break;
+    case 'f':
+      if (gen_fanout_by_name(val, p.fanout))
+	break;
+      fprintf(stderr, "gen_tree: unknown fanout %s\n", val);
+      return 1;
+    case 'w':
+      if (gen_weight_by_name(val, p.weight))
+	break;
+      fprintf(stderr, "gen_tree: unknown weight %s\n", val);
+      return 1;
+    default:
+      usage();
+      return 1;
+    }
+  }
+  if (arg + 1 != argc || p.max_fanout == 0 || p.fanout_exponent <= 1
+      || p.weight_exponent <= 0 || p.max_weight < 1) {
+    usage();
+    return 1;
+  }
+
+  tree t;
+  gen_tree(t, p);
+  if (! export_tree_xml(argv[arg], t, p.threads)) {
+    fprintf(stderr, "gen_tree: cannot write %s\n", argv[arg]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,227 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <expat.h>
+#include <zlib.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+static int errors = 0;
+
+static std::string
+read_file(const std::string& filename)
+{
+  std::string ret;
+  gzFile in = gzopen(filename.c_str(), "rb");
+  if (in == 0)
+    return ret;
+  char buf[65536];
+  int len;
+  while ((len = gzread(in, buf, sizeof(buf))) > 0)
+    ret.append(buf, len);
+  gzclose(in);
+  return ret;
+}
+
+static float
+run(const std::string& cmd)
+{
+  auto start = std::chrono::steady_clock::now();
+  if (system(cmd.c_str()) != 0) {
+    std::cerr << "failed: " << cmd << std::endl;
+    errors++;
+  }
+  return std::chrono::duration<float>(std::chrono::steady_clock::now()
+				      - start).count();
+}
+
+/*
+ * Remove the access times, updated by reading the directories.
+ */
+static std::string
+strip_atime(const std::string& xml)
+{
+  std::string ret;
+  std::string::size_type p = 0, a;
+  while ((a = xml.find(" atime='", p)) != std::string::npos) {
+    ret.append(xml, p, a - p);
+    p = xml.find('\'', a + 8) + 1;
+  }
+  ret.append(xml, p, std::string::npos);
+  return ret;
+}
+
+struct counts {
+  unsigned long dirs;
+  unsigned long files;
+  unsigned long size;
+};
+
+static void
+start_element(void * data, const char * name, const char ** atts)
+{
+  counts * c = static_cast<counts*>(data);
+  if (strcmp(name, "dir") == 0)
+    c->dirs++;
+  else if (strcmp(name, "file") == 0) {
+    c->files++;
+    for (const char ** a = atts; *a != 0; a += 2)
+      if (strcmp(a[0], "size") == 0)
+	c->size += atol(a[1]);
+  }
+}
+
+static bool
+parse(const std::string& xml, counts& c)
+{
+  XML_Parser parser = XML_ParserCreate(NULL);
+  XML_SetUserData(parser, &c);
+  XML_SetStartElementHandler(parser, start_element);
+  bool ok = XML_Parse(parser, xml.data(), int(xml.size()), 1) != 0;
+  XML_ParserFree(parser);
+  return ok;
+}
+
+int main(int argc, char * argv[])
+{
+  std::string dirtree(argv[0]);
+  std::string::size_type p = dirtree.rfind('/');
+  dirtree = (p == std::string::npos ? "." : dirtree.substr(0, p)) + "/dirtree";
+  unsigned long n = argc > 1 ? atol(argv[1]) : 1000000;
+  if (argc > 2)
+    dirtree = argv[2];
+
+  char tmpl[] = "/tmp/dirtreeXXXXXX";
+  if (mkdtemp(tmpl) == 0) {
+    std::cerr << "cannot create a temporary directory\n";
+    return 1;
+  }
+  const std::string dir(tmpl);
+
+  // One dominant directory, like a build output root, holding 100
+  // directories of 100 subdirectories with the files, and a file next
+  // to it.
+  const std::string top = dir + "/build";
+  mkdir(top.c_str(), 0755);
+  const unsigned fanout = 100;
+  const unsigned long per_dir = std::max(5ul, (n + fanout * fanout - 1) / (fanout * fanout));
+  counts expected = { 2, 0, 0 };
+  static const char * odd[] = { "a&b", "x<y>", "it's", "caf\xe9", "tab\tname" };
+  for (unsigned i = 0; i < fanout && expected.files < n; i++) {
+    std::string d1 = top + "/d" + std::to_string(i);
+    mkdir(d1.c_str(), 0755);
+    expected.dirs++;
+    for (unsigned j = 0; j < fanout && expected.files < n; j++) {
+      std::string d2 = d1 + "/s" + std::to_string(j);
+      mkdir(d2.c_str(), 0755);
+      expected.dirs++;
+      for (unsigned long k = 0; k < per_dir && expected.files < n; k++) {
+	std::string f = d2 + "/";
+	if (k < sizeof(odd) / sizeof(odd[0]) && i == 0 && j == 0)
+	  f += odd[k];
+	else
+	  f += "f" + std::to_string(k) + ".txt";
+	int fd = open(f.c_str(), O_WRONLY | O_CREAT, 0644);
+	if (fd < 0) {
+	  std::cerr << "cannot create " << f << std::endl;
+	  return 1;
+	}
+	unsigned size = k % 4;
+	if (write(fd, "data", size) != ssize_t(size))
+	  errors++;
+	close(fd);
+	expected.files++;
+	expected.size += size;
+      }
+    }
+  }
+
+  {
+    const std::string f = dir + "/README";
+    int fd = open(f.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0 || write(fd, "data", 4) != 4)
+      errors++;
+    if (fd >= 0)
+      close(fd);
+    expected.files++;
+    expected.size += 4;
+  }
+
+  const std::string out1(dir + ".1.xml"), out4(dir + ".4.xml"),
+    outgz(dir + ".xml.gz");
+  float time1 = run(dirtree + " -j 1 -o " + out1 + " " + dir);
+  float time4 = run(dirtree + " -j 4 -o " + out4 + " " + dir);
+  float timegz = run(dirtree + " -j 4 -o " + outgz + " " + dir);
+  std::cout << "dirtree on " << expected.files << " files: "
+	    << time1 << "s with 1 thread, "
+	    << time4 << "s with 4 threads, "
+	    << timegz << "s compressed\n";
+
+  std::string xml1 = strip_atime(read_file(out1));
+  std::string xml4 = strip_atime(read_file(out4));
+  std::string xmlgz = strip_atime(read_file(outgz));
+  if (xml1.empty() || xml1 != xml4) {
+    std::cerr << "output depends on the number of threads\n";
+    errors++;
+  }
+  if (xml4 != xmlgz) {
+    std::cerr << "compressed output differs\n";
+    errors++;
+  }
+  counts found = { 0, 0, 0 };
+  if (! parse(xml1, found)) {
+    std::cerr << "output is not well formed\n";
+    errors++;
+  }
+  else if (found.dirs != expected.dirs ||
+	   found.files != expected.files ||
+	   found.size != expected.size) {
+    std::cerr << "found " << found.dirs << " dirs, " << found.files
+	      << " files, " << found.size << " bytes instead of "
+	      << expected.dirs << ", " << expected.files << ", "
+	      << expected.size << std::endl;
+    errors++;
+  }
+  if (xml1.find("<file name='a&amp;b'") == std::string::npos ||
+      xml1.find("<file name='tab^Jname'") == std::string::npos) {
+    std::cerr << "names are not quoted\n";
+    errors++;
+  }
+
+  std::remove(out1.c_str());
+  std::remove(out4.c_str());
+  std::remove(outgz.c_str());
+  system(("rm -rf " + dir).c_str());
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,213 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <infovis/tree/tree.hpp>
+#include <infovis/tree/xml_tree.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace infovis;
+
+static std::string dir_;
+static int errors = 0;
+
+static void
+make_file(const std::string& name, unsigned size)
+{
+  std::ofstream out((dir_ + "/" + name).c_str());
+  out << std::string(size, 'x');
+}
+
+static void
+make_dir(const std::string& name)
+{
+  mkdir((dir_ + "/" + name).c_str(), 0755);
+}
+
+static void
+make_link(const std::string& target, const std::string& name, bool hard)
+{
+  std::string path(dir_ + "/" + name);
+  int ret = hard ? link((dir_ + "/" + target).c_str(), path.c_str())
+    : symlink(target.c_str(), path.c_str());
+  if (ret != 0) {
+    std::cerr << "cannot create link " << name << std::endl;
+    errors++;
+  }
+}
+
+static std::string
+run(const std::string& webtree, const std::string& args,
+    const std::string& output, float * time = 0)
+{
+  std::string cmd = webtree + " " + args + " > " + output;
+  auto start = std::chrono::steady_clock::now();
+  if (system(cmd.c_str()) != 0) {
+    std::cerr << "failed: " << cmd << std::endl;
+    errors++;
+  }
+  if (time != 0)
+    *time = std::chrono::duration<float>(std::chrono::steady_clock::now()
+					 - start).count();
+  std::ifstream in(output.c_str());
+  std::stringstream ret;
+  ret << in.rdbuf();
+  return ret.str();
+}
+
+/*
+ * Remove the access times, updated by reading the directories.
+ */
+static std::string
+strip_atime(const std::string& xml)
+{
+  std::string ret;
+  std::string::size_type p = 0, a;
+  while ((a = xml.find(" atime='", p)) != std::string::npos) {
+    ret.append(xml, p, a - p);
+    p = xml.find('\'', a + 8) + 1;
+  }
+  ret.append(xml, p, std::string::npos);
+  return ret;
+}
+
+static unsigned
+count(const std::string& s, const std::string& what)
+{
+  unsigned n = 0;
+  for (std::string::size_type p = s.find(what); p != std::string::npos;
+       p = s.find(what, p + 1))
+    n++;
+  return n;
+}
+
+int main(int argc, char * argv[])
+{
+  std::string webtree(argv[0]);
+  std::string::size_type p = webtree.rfind('/');
+  webtree = (p == std::string::npos ? "." : webtree.substr(0, p)) + "/webtree";
+  if (argc > 1)
+    webtree = argv[1];
+  unsigned fanout = argc > 2 ? atoi(argv[2]) : 12;
+
+  char tmpl[] = "/tmp/webtreeXXXXXX";
+  if (mkdtemp(tmpl) == 0) {
+    std::cerr << "cannot create a temporary directory\n";
+    return 1;
+  }
+  dir_ = tmpl;
+
+  // a/f1 has three hard links, b/c is a symbolic link to c.txt,
+  // a/sub/loop and b/up are cycles, b/a links a directory that is also
+  // reached directly.
+  make_dir("a");
+  make_dir("a/sub");
+  make_dir("b");
+  make_file("a/f1", 100);
+  make_file("c.txt", 50);
+  make_link("a/f1", "a/f2", true);
+  make_link("a/f1", "b/f3", true);
+  make_link("..", "a/sub/loop", false);
+  make_link("..", "b/up", false);
+  make_link("../a", "b/a", false);
+  make_link("../c.txt", "b/c", false);
+  make_link("nowhere", "broken", false);
+
+  const std::string out1(dir_ + ".1.xml"), out4(dir_ + ".4.xml");
+  std::string xml1 = run(webtree, "-j 1 " + dir_, out1);
+  std::string xml4 = run(webtree, "-j 4 " + dir_, out4);
+  if (xml1.empty() || strip_atime(xml1) != strip_atime(xml4)) {
+    std::cerr << "output depends on the number of threads\n";
+    errors++;
+  }
+  if (count(xml1, "<dir ") != 7 || count(xml1, "</dir>") != 4) {
+    std::cerr << "directories should be expanded once\n";
+    errors++;
+  }
+  if (count(xml1, "link='1'") != 6) {
+    std::cerr << "expected 6 links, found " << count(xml1, "link='1'") << "\n";
+    errors++;
+  }
+
+  tree t;
+  if (xml_tree(out1, t) <= 1) {
+    std::cerr << "cannot parse the output\n";
+    errors++;
+  }
+  else {
+    const StringColumn * tag = StringColumn::cast(t.find_column("tag"));
+    const FloatColumn * size = FloatColumn::cast(t.find_column("size"));
+    float files = 0;
+    for (unsigned n = 0; n < t.num_nodes(); n++)
+      if (tag->get(n) == "file")
+	files += size->get(n);
+    // f1 and c.txt once, and the broken link itself.
+    if (files != 100 + 50 + strlen("nowhere")) {
+      std::cerr << "total file size " << files << " is wrong\n";
+      errors++;
+    }
+  }
+
+  // Timing on a larger generated tree.
+  for (unsigned i = 0; i < fanout; i++) {
+    std::string d = "big" + std::to_string(i);
+    make_dir(d);
+    for (unsigned j = 0; j < fanout; j++) {
+      std::string e = d + "/d" + std::to_string(j);
+      make_dir(e);
+      for (unsigned k = 0; k < fanout; k++)
+	make_file(e + "/f" + std::to_string(k) + ".txt", k);
+    }
+  }
+  float time1, time4;
+  xml1 = run(webtree, "-j 1 " + dir_, out1, &time1);
+  xml4 = run(webtree, "-j 4 " + dir_, out4, &time4);
+  if (strip_atime(xml1) != strip_atime(xml4)) {
+    std::cerr << "output depends on the number of threads\n";
+    errors++;
+  }
+  std::cout << "webtree: " << time1 << "s with 1 thread, "
+	    << time4 << "s with 4 threads\n";
+  std::string dirtree = webtree.substr(0, webtree.rfind('/')) + "/dirtree";
+  if (access(dirtree.c_str(), X_OK) == 0) {
+    float time;
+    run(dirtree, dir_, out1, &time);
+    std::cout << "dirtree: " << time << "s\n";
+  }
+
+  std::remove(out1.c_str());
+  std::remove(out4.c_str());
+  system(("rm -rf " + dir_).c_str());
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,123 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/*
+ * Golden output of xml2csv on data/www.xml.gz in UTC: size and FNV-1a
+ * hash of the output of the original tool.
+ */
+static const size_t golden_size = 24711942;
+static const uint64_t golden_hash = 0x4f131aa94bdd566cull;
+
+static int errors = 0;
+
+static std::string
+run(const std::string& cmd)
+{
+  std::string ret;
+  FILE * in = popen(cmd.c_str(), "r");
+  if (in == 0) {
+    std::cerr << "cannot run " << cmd << std::endl;
+    errors++;
+    return ret;
+  }
+  char buf[65536];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof(buf), in)) != 0)
+    ret.append(buf, len);
+  if (pclose(in) != 0) {
+    std::cerr << "failed: " << cmd << std::endl;
+    errors++;
+  }
+  return ret;
+}
+
+static uint64_t
+fnv1a(const std::string& s)
+{
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+int main(int argc, char * argv[])
+{
+  std::string xml2csv(argv[0]);
+  std::string::size_type p = xml2csv.rfind('/');
+  xml2csv = (p == std::string::npos ? "." : xml2csv.substr(0, p)) + "/xml2csv";
+  const char * data = argc > 1 ? argv[1] : "data/www.xml.gz";
+  if (argc > 2)
+    xml2csv = argv[2];
+
+  std::string csv = run("TZ=UTC " + xml2csv + " " + data);
+  if (csv.size() != golden_size || fnv1a(csv) != golden_hash) {
+    std::cerr << "output differs from the golden output\n";
+    errors++;
+  }
+
+  // All the columns, discovered in a first pass then cached.
+  char tmpl[] = "/tmp/xml2csvXXXXXX";
+  int fd = mkstemp(tmpl);
+  if (fd < 0) {
+    std::cerr << "cannot create a temporary file\n";
+    return 1;
+  }
+  close(fd);
+  std::string copy(std::string(tmpl) + ".xml.gz");
+  std::rename(tmpl, copy.c_str());
+  {
+    std::ifstream in(data, std::ios::binary);
+    std::ofstream out(copy.c_str(), std::ios::binary);
+    out << in.rdbuf();
+  }
+  const std::string header("name;length;atime;mtime;ctime\n");
+  for (int pass = 0; pass < 2; pass++) {
+    std::string all = run("TZ=UTC " + xml2csv + " -a " + copy);
+    if (all.compare(0, header.size(), header) != 0 ||
+	all.compare(header.size(), std::string::npos, csv) != 0) {
+      std::cerr << "-a output differs, pass " << pass << std::endl;
+      errors++;
+    }
+    if (access((copy + ".columns").c_str(), R_OK) != 0) {
+      std::cerr << "columns are not cached\n";
+      errors++;
+    }
+  }
+  std::remove(copy.c_str());
+  std::remove((copy + ".columns").c_str());
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -23,154 +23,355 @@
  * SOFTWARE.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <sys/stat.h>
-#ifdef _WIN32
-#include <io.h>
-#else
 #include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
-#endif
 
-#include <set>
+#include <infovis/parallel_for.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Builds the XML tree of a site from the local filesystem, following
+ * symbolic links.  Directories are crawled by a pool of threads
+ * sharing a queue of directories; a directory reached several times,
+ * through links or cycles, is only listed once and only expanded at
+ * its first position in the output, and a file reached several times,
+ * through hard or symbolic links, only has its size counted once.  The output does not depend
+ * on the number of threads.
+ */
+
+/*
+ * Packed identity of a file.
+ */
+struct file_key {
+  uint64_t dev;
+  uint64_t ino;
+
+  file_key() : dev(0), ino(0) { }
+  file_key(const struct stat& st) : dev(st.st_dev), ino(st.st_ino) { }
+  bool operator == (const file_key& other) const {
+    return dev == other.dev && ino == other.ino;
+  }
+};
+
+struct file_key_hash {
+  size_t operator()(const file_key& k) const {
+    uint64_t h = (k.ino ^ (k.dev << 32 | k.dev >> 32)) * 0x9E3779B97F4A7C15ull;
+    return size_t(h ^ (h >> 29));
+  }
+};
 
-#include <infovis/tree/tree.hpp>
+/*
+ * Concurrent set of file keys, split into independently locked
+ * shards.
+ */
+class file_set {
+public:
+  bool insert(const file_key& k) {
+    shard& s = shards_[file_key_hash()(k) % shard_count];
+    std::lock_guard<std::mutex> lock(s.lock);
+    return s.keys.insert(k).second;
+  }
+protected:
+  enum { shard_count = 64 };
+  struct shard {
+    std::mutex lock;
+    std::unordered_set<file_key, file_key_hash> keys;
+  };
+  shard shards_[shard_count];
+};
 
-struct file_info : public stat {
+struct file_info {
   std::string	name;
-  unsigned	refs;
+  file_key	key;
+  long		size;
+  long		atime;
+  long		mtime;
+  long		ctime;
+  long		uid;
+  long		gid;
+  unsigned	mode;
+  bool		is_dir;
+
+  void set(const struct stat& st) {
+    key = file_key(st);
+    size = st.st_size;
+    atime = st.st_atime;
+    mtime = st.st_mtime;
+    ctime = st.st_ctime;
+    uid = st.st_uid;
+    gid = st.st_gid;
+    mode = st.st_mode;
+    is_dir = S_ISDIR(st.st_mode);
+  }
+  bool operator < (const file_info& other) const {
+    return name < other.name;
+  }
+};
+
+/*
+ * The entries of a directory, sorted by name.
+ */
+struct listing {
+  file_key key;
+  std::vector<file_info> entries;
+};
+
+struct job {
+  std::string path;
+  file_key key;
+};
+
+class work_queue {
+public:
+  work_queue() : busy_(0) { }
+
+  void push(job&& j) {
+    std::lock_guard<std::mutex> lock(lock_);
+    jobs_.push_back(std::move(j));
+    ready_.notify_one();
+  }
+
+  /*
+   * Wait for a job, returning false when the queue is empty and no
+   * worker can push more jobs.
+   */
+  bool pop(job& j) {
+    std::unique_lock<std::mutex> lock(lock_);
+    ready_.wait(lock, [this] { return ! jobs_.empty() || busy_ == 0; });
+    if (jobs_.empty())
+      return false;
+    j = std::move(jobs_.front());
+    jobs_.pop_front();
+    busy_++;
+    return true;
+  }
+
+  void done() {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (--busy_ == 0 && jobs_.empty())
+      ready_.notify_all();
+  }
+protected:
+  std::mutex lock_;
+  std::condition_variable ready_;
+  std::deque<job> jobs_;
+  unsigned busy_;
 };
 
-static inline bool
-operator < (const stat& f1, const stat& f2)
+static void
+list_dir(const job& j, work_queue& queue, file_set& visited,
+	 std::vector<listing>& out)
 {
-  return f1.st_dev < f2.st_dev ||
-    (f1.st_dev == f2.st_dev && f1.st_ino < f2.st_ino);
+  out.push_back(listing());
+  listing& l = out.back();
+  l.key = j.key;
+  DIR * dir = opendir(j.path.c_str());
+  if (dir == 0)
+    return;
+  const int fd = dirfd(dir);
+  struct dirent * ent;
+  struct stat st;
+  while ((ent = readdir(dir)) != 0) {
+    if (ent->d_name[0] == '.')
+      continue;
+    if (fstatat(fd, ent->d_name, &st, 0) != 0 &&
+	fstatat(fd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+      continue;
+    l.entries.push_back(file_info());
+    file_info& f = l.entries.back();
+    f.name = ent->d_name;
+    f.set(st);
+    if (f.is_dir && visited.insert(f.key))
+      queue.push(job{j.path + '/' + f.name, f.key});
+  }
+  closedir(dir);
+  std::sort(l.entries.begin(), l.entries.end());
 }
 
-static inline bool
-operator == (const stat& f1, const stat& f2)
+static void
+crawl(const std::string& root, const file_key& key, unsigned threads,
+      std::vector<listing>& listings)
 {
-  return f1.st_dev == f2.st_dev && f1.st_ino == f2.st_ino;
+  work_queue queue;
+  file_set visited;
+  visited.insert(key);
+  queue.push(job{root, key});
+
+  std::vector<std::vector<listing> > buffers(threads);
+  infovis::parallel_run(threads, [&](unsigned t) {
+    job j;
+    while (queue.pop(j)) {
+      list_dir(j, queue, visited, buffers[t]);
+      queue.done();
+    }
+  });
+
+  for (auto& b : buffers)
+    for (auto& l : b)
+      listings.push_back(std::move(l));
 }
 
-typedef std::set<file_info> FileSet;
+class xml_output {
+public:
+  enum { block_size = 1024 * 1024 };
 
-FileMap file_map;
+  xml_output(FILE * out) : out_(out) { buf_.reserve(block_size + 4096); }
+  ~xml_output() { flush(); }
 
-#ifdef _WIN32
-void process_dir(const char * name, int depth)
-{
-  struct _finddata_t f_data;
-  long code, handle;
-  char dirname[2048];
-  char * p;
-  struct stat st;
+  void flush() {
+    fwrite(buf_.data(), 1, buf_.size(), out_);
+    buf_.clear();
+  }
+  void tab(int i) { buf_.append(i, ' '); }
+  void put(const char * s) {
+    buf_ += s;
+    if (buf_.size() >= block_size)
+      flush();
+  }
+  void put_quoted(const std::string& str) {
+    for (unsigned char c : str) {
+      if (c < 32) {
+	buf_ += '^';
+	buf_ += char('A' + c);
+      }
+      else switch (c) {
+      case '&': buf_ += "&amp;"; break;
+      case '<': buf_ += "&lt;"; break;
+      case '>': buf_ += "&gt;"; break;
+      case '"': buf_ += "&quot;"; break;
+      case '\'': buf_ += "&apos;"; break;
+      default:
+	buf_ += char(c);
+      }
+    }
+  }
+  void attribute(const char * name, long value) {
+    char tmp[32];
+    snprintf(tmp, sizeof(tmp), " %s='%ld'", name, value);
+    buf_ += tmp;
+  }
+protected:
+  FILE * out_;
+  std::string buf_;
+};
 
-  tab(depth);
-  strcpy(dirname, name);
-  p = strrchr(dirname, '/');
-  if (p == 0)
-    p = dirname;
-  else
-    p++;
-  stat(dirname, &st);
-  strcat(dirname, "/");
-  fputs("<dir name='", stdout);
-  print_quoted(p);
-  printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld'>\n",
-	 st.st_size,
-	 st.st_atime,
-	 st.st_mtime,
-	 st.st_ctime);
-  strcat(dirname, "*");
-  for (handle = code = _findfirst(dirname, &f_data);
-       code != -1;
-       code = _findnext(handle, &f_data)) {
-    if (f_data.name[0] == '.')
-      continue;
-    if (f_data.attrib & _A_SUBDIR) {
-      strcpy(dirname, name);
-      strcat(dirname, "/");
-      strcat(dirname, f_data.name);
-      print_dir(dirname, depth+1);
+/*
+ * Serial pass producing the XML in name order from the listings.
+ */
+class tree_printer {
+public:
+  tree_printer(xml_output& out, const std::vector<listing>& listings)
+    : out_(out) {
+    for (const listing& l : listings)
+      dirs_[l.key] = &l;
+  }
+
+  void print_dir(const file_info& d, int depth) {
+    out_.tab(depth);
+    out_.put("<dir name='");
+    out_.put_quoted(d.name);
+    out_.put("'");
+    print_times(d);
+    out_.attribute("uid", d.uid);
+    out_.attribute("gid", d.gid);
+    if (! seen_.insert(d.key).second) {
+      out_.put(" link='1'/>\n");
+      return;
     }
-    else {
-      stat(dirname, &st);
-      tab(depth+1);
-      fputs("<file name='", stdout);
-      print_quoted(f_data.name);
-      printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld'/>\n",
-	     f_data.size,
-	     st.st_atime,
-	     st.st_mtime,
-	     st.st_ctime);
+    out_.put(">\n");
+    auto l = dirs_.find(d.key);
+    if (l != dirs_.end()) {
+      for (const file_info& f : l->second->entries) {
+	if (f.is_dir)
+	  print_dir(f, depth+1);
+	else
+	  print_file(f, depth+1);
+      }
     }
+    out_.tab(depth);
+    out_.put("</dir>\n");
   }
-  if (handle != -1)
-    _findclose(handle);
-  tab(depth);
-  printf("</dir>\n");
-}
-#else
-void process_dir(const char * name, int depth)
-{
-  DIR * dir;
-  struct dirent * ent;
-  char dirname[2048];
-  char * p;
-  struct stat st;
 
-  tab(depth);
-  strcpy(dirname, name);
-  p = strrchr(dirname, '/');
-  if (p == 0)
-    p = dirname;
-  else
-    p++;
-  stat(dirname, &st);
-  dir =opendir(dirname);
-  strcat(dirname, "/");
-  fputs("<dir name='", stdout);
-  print_quoted(p);
-  printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld' uid='%ld' gid='%ld'>\n",
-	 st.st_size,
-	 st.st_atime,
-	 st.st_mtime,
-	 st.st_ctime,
-	 st.st_uid,
-	 st.st_gid);
-  if (dir != 0) {
-    while ((ent = readdir(dir)) != 0) {
-      if (ent->d_name[0] != '.') {
-	strcpy(dirname, name);
-	strcat(dirname, "/");
-	strcat(dirname, ent->d_name);
-	if (lstat(dirname, &st) == 0 &&
-	    S_ISDIR(st.st_mode))
-	  print_dir(dirname, depth+1);
-	else {
-	  tab(depth+1);
-	  fputs("<file name='", stdout);
-	  print_quoted(ent->d_name);
-	  if ((st.st_mode&(S_IXUSR | S_IXGRP | S_IXOTH)) != 0 &&
-	      strchr(ent->d_name, '.') == 0) {
-	    fputs(".sh", stdout); /* add dummy executable suffix */
-	  }
-	  printf("' size='%ld' atime='%ld' mtime='%ld' ctime='%ld'/>\n",
-		 st.st_size,
-		 st.st_atime,
-		 st.st_mtime,
-		 st.st_ctime);
-	}
-      }
+  void print_file(const file_info& f, int depth) {
+    bool link = ! seen_.insert(f.key).second;
+    out_.tab(depth);
+    out_.put("<file name='");
+    out_.put_quoted(f.name);
+    if ((f.mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0 &&
+	strchr(f.name.c_str(), '.') == 0) {
+      out_.put(".sh"); /* add dummy executable suffix */
     }
-    closedir(dir);
+    out_.put("'");
+    print_times(f, link ? 0 : f.size);
+    if (link)
+      out_.put(" link='1'");
+    out_.put("/>\n");
   }
-  tab(depth);
-  printf("</dir>\n");
+
+protected:
+  void print_times(const file_info& f) { print_times(f, f.size); }
+  void print_times(const file_info& f, long size) {
+    out_.attribute("size", size);
+    out_.attribute("atime", f.atime);
+    out_.attribute("mtime", f.mtime);
+    out_.attribute("ctime", f.ctime);
+  }
+
+  xml_output& out_;
+  std::unordered_map<file_key, const listing*, file_key_hash> dirs_;
+  std::unordered_set<file_key, file_key_hash> seen_;
+};
+
+int main(int argc, char * argv[])
+{
+  unsigned threads = std::thread::hardware_concurrency();
+  int arg = 1;
+  if (arg + 1 < argc && strcmp(argv[arg], "-j") == 0) {
+    threads = atoi(argv[arg+1]);
+    arg += 2;
+  }
+  if (arg >= argc) {
+    fprintf(stderr, "syntax: webtree [-j threads] <dir>\n");
+    return 1;
+  }
+  if (threads == 0)
+    threads = 1;
+
+  std::string root(argv[arg]);
+  while (root.size() > 1 && root[root.size()-1] == '/')
+    root.erase(root.size()-1);
+  struct stat st;
+  if (stat(root.c_str(), &st) != 0 || ! S_ISDIR(st.st_mode)) {
+    fprintf(stderr, "webtree: %s is not a directory\n", root.c_str());
+    return 1;
+  }
+  file_info top;
+  top.set(st);
+  std::string::size_type p = root.rfind('/');
+  top.name = p == std::string::npos ? root : root.substr(p+1);
+
+  std::vector<listing> listings;
+  crawl(root, top.key, threads, listings);
+
+  xml_output out(stdout);
+  out.put("<?xml version=\"1.0\" encoding=\"iso-8859-1\"?>\n");
+  tree_printer printer(out, listings);
+  printer.print_dir(top, 0);
+  return 0;
 }
-#endif
@@ -4,104 +4,289 @@
 #include <string.h>
 #include <time.h>
 #include <stdlib.h>
+#include <sys/stat.h>
+
+/*
+ * Converts a directory tree in XML, as produced by dirtree, into
+ * semicolon separated values.  By default, the columns are the name,
+ * length and times of the dir and file elements.  With -a, all the
+ * attributes are output; their names are found by a first pass over
+ * the file and cached in <filename>.columns.
+ */
+
+#define READ_SIZE (4*1024*1024)
+#define WRITE_SIZE (4*1024*1024)
+#define MAX_COLUMNS 256
+
+static char out_buf[WRITE_SIZE];
+static size_t out_len = 0;
 
 static void
-printTime(const char * ts)
+flush_output(void)
+{
+  fwrite(out_buf, 1, out_len, stdout);
+  out_len = 0;
+}
+
+static void
+put(const char * s, size_t len)
+{
+  if (out_len + len > WRITE_SIZE) {
+    flush_output();
+    if (len > WRITE_SIZE) {
+      fwrite(s, 1, len, stdout);
+      return;
+    }
+  }
+  memcpy(out_buf + out_len, s, len);
+  out_len += len;
+}
+
+static void
+put_char(char c)
+{
+  if (out_len == WRITE_SIZE)
+    flush_output();
+  out_buf[out_len++] = c;
+}
+
+/* Times repeat a lot, so the last formatted time of each column is kept. */
+struct time_cache {
+  time_t time;
+  int valid;
+  size_t len;
+  char buffer[64];
+};
+
+static void
+printTime(struct time_cache * cache, const char * ts)
 {
   time_t t = atol(ts);
-  char buffer[1024];
-  struct tm * tm = localtime(&t);
-  strftime(buffer, 1024, "%d %b %Y %H:%M:%S", tm);
-  fputs(buffer, stdout);
+  if (! cache->valid || cache->time != t) {
+    struct tm * tm = localtime(&t);
+    cache->len = strftime(cache->buffer, sizeof(cache->buffer),
+			  "%d %b %Y %H:%M:%S", tm);
+    cache->time = t;
+    cache->valid = 1;
+  }
+  put(cache->buffer, cache->len);
+}
+
+static int
+is_time(const char * name)
+{
+  return strcmp(name, "atime") == 0 ||
+    strcmp(name, "mtime") == 0 ||
+    strcmp(name, "ctime") == 0;
+}
+
+/*
+ * Columns: their names, and for each element the value of each
+ * column.  The index of the last attribute name seen is cached since
+ * elements tend to list their attributes in the same order.
+ */
+static const char * columns[MAX_COLUMNS];
+static int column_count = 0;
+static const char * values[MAX_COLUMNS];
+static struct time_cache times[MAX_COLUMNS];
+
+static int
+find_column(const char * name, int guess)
+{
+  int i;
+  if (guess < column_count && strcmp(columns[guess], name) == 0)
+    return guess;
+  for (i = 0; i < column_count; i++)
+    if (strcmp(columns[i], name) == 0)
+      return i;
+  return -1;
+}
+
+static int
+add_column(const char * name)
+{
+  int i = find_column(name, 0);
+  if (i >= 0 || column_count == MAX_COLUMNS)
+    return i;
+  columns[column_count] = strdup(name);
+  return column_count++;
+}
+
+static void
+discoverElement(void *userData,
+		const char *qname, const char **atts)
+{
+  const char ** a;
+  for (a = atts; *a != 0; a += 2)
+    add_column(a[0]);
 }
 
 static void
 startElement(void *userData,
 	     const char *qname, const char **atts)
 {
-  const char * name = "";
-  const char * length = "";
-  const char * atime = "";
-  const char * mtime = "";
-  const char * ctime = "";
   const char * chr;
+  const char * name;
+  int i, guess = 0;
 
+  for (i = 0; i < column_count; i++)
+    values[i] = "";
   if (strcmp(qname, "dir") == 0 ||
       strcmp(qname, "file") == 0) {
     const char ** a;
     for (a = atts; *a != 0; a += 2) {
-      if (strcmp(a[0], "name") == 0) {
-	name = a[1];
-      }
-      else if (strcmp(a[0], "length") == 0) {
-	length = a[1];
-      }
-      else if (strcmp(a[0], "atime") == 0) {
-	atime = a[1];
-      }
-      else if (strcmp(a[0], "mtime") == 0) {
-	mtime = a[1];
-      }
-      else if (strcmp(a[0], "ctime") == 0) {
-	ctime = a[1];
+      i = find_column(a[0], guess);
+      if (i >= 0) {
+	values[i] = a[1];
+	guess = i + 1;
       }
     }
   }
-  chr = name;
-  if ((chr = strchr(chr, ';')) != NULL) {
-    fwrite(name, 1, chr - name, stdout);
+  for (i = 0; i < column_count; i++) {
+    if (i != 0)
+      put_char(';');
+    if (i == 0 && strcmp(columns[0], "name") == 0) {
+      name = values[0];
+      if ((chr = strchr(name, ';')) != NULL)
+	put(name, chr - name);
+      else
+	put(name, strlen(name));
+    }
+    else if (is_time(columns[i]))
+      printTime(&times[i], values[i]);
+    else
+      put(values[i], strlen(values[i]));
   }
-  else
-    fputs(name, stdout);
-  putchar(';');
-  fputs(length, stdout);
-  putchar(';');
-  printTime(atime);
-  putchar(';');
-  printTime(mtime);
-  putchar(';');
-  printTime(ctime);
-  putchar('\n');
+  put_char('\n');
 }
 
 static void endElement(void *userData, const char *name)
 {
 }
 
+static int
+parse(const char * filename, XML_StartElementHandler start)
+{
+  gzFile input;
+  XML_Parser parser;
+  int done = 0;
+  int ret = 0;
 
+  input = gzopen(filename, "rb");
+  if (input == NULL) {
+    fprintf(stderr, "cannot open %s\n", filename);
+    return 1;
+  }
+  gzbuffer(input, 256 * 1024);
 
-int main(int argc, char * argv[])
-{
-    char buf[1024];
-    gzFile input;
-    XML_Parser parser;
-    int done = 0;
-
-    if (argc < 2) {
-      fprintf(stderr, "syntax: %s filename\n", argv[0]);
-      exit(1);
+  parser = XML_ParserCreate(NULL);
+  XML_SetElementHandler(parser, start, endElement);
+  do {
+    void * buf = XML_GetBuffer(parser, READ_SIZE);
+    int len;
+    if (buf == NULL) {
+      fprintf(stderr, "out of memory\n");
+      ret = 1;
+      break;
     }
-
-    input = gzopen(argv[1], "rb");
-    if (input == NULL) {
-      fprintf(stderr, "cannot open %s\n", argv[0]);
-      exit(1);
+    len = gzread(input, buf, READ_SIZE);
+    if (len < 0)
+      len = 0;
+    done = len < READ_SIZE;
+    if (!XML_ParseBuffer(parser, len, done)) {
+      fprintf(stderr,
+	      "%s at line %d\n",
+	      XML_ErrorString(XML_GetErrorCode(parser)),
+	      (int)XML_GetCurrentLineNumber(parser));
+      done = 1;
     }
+  } while (!done);
+  gzclose(input);
+  XML_ParserFree(parser);
+  return ret;
+}
 
-    parser = XML_ParserCreate(NULL);
-    XML_SetElementHandler(parser, startElement, endElement);
-    do {
-      size_t len = gzread(input, buf, sizeof(buf));
-      done = len < sizeof(buf);
-      if (!XML_Parse(parser, buf, len, done)) {
-	fprintf(stderr,
-		"%s at line %d\n",
-		XML_ErrorString(XML_GetErrorCode(parser)),
-		XML_GetCurrentLineNumber(parser));
-	done = 1;
-      }
-    } while (!done);
-    gzclose(input);
-    XML_ParserFree(parser);
+/*
+ * Read the cached column names, if the cache is newer than the file.
+ */
+static int
+read_columns(const char * filename, const char * cache)
+{
+  struct stat file_st, cache_st;
+  char line[1024];
+  FILE * in;
+
+  if (stat(filename, &file_st) != 0 ||
+      stat(cache, &cache_st) != 0 ||
+      cache_st.st_mtime < file_st.st_mtime)
     return 0;
+  in = fopen(cache, "r");
+  if (in == NULL)
+    return 0;
+  while (fgets(line, sizeof(line), in) != NULL) {
+    line[strcspn(line, "\n")] = 0;
+    if (line[0] != 0)
+      add_column(line);
+  }
+  fclose(in);
+  return column_count != 0;
+}
+
+static void
+write_columns(const char * cache)
+{
+  int i;
+  FILE * out = fopen(cache, "w");
+  if (out == NULL)
+    return;
+  for (i = 0; i < column_count; i++)
+    fprintf(out, "%s\n", columns[i]);
+  fclose(out);
+}
+
+int main(int argc, char * argv[])
+{
+  const char * filename;
+  int all = 0;
+  int i, ret;
+
+  if (argc > 2 && strcmp(argv[1], "-a") == 0) {
+    all = 1;
+    argv++;
+    argc--;
+  }
+  if (argc < 2) {
+    fprintf(stderr, "syntax: %s [-a] filename\n", argv[0]);
+    exit(1);
+  }
+  filename = argv[1];
+
+  if (all) {
+    char * cache = malloc(strlen(filename) + sizeof(".columns"));
+    strcpy(cache, filename);
+    strcat(cache, ".columns");
+    add_column("name");
+    if (! read_columns(filename, cache)) {
+      if (parse(filename, discoverElement) != 0)
+	return 1;
+      write_columns(cache);
+    }
+    free(cache);
+    for (i = 0; i < column_count; i++) {
+      if (i != 0)
+	put_char(';');
+      put(columns[i], strlen(columns[i]));
+    }
+    put_char('\n');
+  }
+  else {
+    add_column("name");
+    add_column("length");
+    add_column("atime");
+    add_column("mtime");
+    add_column("ctime");
+  }
+  ret = parse(filename, startElement);
+  flush_output();
+  return ret;
 }
@@ -88,6 +88,28 @@ AnimateTree::render(float param)
   glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
   glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
 
+  if (! nodes_.empty()) {
+    for (unsigned i : fixed_)
+      drawer_.draw_box(end_[i], nodes_[i], 1);
+    for (unsigned i : moving_) {
+      const Box& from = start_[i];
+      const Box& to = end_[i];
+      Box interp;
+      if (is_null_box(from)) {
+	Point p(center(to));
+	interp = interp_box(Box(p, p), to, param);
+      }
+      else if (is_null_box(to)) {
+	Point p(center(from));
+	interp = interp_box(from, Box(p, p), param);
+      }
+      else
+	interp = interp_box(from, to, param);
+      drawer_.draw_box(interp, nodes_[i], 1);
+    }
+    last = 0;
+  }
+
   for (int i = 0; i < last; i++) {
     const Box& from = start_[i];
     const Box& to = end_[i];
@@ -119,6 +141,51 @@ AnimateTree::clear()
   std::fill(end_.begin(), end_.end(), Box());
   std::fill(tex_coords_.begin(), tex_coords_.end(), Box());
   texture_ = 0;
+  nodes_.clear();
+  moving_.clear();
+  fixed_.clear();
+}
+
+void
+AnimateTree::setDiff(const tree& from, const tree_diff& diff,
+		     const BoxList& from_boxes, const BoxList& to_boxes)
+{
+  static const Box null_box;
+  const unsigned n = unsigned(diff.old_of_new.size());
+  const unsigned count = n + unsigned(diff.removed.size());
+  start_.assign(count, null_box);
+  end_.assign(count, null_box);
+  nodes_.resize(count);
+  moving_.clear();
+  fixed_.clear();
+  texture_ = 0;
+
+  // The boxes of the tree, in its own indexing.
+  for (unsigned i = 0; i < n; i++) {
+    nodes_[i] = i;
+    if (i < to_boxes.size())
+      end_[i] = to_boxes[i];
+    const unsigned o = diff.old_of_new[i];
+    if (o != tree_diff::none && o < from_boxes.size())
+      start_[i] = from_boxes[o];
+  }
+  // Then the removed nodes, after them.
+  for (unsigned k = 0; k < diff.removed.size(); k++) {
+    unsigned o = diff.removed[k];
+    if (o < from_boxes.size())
+      start_[n + k] = from_boxes[o];
+    while (o != tree::root && diff.new_of_old[o] == tree_diff::none)
+      o = from.parent(o);
+    nodes_[n + k] = diff.new_of_old[o];
+  }
+  for (unsigned i = 0; i < count; i++) {
+    if (is_null_box(start_[i]) && is_null_box(end_[i]))
+      continue;
+    if (start_[i] == end_[i])
+      fixed_.push_back(i);
+    else
+      moving_.push_back(i);
+  }
 }
 
 
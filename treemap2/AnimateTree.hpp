@@ -26,6 +26,7 @@
 #define TREEMAP2_ANIMATETREE_HPP
 
 #include <infovis/drawing/AnimateBoxList.hpp>
+#include <infovis/tree/tree_diff.hpp>
 
 #include <types.hpp>
 
@@ -40,9 +41,29 @@ public:
   
   virtual void render(float param = 0.0f);
   void clear();
+
+  /**
+   * Animate from the layout of another version of the tree.
+   * Matched nodes move from their old box to their new one, added
+   * nodes grow from their center and removed nodes shrink into
+   * theirs, drawn with the color of their closest matched ancestor.
+   * Only the boxes that differ are interpolated.
+   * @param from the old tree
+   * @param diff the correspondence computed by diff_trees(from, tree)
+   * @param from_boxes the boxes of the old tree
+   * @param to_boxes the boxes of the tree
+   */
+  void setDiff(const tree& from, const tree_diff& diff,
+	       const BoxList& from_boxes, const BoxList& to_boxes);
+
+  unsigned movingCount() const { return unsigned(moving_.size()); }
+
 protected:
   Tree& tree_;
   FastDrawer& drawer_;
+  std::vector<unsigned> nodes_;	///< node drawn by each diff box
+  std::vector<unsigned> moving_; ///< diff boxes to interpolate
+  std::vector<unsigned> fixed_;	///< diff boxes drawn in place
 };
 
 } // namespace infovis
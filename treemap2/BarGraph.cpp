@@ -31,7 +31,9 @@ namespace infovis {
 
 
 BarGraph::BarGraph(unsigned bars)
-  : bars_(bars)
+  : bars_(bars),
+    values_(nullptr),
+    filter_(nullptr)
 {
   reset();
 }
@@ -76,17 +78,51 @@ void
 BarGraph::computeDistribution(const FloatColumn& values,
 			      float min_val, float max_val)
 {
-  float step = (max_val - min_val + 1) / bars_.size();
-  float gap = bars_.size() / (max_val - min_val + 1);
+  values_ = &values;
+  histogram_.set_domain(min_val, max_val, 1);
+  histogram_.compute(values, filter_);
+  rebin();
+}
 
-  reset(0);
+void
+BarGraph::updateRows(const std::vector<unsigned>& entered,
+		     const std::vector<unsigned>& left)
+{
+  if (values_ == nullptr || (entered.empty() && left.empty()))
+    return;
+  histogram_.update(*values_, entered, left);
+  rebin();
+}
 
-  for (const auto& value : values) {
-    if (value < min_val || value > max_val)
-      continue;
-    int index = int((value - min_val) / step);
-    for (int j = index; j <= int(index + gap); j++)
-      bars_[j]++;
+void
+BarGraph::setBars(unsigned bars)
+{
+  if (bars < 2 || bars == bars_.size())
+    return;
+  bars_.resize(bars);
+  if (values_ != nullptr)
+    rebin();
+  else
+    reset(0);
+}
+
+void
+BarGraph::rebin()
+{
+  // Each value covers a unit interval so, when there are more bars
+  // than units in the range, a value spreads over several bars.
+  histogram::Bins counts;
+  histogram_.resample(unsigned(bars_.size()), counts);
+  const float extent = histogram_.max() - histogram_.min() + 1;
+  int gap = 0;
+  if (extent > 0)
+    gap = int(std::min(float(bars_.size()), bars_.size() / extent));
+  unsigned long sum = 0;
+  for (size_t j = 0; j < bars_.size(); j++) {
+    sum += counts[j];
+    if (int(j) > gap)
+      sum -= counts[j - gap - 1];
+    bars_[j] = float(sum);
   }
   max_ = min_ = bars_[0];
   for (auto it = bars_.begin() + 1; it != bars_.end(); ++it) {
@@ -98,7 +134,6 @@ BarGraph::computeDistribution(const FloatColumn& values,
   }
 }
 
-
 void
 BarGraph::updateMinMax()
 {
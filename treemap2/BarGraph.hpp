@@ -28,6 +28,7 @@
 #include <infovis/drawing/drawing.hpp>
 #include <infovis/drawing/direction.hpp>
 #include <infovis/table/column.hpp>
+#include <infovis/table/histogram.hpp>
 #include <vector>
 
 namespace infovis {
@@ -46,12 +47,38 @@ public:
   virtual void computeDistribution(const FloatColumn& values);
   virtual void computeDistribution(const FloatColumn& values,
 				   float min_val, float max_val);
+
+  /**
+   * Restrict the distribution to the rows not filtered out.
+   * @param filter the filter column, or 0 to count all the rows
+   */
+  void setFilter(const column_of<unsigned> * filter) { filter_ = filter; }
+
+  /**
+   * Update the distribution for rows whose visibility changed
+   * without rescanning the column.
+   * @param entered the rows that entered the filter
+   * @param left the rows that left the filter
+   */
+  virtual void updateRows(const std::vector<unsigned>& entered,
+			  const std::vector<unsigned>& left);
+
+  unsigned getBars() const { return unsigned(bars_.size()); }
+
+  /**
+   * Change the number of bars, resampling the current distribution.
+   */
+  virtual void setBars(unsigned bars);
   
 protected:
   void updateMinMax();
+  void rebin();
   List bars_;
   float min_;
   float max_;
+  histogram histogram_;
+  const FloatColumn * values_;
+  const column_of<unsigned> * filter_;
 };
 
 } // namespace infovis
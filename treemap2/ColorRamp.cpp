@@ -112,4 +112,18 @@ getRamp(Ramp r)
   return _ramp_sequential1();
 }
 
+const color_lut&
+getRampLUT(Ramp r, bool smooth)
+{
+  static color_lut luts[ramp_max][2];
+  static bool built[ramp_max][2];
+  if (r < 0 || r >= ramp_max)
+    r = ramp_sequential1;
+  if (! built[r][smooth]) {
+    luts[r][smooth].build(getRamp(r), smooth);
+    built[r][smooth] = true;
+  }
+  return luts[r][smooth];
+}
+
 } // namespace infovis
@@ -26,6 +26,7 @@
 #define TREEMAP2_COLORRAMP_HPP
 
 #include <infovis/drawing/drawing.hpp>
+#include <infovis/drawing/colors/color_lut.hpp>
 #include <vector>
 
 namespace infovis {
@@ -49,6 +50,13 @@ enum Ramp {
 
 const ColorRamp& getRamp(Ramp r);
 
+/**
+ * Return the lookup table sampling a ramp, built on first use.
+ * @param r the ramp
+ * @param smooth true to interpolate between the colors of the ramp
+ */
+const color_lut& getRampLUT(Ramp r, bool smooth);
+
 
 } // namespace infovis
 
@@ -237,6 +237,7 @@ ControlsTab::ControlsTab(LiteTreemap * tm,
   current_ramp_ = ramp_categorical1;
 
   color_bargraph_ = new BarGraph(100);
+  color_bargraph_->setFilter(filter_);
   color_range_slider_ = new LiteRangeSliderGraph(&color_range_,
 						 Box(100, 0, 200, 10),
 						 color_bargraph_,
@@ -310,15 +311,26 @@ ControlsTab::doRender(const RenderContext& rc)
   }
 }
 
+static void
+set_query_bounds(DefaultBoundedRangeObservable * bounds,
+		 const FloatColumn * col)
+{
+  bounds->set_min(col->min());
+  bounds->set_max(col->max());
+  bounds->set_value_range(col->min(),
+			  (col->get_name() == "degree") ?
+			  0 : col->max() - col->min());
+}
+
 void
 ControlsTab::create_numeric(const FloatColumn * col)
 {
+  // Derived columns not filled yet get their bounds in requireQueries()
+  const bool pending = treemap_->isPendingColumn(col->get_name());
   DefaultBoundedRangeObservable * bounds =
-    new DefaultBoundedRangeObservable(col->min(),
-				      col->max(),
-				      col->min(),
-				      (col->get_name() == "degree") ?
-				      0 : col->max() - col->min());
+    new DefaultBoundedRangeObservable(0, 0, 0);
+  if (! pending)
+    set_query_bounds(bounds, col);
   LiteRangeSlider * slider = new LiteRangeSlider(bounds,
 						 Box(100, 0, 200, 10),
 						 left_to_right);
@@ -332,8 +344,27 @@ ControlsTab::create_numeric(const FloatColumn * col)
   slider->addBeginEndObserver(this);
   slider->addBeginEndObserver(treemap_);
   bounds->addBoundedRangeObserver(this);
+  bounds_.push_back(bounds);
   column_.push_back(col);
-  applyFilters(column_.size()-1);
+  if (! pending)
+    applyFilters(column_.size()-1);
+}
+
+void
+ControlsTab::requireQueries()
+{
+  bool filled = false;
+  for (unsigned i = 0; i < column_.size(); i++) {
+    const FloatColumn * col = FloatColumn::cast(column_[i]);
+    if (col == nullptr || ! treemap_->requireColumn(col->get_name()))
+      continue;
+    set_query_bounds(bounds_[i], col);
+    bounds_[i]->notifyBoundedRange();
+    applyFilters(i);
+    filled = true;
+  }
+  if (filled)
+    treemap_->updateMinMax();
 }
 
 void
@@ -406,17 +437,26 @@ ControlsTab::filter(int index)
   unsigned filtered = 0;
   const unsigned mask = 1 << index;
   const unsigned not_mask = ~mask;
+  std::vector<unsigned> entered, left;
 
   for (size_t i = 0; i < col->size(); i++) {
+    unsigned& f = (*filter_)[i];
+    const unsigned old = f;
     if (!col->defined(i) ||
         !in_range(col->fast_get(i), min, max)) {
-      (*filter_)[i] |= mask;
+      f |= mask;
       filtered++;
     }
     else {
-      (*filter_)[i] &= not_mask;
+      f &= not_mask;
     }
+    if (old == 0 && f != 0)
+      left.push_back(unsigned(i));
+    else if (old != 0 && f == 0)
+      entered.push_back(unsigned(i));
   }
+  color_bargraph_->updateRows(entered, left);
+  treemap_->filterChanged();
 #ifdef PRINT
   if (filtered != 0)
     std::cerr << "Filtered " << filtered << " items\n";
@@ -775,6 +815,7 @@ ControlsTab::setColorAttribute(const string& prop)
     }
   }
   float min_val, max_val;
+  treemap_->requireColumn(prop);
   const FloatColumn& values = *FloatColumn::cast(tree_.find_column(prop));
   min_val = values.min();
   max_val = values.max();
@@ -793,6 +834,17 @@ ControlsTab::setColorAttribute(const string& prop)
   repaint();
 }
 
+void
+ControlsTab::updateColorDistribution()
+{
+  const FloatColumn * values =
+    FloatColumn::cast(tree_.find_column(treemap_->getColorProp()));
+  if (values == nullptr)
+    return;
+  color_bargraph_->computeDistribution(*values,
+				       color_range_.min(), color_range_.max());
+}
+
 void
 ControlsTab::fill_color_ramp_menu()
 {
@@ -809,7 +861,7 @@ ControlsTab::setRamp(Ramp r)
   if (r == current_ramp_) return;
   color_ramp_combo_->setSelectedMenuItem(r);
   current_ramp_ = r;
-  treemap_->getDrawer().set_color_ramp(getRamp(r));
+  treemap_->getDrawer().set_color_ramp(r);
   treemap_->enableSaveUnder();
   repaint();
 }
@@ -882,6 +934,8 @@ ControlsTab::sortBy(const string& order)
     sort(tree_, compare_order());
   }
   else {
+    treemap_->requireColumn(order[0] == '<' || order[0] == '>' ?
+			    order.substr(1) : order);
     if (order[0] == '<')
       sort(tree_, less_weight(*FloatColumn::find(order.substr(1), tree_)));
     else if (order[0] == '>')
@@ -84,6 +84,19 @@ public:
   void set_color_range(float min, float range);
   void sortBy(const string& order);
   void setLayout(LiteTreemap::Layout l);
+
+  /**
+   * Recompute the distribution shown under the color range slider
+   * after values of the color column or rows changed in place,
+   * keeping the selected range.
+   */
+  void updateColorDistribution();
+
+  /**
+   * Fill the derived columns of the query sliders not filled yet,
+   * before the queries are shown.
+   */
+  void requireQueries();
   
   // InteractorEnterLeave
   virtual bool doEnter(const Event&);
@@ -133,6 +146,7 @@ protected:
 
   LiteBox * queries_;
   std::vector<LiteRangeSlider*> slider_;
+  std::vector<DefaultBoundedRangeObservable*> bounds_;
   std::vector<const column*> column_;
 
   LiteBox * controls_;
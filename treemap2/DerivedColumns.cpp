@@ -0,0 +1,253 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <DerivedColumns.hpp>
+#include <infovis/table/column_view.hpp>
+#include <infovis/table/metadata.hpp>
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace infovis {
+
+static inline float
+log_value(float w)
+{
+  double d = std::log(w + 1.0);
+  return std::isnan(d) ? 0 : d;
+}
+
+static inline float
+sqrt_value(float w)
+{
+  double d = std::sqrt(w);
+  return std::isnan(d) ? 0 : d;
+}
+
+DerivedColumns::DerivedColumns(tree& t, FloatColumn& weight)
+  : tree_(t),
+    weight_(weight),
+    sum_weight_(false)
+{ }
+
+FloatColumn *
+DerivedColumns::declare(const string& name, Kind kind)
+{
+  FloatColumn * col = FloatColumn::find(name, tree_);
+  col->resize(0);
+  if (kind != depth)
+    col->put_metadata(metadata::aggregate, metadata::aggregate_sum);
+  Derived d = { name, kind, col };
+  pending_.push_back(d);
+  return col;
+}
+
+bool
+DerivedColumns::isPending(const string& name) const
+{
+  for (const Derived& d : pending_)
+    if (d.name == name)
+      return true;
+  return false;
+}
+
+bool
+DerivedColumns::require(const string& name)
+{
+  if (! isPending(name))
+    return false;
+  compute(std::vector<string>(1, name));
+  return true;
+}
+
+void
+DerivedColumns::compute(const std::vector<string>& names, unsigned threads)
+{
+  DerivedList todo, rest;
+  for (const Derived& d : pending_) {
+    if (std::find(names.begin(), names.end(), d.name) != names.end())
+      todo.push_back(d);
+    else
+      rest.push_back(d);
+  }
+  if (todo.empty() && ! sum_weight_)
+    return;
+  fill(todo, threads);
+  pending_.swap(rest);
+}
+
+void
+DerivedColumns::computeAll(unsigned threads)
+{
+  DerivedList todo;
+  todo.swap(pending_);
+  if (todo.empty() && ! sum_weight_)
+    return;
+  fill(todo, threads);
+}
+
+void
+DerivedColumns::fill(const DerivedList& todo, unsigned threads)
+{
+  const unsigned n = tree_.num_nodes();
+  if (n == 0)
+    return;
+
+  // Preorder array and depths, following the sibling links upward
+  // instead of keeping a stack.
+  preorder_.clear();
+  preorder_.reserve(n);
+  depth_.assign(n, 0);
+  tree::node_descriptor node = tree::root;
+  unsigned d = 0;
+  for (;;) {
+    preorder_.push_back(node);
+    depth_[node] = d;
+    if (! tree_.is_leaf(node)) {
+      node = tree_.child(node);
+      d++;
+      continue;
+    }
+    while (node != tree::root && tree_.next(node) == tree::nil()) {
+      node = tree_.parent(node);
+      d--;
+    }
+    if (node == tree::root)
+      break;
+    node = tree_.next(node);
+  }
+
+  // Per node values, in parallel.  Only the leaves of summed columns
+  // get a value, the other nodes are set by the bottom-up pass.
+  for (const Derived& c : todo)
+    c.column->resize(n);
+  const column_view<float> weight(weight_);
+  parallel_for(n, parallel_threads(n, threads),
+	       [&](unsigned, unsigned begin, unsigned end) {
+    for (const Derived& c : todo) {
+      FloatColumn& col = *c.column;
+      for (unsigned i = begin; i < end; i++) {
+	const bool leaf = tree_.is_leaf(i);
+	const float w = i < weight.size() ? weight[i] : 0;
+	float v;
+	switch(c.kind) {
+	case log_weight:  v = leaf ? log_value(w) : 0; break;
+	case sqrt_weight: v = leaf ? sqrt_value(w) : 0; break;
+	case leaf_count:  v = leaf ? 1 : 0; break;
+	default:          v = depth_[i]; break;
+	}
+	col.fast_set(i, v);
+      }
+    }
+  });
+  for (const Derived& c : todo) {
+    c.column->define_all();
+    filled_.push_back(c);
+  }
+
+  // One bottom-up pass summing all the aggregated columns, adding the
+  // children in order like sum_weights so the results are identical.
+  std::vector<FloatColumn*> summed;
+  for (const Derived& c : todo)
+    if (c.kind != depth)
+      summed.push_back(c.column);
+  const unsigned derived = unsigned(summed.size());
+  if (sum_weight_) {
+    if (weight_.size() < n)
+      weight_.resize(n);
+    summed.push_back(&weight_);
+  }
+  std::vector<float> sum(summed.size());
+  for (unsigned p = unsigned(preorder_.size()); p-- != 0; ) {
+    node = preorder_[p];
+    if (tree_.is_leaf(node))
+      continue;
+    std::fill(sum.begin(), sum.end(), 0.0f);
+    for (tree::node_descriptor c = tree_.child(node);
+	 c != tree::nil(); c = tree_.next(c))
+      for (unsigned j = 0; j < summed.size(); j++)
+	sum[j] += summed[j]->fast_get(c);
+    for (unsigned j = 0; j < derived; j++)
+      summed[j]->fast_set(node, sum[j]);
+    if (sum_weight_)
+      weight_[node] = sum[derived];
+    for (const Derived& c : todo)
+      c.column->undefine(node);
+  }
+  sum_weight_ = false;
+}
+
+void
+DerivedColumns::update(const std::vector<tree::node_descriptor>& nodes)
+{
+  if (filled_.empty())
+    return;
+  // set_leaf_value adds to the dirty list, which may be the argument.
+  const std::vector<tree::node_descriptor> changed(nodes);
+  const unsigned n = tree_.num_nodes();
+  for (const Derived& c : filled_)
+    if (c.column->size() < n)
+      c.column->resize(n);
+
+  std::vector<tree::node_descriptor> stack;
+  for (tree::node_descriptor node : changed) {
+    if (node >= n || tree_.removed(node))
+      continue;
+    const float w = node < weight_.size() ? weight_[node] : 0;
+    for (const Derived& c : filled_) {
+      FloatColumn& col = *c.column;
+      if (c.kind == depth) {
+	unsigned d = 0;
+	for (tree::node_descriptor p = node; p != tree::root;
+	     p = tree_.parent(p))
+	  d++;
+	if (col.defined(node) && col.fast_get(node) == d)
+	  continue;
+	// Moved subtrees change the depth of all their nodes.
+	stack.push_back(node);
+	col.set(node, d);
+	while (! stack.empty()) {
+	  tree::node_descriptor p = stack.back();
+	  stack.pop_back();
+	  for (tree::node_descriptor ch = tree_.child(p);
+	       ch != tree::nil(); ch = tree_.next(ch)) {
+	    col.set(ch, col.fast_get(p) + 1);
+	    stack.push_back(ch);
+	  }
+	}
+      }
+      else if (tree_.is_leaf(node)) {
+	float v;
+	switch(c.kind) {
+	case log_weight:  v = log_value(w); break;
+	case sqrt_weight: v = sqrt_value(w); break;
+	default:          v = 1; break;
+	}
+	tree_.set_leaf_value(node, col, v);
+      }
+    }
+  }
+}
+
+} // namespace infovis
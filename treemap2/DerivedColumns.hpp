@@ -0,0 +1,129 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TREEMAP2_DERIVEDCOLUMNS_HPP
+#define TREEMAP2_DERIVEDCOLUMNS_HPP
+
+#include <infovis/tree/tree.hpp>
+#include <infovis/table/column.hpp>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Columns derived from the weight column and the tree structure.
+ *
+ * Derived columns are declared empty so that they show up in the
+ * menus, and filled on first use.  Filling several columns is fused
+ * into one pass: the per node values are computed in parallel over a
+ * preorder array of the tree, then all the summed columns are
+ * aggregated in a single bottom-up traversal.  As in the rest of
+ * treemap2, only the leaf values of the filled columns are defined.
+ */
+class DerivedColumns
+{
+public:
+  enum Kind {
+    log_weight,			///< log(weight + 1), summed
+    sqrt_weight,		///< sqrt(weight), summed
+    leaf_count,			///< number of leaves under a node
+    depth			///< depth of a node, the root being 0
+  };
+
+  /**
+   * Create the derived columns of a tree.
+   * @param t the tree
+   * @param weight the column the weights are derived from
+   */
+  DerivedColumns(tree& t, FloatColumn& weight);
+
+  /**
+   * Also sum the weight column itself during the next fill.
+   */
+  void sumWeight() { sum_weight_ = true; }
+
+  /**
+   * Declare a derived column, creating it empty in the tree.
+   * @param name the column name
+   * @param kind how to derive it
+   * @return the column
+   */
+  FloatColumn * declare(const string& name, Kind kind);
+
+  /**
+   * Check whether a column is declared but not filled yet.
+   */
+  bool isPending(const string& name) const;
+
+  /**
+   * Fill a column if it is pending.
+   * @param name the column name
+   * @return true if the column has been filled by this call
+   */
+  bool require(const string& name);
+
+  /**
+   * Fill several pending columns in one pass.
+   * @param names the column names, names not pending are ignored
+   * @param threads the number of threads, 0 for the hardware
+   * concurrency
+   */
+  void compute(const std::vector<string>& names, unsigned threads = 0);
+
+  /**
+   * Fill all the pending columns in one pass.
+   */
+  void computeAll(unsigned threads = 0);
+
+  /**
+   * Update the filled columns after the tree has been mutated.
+   * Leaves get their values derived again through
+   * tree::set_leaf_value, so the sums follow along their ancestors,
+   * and the depths are recomputed below the changed nodes.
+   * @param nodes the changed nodes, usually tree::dirty_nodes()
+   */
+  void update(const std::vector<tree::node_descriptor>& nodes);
+
+protected:
+  struct Derived {
+    string name;
+    Kind kind;
+    FloatColumn * column;
+  };
+  typedef std::vector<Derived> DerivedList;
+
+  void fill(const DerivedList& todo, unsigned threads);
+
+  tree& tree_;
+  FloatColumn& weight_;
+  bool sum_weight_;
+  DerivedList pending_;
+  DerivedList filled_;
+  std::vector<tree::node_descriptor> preorder_;
+  std::vector<unsigned> depth_;
+};
+
+} // namespace infovis
+
+#endif // TREEMAP2_DERIVEDCOLUMNS_HPP
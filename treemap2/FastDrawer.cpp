@@ -26,6 +26,8 @@
 #include <infovis/drawing/lite/LiteWindow.hpp>
 #include <FastDrawer.hpp>
 #include <ColorRamp.hpp>
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
 #include <iostream>
 #if 0
 #define GLH_EXT_SINGLE_FILE
@@ -68,17 +70,21 @@ FastDrawer::FastDrawer(const Tree& t,
     current_(0),
     mode_(gl::bm_quads),
     max_depth_(unsigned(-1)),
-    filter_(FilterColumn::cast(t.find_column("$filter"))),
     color_texture_(0),
     color_smooth_(false),
     color_ramp_(),
+    ramp_(ramp_max),
+    lut_(&color_lut_),
     color_range_(0),
     color_min_(0),
     color_scale_(0),
+    color_norm_(0),
     color_delta_(0),
+    color_index_valid_(false),
     dryrun_(false),
     total_size_(0)
 {
+  color_lut_.build(std::vector<Color>(1, color_white), false);
 #if 0
   if (false &&
       glh_init_extensions("GL_ARB_multitexture "
@@ -124,6 +130,7 @@ FastDrawer::FastDrawer(const Tree& t,
 #endif
   // continue with std allocation
   data_ = new float[size_ * VERTEX_INFO];
+  update_views();
 }
 
 FastDrawer::~FastDrawer()
@@ -235,7 +242,7 @@ FastDrawer::allocate_ressources()
 #endif
     if (color_ramp_.empty()) {
       // beware of the order, set_color_ramp calls allocate_ressources
-      set_color_ramp(getRamp(ramp_categorical1));
+      set_color_ramp(ramp_categorical1);
       set_color_smooth(false);
     }
   }
@@ -252,7 +259,13 @@ FastDrawer::allocate_ressources()
 void
 FastDrawer::set_color_ramp(const std::vector<Color>& colors)
 {
-  color_ramp_ = colors;
+  if (&colors != &color_ramp_) {
+    color_ramp_ = colors;
+    ramp_ = ramp_max;
+    color_lut_.build(color_ramp_, color_smooth_);
+  }
+  update_lut();
+  color_index_valid_ = false;
 
 #ifndef NO_TEXTURE
   int i;
@@ -330,6 +343,26 @@ FastDrawer::set_color_ramp(const std::vector<Color>& colors)
   set_color_range(color_min_, color_range_);
 }
 
+void
+FastDrawer::set_color_ramp(Ramp r)
+{
+  color_ramp_ = getRamp(r);
+  ramp_ = r;
+  set_color_ramp(color_ramp_);
+}
+
+void
+FastDrawer::update_lut()
+{
+  if (ramp_ != ramp_max)
+    lut_ = &getRampLUT(ramp_, color_smooth_);
+  else {
+    if (color_lut_.smooth() != color_smooth_)
+      color_lut_.build(color_ramp_, color_smooth_);
+    lut_ = &color_lut_;
+  }
+}
+
 const std::vector<Color>&
 FastDrawer::get_color_ramp() const
 {
@@ -340,6 +373,16 @@ void
 FastDrawer::set_color_prop(const FloatColumn * prop)
 {
   color_prop_ = prop;
+  color_index_valid_ = false;
+  update_views();
+}
+
+void
+FastDrawer::update_views()
+{
+  color_ = color_prop_ != 0 ? column_view<float>(*color_prop_)
+    : column_view<float>();
+  filter_ = column_view<unsigned>::of(tree_.find_column("$filter"));
 }
 
 void
@@ -347,6 +390,8 @@ FastDrawer::set_color_smooth(bool smooth)
 {
   color_smooth_ = smooth;
   allocate_ressources();
+  if (! color_ramp_.empty() && lut_->smooth() != smooth)
+    update_lut();
   //std::cerr << "Color smooth: " << smooth << std::endl;
 #ifndef NO_TEXTURE
 #if VERTEX_INFO==5
@@ -399,8 +444,10 @@ FastDrawer::set_color_range(float min_value, float range)
   }
   color_scale_ = (color_ramp_.size()-1) / ((s-1) * color_range_) ;
 #endif
+  color_norm_ = 1.0f / color_range_;
   //color_delta_ = color_scale_ * 0.2f;
   color_delta_ = 0;
+  color_index_valid_ = false;
 
 #if 0
   std::cerr << "Color range: " << range 
@@ -418,10 +465,44 @@ FastDrawer::get_color_range(float& min_value, float& range)
   range = color_range_;
 }
 
+void
+FastDrawer::update_color_index(unsigned threads)
+{
+  // Nodes without a color value, if any, get the first color.
+  const unsigned n = std::max(color_.size(), unsigned(tree_.num_nodes()));
+  color_index_.resize(n);
+  parallel_for(n, parallel_threads(n, threads),
+	       [this](unsigned, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; i++)
+      color_index_[i] = i < color_.size() ? color_to_index(color_[i]) : 0;
+  });
+  color_index_valid_ = true;
+}
+
+void
+FastDrawer::update_color_index(const std::vector<node_descriptor>& nodes)
+{
+  update_views();
+  if (! color_index_valid_)
+    return;			// start() recomputes everything anyway
+  const unsigned old_size = unsigned(color_index_.size());
+  const unsigned n = std::max(color_.size(), unsigned(tree_.num_nodes()));
+  color_index_.resize(n, 0);
+  for (unsigned i = old_size; i < color_.size(); i++)
+    color_index_[i] = color_to_index(color_[i]);
+  for (node_descriptor i : nodes)
+    if (i < color_.size())
+      color_index_[i] = color_to_index(color_[i]);
+}
+
 void
 FastDrawer::start(gl::begin_mode mode)
 {
   mode_ = mode;
+  update_views();
+  if (! color_index_valid_ ||
+      color_index_.size() < std::max(color_.size(), unsigned(tree_.num_nodes())))
+    update_color_index();
 #ifdef NO_TEXTURE
   glEnableClientState(GL_COLOR_ARRAY);
 #else
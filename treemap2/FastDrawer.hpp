@@ -30,7 +30,10 @@
 #include <infovis/tree/treemap/drawing/color_drawer.hpp>
 #include <infovis/tree/treemap/drawing/border_drawer.hpp>
 #include <infovis/drawing/drawing.hpp>
+#include <infovis/drawing/colors/color_lut.hpp>
+#include <infovis/table/column_view.hpp>
 #include <BorderDrawer.hpp>
+#include <ColorRamp.hpp>
 #include <types.hpp>
 
 #define VERTEX_INFO 4
@@ -55,10 +58,33 @@ public:
 	     unsigned size = (1<<15)); // use large buffer
   ~FastDrawer();
 
+  /**
+   * Use a custom ramp.  The color index is recomputed by the next
+   * start(), its scale depending on the ramp size.
+   */
   void set_color_ramp(const std::vector<Color>& colors);
+  /**
+   * Use one of the predefined ramps, sharing its cached lookup table.
+   */
+  void set_color_ramp(Ramp r);
   const std::vector<Color>& get_color_ramp() const;
 
+  /**
+   * Return the table mapping a value normalized over the color range
+   * to its rgba8 color, following the ramp and smoothness.  The boxes
+   * only go through it under NO_TEXTURE; otherwise they carry a
+   * texture coordinate and the ramp texture colors them on the GPU.
+   */
+  const color_lut& get_color_lut() const { return *lut_; }
+
   void set_color_prop(const FloatColumn * prop);
+  const FloatColumn * get_color_prop() const { return color_prop_; }
+
+  /**
+   * Resolve the color and filter views again, after the columns have
+   * been resized.  Called by start().
+   */
+  void update_views();
   
   void set_color_smooth(bool smooth = false);
   bool get_color_smooth() const;
@@ -66,50 +92,64 @@ public:
   void set_color_range(float min_value = 0, float range = 0);
   void get_color_range(float& min_value, float& range);
 
-  void start(gl::begin_mode mode = gl::bm_quads);
+  /**
+   * Recompute the color index of all the nodes, in parallel.  Done
+   * by start() when the color column, its range or the ramp changed.
+   * @param threads the number of threads, 0 for the hardware
+   * concurrency
+   */
+  void update_color_index(unsigned threads = 0);
 
-#ifdef NO_TEXTURE
-  static inline float interp(float t, float v1, float v2) {
-    return (1-t)*v1 + t*v2;
-  }
+  /**
+   * Recompute the color index of some nodes whose color value
+   * changed in place, growing the index if nodes have been added.
+   * @param nodes the nodes, typically tree::dirty_nodes()
+   */
+  void update_color_index(const std::vector<node_descriptor>& nodes);
 
-  static inline Color interp(float t, const Color& c1, const Color& c2) {
-    Color ret;
-    detail::round(ret[Color::red],
-		  interp(t, c1[Color::red], c2[Color::red]));
-    detail::round(ret[Color::green],
-		  interp(t, c1[Color::green], c2[Color::green]));
-    detail::round(ret[Color::blue],
-		  interp(t, c1[Color::blue], c2[Color::blue]));
-    return ret;
+  const std::vector<unsigned short>& get_color_index() const {
+    return color_index_;
   }
-#endif
+
+  void start(gl::begin_mode mode = gl::bm_quads);
+
   inline float compute_color(float c) {
-#ifdef NO_TEXTURE_TRANSFORM
+#ifdef NO_TEXTURE
+    // the packed rgba color travels in the float slot of the vertex
+    const Color& col = (*lut_)((c - color_min_) * color_norm_);
+    return *reinterpret_cast<const float*>(&col);
+#else
     return (c - color_min_) * color_scale_;
 #endif
+  }
+
+  /**
+   * Quantize a color value to its position along the ramp, over
+   * max_color_index steps, clamped like the texture coordinates.
+   */
+  inline unsigned short color_to_index(float c) const {
 #ifdef NO_TEXTURE
-    c = (c - color_min_) * color_scale_;
-    int index = int(c);
-    if (index < 0)
-      index = 0;
-    else if (index >= color_ramp_.size())
-      index = color_ramp_.size()-1;
-    if (color_smooth_) {
-      float t = c - index;
-      if (t == 0)
-	c = *reinterpret_cast<float*>(&color_ramp_[index]);
-      else {
-	const Color& c1 = color_ramp_[index];
-	const Color& c2 = color_ramp_[index+1];
-	Color col(interp(t, c1, c2));
-	c = *reinterpret_cast<float*>(&col);
-      }
-    }
-    else {
-      c = *reinterpret_cast<float*>(&color_ramp_[index]);
-    }
-    return c;
+    float t = (c - color_min_) * color_norm_;
+#else
+    float t = (c - color_min_) * color_scale_;
+#endif
+    if (! (t > 0))		// also for NaN
+      return 0;
+    if (t >= 1)
+      return max_color_index;
+    return static_cast<unsigned short>(t * max_color_index + 0.5f);
+  }
+
+  /**
+   * Return what push() sends for a color index: the texture
+   * coordinate, or the packed color without texture.
+   */
+  inline float index_color(unsigned short i) const {
+#ifdef NO_TEXTURE
+    const Color& col = (*lut_)(i * index_norm_);
+    return *reinterpret_cast<const float*>(&col);
+#else
+    return i * index_norm_;
 #endif
   }
 
@@ -127,9 +167,15 @@ public:
   }
 
   inline void push(const Box& b, unsigned depth, float c) {
-    if (dryrun_) return;
+    push_color(b, depth, compute_color(c));
+  }
+
+  inline void push_index(const Box& b, unsigned depth, unsigned short i) {
+    push_color(b, depth, index_color(i));
+  }
+
+  inline void push_color(const Box& b, unsigned depth, float c) {
     check_flush(4);
-    c = compute_color(c);
     push_vertex(xmin(b), ymin(b), depth, c);
     push_vertex(xmax(b), ymin(b), depth+0.5f, c);
     push_vertex(xmax(b), ymax(b), depth, c);
@@ -147,8 +193,8 @@ public:
   void draw_box(const Box& b,
 		node_descriptor n,
 		unsigned depth) {
-    if (filter_->fast_get(n) == 0)
-      push(b, depth, (*color_prop_)[n]);
+    if (filter_[n] == 0)
+      push_index(b, depth, color_index_[n]);
   }
   void draw_border(Box& b, 
 		   node_descriptor n,
@@ -156,22 +202,22 @@ public:
     if (begin_border(b, n, depth)) {
 #if 1
       if (! is_leaf(n, tree_)) {
-	float c = (*color_prop_)[n];
+	float c = index_color(color_index_[n]);
 	Box b_box = b;
 	if (left_border(b_box, n, depth)) {
-	  push(b_box, depth, c);
+	  push_color(b_box, depth, c);
 	  b_box = b;
 	}
 	if (top_border(b_box, n, depth)) {
-	  push(b_box, depth, c);
+	  push_color(b_box, depth, c);
 	  b_box = b;
 	}
 	if (right_border(b_box, n, depth)) {
-	  push(b_box, depth, c);
+	  push_color(b_box, depth, c);
 	  b_box = b;
 	}
 	if (bottom_border(b_box, n, depth)) {
-	  push(b_box, depth, c);
+	  push_color(b_box, depth, c);
 	}
       }
 #endif
@@ -200,11 +246,13 @@ public:
   
 protected:
   void allocate_ressources();
+  void update_lut();
 
   unsigned size_;
   const FloatColumn * color_prop_;
   unsigned max_depth_;		// only display treemap up to that depth
-  const FilterColumn * filter_;
+  column_view<float> color_;
+  column_view<unsigned> filter_;
 
   float * data_;
   int current_;
@@ -213,11 +261,19 @@ protected:
   unsigned int color_texture_;
   bool color_smooth_;
   std::vector<Color> color_ramp_;
+  Ramp ramp_;			// ramp_max for a custom ramp
+  color_lut color_lut_;		// custom ramp sampled
+  const color_lut * lut_;	// cached table of ramp_ or color_lut_
   float color_range_;
   float color_min_;
   float color_scale_;
+  float color_norm_;		// 1 / color_range_
   float color_delta_;		// experimental
-  bool dryrun_;
+  enum { max_color_index = 0xffff };
+  static constexpr float index_norm_ = 1.0f / max_color_index;
+  std::vector<unsigned short> color_index_; // quantized color of each node
+  bool color_index_valid_;
+  bool dryrun_;			// fill the buffers but send nothing to GL
 
   // for NVidia extension GL_NV_vertex_array_range and GL_NV_fence
   unsigned total_size_;		// total size of allocated AGP memory
@@ -78,16 +78,19 @@ FastPicker::finish(const Box& bounds,
 		   const StringColumn& name)
 {
 #if 1
+  frame_arena::scope frame(label_arena_);
   LabelLayoutRect::List disp_labels;
+  disp_labels.reserve(label_centers.size());
   for(int i = 0; i < label_centers.size(); i++) {
-    LiteDisplacedLabel * ld = new LiteDisplacedLabel(name[labels[i]],
-						     label_centers[i],
-						     LiteLabel::just_center,
-						     font,
-						     color_black,
-						     color_none,
-						     color_white
-						     );
+    LiteDisplacedLabel * ld =
+      label_arena_.create<LiteDisplacedLabel>(name[labels[i]],
+					      label_centers[i],
+					      LiteLabel::just_center,
+					      font,
+					      color_black,
+					      color_none,
+					      color_white
+					      );
     ld->setLineAlpha(line_alpha);
     disp_labels.push_back(ld);
   }
@@ -106,7 +109,7 @@ FastPicker::finish(const Box& bounds,
   for (LabelLayoutRect::List::const_iterator j = disp_labels.begin();
        j != disp_labels.end(); j++) {
     (*j)->render(rc);
-    delete *j;
+    frame_arena::destroy(*j);
   }
   glPopAttrib();
 #else
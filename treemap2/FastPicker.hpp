@@ -25,6 +25,8 @@
 #ifndef TREEMAP2_FASTPICKER_HPP
 #define TREEMAP2_FASTPICKER_HPP
 
+#include <infovis/arena_alloc.hpp>
+#include <infovis/memory_usage.hpp>
 #include <infovis/drawing/Font.hpp>
 #include <infovis/tree/tree_traits.hpp>
 #include <infovis/tree/treemap/drawing/pick_drawer.hpp>
@@ -127,6 +129,11 @@ public:
 	      const StringColumn& name);
 
   const Tree& get_tree() const { return border.tree_; }
+
+  memory_size memory_usage() const {
+    return vector_memory(label_centers) + vector_memory(labels) +
+      vector_memory(path_boxes);
+  }
 protected:
   int x_pos, y_pos;
   node_descriptor hit_;
@@ -137,6 +144,7 @@ protected:
   Box labels_clip;
   const BorderDrawer& border;
   bool show_all_labels_;
+  frame_arena label_arena_;	// labels created in finish() live one frame
 };
 
 } // namespace infovis
@@ -84,7 +84,7 @@ FileType::fileType(const string& filename) const
   i = extmap.find(filename.substr(p2+1, p - p2 - 1));
   if (i == extmap.end())
     return Type(false, false, code);
-  return Type(false, true, i->second);
+  return Type(true, false, i->second);
 }
 
 void
@@ -104,7 +104,100 @@ FileType::load(const string& filename)
   while (in) {
     string ext;
     int num;
-    in >> ext >> num;
-    setCode(ext, num);
+    if (in >> ext >> num)
+      setCode(ext, num);
   }
 }
+
+static inline unsigned char
+lower(unsigned char c)
+{
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+FileTypeTrie::FileTypeTrie(const FileType& ft)
+  : classes_(1)
+{
+  std::memset(class_, 0, sizeof(class_));
+  for (int e = 0; e < ft.extensionCount(); e++) {
+    const string& ext = ft.getExtension(e);
+    for (unsigned char c : ext) {
+      c = lower(c);
+      if (class_[c] == 0)
+	class_[c] = classes_++;
+    }
+  }
+  for (unsigned c = 'A'; c <= 'Z'; c++)
+    class_[c] = class_[lower(c)];
+  class_[(unsigned char)'.'] = 0;
+
+  next_.assign(classes_, 0);
+  code_.assign(1, FileType::type_unknown);
+  for (int e = 0; e < ft.extensionCount(); e++) {
+    const string& ext = ft.getExtension(e);
+    if (ext.empty() || ext.find('.') != string::npos)
+      continue;
+    unsigned node = 0;
+    for (string::const_reverse_iterator c = ext.rbegin();
+	 c != ext.rend(); ++c) {
+      const size_t edge = node * classes_ + class_[(unsigned char)*c];
+      if (next_[edge] == 0) {
+	next_[edge] = code_.size();
+	code_.push_back(FileType::type_unknown);
+	next_.resize(next_.size() + classes_, 0);
+      }
+      node = next_[edge];
+    }
+    code_[node] = ft.getCode(ext);
+  }
+}
+
+/*
+ * Match the extension ending at end, i.e. the bytes after the last
+ * dot before end, or all the bytes from begin if there is no dot.
+ * Set dot to the position of that dot, or to null.
+ */
+int
+FileTypeTrie::match(const char * begin, const char * end,
+		    const char *& dot) const
+{
+  unsigned node = 0;
+  dot = nullptr;
+  while (end != begin) {
+    unsigned char c = *--end;
+    if (c == '.') {
+      dot = end;
+      return code_[node];
+    }
+    unsigned cl = class_[c];
+    if (cl == 0)
+      return FileType::type_unknown;
+    node = next_[node * classes_ + cl];
+    if (node == 0)
+      return FileType::type_unknown;
+  }
+  return code_[node];
+}
+
+FileType::Type
+FileTypeTrie::fileType(const char * name, size_t len) const
+{
+  typedef FileType::Type Type;
+  if (len == 0)
+    return Type(false, false, FileType::type_unknown);
+  if (name[len-1] == '/')
+    return Type(false, true, FileType::type_directory);
+  const char * dot;
+  int code = match(name, name + len, dot);
+  if (code == FileType::type_directory)
+    return Type(false, true, code);
+  else if (code != FileType::type_compressed || dot == nullptr)
+    return Type(false, false, code);
+  if (dot == name)		// like FileType, ".gz" is a compressed gz
+    return Type(true, false, code);
+  const char * dot2;
+  int inner = match(name, dot, dot2);
+  if (dot2 == nullptr || inner == FileType::type_unknown)
+    return Type(false, false, code);
+  return Type(true, false, inner);
+}
@@ -28,6 +28,7 @@
 #include <infovis/alloc.hpp>
 #include <map>
 #include <string>
+#include <vector>
 #include <cstring>
 #include <strings.h> // TODO: Added for strncasecmp - C++17 modernization
 using std::string;
@@ -88,4 +89,28 @@ protected:
   Map extmap;
 };
 
+/**
+ * Compiled form of a FileType: a trie of the reversed extensions,
+ * matched in place from the end of a file name without extracting
+ * or allocating strings.  It classifies names like
+ * FileType::fileType.
+ */
+class FileTypeTrie {
+public:
+  FileTypeTrie(const FileType& ft);
+
+  FileType::Type fileType(const char * name, size_t len) const;
+  FileType::Type fileType(const string& name) const {
+    return fileType(name.data(), name.size());
+  }
+protected:
+  int match(const char * begin, const char * end,
+	    const char *& dot) const;
+
+  unsigned char class_[256];	// byte to letter class, 0 if unused
+  unsigned classes_;
+  std::vector<unsigned short> next_; // node * classes_ + class to node
+  std::vector<int> code_;	// code of the extension ending at node
+};
+
 #endif
@@ -64,6 +64,24 @@ LabelTreemap::doRender(const RenderContext& rc)
   }
 }
 
+bool
+LabelTreemap::hitTest(const Box& b) const
+{
+  for (PathBoxes::const_iterator i = boxes_.begin(); i != boxes_.end(); i++)
+    if (intersects_outline(*i, b))
+      return true;
+  return false;
+}
+
+Box
+LabelTreemap::getHull() const
+{
+  Box hull(LiteGroup::getHull());
+  for (PathBoxes::const_iterator i = boxes_.begin(); i != boxes_.end(); i++)
+    hull = box_union(hull, *i);
+  return hull;
+}
+
 bool
 LabelTreemap::isLabelOver(const Box& box) const
 {
@@ -135,6 +153,13 @@ LabelTreemap::changed(ChangeObservable * obs)
   std::cout << "found no root" << std::endl;
 }
 
+memory_size
+LabelTreemap::memoryUsage() const
+{
+  return vector_memory(boxes_) + vector_memory(label_boxes_) +
+    vector_memory(labels_);
+}
+
 void
 LabelTreemap::clear()
 {
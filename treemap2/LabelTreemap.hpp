@@ -44,9 +44,12 @@ public:
 
   Lite * clone() const;
   void doRender(const RenderContext& );
+  bool hitTest(const Box& b) const;
+  Box getHull() const;
 
   void setBoxes(const PathBoxes& boxes) {
     boxes_ = boxes;
+    invalidateHull();
   }
   const PathBoxes& getBoxes() const { return boxes_; }
 
@@ -56,6 +59,7 @@ public:
   bool addLabel(const Box& box);
 
   void clear();
+  memory_size memoryUsage() const;
   bool layoutLabel(const string& label, const Box& box);
   void layoutLabels();
     
@@ -35,6 +35,28 @@ namespace infovis {
 LayoutVisu::~LayoutVisu()
 { }
 
+void
+LayoutVisu::begin_draw()
+{
+  glPushAttrib(GL_FOG_BIT);
+  glFogi(GL_FOG_START, 0);
+  //glFogi(GL_FOG_END, tm_->max_depth_.getBoundedRange()->value());
+  glFogi(GL_FOG_END, 15);
+  glShadeModel(GL_SMOOTH);
+  glPushMatrix();
+  glScalef(1, 1, -1);
+  tm_->drawer_.start();
+}
+
+void
+LayoutVisu::end_draw()
+{
+  tm_->drawer_.finish();
+  glShadeModel(GL_FLAT);
+  glPopMatrix();
+  glPopAttrib();
+}
+
 static LayoutVisuSquarified layout_squarified(0);
 static LayoutVisuSliceAndDice layout_slice_and_dice(0);
 static LayoutVisuScatterPlot layout_scatter_plot(0);
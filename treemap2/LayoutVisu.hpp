@@ -57,9 +57,37 @@ public:
   virtual unsigned pick(float param) = 0;
   virtual void boxlist(float param,
 		       AnimateTree::BoxList& bl, int depth) = 0;
+  /**
+   * Drops the layout state kept across frames, when the tree, the
+   * weights or the drawing options change.
+   */
+  virtual void invalidate() { }
+
+  /**
+   * Starts drawing the layout breadth first, in slices drawn by
+   * draw_slice(), so a large tree does not freeze the interface.
+   * @return false if the layout can only be drawn at once by draw()
+   */
+  virtual bool start_progressive() { return false; }
+  /**
+   * Draws the next slice of the progressive layout, over the
+   * previous ones.
+   * @param budget_ms the time after which the slice stops
+   * @param finished set to true when the layout has been completed
+   * @return the number of boxes drawn by the slice
+   */
+  virtual unsigned draw_slice(int budget_ms, bool& finished) {
+    finished = true;
+    return 0;
+  }
 
   static LayoutVisu * create_visu(LiteTreemap::Layout l, LiteTreemap *);
 protected:
+  /// Sets up the GL state and the drawer for drawing boxes.
+  void begin_draw();
+  /// Flushes the drawer and restores the GL state.
+  void end_draw();
+
   LiteTreemap * tm_;
 };
 
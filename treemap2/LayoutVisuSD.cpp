@@ -30,31 +30,66 @@ LayoutVisuSliceAndDice::LayoutVisuSliceAndDice(LiteTreemap * tm)
   : LayoutVisu(tm)
 { }
 
+void
+LayoutVisuSliceAndDice::invalidate()
+{
+  progressive_.reset();
+}
+
+bool
+LayoutVisuSliceAndDice::start_progressive()
+{
+#ifdef VECTOR_AS_TREE
+  return false;
+#else
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
+  progressive_.reset(new Progressive(tm_->tree_, weight, tm_->drawer_));
+  progressive_->start_progressive(((node_depth(tm_->current_root_,
+					       tm_->tree_)&1) == 0)
+				  ? left_to_right : top_to_bottom,
+				  tm_->getBounds(),
+				  tm_->current_root_);
+  return true;
+#endif
+}
+
+unsigned
+LayoutVisuSliceAndDice::draw_slice(int budget_ms, bool& finished)
+{
+  finished = true;
+  if (progressive_ == 0)
+    return 0;
+  begin_draw();
+  unsigned displayed =
+    progressive_->resume(frame_budget(std::chrono::milliseconds(budget_ms)));
+  end_draw();
+  finished = progressive_->finished();
+  if (finished)
+    progressive_.reset();
+  return displayed;
+}
+
 unsigned
 LayoutVisuSliceAndDice::draw(float param)
 {
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
   int displayed;
 
-  glPushAttrib(GL_FOG_BIT);
-  glFogi(GL_FOG_START, 0);
-  //glFogi(GL_FOG_END, tm_->max_depth_.getBoundedRange()->value());
-  glFogi(GL_FOG_END, 15);
-  glShadeModel(GL_SMOOTH);
-  glPushMatrix();
-  glScalef(1, 1, -1);
-  tm_->drawer_.start();
+  begin_draw();
   if (param == 0) {
     treemap_slice_and_dice<
       Tree,
       Box,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       Drawer&
       > treemap(tm_->tree_,
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		tm_->drawer_);
     displayed = treemap.visit(((node_depth(tm_->current_root_,tm_->tree_)&1)
@@ -67,8 +102,9 @@ LayoutVisuSliceAndDice::draw(float param)
     Interp weight2(tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 		   tm_->tree_.get_prop_numeric(tm_->weight2_prop_));
 #else
-    Interp weight2(*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
-		   *FloatColumn::find(tm_->weight2_prop_, tm_->tree_));
+    const column_view<float> next_weight(*FloatColumn::find(tm_->weight2_prop_,
+							    tm_->tree_));
+    Interp weight2(weight, next_weight);
 #endif
     weight2.set_std_balance();
     weight2.set_param(param);
@@ -88,16 +124,15 @@ LayoutVisuSliceAndDice::draw(float param)
 			      tm_->getBounds(),
 			      tm_->current_root_);
   }
-  tm_->drawer_.finish();
-  glShadeModel(GL_FLAT);
-  glPopMatrix();
-  glPopAttrib();
+  end_draw();
   return displayed;
 }
 
 unsigned
 LayoutVisuSliceAndDice::pick(float param)
 {
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
   int displayed;
 
   tm_->picker_.start();
@@ -107,14 +142,14 @@ LayoutVisuSliceAndDice::pick(float param)
     treemap_slice_and_dice<
       Tree,
       Box,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       Picker&
       > treemap(tm_->tree_,
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		tm_->picker_);
     displayed = treemap.visit(((node_depth(tm_->current_root_,tm_->tree_)&1)
@@ -127,8 +162,9 @@ LayoutVisuSliceAndDice::pick(float param)
     Interp weight2(tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 		   tm_->tree_.get_prop_numeric(tm_->weight2_prop_));
 #else
-    Interp weight2(*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
-		   *FloatColumn::find(tm_->weight2_prop_, tm_->tree_));
+    const column_view<float> next_weight(*FloatColumn::find(tm_->weight2_prop_,
+							    tm_->tree_));
+    Interp weight2(weight, next_weight);
 #endif
     weight2.set_std_balance();
     //weight2.set_balance(total_weight2.get_balance());
@@ -168,6 +204,8 @@ void
 LayoutVisuSliceAndDice::boxlist(float param,
 				AnimateTree::BoxList& bl, int depth)
 {
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
   int displayed;
 
   BoxDrawer drawer(tm_->drawer_, bl);
@@ -178,14 +216,14 @@ LayoutVisuSliceAndDice::boxlist(float param,
     treemap_slice_and_dice<
       Tree,
       Box,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       BoxDrawer&
       > treemap(tm_->tree_,
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		drawer);
     displayed = treemap.visit(((node_depth(tm_->current_root_,tm_->tree_)&1)
@@ -198,8 +236,9 @@ LayoutVisuSliceAndDice::boxlist(float param,
     Interp weight2(tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 		   tm_->tree_.get_prop_numeric(tm_->weight2_prop_));
 #else
-    Interp weight2(*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
-		   *FloatColumn::find(tm_->weight2_prop_, tm_->tree_));
+    const column_view<float> next_weight(*FloatColumn::find(tm_->weight2_prop_,
+							    tm_->tree_));
+    Interp weight2(weight, next_weight);
 #endif
     weight2.set_std_balance();
     weight2.set_param(param);
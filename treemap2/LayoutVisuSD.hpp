@@ -25,16 +25,18 @@
 #ifndef TREEMAP2_LAYOUTVISUSD_HPP
 #define TREEMAP2_LAYOUTVISUSD_HPP
 
+#include <infovis/table/column_view.hpp>
 #include <infovis/tree/treemap/slice_and_dice.hpp>
 #include <infovis/tree/treemap/drawing/weight_interpolator.hpp>
 
 #include <LiteTreemap.hpp>
 #include <LayoutVisu.hpp>
 #include <BoxDrawer.hpp>
+#include <memory>
 
 namespace infovis {
 
-typedef weight_interpolator<WeightMap> Interp;
+typedef weight_interpolator<column_view<float> > Interp;
 
 class LayoutVisuSliceAndDice : public LayoutVisu
 {
@@ -43,6 +45,20 @@ public:
   virtual unsigned draw(float param);
   virtual unsigned pick(float param);
   virtual void boxlist(float param, AnimateTree::BoxList& bl, int depth);
+  virtual void invalidate();
+  virtual bool start_progressive();
+  virtual unsigned draw_slice(int budget_ms, bool& finished);
+
+protected:
+  typedef treemap_slice_and_dice<
+    Tree,
+    Box,
+    column_view<float>,
+    Drawer&
+    > Progressive;
+
+  /// Breadth first layout drawn a slice per frame.
+  std::unique_ptr<Progressive> progressive_;
 };
 } // namespace infovis
 
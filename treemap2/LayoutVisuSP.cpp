@@ -23,21 +23,46 @@
  * SOFTWARE.
  */
 #include <LayoutVisuSP.hpp>
+#include <infovis/drawing/SaveUnder.hpp>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
 namespace infovis {
 
 LayoutVisuScatterPlot::LayoutVisuScatterPlot(LiteTreemap * tm)
   : LayoutVisu(tm),
+    index_valid_(false),
     cached_x_axis_(0),
     cached_y_axis_(0),
     cached_color_axis_(0),
     cached_weight_(0),
-    cached_float_range_(0),
-    cached_vetices_(0),
-    cached_vetices_size_(0)
+    cached_size_(0),
+    cached_filter_version_(0),
+    cached_color_min_(0),
+    cached_color_range_(0),
+    cached_color_ramp_size_(0),
+    density_threshold_(1),
+    density_valid_(false),
+    density_x_axis_(0),
+    density_y_axis_(0),
+    density_color_(0),
+    density_size_(0),
+    density_filter_version_(0),
+    density_color_min_(0),
+    density_color_range_(0),
+    density_smooth_(false),
+    density_texture_(0),
+    density_tex_width_(0),
+    density_tex_height_(0)
 { }
 
+LayoutVisuScatterPlot::~LayoutVisuScatterPlot()
+{
+  if (density_texture_ != 0)
+    glDeleteTextures(1, &density_texture_);
+}
+
 template <class DRAWER>
 static void
 renderScatterPlotBackward(LiteTreemap * tm_, DRAWER& drawer)
@@ -74,109 +99,259 @@ renderScatterPlotBackward(LiteTreemap * tm_, DRAWER& drawer)
   }
 }
 
-template <class DRAWER>
-static void
-renderScatterPlotForward(LiteTreemap * tm_, DRAWER& drawer)
+ScatterPlotGeometry
+LayoutVisuScatterPlot::currentGeometry() const
 {
-  float plot_range = tm_->plot_range_.getBoundedRange()->range();
-  float plot_min  = tm_->plot_range_.getBoundedRange()->value();
-  float plot_max = plot_min + plot_range;
-  FilterColumn * filter =
-    FilterColumn::cast(tm_->tree_.find_column("$filter"));
+  ScatterPlotGeometry geom;
+  geom.bounds = tm_->getBounds();
+  geom.x_min = tm_->x_axis_min_;
+  geom.x_max = tm_->x_axis_max_;
+  geom.y_min = tm_->y_axis_min_;
+  geom.y_max = tm_->y_axis_max_;
+  geom.weight_min = tm_->weight_min_;
+  geom.weight_max = tm_->weight_max_;
+  geom.plot_min = tm_->plot_range_.getBoundedRange()->value();
+  geom.plot_range = tm_->plot_range_.getBoundedRange()->range();
+  return geom;
+}
 
-  Box bounds(tm_->getBounds());
-  float x_scale = tm_->x_axis_max_ - tm_->x_axis_min_;
-  if (x_scale == 0)
-    x_scale = 1;
-  float y_scale = tm_->y_axis_max_ - tm_->y_axis_min_;
-  if (y_scale == 0)
-    y_scale = 1;
-      
-  x_scale = (width(bounds)-plot_max*2) / x_scale;
-  y_scale = (height(bounds)-plot_max*2) / y_scale;
+void
+LayoutVisuScatterPlot::validateIndex()
+{
+  ScatterPlotGeometry geom = currentGeometry();
+
+  Drawer& drawer = tm_->drawer_;
+  const FloatColumn * color = drawer.get_color_prop();
+  float color_min, color_range;
+  drawer.get_color_range(color_min, color_range);
+  unsigned ramp_size = unsigned(drawer.get_color_ramp().size());
+
+  if (index_valid_ &&
+      geom == index_.geometry() &&
+      cached_x_axis_ == tm_->x_axis_ &&
+      cached_y_axis_ == tm_->y_axis_ &&
+      cached_weight_ == tm_->weight_ &&
+      cached_color_axis_ == color &&
+      cached_size_ == tm_->x_axis_->size() &&
+      cached_filter_version_ == tm_->getFilterVersion() &&
+      cached_color_min_ == color_min &&
+      cached_color_range_ == color_range &&
+      cached_color_ramp_size_ == ramp_size)
+    return;
 
-  float weight_scale = (plot_range-1) / (tm_->weight_max_ - tm_->weight_min_);
+  index_.build(*tm_->x_axis_, *tm_->y_axis_, *tm_->weight_, *color,
+	       FilterColumn::cast(tm_->tree_.find_column("$filter")),
+	       geom);
+  index_.colorize([&drawer](float c) { return drawer.compute_color(c); });
+
+  index_valid_ = true;
+  cached_x_axis_ = tm_->x_axis_;
+  cached_y_axis_ = tm_->y_axis_;
+  cached_weight_ = tm_->weight_;
+  cached_color_axis_ = color;
+  cached_size_ = tm_->x_axis_->size();
+  cached_filter_version_ = tm_->getFilterVersion();
+  cached_color_min_ = color_min;
+  cached_color_range_ = color_range;
+  cached_color_ramp_size_ = ramp_size;
+}
 
-  for (int n = 0; n < tm_->x_axis_->size(); n++) {
-    if (filter->fast_get(n) != 0)
+static void
+use_vertices(const ScatterPlotIndex::Vertex * v)
+{
+  glVertexPointer(3, GL_FLOAT, sizeof(*v), &v->x);
+#ifndef NO_TEXTURE
+  glTexCoordPointer(1, GL_FLOAT, sizeof(*v), &v->tex);
+#else
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(*v), &v->tex);
+#endif
+}
+
+/*
+ * Draws each size bucket with a single glDrawArrays of GL_POINTS.
+ * Under the opaque stencil test the first point drawn wins, so small
+ * points are drawn first to stay visible over large ones; with
+ * blending the large points are drawn first for the same reason.
+ * Buckets larger than the implementation point size fall back to
+ * quads through the drawer buffer.
+ */
+void
+LayoutVisuScatterPlot::renderFastScatterPlot(bool forward)
+{
+  Drawer& drawer = tm_->drawer_;
+  float point_range[2];
+  glGetFloatv(GL_ALIASED_POINT_SIZE_RANGE, point_range);
+
+  unsigned count = index_.bucket_count();
+  for (unsigned k = 0; k < count; k++) {
+    const ScatterPlotIndex::Bucket& b = index_.bucket(forward ? count-1-k : k);
+    if (2*b.size <= point_range[1]) {
+      use_vertices(&b.vertices[0]);
+      glPointSize(2*b.size);
+      glDrawArrays(GL_POINTS, 0, GLsizei(b.vertices.size()));
       continue;
-    Point p(((*tm_->x_axis_)[n] - tm_->x_axis_min_) * x_scale +
-	    plot_range + xmin(bounds),
-	    ((*tm_->y_axis_)[n] - tm_->y_axis_min_) * y_scale +
-	    plot_range + ymin(bounds));
-    float w = 1.0f+((*tm_->weight_)[n] - tm_->weight_min_) * weight_scale + plot_min;
-    Box b(x(p)-w,y(p)-w, x(p)+w,y(p)+w);
-    drawer.draw_box(b, n, 1);
+    }
+    use_vertices(reinterpret_cast<const ScatterPlotIndex::Vertex*>
+		 (drawer.get_data()));
+    for (const ScatterPlotIndex::Vertex& v : b.vertices) {
+      drawer.check_flush(4);
+      drawer.push_vertex(v.x - b.size, v.y - b.size, v.z, v.tex);
+      drawer.push_vertex(v.x + b.size, v.y - b.size, v.z+0.5f, v.tex);
+      drawer.push_vertex(v.x + b.size, v.y + b.size, v.z, v.tex);
+      drawer.push_vertex(v.x - b.size, v.y + b.size, v.z-0.5f, v.tex);
+    }
+    drawer.flush();
   }
+  glPointSize(1);
+  use_vertices(reinterpret_cast<const ScatterPlotIndex::Vertex*>
+	       (drawer.get_data()));
 }
 
+static bool
+same_ramp(const std::vector<Color>& a, const std::vector<Color>& b)
+{
+  return a.size() == b.size() &&
+    (a.empty() || memcmp(&a[0], &b[0], a.size() * sizeof(Color)) == 0);
+}
 
-struct VertexInfo {
-  float x_, y_, z_, tex_;
-  VertexInfo() { }
-  VertexInfo(float x, float y, float z, float t)
-    : x_(x), y_(y), z_(z), tex_(t) { }
-};
-
-using VertexTable = std::vector<VertexInfo>;
+bool
+LayoutVisuScatterPlot::useDensity() const
+{
+  Box bounds(tm_->getBounds());
+  return tm_->x_axis_->size() > density_threshold_ * width(bounds) * height(bounds);
+}
 
+/*
+ * Bins the points at one cell per pixel of the plotting area and
+ * turns the grid into an image: the color of a cell is the mean
+ * color value of its points, its opacity grows with the log of its
+ * count.  The axes are only resorted when the columns change; a new
+ * range or filter just rebins the visible points.
+ */
 void
-LayoutVisuScatterPlot::renderFastScatterPlot(float param)
+LayoutVisuScatterPlot::validateDensity()
 {
-#if 0
-  glPushAttrib(GL_COLOR_BUFFER_BIT
-	       | GL_FOG_BIT 
-	       | GL_STENCIL_BUFFER_BIT
-	       );
+  ScatterPlotGeometry geom = currentGeometry();
+  Drawer& drawer = tm_->drawer_;
+  const FloatColumn * color = drawer.get_color_prop();
+  float color_min, color_range;
+  drawer.get_color_range(color_min, color_range);
+
+  bool resort =
+    ! density_.sorted() ||
+    density_x_axis_ != tm_->x_axis_ ||
+    density_y_axis_ != tm_->y_axis_ ||
+    density_size_ != tm_->x_axis_->size();
+  if (! resort &&
+      density_valid_ &&
+      geom == density_geom_ &&
+      density_color_ == color &&
+      density_filter_version_ == tm_->getFilterVersion() &&
+      density_color_min_ == color_min &&
+      density_color_range_ == color_range &&
+      same_ramp(density_ramp_, drawer.get_color_ramp()) &&
+      density_smooth_ == drawer.get_color_smooth())
+    return;
 
-  glShadeModel(GL_SMOOTH);
-  glPushMatrix();
-  glScalef(1, 1, -1);
-  tm_->drawer_.start();
-  glEnable(GL_STENCIL_TEST);
-  glStencilOp(GL_KEEP, GL_INCR, GL_INCR);
+  if (resort) {
+    density_.sort(*tm_->x_axis_, *tm_->y_axis_);
+    density_x_axis_ = tm_->x_axis_;
+    density_y_axis_ = tm_->y_axis_;
+    density_size_ = tm_->x_axis_->size();
+  }
+  float plot_max = geom.plot_min + geom.plot_range;
+  density_.set_grid(unsigned(std::max(1.0f, width(geom.bounds) - 2*plot_max)),
+		    unsigned(std::max(1.0f, height(geom.bounds) - 2*plot_max)));
+  density_.set_domain(geom.x_min, geom.x_max, geom.y_min, geom.y_max);
+  density_.compute(*tm_->x_axis_, *tm_->y_axis_, *color,
+		   FilterColumn::cast(tm_->tree_.find_column("$filter")));
+
+  density_geom_ = geom;
+  density_color_ = color;
+  density_filter_version_ = tm_->getFilterVersion();
+  density_color_min_ = color_min;
+  density_color_range_ = color_range;
+  density_ramp_ = drawer.get_color_ramp();
+  density_smooth_ = drawer.get_color_smooth();
+  density_valid_ = true;
+
+  const unsigned cells = density_.cols() * density_.rows();
+  const ScatterPlotDensity::Counts& count = density_.counts();
+  const ScatterPlotDensity::Values& sum = density_.sums();
+  std::vector<float> mean(cells);
+  for (unsigned c = 0; c < cells; c++)
+    mean[c] = count[c] != 0 ? sum[c] / count[c] : color_min;
+  density_image_.resize(cells);
+  drawer.get_color_lut().map(mean.data(), cells, color_min, color_range,
+			     density_image_.data());
+  float log_max = std::log1p(float(density_.max_count()));
+  for (unsigned c = 0; c < cells; c++) {
+    if (count[c] == 0)
+      density_image_[c] = Color(0u, 0u, 0u, 0u);
+    else
+      density_image_[c][color_space_rgba::alpha] =
+	(unsigned char)(64 + 191 * std::log1p(float(count[c])) / log_max);
+  }
 
-  float trans = (1.0-(tm_->transparency_.getBoundedRange()->value()/100));
+  if (density_texture_ == 0)
+    glGenTextures(1, &density_texture_);
+  glBindTexture(GL_TEXTURE_2D, density_texture_);
+  unsigned tw = SaveUnder::next_power_of_2(density_.cols());
+  unsigned th = SaveUnder::next_power_of_2(density_.rows());
+  if (tw != density_tex_width_ || th != density_tex_height_) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, tw, th, 0,
+		 GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    density_tex_width_ = tw;
+    density_tex_height_ = th;
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, density_.cols(), density_.rows(),
+		  GL_RGBA, GL_UNSIGNED_BYTE, density_image_.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void
+LayoutVisuScatterPlot::renderDensity()
+{
+  validateDensity();
+  const Box& bounds = density_geom_.bounds;
+  float plot_max = density_geom_.plot_min + density_geom_.plot_range;
+  float x0 = xmin(bounds) + density_geom_.plot_range;
+  float y0 = ymin(bounds) + density_geom_.plot_range;
+  float x1 = x0 + std::max(1.0f, width(bounds) - 2*plot_max);
+  float y1 = y0 + std::max(1.0f, height(bounds) - 2*plot_max);
+  float s = float(density_.cols()) / density_tex_width_;
+  float t = float(density_.rows()) / density_tex_height_;
+
+  glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT);
+  glDisable(GL_TEXTURE_1D);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, density_texture_);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  //glStencilFunc(GL_GREATER, 100, (unsigned int)(-1));
-  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-  glStencilFunc(GL_ALWAYS, 1, (unsigned int)(-1));
-
-  int plot_range = tm_->plot_range_.getBoundedRange()->value();
-  Box bounds(tm_->getBounds());
-
-  float weight_scale = max_rect_range / (weight_max_ - weight_min_);
-  std::vector<VertexTable> table_by_size;
-  table_by_size.resize(int(max_plot_size));
-
-  for (int n = 0; n < x_axis_->size(); n++) {
-    Point p((*x_axis_)[n], (*y_axis_)[n]);
-    float w = ((*weight_)[n] - weight_min_) * weight_scale;
-    table_by_size[int(w)].push_back(VertexInfo(x(p), y(p), n+1,
-					       drawer_.compute_color((*type_)[n])));
-  }
-  for (int i = 0; i < table_by_size.size(); i++) {
-    VertexTable& vt = table_by_size[i];
-    if (vt.size() != 0) {
-      glPointSize(i+1);
-      glVertexPointer(3, GL_FLOAT, sizeof(VertexInfo),
-		      &(*vt.begin()));
-      glTexCoordPointer(1, GL_FLOAT, sizeof(VertexInfo),
-			&((*vt.begin()).tex_));
-      glDrawArrays(GL_POINTS, 0, vt.size());
-    }
-  }
-  glPointSize(1);
-  tm_->drawer_.finish();
-  glPopMatrix();
+  float trans = (1.0-(tm_->transparency_.getBoundedRange()->value()/100));
+  glColor4f(1.0f, 1.0f, 1.0f, trans);
+  glBegin(GL_QUADS);
+  glTexCoord2f(0, 0); glVertex2f(x0, y0);
+  glTexCoord2f(s, 0); glVertex2f(x1, y0);
+  glTexCoord2f(s, t); glVertex2f(x1, y1);
+  glTexCoord2f(0, t); glVertex2f(x0, y1);
+  glEnd();
+  glBindTexture(GL_TEXTURE_2D, 0);
   glPopAttrib();
-#endif
 }
 
 unsigned
 LayoutVisuScatterPlot::draw(float param)
 {
+  if (useDensity()) {
+    renderDensity();
+    return (*tm_->x_axis_).size();
+  }
+  validateIndex();
   glPushAttrib(GL_COLOR_BUFFER_BIT
 	       | GL_FOG_BIT 
 	       | GL_STENCIL_BUFFER_BIT
@@ -200,12 +375,12 @@ LayoutVisuScatterPlot::draw(float param)
     //glStencilFunc(GL_GREATER, 100, (unsigned int)(-1));
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
     glStencilFunc(GL_ALWAYS, 1, (unsigned int)(-1));
-    renderScatterPlotForward(tm_, tm_->drawer_);
+    renderFastScatterPlot(true);
   }
   else {
     glStencilFunc(GL_GREATER, 1, (unsigned int)(-1));
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-    renderScatterPlotBackward(tm_, tm_->drawer_);
+    renderFastScatterPlot(false);
   }
   tm_->drawer_.finish();
   glPopMatrix();
@@ -225,41 +400,18 @@ push_parents(FastPicker& picker_,
   picker_.enter(b, n, 0);
 }
 
-struct ScatterPlotPicker
-{
-  Picker& picker_;
-  Point pos_;
-  int hit_count_;
-
-  ScatterPlotPicker(Picker& p)
-    : picker_(p),
-      pos_(p.get_x_pos(), p.get_y_pos()),
-      hit_count_(0)
-  { }
-
-  void draw_box(const Box& b,
-		node_descriptor n,
-		unsigned depth) {
-    if (infovis::inside(b, x(pos_), y(pos_))) {
-//       if (hit_count_ == 0) {
-// 	push_parents(picker_, b, n, picker_.get_tree());
-//       }
-      picker_.add_label(Point(xmin(b) + width(b)/2,
-			      ymin(b) + height(b)/2), n);
-    }
-  }
-};
-
 unsigned
 LayoutVisuScatterPlot::pick(float param)
 {
   int plot_range = int(tm_->plot_range_.getBoundedRange()->value());
-  ScatterPlotPicker picker(tm_->picker_);
+  Point pos_(tm_->picker_.get_x_pos(), tm_->picker_.get_y_pos());
 
+  validateIndex();
   tm_->picker_.start();
-  renderScatterPlotBackward(tm_, picker);
+  index_.pick(pos_, hits_);
+  for (const ScatterPlotIndex::Hit& h : hits_)
+    tm_->picker_.add_label(h.center, h.node);
 
-  Point& pos_ = picker.pos_;
   tm_->picker_.set_labels_clip(Box(x(pos_)-plot_range, y(pos_)-plot_range,
 				   x(pos_)+plot_range, y(pos_)+plot_range));
 
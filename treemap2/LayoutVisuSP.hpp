@@ -28,6 +28,8 @@
 #include <LiteTreemap.hpp>
 #include <LayoutVisu.hpp>
 #include <BoxDrawer.hpp>
+#include <ScatterPlotIndex.hpp>
+#include <ScatterPlotDensity.hpp>
 
 namespace infovis {
 
@@ -35,18 +37,54 @@ class LayoutVisuScatterPlot : public LayoutVisu
 {
 public:
   LayoutVisuScatterPlot(LiteTreemap * tm);
+  virtual ~LayoutVisuScatterPlot();
   virtual unsigned draw(float param);
   virtual unsigned pick(float param);
   virtual void boxlist(float param, AnimateTree::BoxList& bl, int depth);
-  void renderFastScatterPlot(float param);
+  void renderFastScatterPlot(bool forward);
+  void renderDensity();
+
+  /**
+   * Set the number of points per pixel above which the points are
+   * binned into a density grid instead of being drawn one by one.
+   */
+  void setDensityThreshold(float t) { density_threshold_ = t; }
+  float getDensityThreshold() const { return density_threshold_; }
+  bool useDensity() const;
 protected:
+  ScatterPlotGeometry currentGeometry() const;
+  void validateIndex();
+  void validateDensity();
+
+  ScatterPlotIndex index_;
+  ScatterPlotIndex::HitTable hits_;
+  bool index_valid_;
   const FloatColumn * cached_x_axis_;
   const FloatColumn * cached_y_axis_;
   const FloatColumn * cached_color_axis_;
   const FloatColumn * cached_weight_;
-  float cached_float_range_;
-  float * cached_vetices_;
-  int cached_vetices_size_;
+  unsigned cached_size_;
+  unsigned cached_filter_version_;
+  float cached_color_min_;
+  float cached_color_range_;
+  unsigned cached_color_ramp_size_;
+
+  ScatterPlotDensity density_;
+  float density_threshold_;
+  bool density_valid_;
+  const FloatColumn * density_x_axis_;
+  const FloatColumn * density_y_axis_;
+  const FloatColumn * density_color_;
+  unsigned density_size_;
+  ScatterPlotGeometry density_geom_;
+  unsigned density_filter_version_;
+  float density_color_min_;
+  float density_color_range_;
+  std::vector<Color> density_ramp_;
+  bool density_smooth_;
+  std::vector<Color> density_image_;
+  unsigned int density_texture_;
+  unsigned density_tex_width_, density_tex_height_;
 };
 
 } // namespace infovis
@@ -27,30 +27,64 @@
 namespace infovis {
 
 LayoutVisuSquarified::LayoutVisuSquarified(LiteTreemap * tm)
-  : LayoutVisu(tm)
+  : LayoutVisu(tm),
+    transition_root_(0)
 { }
 
+void
+LayoutVisuSquarified::invalidate()
+{
+  transition_.reset();
+  progressive_.reset();
+}
+
+bool
+LayoutVisuSquarified::start_progressive()
+{
+#if defined(VECTOR_AS_TREE) || defined(USE_FILTER)
+  return false;
+#else
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
+  progressive_.reset(new Progressive(tm_->tree_, weight,
+				     tm_->drawer_, tm_->orient_));
+  progressive_->start_progressive(tm_->getBounds(), tm_->current_root_);
+  return true;
+#endif
+}
+
+unsigned
+LayoutVisuSquarified::draw_slice(int budget_ms, bool& finished)
+{
+  finished = true;
+  if (progressive_ == 0)
+    return 0;
+  begin_draw();
+  unsigned displayed =
+    progressive_->resume(frame_budget(std::chrono::milliseconds(budget_ms)));
+  end_draw();
+  finished = progressive_->finished();
+  if (finished)
+    progressive_.reset();
+  return displayed;
+}
+
 unsigned
 LayoutVisuSquarified::draw(float param)
 {
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
   int displayed;
 #ifdef USE_FILTER
   Filter filter(*FilterColumn::find("$filter", tm_->tree_));
 #endif
 
-  glPushAttrib(GL_FOG_BIT);
-  glFogi(GL_FOG_START, 0);
-  //glFogi(GL_FOG_END, tm_->max_depth_.getBoundedRange()->value());
-  glFogi(GL_FOG_END, 15);
-  glShadeModel(GL_SMOOTH);
-  glPushMatrix();
-  glScalef(1, 1, -1);
-  tm_->drawer_.start();
+  begin_draw();
   if (param == 0) {
     treemap_squarified<
       Tree,
       Box,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       Drawer&,
       LiteTreemap::orient_choser&
@@ -61,7 +95,7 @@ LayoutVisuSquarified::draw(float param)
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		tm_->drawer_,
 		tm_->orient_
@@ -72,12 +106,14 @@ LayoutVisuSquarified::draw(float param)
     displayed = treemap.visit(tm_->getBounds(), tm_->current_root_);
   }
   else {
+#if defined(VECTOR_AS_TREE) || defined(USE_FILTER)
 #ifdef VECTOR_AS_TREE
     Interp weight2(tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 		   tm_->tree_.get_prop_numeric(tm_->weight2_prop_));
 #else
-    Interp weight2(*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
-		   *FloatColumn::find(tm_->weight2_prop_, tm_->tree_));
+    const column_view<float> next_weight(*FloatColumn::find(tm_->weight2_prop_,
+							    tm_->tree_));
+    Interp weight2(weight, next_weight);
 #endif
     weight2.set_std_balance();
     weight2.set_param(param);
@@ -85,7 +121,7 @@ LayoutVisuSquarified::draw(float param)
       Tree,
       Box,
       Drawer&,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       Interp&,
       //Interp&,
@@ -97,7 +133,7 @@ LayoutVisuSquarified::draw(float param)
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		weight2,
 		tm_->drawer_,
@@ -110,17 +146,38 @@ LayoutVisuSquarified::draw(float param)
     displayed = treemap.visit_anim(tm_->getBounds(),
 				   tm_->getBounds(),
 				   tm_->current_root_);
+#else
+    // The strips of the first layout do not depend on param, so they
+    // are recorded once and replayed while param is dragged.
+    const Box bounds = tm_->getBounds();
+    if (transition_ == 0 ||
+	transition_root_ != tm_->current_root_ ||
+	! (transition_bounds_ == bounds)) {
+      weight_ = weight;
+      next_weight_ =
+	column_view<float>(*FloatColumn::find(tm_->weight2_prop_, tm_->tree_));
+      Interp interp(weight_, next_weight_);
+      interp.set_std_balance();
+      transition_.reset(new Transition(tm_->tree_, weight_, interp,
+				       tm_->drawer_, tm_->orient_));
+      transition_root_ = tm_->current_root_;
+      transition_bounds_ = bounds;
+      transition_->prepare(bounds, transition_root_);
+    }
+    transition_->weight2_.set_param(param);
+    transition_->interpolate();
+    displayed = transition_->visit_prepared(bounds);
+#endif
   }
-  tm_->drawer_.finish();
-  glShadeModel(GL_FLAT);
-  glPopMatrix();
-  glPopAttrib();
+  end_draw();
   return displayed;
 }
 
 unsigned
 LayoutVisuSquarified::pick(float param)
 {
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
   int displayed;
 
   tm_->picker_.start();
@@ -130,7 +187,7 @@ LayoutVisuSquarified::pick(float param)
     treemap_squarified<
       Tree,
       Box,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       Picker&,
       LiteTreemap::orient_choser&
@@ -138,7 +195,7 @@ LayoutVisuSquarified::pick(float param)
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		tm_->picker_,
 		tm_->orient_);
@@ -149,8 +206,9 @@ LayoutVisuSquarified::pick(float param)
     Interp weight2(tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 		   tm_->tree_.get_prop_numeric(tm_->weight2_prop_));
 #else
-    Interp weight2(*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
-		   *FloatColumn::find(tm_->weight2_prop_, tm_->tree_));
+    const column_view<float> next_weight(*FloatColumn::find(tm_->weight2_prop_,
+							    tm_->tree_));
+    Interp weight2(weight, next_weight);
 #endif
     weight2.set_std_balance();
     weight2.set_param(param);
@@ -158,7 +216,7 @@ LayoutVisuSquarified::pick(float param)
       Tree,
       Box,
       Picker&,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       Interp&,
       //Interp&,
@@ -167,7 +225,7 @@ LayoutVisuSquarified::pick(float param)
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		weight2,
 		tm_->picker_,
@@ -192,6 +250,8 @@ LayoutVisuSquarified::pick(float param)
 void
 LayoutVisuSquarified::boxlist(float param, AnimateTree::BoxList& bl, int depth)
 {
+  const column_view<float> weight(*FloatColumn::find(tm_->weight_prop_,
+						     tm_->tree_));
   int displayed;
   
   BoxDrawer drawer(tm_->drawer_, bl);
@@ -201,7 +261,7 @@ LayoutVisuSquarified::boxlist(float param, AnimateTree::BoxList& bl, int depth)
     treemap_squarified<
       Tree,
       Box,
-      const FloatColumn&,
+      column_view<float>,
       //const FloatColumn&,
       BoxDrawer&,
       LiteTreemap::orient_choser&
@@ -209,7 +269,7 @@ LayoutVisuSquarified::boxlist(float param, AnimateTree::BoxList& bl, int depth)
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		drawer,
 		tm_->orient_);
@@ -220,8 +280,9 @@ LayoutVisuSquarified::boxlist(float param, AnimateTree::BoxList& bl, int depth)
     Interp weight2(tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 		   tm_->tree_.get_prop_numeric(tm_->weight2_prop_));
 #else
-    Interp weight2(*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
-		   *FloatColumn::find(tm_->weight2_prop_, tm_->tree_));
+    const column_view<float> next_weight(*FloatColumn::find(tm_->weight2_prop_,
+							    tm_->tree_));
+    Interp weight2(weight, next_weight);
 #endif
     weight2.set_std_balance();
     weight2.set_param(param);
@@ -229,14 +290,14 @@ LayoutVisuSquarified::boxlist(float param, AnimateTree::BoxList& bl, int depth)
       Tree,
       Box,
       BoxDrawer&,
-      const FloatColumn&,
+      column_view<float>,
       Interp&,
       LiteTreemap::orient_choser&
       > treemap(tm_->tree_,
 #ifdef VECTOR_AS_TREE
 		tm_->tree_.get_prop_numeric(tm_->weight_prop_),
 #else
-		*FloatColumn::find(tm_->weight_prop_, tm_->tree_),
+		weight,
 #endif
 		weight2,
 		drawer,
@@ -29,12 +29,14 @@
 #include <LayoutVisu.hpp>
 #include <BoxDrawer.hpp>
 
+#include <infovis/table/column_view.hpp>
 #include <infovis/tree/treemap/drawing/weight_interpolator.hpp>
 #include <infovis/tree/treemap/squarified_anim.hpp>
+#include <memory>
 
 namespace infovis {
 
-typedef weight_interpolator<WeightMap> Interp;
+typedef weight_interpolator<column_view<float> > Interp;
 
 class LayoutVisuSquarified : public LayoutVisu
 {
@@ -44,6 +46,37 @@ public:
   virtual unsigned pick(float param);
   virtual void boxlist(float param,
 		       AnimateTree::BoxList& bl, int depth);
+  virtual void invalidate();
+  virtual bool start_progressive();
+  virtual unsigned draw_slice(int budget_ms, bool& finished);
+
+protected:
+  typedef treemap_squarified_anim<
+    Tree,
+    Box,
+    Drawer&,
+    column_view<float>,
+    Interp,
+    LiteTreemap::orient_choser&
+    > Transition;
+
+  column_view<float> weight_;
+  column_view<float> next_weight_;
+  /// Strips of the first weights, replayed while param is dragged.
+  std::unique_ptr<Transition> transition_;
+  Box transition_bounds_;
+  node_descriptor transition_root_;
+
+  typedef treemap_squarified<
+    Tree,
+    Box,
+    column_view<float>,
+    Drawer&,
+    LiteTreemap::orient_choser&
+    > Progressive;
+
+  /// Breadth first layout drawn a slice per frame.
+  std::unique_ptr<Progressive> progressive_;
 };
 
 } // namespace infovis
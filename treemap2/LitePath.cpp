@@ -64,6 +64,7 @@ LitePath::setReference(int i)
   set_y(position_, y(position_) + reference_ * font_->getHeight());
   reference_ = i;
   set_y(position_, y(position_) - reference_ * font_->getHeight());
+  invalidateHull();
 }
 
 void
@@ -105,6 +106,7 @@ LitePath::setBounds(const Box& b)
   Box inBounds(border_.shrinkBox(b));
   position_ = Point(infovis::xmin(inBounds),
 		    infovis::ymax(inBounds));
+  invalidateHull();
 }
 
 Lite *
@@ -230,6 +232,13 @@ LitePath::updateBounds()
   }
   float fh = (font_) ? font_->getHeight() : 0;
   size_ = Vector(w, fh * (depth_+1));
+  invalidateHull();
+}
+
+bool
+LitePath::hitTest(const Box& b) const
+{
+  return depth_ != 0 && infovis::intersects(getBounds(), b);
 }
 
 void
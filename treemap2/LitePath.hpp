@@ -62,9 +62,10 @@ public:
   Box getInBounds() const;
   void setBounds(const Box& b);
   Point getPosition() const		{ return position_; }
-  void setPosition(const Point& p)	{ position_ = p; }
+  void setPosition(const Point& p)	{ position_ = p; invalidateHull(); }
 
   Lite * clone() const;
+  bool hitTest(const Box& b) const;
   void setSelected(int s)		{ selected_ = s; }
   int getSelected() const		{ return selected_; }
   node_descriptor getSelectedRoot() const;
@@ -29,7 +29,7 @@ namespace infovis {
 
 LiteRangeSliderGraph::LiteRangeSliderGraph(BoundedRangeObservable * observable,
 					   const Box& bounds,
-					   const BarGraph * bar,
+					   BarGraph * bar,
 					   direction dir,
 					   const Color& fg,
 					   const Color& bg,
@@ -41,7 +41,7 @@ LiteRangeSliderGraph::LiteRangeSliderGraph(BoundedRangeObservable * observable,
 { }
 
 LiteRangeSliderGraph::LiteRangeSliderGraph(const Box& bounds,
-					   const BarGraph * bar,
+					   BarGraph * bar,
 					   direction dir,
 					   const Color& fg,
 					   const Color& bg,
@@ -65,6 +65,18 @@ LiteRangeSliderGraph::clone() const
 				  min_size_);
 }
 
+void
+LiteRangeSliderGraph::setBounds(const Box& b)
+{
+  LiteRangeSlider::setBounds(b);
+  // One bar per pixel, resampled from the histogram of the graph.
+  float w = (direction_ == left_to_right || direction_ == right_to_left)
+    ? width(b) : height(b);
+  w -= getMinSize() + getMaxSize();
+  if (w >= 2)
+    bar_->setBars(unsigned(w));
+}
+
 void
 LiteRangeSliderGraph::renderOverlay(const Box& b)
 {
@@ -79,5 +91,15 @@ LiteRangeSliderGraph::renderOverlay(const Box& b)
   glPopAttrib();
 }
 
+bool
+LiteRangeSliderGraph::hitOverlay(const Box& b) const
+{
+  // The bars are approximated by the box they are drawn in.
+  Box bounds(getBounds());
+  Box inner(xmin(bounds)+getMinSize(), ymin(bounds),
+	    xmax(bounds)-getMaxSize(), ymax(bounds));
+  return LiteRangeSlider::hitOverlay(b) || infovis::intersects(inner, b);
+}
+
 
 } // namespace infovis
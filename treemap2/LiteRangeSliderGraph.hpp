@@ -35,7 +35,7 @@ class LiteRangeSliderGraph : public LiteRangeSlider
 public:
   LiteRangeSliderGraph(BoundedRangeObservable * observable,
 		       const Box& bounds,
-		       const BarGraph * bar,
+		       BarGraph * bar,
 		       direction dir = left_to_right,
 		       const Color& fg = color_black,
 		       const Color& bg = color_white,
@@ -43,7 +43,7 @@ public:
 		       float minmax_size = 10
 		       );
   LiteRangeSliderGraph(const Box& bounds,
-		       const BarGraph * bar,
+		       BarGraph * bar,
 		       direction dir = left_to_right,
 		       const Color& fg = color_black,
 		       const Color& bg = color_white,
@@ -53,9 +53,11 @@ public:
   
   virtual Lite * clone() const;
 
+  virtual void setBounds(const Box& b);
   virtual void renderOverlay(const Box& b);
+  virtual bool hitOverlay(const Box& b) const;
 protected:
-  const BarGraph * bar_;
+  BarGraph * bar_;
 };
 
 } // namespace infovis
@@ -123,6 +123,12 @@ LiteScatterPlot::computeBox(int i) const
   return Box();
 }
 
+bool
+LiteScatterPlot::hitTest(const Box& b) const
+{
+  return infovis::intersects(bounds, b);
+}
+
 void
 LiteScatterPlot::doRender(const RenderContext& c)
 {
@@ -74,6 +74,7 @@ public:
 
   Interactor * interactor(const string& name, int tool_id);
   void doRender(const RenderContext& c);
+  bool hitTest(const Box& b) const;
   void doPassiveMotion(int x, int y);
   // Interactor3States
   void doMove(const Point& pos);
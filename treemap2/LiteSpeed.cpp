@@ -44,6 +44,12 @@ LiteSpeed::interactor(const string& name, int tool_id)
   return 0;
 }
 
+bool
+LiteSpeed::hitTest(const Box& b) const
+{
+  return infovis::intersects(bounds, b);
+}
+
 void
 LiteSpeed::doRender(const RenderContext& rc)
 {
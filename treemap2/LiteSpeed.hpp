@@ -40,6 +40,7 @@ public:
   LiteSpeed(LiteTreemap * tm, const Box& bounds, Font * font);
 
   void doRender(const RenderContext& rc);
+  bool hitTest(const Box& b) const;
   Lite * clone() const;
   Interactor * interactor(const string& name, int tool_id);
   
@@ -26,10 +26,13 @@
 #include <LayoutVisu.hpp>
 #include <Properties.hpp>
 #include <LabelTreemap.hpp>
+#include <DerivedColumns.hpp>
 #include <infovis/drawing/lite/LiteWindow.hpp>
 #include <infovis/drawing/inter/KeyCodes.hpp>
 #include <infovis/drawing/Image.hpp>
 #include <infovis/tree/numeric_prop_min_max.hpp>
+#include <infovis/table/column_view.hpp>
+#include <algorithm>
 #include <iostream>
 #include <GL/glu.h>
 
@@ -116,7 +119,11 @@ LiteTreemap::LiteTreemap(const Box& b,
     show_overlaps_(false),
     list_(0),
     shift_(false),
-    inhibit_dynamic_labels_(false)
+    inhibit_dynamic_labels_(false),
+    filter_version_(0),
+    derived_(0),
+    frame_budget_(Properties::instance()->get_int("treemap.frame_budget", 0)),
+    refining_(false)
 {
   DBG;
   current_root_ = root(tree_);
@@ -156,6 +163,7 @@ void
 LiteTreemap::disableSaveUnder()
 {
   tex_action_ = no_texture;
+  refining_ = false;
 }
 
 void
@@ -163,8 +171,20 @@ LiteTreemap::enableSaveUnder(bool reuse_cache)
 {
   if (reuse_cache)
     tex_action_ = use_texture;
-  else
+  else {
     tex_action_ = save_texture;
+    refining_ = false;
+    if (visu_ != 0)
+      visu_->invalidate();
+  }
+}
+
+void
+LiteTreemap::setFrameBudget(int ms)
+{
+  frame_budget_ = ms < 0 ? 0 : ms;
+  enableSaveUnder();
+  repaint();
 }
 
 void
@@ -181,6 +201,7 @@ LiteTreemap::update_root(node_descriptor n)
       if (tex_action_ != no_texture)
 	tex_action_ = save_texture;
 #endif
+      refining_ = false;
       picker_.set_label_level(1);
       picker_.set_labels_clip(Box());
       labels_->setVisible(false);
@@ -201,6 +222,12 @@ LiteTreemap::interactor(const string& name, int tool_id)
   return 0;
 }
 
+bool
+LiteTreemap::hitTest(const Box& b) const
+{
+  return infovis::intersects(bounds, b);
+}
+
 void
 
 LiteTreemap::doRender(const RenderContext& c)
@@ -233,6 +260,12 @@ LiteTreemap::doRender(const RenderContext& c)
     animate_->render(1.0f - param);
     repaint();			// force last repaint
   }
+  else if (refining_) {
+    renderSlice(true);
+  }
+  else if (param == 0 && startRefinement()) {
+    renderSlice(false);
+  }
   else {
     displayed_items_ = visu_->draw(param);
     if (tex_action_ == save_texture) {
@@ -264,7 +297,8 @@ LiteTreemap::doRender(const RenderContext& c)
     DBG;
   }
   //std::cerr << "line_alpha = " << line_alpha << std::endl;
-  if (param == 0.0f && ! was_animating && tex_action_ != no_texture) {
+  if (param == 0.0f && ! was_animating && tex_action_ != no_texture &&
+      ! refining_) {
     visu_->pick(param);
   }
   DBG;
@@ -278,6 +312,50 @@ LiteTreemap::doRender(const RenderContext& c)
   glShadeModel(GL_FLAT);
 }
 
+/**
+ * Start drawing a new layout breadth first, when a frame budget is
+ * set and the layout supports it.
+ */
+bool
+LiteTreemap::startRefinement()
+{
+#ifdef USE_SAVE_UNDER
+  if (frame_budget_ == 0 || tex_action_ != save_texture ||
+      ! visu_->start_progressive())
+    return false;
+  refining_ = true;
+  displayed_items_ = 0;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Draw the next slice of the progressive layout, over the previous
+ * ones saved in save_under_.  Events are handled between the slices,
+ * and the last one leaves the complete frame in save_under_ like a
+ * layout drawn at once.
+ */
+void
+LiteTreemap::renderSlice(bool over_previous)
+{
+  if (over_previous)
+    save_under_.restore();
+  bool finished;
+  displayed_items_ += visu_->draw_slice(frame_budget_, finished);
+  save_under_.save(int(xmin(bounds)),
+		   int(ymin(bounds)),
+		   int(width(bounds)),
+		   int(height(bounds)));
+  if (finished) {
+    refining_ = false;
+    tex_action_ = use_texture;
+  }
+  else
+    repaint();
+}
+
 bool
 LiteTreemap::doIdle(const Event& ev)
 {
@@ -345,6 +423,20 @@ LiteTreemap::doMove(const Event& ev)
   old_y = y;
 }
 
+memory_size
+LiteTreemap::printMemoryUsage(std::ostream& out) const
+{
+  memory_size save_under = save_under_.memory_usage();
+  memory_size picker = picker_.memory_usage();
+  memory_size labels = labels_ != 0 ? labels_->memoryUsage() : memory_size();
+  memory_size boxes = vector_memory(current_boxes_);
+  out << "  save under: " << save_under << "\n"
+      << "  picker and label centers: " << picker << "\n"
+      << "  label boxes: " << labels << "\n"
+      << "  current path: " << boxes << "\n";
+  return save_under + picker + labels + boxes;
+}
+
 void
 LiteTreemap::enableDynamicLabels()
 {
@@ -372,6 +464,7 @@ LiteTreemap::setColorProp(const string& prop)
 {
   if (prop == color_prop_)
     return;
+  requireColumn(prop);
   FloatColumn * np = FloatColumn::cast(tree_.find_column(prop));
   if (np == 0)
     return;
@@ -389,6 +482,7 @@ LiteTreemap::setXAxisProp(const string& prop)
   if (x_axis_prop_ == prop)
     return;
   x_axis_prop_ = prop;
+  requireColumn(prop);
 
   x_axis_ = FloatColumn::find(x_axis_prop_, tree_);
   x_axis_min_ = x_axis_->min();
@@ -402,6 +496,7 @@ LiteTreemap::setYAxisProp(const string& prop)
   if (y_axis_prop_ == prop)
     return;
   y_axis_prop_ = prop;
+  requireColumn(prop);
 
   y_axis_ = FloatColumn::find(y_axis_prop_, tree_);
   y_axis_min_ = y_axis_->min();
@@ -416,27 +511,43 @@ LiteTreemap::setWeightProp(const string& prop)
     return;
   weight2_prop_ = weight_prop_;
   weight_prop_ = prop;
+  requireColumn(prop);
 
   weight_ = FloatColumn::find(weight_prop_, tree_);
   weight_min_ = weight_->min();
   weight_max_ = weight_->max();
 }
 
+bool
+LiteTreemap::isPendingColumn(const string& prop) const
+{
+  return derived_ != 0 && derived_->isPending(prop);
+}
+
+bool
+LiteTreemap::requireColumn(const string& prop)
+{
+  return derived_ != 0 && derived_->require(prop);
+}
+
 static inline int updateColumn(const FloatColumn * col,
 			       const FilterColumn * filter,
 			       float& min_val, float& max_val)
 {
-  int i;
+  const column_view<float> values(*col);
+  const column_view<unsigned> hidden(*filter);
+  const unsigned n = std::min(values.size(), hidden.size());
+  unsigned i;
   int cnt = 0;
-  for (i = 0; i < col->size(); i++) {
-    if (filter->fast_get(i) == 0) {
-      min_val = max_val = col->fast_get(i);
+  for (i = 0; i < n; i++) {
+    if (hidden[i] == 0) {
+      min_val = max_val = values[i];
       break;
     }
   }
-  for (; i < col->size(); i++) {
-    if (filter->fast_get(i) == 0) {
-      float val = col->fast_get(i);
+  for (; i < n; i++) {
+    if (hidden[i] == 0) {
+      float val = values[i];
       if (val < min_val)
 	min_val = val;
       else if (val > max_val)
@@ -625,6 +736,9 @@ LiteTreemap::doKeyboard(int key, bool down, int x, int y)
     enableSaveUnder();
     repaint();
   }
+  else if (key == 'p' && down) {
+    setFrameBudget(frame_budget_ == 0 ? 16 : 0);
+  }
   else if (key == 'o' && layout_ == layout_scatter_plot) {
     show_overlaps_ = down;
     repaint();
@@ -49,6 +49,7 @@ class LiteTreemap;
 class LabelTreemap;
 
 class LayoutVisu;
+class DerivedColumns;
 
 class LiteTreemap : public LiteGroup,
 		    public BoundedRangeObserver,
@@ -91,8 +92,21 @@ public:
   void enableSaveUnder(bool reuse_cache = false);
   void update_root(node_descriptor n);
 
+  /**
+   * Set the time given to each frame when the treemap is drawn
+   * progressively, breadth first over several frames, 0 to draw it
+   * in one frame.
+   */
+  void setFrameBudget(int ms);
+  int getFrameBudget() const { return frame_budget_; }
+  /// True while the slices of a progressive layout are being drawn.
+  bool isRefining() const { return refining_; }
+
   Interactor * interactor(const string& name, int tool_id);
   void doRender(const RenderContext& c);
+  bool startRefinement();
+  void renderSlice(bool over_previous);
+  bool hitTest(const Box& b) const;
 
   // InteractorIdle
   bool doIdle(const Event& ev);
@@ -129,6 +143,13 @@ public:
   void setWeightProp(const string& prop);
   void updateMinMax();
 
+  /**
+   * Set the derived columns, filled by requireColumn() when first used.
+   */
+  void setDerivedColumns(DerivedColumns * derived) { derived_ = derived; }
+  bool isPendingColumn(const string& prop) const;
+  bool requireColumn(const string& prop);
+
   Drawer& getDrawer() { return drawer_; }
 
   float getFps() const {return fps_; }
@@ -163,8 +184,15 @@ public:
   void renderFastScatterPlot(const Vector& one, float max_plot_size);
   void endScatterPlot();
 
+  /// Print the memory held by the treemap caches, returning the total.
+  memory_size printMemoryUsage(std::ostream& out) const;
+
   void enableDynamicLabels();
   void disableDynamicLabels(bool inhibit = false);
+
+  /// Called when the $filter column changes, invalidates cached layouts.
+  void filterChanged() { filter_version_++; }
+  unsigned getFilterVersion() const { return filter_version_; }
   //protected:
   struct orient_choser
   {
@@ -229,6 +257,10 @@ public:
 
   bool shift_;
   bool inhibit_dynamic_labels_;
+  unsigned filter_version_;
+  DerivedColumns * derived_;
+  int frame_budget_;
+  bool refining_;
 };
 
 } // namespace infovis
@@ -0,0 +1,231 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <ScatterPlotDensity.hpp>
+#include <infovis/parallel_for.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace infovis {
+
+// Orders values with NaN after everything, keeping a strict weak order.
+static inline bool
+value_less(float a, float b)
+{
+  if (std::isnan(b))
+    return ! std::isnan(a);
+  return a < b;
+}
+
+struct ScatterPlotDensity::Grid
+{
+  Counts count;
+  Values sum;
+  Values max;
+
+  explicit Grid(unsigned cells)
+    : count(cells, 0), sum(cells, 0), max(cells, -FLT_MAX) { }
+};
+
+ScatterPlotDensity::ScatterPlotDensity()
+  : cols_(1), rows_(1),
+    x_min_(0), x_max_(0), x_scale_(0),
+    y_min_(0), y_max_(0), y_scale_(0),
+    max_count_(0), total_(0), scanned_(0)
+{ }
+
+// Maps a float to an unsigned key with the same order, NaN last.
+static inline unsigned
+float_key(float v)
+{
+  if (std::isnan(v))
+    return ~0u;
+  unsigned bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+// Two pass LSD radix sort of the rows by value, stable.
+static void
+sort_by_value(const FloatColumn& axis, unsigned n, std::vector<unsigned>& order)
+{
+  std::vector<unsigned> keys(n), tmp_keys(n), tmp(n);
+  order.resize(n);
+  for (unsigned i = 0; i < n; i++) {
+    keys[i] = float_key(axis.fast_get(i));
+    order[i] = i;
+  }
+  std::vector<unsigned> count(65537);
+  for (unsigned shift = 0; shift < 32; shift += 16) {
+    std::fill(count.begin(), count.end(), 0);
+    for (unsigned i = 0; i < n; i++)
+      count[((keys[i] >> shift) & 0xffff) + 1]++;
+    for (unsigned d = 0; d < 65536; d++)
+      count[d+1] += count[d];
+    for (unsigned i = 0; i < n; i++) {
+      unsigned pos = count[(keys[i] >> shift) & 0xffff]++;
+      tmp[pos] = order[i];
+      tmp_keys[pos] = keys[i];
+    }
+    order.swap(tmp);
+    keys.swap(tmp_keys);
+  }
+}
+
+void
+ScatterPlotDensity::sort(const FloatColumn& x_axis, const FloatColumn& y_axis)
+{
+  unsigned n = std::min(x_axis.size(), y_axis.size());
+  sort_by_value(x_axis, n, x_order_);
+  sort_by_value(y_axis, n, y_order_);
+}
+
+void
+ScatterPlotDensity::clear_sort()
+{
+  x_order_.clear();
+  y_order_.clear();
+}
+
+void
+ScatterPlotDensity::set_grid(unsigned cols, unsigned rows)
+{
+  cols_ = std::max(1u, cols);
+  rows_ = std::max(1u, rows);
+  set_domain(x_min_, x_max_, y_min_, y_max_);
+}
+
+void
+ScatterPlotDensity::set_domain(float x_min, float x_max,
+			       float y_min, float y_max)
+{
+  x_min_ = x_min;
+  x_max_ = x_max;
+  y_min_ = y_min;
+  y_max_ = y_max;
+  x_scale_ = x_max > x_min ? cols_ / (x_max - x_min) : 0;
+  y_scale_ = y_max > y_min ? rows_ / (y_max - y_min) : 0;
+}
+
+void
+ScatterPlotDensity::range(const FloatColumn& axis,
+			  const std::vector<unsigned>& order,
+			  float min, float max,
+			  unsigned& begin, unsigned& end) const
+{
+  begin = unsigned(std::lower_bound(order.begin(), order.end(), min,
+				    [&axis](unsigned i, float v) {
+				      return value_less(axis.fast_get(i), v);
+				    }) - order.begin());
+  end = unsigned(std::upper_bound(order.begin() + begin, order.end(), max,
+				  [&axis](float v, unsigned i) {
+				    return value_less(v, axis.fast_get(i));
+				  }) - order.begin());
+}
+
+void
+ScatterPlotDensity::compute(const FloatColumn& x_axis,
+			    const FloatColumn& y_axis,
+			    const FloatColumn& color,
+			    const column_of<unsigned> * filter,
+			    unsigned threads)
+{
+  const unsigned n = std::min(std::min(x_axis.size(), y_axis.size()),
+			      color.size());
+  const unsigned cells = cols_ * rows_;
+
+  // Visit only the rows inside the domain on the most selective axis,
+  // unless it selects most of the rows and a linear scan is cheaper.
+  const unsigned * order = 0;
+  unsigned begin = 0, end = n;
+  if (sorted() && x_order_.size() == n) {
+    unsigned xb, xe, yb, ye;
+    range(x_axis, x_order_, x_min_, x_max_, xb, xe);
+    range(y_axis, y_order_, y_min_, y_max_, yb, ye);
+    if (xe - xb <= ye - yb) {
+      order = x_order_.data();
+      begin = xb;
+      end = xe;
+    }
+    else {
+      order = y_order_.data();
+      begin = yb;
+      end = ye;
+    }
+    if (end - begin > n / 2) {
+      order = 0;
+      begin = 0;
+      end = n;
+    }
+  }
+  const unsigned rows = end - begin;
+  scanned_ = rows;
+
+  threads = parallel_threads(rows, threads);
+
+  const unsigned filtered = filter != 0 ? filter->size() : 0;
+  std::vector<Grid> partial(threads, Grid(cells));
+  parallel_for(rows, threads, [&](unsigned t, unsigned first, unsigned last) {
+    Grid& grid = partial[t];
+    for (unsigned k = begin + first; k < begin + last; k++) {
+      unsigned i = order != 0 ? order[k] : k;
+      if (i < filtered && filter->fast_get(i) != 0)
+	continue;
+      unsigned c = cell(x_axis.fast_get(i), y_axis.fast_get(i));
+      if (c >= cells)
+	continue;
+      float v = color.fast_get(i);
+      grid.count[c]++;
+      grid.sum[c] += v;
+      if (v > grid.max[c])
+	grid.max[c] = v;
+    }
+  });
+
+  Grid& grid = partial[0];
+  for (unsigned t = 1; t < threads; t++) {
+    const Grid& other = partial[t];
+    for (unsigned c = 0; c < cells; c++) {
+      if (other.count[c] == 0)
+	continue;
+      grid.count[c] += other.count[c];
+      grid.sum[c] += other.sum[c];
+      grid.max[c] = std::max(grid.max[c], other.max[c]);
+    }
+  }
+  count_.swap(grid.count);
+  sum_.swap(grid.sum);
+  max_.swap(grid.max);
+
+  max_count_ = 0;
+  total_ = 0;
+  for (unsigned c = 0; c < cells; c++) {
+    max_count_ = std::max(max_count_, count_[c]);
+    total_ += count_[c];
+  }
+}
+
+} // namespace infovis
@@ -0,0 +1,130 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TREEMAP2_SCATTERPLOTDENSITY_HPP
+#define TREEMAP2_SCATTERPLOTDENSITY_HPP
+
+#include <infovis/table/column.hpp>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Aggregated scatter plot: the points are binned into a grid of cells
+ * holding their count, and the sum and maximum of their color value.
+ *
+ * Once the axes are sorted, binning only visits the points whose
+ * values fall in the domain, found by binary search on the axis
+ * selecting the fewest of them, so zooming on a small range does not
+ * rescan the whole columns.
+ */
+class ScatterPlotDensity
+{
+public:
+  typedef std::vector<unsigned> Counts;
+  typedef std::vector<float> Values;
+
+  ScatterPlotDensity();
+
+  /**
+   * Sort the rows by each axis value, used to restrict the binning to
+   * the visible range.
+   */
+  void sort(const FloatColumn& x_axis, const FloatColumn& y_axis);
+  bool sorted() const { return ! x_order_.empty(); }
+  void clear_sort();
+
+  /**
+   * Set the grid resolution, usually one cell per pixel.
+   */
+  void set_grid(unsigned cols, unsigned rows);
+  unsigned cols() const { return cols_; }
+  unsigned rows() const { return rows_; }
+
+  /**
+   * Set the domain binned. Values in [min, max] are counted on each
+   * axis, the max value falling into the last cell.
+   */
+  void set_domain(float x_min, float x_max, float y_min, float y_max);
+
+  /**
+   * Return the cell of a point or cols()*rows() if it is outside the
+   * domain.
+   */
+  unsigned cell(float x, float y) const {
+    if (! (x >= x_min_ && x <= x_max_ && y >= y_min_ && y <= y_max_))
+      return cols_ * rows_;
+    unsigned c = unsigned((x - x_min_) * x_scale_);
+    unsigned r = unsigned((y - y_min_) * y_scale_);
+    if (c >= cols_) c = cols_ - 1;
+    if (r >= rows_) r = rows_ - 1;
+    return r * cols_ + c;
+  }
+
+  /**
+   * Recompute the grid.
+   * @param x_axis the x column
+   * @param y_axis the y column
+   * @param color the color column, summed and maxed per cell
+   * @param filter if not null, only rows where the filter is 0 are
+   * counted
+   * @param threads the number of threads to use, 0 for the number of
+   * hardware threads
+   */
+  void compute(const FloatColumn& x_axis,
+	       const FloatColumn& y_axis,
+	       const FloatColumn& color,
+	       const column_of<unsigned> * filter = 0,
+	       unsigned threads = 0);
+
+  const Counts& counts() const { return count_; }
+  const Values& sums() const { return sum_; }
+  const Values& maxs() const { return max_; }
+  unsigned max_count() const { return max_count_; }
+  unsigned long total() const { return total_; }
+
+  /// Number of rows visited by the last compute().
+  unsigned scanned() const { return scanned_; }
+
+protected:
+  struct Grid;
+  void range(const FloatColumn& axis, const std::vector<unsigned>& order,
+	     float min, float max, unsigned& begin, unsigned& end) const;
+
+  std::vector<unsigned> x_order_;
+  std::vector<unsigned> y_order_;
+  unsigned cols_, rows_;
+  float x_min_, x_max_, x_scale_;
+  float y_min_, y_max_, y_scale_;
+  Counts count_;
+  Values sum_;
+  Values max_;
+  unsigned max_count_;
+  unsigned long total_;
+  unsigned scanned_;
+};
+
+} // namespace infovis
+
+#endif // TREEMAP2_SCATTERPLOTDENSITY_HPP
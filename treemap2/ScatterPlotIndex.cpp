@@ -0,0 +1,197 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <ScatterPlotIndex.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace infovis {
+
+const float ScatterPlotIndex::min_cell = 4;
+
+bool
+ScatterPlotGeometry::operator == (const ScatterPlotGeometry& other) const
+{
+  return
+    bounds == other.bounds &&
+    x_min == other.x_min && x_max == other.x_max &&
+    y_min == other.y_min && y_max == other.y_max &&
+    weight_min == other.weight_min && weight_max == other.weight_max &&
+    plot_min == other.plot_min && plot_range == other.plot_range;
+}
+
+ScatterPlotIndex::ScatterPlotIndex()
+  : size_(0)
+{ }
+
+void
+ScatterPlotIndex::clear()
+{
+  buckets_.clear();
+  size_ = 0;
+}
+
+void
+ScatterPlotIndex::build(const FloatColumn& x_axis,
+			const FloatColumn& y_axis,
+			const FloatColumn& weight,
+			const FloatColumn& color,
+			const UnsignedColumn * filter,
+			const ScatterPlotGeometry& geom)
+{
+  clear();
+  geom_ = geom;
+
+  const Box& bounds = geom.bounds;
+  float plot_max = geom.plot_min + geom.plot_range;
+  float x_scale = geom.x_max - geom.x_min;
+  if (x_scale == 0)
+    x_scale = 1;
+  float y_scale = geom.y_max - geom.y_min;
+  if (y_scale == 0)
+    y_scale = 1;
+  x_scale = (width(bounds)-plot_max*2) / x_scale;
+  y_scale = (height(bounds)-plot_max*2) / y_scale;
+  float weight_scale = 0;
+  if (geom.weight_max != geom.weight_min)
+    weight_scale = (geom.plot_range-1) / (geom.weight_max - geom.weight_min);
+
+  unsigned n = std::min(std::min(x_axis.size(), y_axis.size()),
+			std::min(weight.size(), color.size()));
+
+  // First pass: size bucket of every node, counted by rounded size.
+  const unsigned short filtered = 0xffff;
+  unsigned max_size = unsigned(std::max(plot_max, 0.0f) + 1.5f);
+  std::vector<unsigned short> which(n);
+  std::vector<unsigned> count(max_size+1, 0);
+  for (unsigned i = 0; i < n; i++) {
+    if (filter != nullptr && i < filter->size() && filter->fast_get(i) != 0) {
+      which[i] = filtered;
+      continue;
+    }
+    float w = 1.0f + (weight[i] - geom.weight_min) * weight_scale
+      + geom.plot_min;
+    int s = int(w + 0.5f);
+    if (s < 1)
+      s = 1;
+    else if (unsigned(s) > max_size)
+      s = max_size;
+    which[i] = (unsigned short)s;
+    count[s]++;
+  }
+
+  std::vector<unsigned> slot(max_size+1, 0);
+  for (unsigned s = 1; s <= max_size; s++) {
+    if (count[s] == 0)
+      continue;
+    slot[s] = unsigned(buckets_.size());
+    buckets_.push_back(Bucket());
+    Bucket& b = buckets_.back();
+    b.size = float(s);
+    b.vertices.reserve(count[s]);
+    b.nodes.reserve(count[s]);
+  }
+
+  // Second pass, backward to keep the order of the backward rendering.
+  for (unsigned i = n; i-- > 0; ) {
+    if (which[i] == filtered)
+      continue;
+    Bucket& b = buckets_[slot[which[i]]];
+    b.vertices.push_back(Vertex((x_axis[i] - geom.x_min) * x_scale +
+				geom.plot_range + xmin(bounds),
+				(y_axis[i] - geom.y_min) * y_scale +
+				geom.plot_range + ymin(bounds),
+				1, color[i]));
+    b.nodes.push_back(i);
+    size_++;
+  }
+  for (Bucket& b : buckets_)
+    build_grid(b);
+}
+
+static inline unsigned
+grid_cell(float v, float origin, float cell, unsigned count)
+{
+  float c = (v - origin) / cell;
+  if (! (c > 0))		// also catches NaN
+    return 0;
+  if (c >= count)
+    return count-1;
+  return unsigned(c);
+}
+
+void
+ScatterPlotIndex::build_grid(Bucket& b) const
+{
+  const Box& bounds = geom_.bounds;
+  b.cell = std::max(2*b.size, min_cell);
+  b.cols = std::max(1u, unsigned(std::ceil(width(bounds) / b.cell)));
+  b.rows = std::max(1u, unsigned(std::ceil(height(bounds) / b.cell)));
+  b.cell_start.assign(b.cols * b.rows + 1, 0);
+  b.items.resize(b.vertices.size());
+
+  // Counting sort of the vertices by cell.
+  std::vector<unsigned> cells(b.vertices.size());
+  for (unsigned i = 0; i < b.vertices.size(); i++) {
+    const Vertex& v = b.vertices[i];
+    unsigned c =
+      grid_cell(v.y, ymin(bounds), b.cell, b.rows) * b.cols +
+      grid_cell(v.x, xmin(bounds), b.cell, b.cols);
+    cells[i] = c;
+    b.cell_start[c+1]++;
+  }
+  for (unsigned c = 0; c < b.cols * b.rows; c++)
+    b.cell_start[c+1] += b.cell_start[c];
+  std::vector<unsigned> next(b.cell_start.begin(), b.cell_start.end()-1);
+  for (unsigned i = 0; i < b.vertices.size(); i++)
+    b.items[next[cells[i]]++] = i;
+}
+
+void
+ScatterPlotIndex::pick(const Point& pos, HitTable& hits) const
+{
+  const Box& bounds = geom_.bounds;
+  hits.clear();
+  for (const Bucket& b : buckets_) {
+    // A point containing pos has its center within one cell of it.
+    unsigned cx = grid_cell(x(pos), xmin(bounds), b.cell, b.cols);
+    unsigned cy = grid_cell(y(pos), ymin(bounds), b.cell, b.rows);
+    unsigned x0 = cx == 0 ? 0 : cx-1, x1 = std::min(cx+1, b.cols-1);
+    unsigned y0 = cy == 0 ? 0 : cy-1, y1 = std::min(cy+1, b.rows-1);
+    for (unsigned gy = y0; gy <= y1; gy++) {
+      for (unsigned gx = x0; gx <= x1; gx++) {
+	unsigned c = gy * b.cols + gx;
+	for (unsigned i = b.cell_start[c]; i < b.cell_start[c+1]; i++) {
+	  const Vertex& v = b.vertices[b.items[i]];
+	  if (! (x(pos) < v.x - b.size || v.x + b.size < x(pos) ||
+		 y(pos) < v.y - b.size || v.y + b.size < y(pos)))
+	    hits.push_back(Hit(b.nodes[b.items[i]], Point(v.x, v.y)));
+	}
+      }
+    }
+  }
+  std::sort(hits.begin(), hits.end());
+}
+
+} // namespace infovis
@@ -0,0 +1,143 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TREEMAP2_SCATTERPLOTINDEX_HPP
+#define TREEMAP2_SCATTERPLOTINDEX_HPP
+
+#include <infovis/drawing/drawing.hpp>
+#include <infovis/table/column.hpp>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Placement of the scatter plot points inside the treemap bounds.
+ *
+ * A point is centered on its projected x/y values and is a square
+ * whose half width grows from 1+plot_min to plot_min+plot_range with
+ * its weight.
+ */
+struct ScatterPlotGeometry
+{
+  Box bounds;
+  float x_min, x_max;
+  float y_min, y_max;
+  float weight_min, weight_max;
+  float plot_min, plot_range;
+
+  bool operator == (const ScatterPlotGeometry& other) const;
+  bool operator != (const ScatterPlotGeometry& other) const {
+    return ! (*this == other);
+  }
+};
+
+/**
+ * Points of the scatter plot sorted into buckets of equal size.
+ *
+ * Each bucket holds a vertex array ready to be drawn with one
+ * glDrawArrays(GL_POINTS) call and a uniform grid over its projected
+ * points, so picking only visits the points near the mouse.
+ */
+class ScatterPlotIndex
+{
+public:
+  /// Vertex layout shared with the FastDrawer buffers.
+  struct Vertex {
+    float x, y, z, tex;
+    Vertex() { }
+    Vertex(float X, float Y, float Z, float t)
+      : x(X), y(Y), z(Z), tex(t) { }
+  };
+  typedef std::vector<Vertex> VertexTable;
+  typedef std::vector<unsigned> NodeTable;
+
+  struct Hit {
+    unsigned node;
+    Point center;
+    Hit(unsigned n, const Point& c) : node(n), center(c) { }
+    bool operator < (const Hit& other) const { return node > other.node; }
+  };
+  typedef std::vector<Hit> HitTable;
+
+  struct Bucket {
+    float size;			// half width of the points
+    VertexTable vertices;	// in decreasing node order
+    NodeTable nodes;		// node of each vertex
+
+    // Uniform grid over the vertices, stored as cell ranges in items.
+    float cell;
+    unsigned cols, rows;
+    std::vector<unsigned> cell_start;
+    std::vector<unsigned> items;
+  };
+
+  ScatterPlotIndex();
+
+  /**
+   * Rebuilds the buckets from the axis, weight and color columns.
+   * Nodes with a non zero value in the filter column are left out.
+   * The tex field of the vertices holds the raw color value until
+   * colorize() is called.
+   */
+  void build(const FloatColumn& x_axis,
+	     const FloatColumn& y_axis,
+	     const FloatColumn& weight,
+	     const FloatColumn& color,
+	     const UnsignedColumn * filter,
+	     const ScatterPlotGeometry& geom);
+  void clear();
+
+  /// Maps the raw color values through the drawer color function.
+  template <class ColorFn>
+  void colorize(ColorFn compute_color) {
+    for (Bucket& b : buckets_)
+      for (Vertex& v : b.vertices)
+	v.tex = compute_color(v.tex);
+  }
+
+  unsigned size() const { return size_; }
+  unsigned bucket_count() const { return unsigned(buckets_.size()); }
+  const Bucket& bucket(unsigned i) const { return buckets_[i]; }
+  const ScatterPlotGeometry& geometry() const { return geom_; }
+
+  /**
+   * Collects the nodes whose point contains pos with the center of
+   * their point, in decreasing node order like the backward rendering.
+   */
+  void pick(const Point& pos, HitTable& hits) const;
+
+  /// Minimum size of a grid cell in pixels.
+  static const float min_cell;
+
+protected:
+  void build_grid(Bucket& b) const;
+
+  std::vector<Bucket> buckets_;	// by increasing size
+  ScatterPlotGeometry geom_;
+  unsigned size_;
+};
+
+} // namespace infovis
+
+#endif // TREEMAP2_SCATTERPLOTINDEX_HPP
@@ -0,0 +1,103 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <TreeColumns.hpp>
+#include <infovis/table/metadata.hpp>
+#include <infovis/parallel_for.hpp>
+
+namespace infovis {
+
+static inline bool
+is_internal(const column * c)
+{
+  const string& name = c->get_name();
+  return ! name.empty()
+    && (name[0] == '$' || name[0] == table::internal_prefix);
+}
+
+float
+file_type_code(const FileTypeTrie& trie, const string& name)
+{
+  float code = trie.fileType(name.data(), name.size()).getCode();
+  if (code != 0)
+    code--;
+  return code;
+}
+
+bool
+compute_file_types(tree& t, const FileTypeTrie& trie)
+{
+  column * c = t.find_column("name");
+  if (c == nullptr)
+    return false;
+
+  const StringColumn& name = *StringColumn::cast(c);
+  FloatColumn& type = *FloatColumn::find("type", t);
+  type.put_metadata(metadata::type, metadata::type_categorical);
+
+  const unsigned n = name.size();
+  type.resize(n);
+  parallel_for(n, parallel_threads(n),
+	       [&](unsigned, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; i++)
+      type.fast_set(i, file_type_code(trie, name.fast_get(i)));
+  });
+  type.define_all();
+  return true;
+}
+
+void
+hide_sums(const tree& t, column * c)
+{
+  for (tree::node_descriptor n = 0; n < c->size(); n++) {
+    if (! is_leaf(n, t))
+      c->undefine(n);
+  }
+}
+
+void
+hide_sums(const tree& t, const std::vector<tree::node_descriptor>& nodes)
+{
+  for (unsigned i = 0; i < t.column_count(); i++) {
+    column * c = t.get_column(i);
+    if (is_internal(c))
+      continue;
+    for (tree::node_descriptor n : nodes)
+      if (n < c->size() && ! is_leaf(n, t))
+	c->undefine(n);
+  }
+}
+
+void
+hide_sums(const tree& t)
+{
+  for (unsigned i = 0; i < t.column_count(); i++) {
+    column * c = t.get_column(i);
+    if (is_internal(c))
+      continue;
+    hide_sums(t, c);
+  }
+}
+
+} // namespace infovis
@@ -0,0 +1,69 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TREEMAP2_TREECOLUMNS_HPP
+#define TREEMAP2_TREECOLUMNS_HPP
+
+#include <infovis/tree/tree.hpp>
+#include <FileType.hpp>
+#include <vector>
+
+namespace infovis {
+
+/**
+ * Return the value of the categorical "type" column for a file
+ * name, the code of its extension minus one so that unknown files
+ * and the first category share 0.
+ */
+float file_type_code(const FileTypeTrie& trie, const string& name);
+
+/**
+ * Fill the categorical "type" column of a tree from the "name"
+ * column.
+ * @return false if the tree has no "name" column
+ */
+bool compute_file_types(tree& t, const FileTypeTrie& trie);
+
+/**
+ * Undefine the values of the interior nodes of a column, so that
+ * only the leaf values are displayed.
+ */
+void hide_sums(const tree& t, column * c);
+
+/**
+ * Undefine the values of the given interior nodes in all the user
+ * columns.  Internal columns, whose names start with '$' or
+ * table::internal_prefix, are left alone: they hold the structure of
+ * the tree and stay defined for every node.
+ */
+void hide_sums(const tree& t, const std::vector<tree::node_descriptor>& nodes);
+
+/**
+ * Undefine the values of all the interior nodes in the user columns.
+ */
+void hide_sums(const tree& t);
+
+} // namespace infovis
+
+#endif // TREEMAP2_TREECOLUMNS_HPP
@@ -0,0 +1,215 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <AnimateTree.hpp>
+#include <FastDrawer.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/tree/treemap/squarified.hpp>
+#include <infovis/tree/treemap/drawing/drawer.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+using namespace infovis;
+typedef tree::node_descriptor node_descriptor;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+// Exposes the boxes setDiff selected.
+struct probe : public AnimateTree {
+  probe(Tree& t, FastDrawer& d) : AnimateTree(0, t, d) { }
+  using AnimateTree::nodes_;
+  using AnimateTree::moving_;
+  using AnimateTree::fixed_;
+};
+
+// Records the box of every node laid out.
+struct box_recorder : public null_drawer<tree,Box> {
+  AnimateTree::BoxList& boxes;
+  box_recorder(AnimateTree::BoxList& b) : boxes(b) { }
+  bool begin_box(const Box& b, node_descriptor n, unsigned) {
+    if (n >= boxes.size())
+      boxes.resize(n + 1);
+    boxes[n] = b;
+    return true;
+  }
+};
+
+static void
+layout(tree& t, AnimateTree::BoxList& boxes)
+{
+  FloatColumn& size = *FloatColumn::find("size", t);
+  sum_weights(t, size);
+  boxes.assign(t.num_nodes(), Box());
+  box_recorder rec(boxes);
+  treemap_squarified<tree,Box,const FloatColumn&,box_recorder&>
+    sq(t, size, rec);
+  sq.visit(Box(0, 0, 1000, 1000), tree::root);
+}
+
+static void
+fill(tree& t, node_descriptor from)
+{
+  StringColumn& names = *StringColumn::find("name", t);
+  FloatColumn& size = *FloatColumn::find("size", t);
+  for (node_descriptor i = from; i < t.num_nodes(); i++) {
+    names[i] = std::to_string(i);
+    size[i] = float(1 + rand() % 10);
+  }
+}
+
+static bool
+is_ancestor(const tree& t, node_descriptor a, node_descriptor n)
+{
+  for (; n != tree::root; n = t.parent(n))
+    if (n == a)
+      return true;
+  return a == tree::root;
+}
+
+// Checks the boxes setDiff chose against the diff and both layouts.
+static void
+check(const tree& from, Tree& to, const tree_diff& d, FastDrawer& drawer,
+      unsigned expected_moving)
+{
+  AnimateTree::BoxList from_boxes, to_boxes;
+  layout(const_cast<tree&>(from), from_boxes);
+  layout(to, to_boxes);
+  probe anim(to, drawer);
+  anim.setDiff(from, d, from_boxes, to_boxes);
+
+  const unsigned n = to.num_nodes();
+  const AnimateTree::BoxList& start = anim.getStartList();
+  const AnimateTree::BoxList& end = anim.getEndList();
+  if (start.size() != n + d.removed.size() || end.size() != start.size()) {
+    fail("box count", unsigned(start.size()));
+    return;
+  }
+  for (unsigned i = 0; i < n; i++) {
+    const node_descriptor o = d.old_of_new[i];
+    if (! (end[i] == to_boxes[i]))
+      fail("end box", i);
+    if (! (start[i] == (o == tree_diff::none ? Box() : from_boxes[o])))
+      fail("start box", i);
+    if (anim.nodes_[i] != i)
+      fail("node", i);
+  }
+  for (unsigned k = 0; k < d.removed.size(); k++) {
+    const node_descriptor o = d.removed[k];
+    if (! (start[n + k] == from_boxes[o]) || ! (end[n + k] == Box()))
+      fail("removed box", o);
+    // Drawn with the color of the closest matched ancestor.
+    const node_descriptor m = anim.nodes_[n + k];
+    if (m >= n || d.old_of_new[m] == tree_diff::none ||
+	! is_ancestor(from, d.old_of_new[m], o))
+      fail("removed color", o);
+    else
+      for (node_descriptor a = from.parent(o); a != d.old_of_new[m];
+	   a = from.parent(a))
+	if (d.new_of_old[a] != tree_diff::none)
+	  fail("removed color", o);
+  }
+
+  // Every visible box is either moving or fixed, only moving if its
+  // start and end differ.
+  std::vector<int> seen(start.size(), 0);
+  for (unsigned i : anim.moving_) {
+    seen[i]++;
+    if (start[i] == end[i])
+      fail("moving box in place", i);
+  }
+  for (unsigned i : anim.fixed_) {
+    seen[i]++;
+    if (! (start[i] == end[i]))
+      fail("fixed box moves", i);
+  }
+  for (unsigned i = 0; i < start.size(); i++)
+    if (seen[i] != ((start[i] == Box() && end[i] == Box()) ? 0 : 1))
+      fail("box classified", i);
+  if (expected_moving != unsigned(-1) && anim.movingCount() != expected_moving)
+    fail("moving count", anim.movingCount());
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 10000;
+  srand(5);
+
+  std::vector<node_descriptor> parents(n);
+  for (unsigned i = 1; i < n; i++)
+    parents[i] = rand() % i;
+  tree from;
+  from.build_from_parents(parents);
+  fill(from, 0);
+
+  Tree to;
+  to.build_from_parents(parents);
+  StringColumn& names = *StringColumn::find("name", to);
+  FloatColumn& size = *FloatColumn::find("size", to);
+  names.resize(n);
+  size.resize(n);
+  const StringColumn& from_names = *StringColumn::find("name", from);
+  const FloatColumn& from_size = *FloatColumn::find("size", from);
+  for (unsigned i = 0; i < n; i++) {
+    names[i] = from_names[i];
+    size[i] = from_size[i];
+  }
+  FastDrawer drawer(to, &size, n);
+  tree_diff d;
+
+  // Renaming a leaf keeps the layout: only its old box shrinking and
+  // its new one growing are animated.
+  node_descriptor leaf = n - 1;
+  while (! to.is_leaf(leaf))
+    leaf--;
+  names[leaf] = "renamed";
+  diff_trees(from, to, d);
+  if (d.added.size() != 1 || d.removed.size() != 1)
+    fail("rename diff", leaf);
+  check(from, to, d, drawer, 2);
+
+  // Removed, added and resized subtrees.
+  const node_descriptor sub[] = { 0, 0, 0, 1, 1, 2 };
+  for (unsigned k = 0; k < n / 500; k++) {
+    node_descriptor r = 1 + rand() % (n - 1);
+    if (! to.removed(r))
+      to.remove_subtree(r);
+    fill(to, to.add_subtree(rand() % n, sub, 6));
+    size[rand() % n] = 100;
+  }
+  diff_trees(from, to, d);
+  check(from, to, d, drawer, unsigned(-1));
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,203 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <DerivedColumns.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/tree/visitor.hpp>
+#include <infovis/table/metadata.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace infovis;
+
+static int errors;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " differs at " << i << std::endl;
+}
+
+struct depth_visitor {
+  unsigned depth_;
+  FloatColumn& col_;
+  depth_visitor(FloatColumn& col) : depth_(0), col_(col) { }
+  void preorder(tree::node_descriptor n) { col_[n] = depth_++; }
+  void inorder(tree::node_descriptor) { }
+  void postorder(tree::node_descriptor) { --depth_; }
+};
+
+// The separate passes treemap2 used to run at startup.
+static void
+reference(tree& t, const FloatColumn& weight,
+	  FloatColumn& log, FloatColumn& degree,
+	  FloatColumn& sqrt, FloatColumn& depth)
+{
+  const unsigned n = t.num_nodes();
+  for (unsigned i = 0; i < n; i++) {
+    double l = std::log(weight[i] + 1.0);
+    log[i] = std::isnan(l) ? 0 : l;
+    degree[i] = t.is_leaf(i) ? 1 : 0;
+    double s = std::sqrt(weight[i]);
+    sqrt[i] = std::isnan(s) ? 0 : s;
+  }
+  sum_weights(t, log);
+  sum_weights(t, degree);
+  sum_weights(t, sqrt);
+  depth_visitor vis(depth);
+  traverse_tree(tree::root, t, vis);
+}
+
+static void
+check(const tree& t, const FloatColumn& expected, const FloatColumn& got,
+      const char * what)
+{
+  if (got.size() != t.num_nodes()) {
+    fail(what, got.size());
+    return;
+  }
+  for (unsigned i = 0; i < t.num_nodes(); i++) {
+    if (expected[i] != got[i])
+      fail(what, i);
+    if (got.defined(i) != t.is_leaf(i))
+      fail(what, i);
+  }
+}
+
+// Compares the reachable nodes only, the sums being accumulated in
+// another order.
+static void
+check_reachable(tree& t, const FloatColumn& expected, const FloatColumn& got,
+		const char * what)
+{
+  std::vector<tree::node_descriptor> stack(1, tree::root);
+  while (! stack.empty()) {
+    tree::node_descriptor i = stack.back();
+    stack.pop_back();
+    if (std::fabs(expected[i] - got[i]) > 1e-3 * std::fabs(expected[i]) + 1e-3)
+      fail(what, i);
+    for (tree::node_descriptor c = t.child(i); c != tree::nil(); c = t.next(c))
+      stack.push_back(c);
+  }
+}
+
+int main(int argc, char * argv[])
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 300000;
+
+  srand(17);
+  std::vector<tree::node_descriptor> parents(n);
+  for (unsigned i = 1; i < n; i++)
+    parents[i] = i < 64 ? 0 : rand() % (i / 2) ;
+  tree t;
+  t.build_from_parents(parents);
+
+  FloatColumn& weight = *FloatColumn::find("size", t);
+  for (unsigned i = 0; i < n; i++)
+    weight[i] = t.is_leaf(i) ? float(rand() % 100000) : 0;
+  const FloatColumn leaf_weight(weight);
+  FloatColumn summed(weight);
+  sum_weights(t, summed);
+
+  FloatColumn log("log"), degree("degree"), sqrt("sqrt"), depth("depth");
+  reference(t, summed, log, degree, sqrt, depth);
+
+  for (unsigned threads = 1; threads <= 4; threads *= 4) {
+    FloatColumn& w = *FloatColumn::find("size", t);
+    w = leaf_weight;
+    DerivedColumns derived(t, w);
+    derived.sumWeight();
+    derived.declare("log", DerivedColumns::log_weight);
+    derived.declare("degree", DerivedColumns::leaf_count);
+    derived.declare("sqrt", DerivedColumns::sqrt_weight);
+    derived.declare("depth", DerivedColumns::depth);
+    if (! derived.isPending("sqrt") || derived.isPending("size"))
+      fail("pending", threads);
+
+    derived.compute(std::vector<string>(1, "log"), threads);
+    check(t, log, *FloatColumn::find("log", t), "log");
+    for (unsigned i = 0; i < n; i++)
+      if (w[i] != summed[i])
+	fail("summed weight", i);
+    if (! derived.isPending("sqrt") ||
+	FloatColumn::find("sqrt", t)->size() != 0)
+      fail("lazy sqrt", threads);
+
+    if (! derived.require("depth") || derived.require("depth"))
+      fail("require", threads);
+    check(t, depth, *FloatColumn::find("depth", t), "depth");
+
+    derived.computeAll(threads);
+    check(t, degree, *FloatColumn::find("degree", t), "degree");
+    check(t, sqrt, *FloatColumn::find("sqrt", t), "sqrt");
+    if (derived.isPending("degree") || derived.isPending("sqrt"))
+      fail("computed", threads);
+    if (FloatColumn::find("depth", t)->get_metadata(metadata::aggregate) ==
+	metadata::aggregate_sum)
+      fail("depth aggregate", threads);
+    for (unsigned i = 0; i < n; i++)
+      if (w[i] != summed[i])
+	fail("weight summed twice", i);
+
+    // Mutate the tree and update the derived columns incrementally.
+    w.put_metadata(metadata::aggregate, metadata::aggregate_sum);
+    t.clear_dirty();
+    for (unsigned k = 0; k < 1000; k++) {
+      tree::node_descriptor i = rand() % t.num_nodes();
+      if (t.is_leaf(i) && ! t.removed(i))
+	t.set_leaf_value(i, w, float(rand() % 100000));
+    }
+    const tree::node_descriptor sub[] = { 0, 0, 1, 1 };
+    for (unsigned k = 0; k < 10; k++) {
+      tree::node_descriptor base = t.add_subtree(rand() % n, sub, 4);
+      for (unsigned j = 2; j < 4; j++)
+	t.set_leaf_value(base + j, w, float(rand() % 100000));
+      tree::node_descriptor r;
+      do
+	r = 64 + rand() % (n - 64);
+      while (t.removed(r));
+      t.remove_subtree(r);
+    }
+    t.move_subtree(63, 1);
+    derived.update(t.dirty_nodes());
+
+    const unsigned m = t.num_nodes();
+    FloatColumn leaves("leaves");
+    for (unsigned i = 0; i < m; i++)
+      leaves[i] = t.is_leaf(i) ? w[i] : 0;
+    sum_weights(t, leaves);
+    FloatColumn log2("log"), degree2("degree"), sqrt2("sqrt"), depth2("depth");
+    reference(t, leaves, log2, degree2, sqrt2, depth2);
+    check_reachable(t, leaves, w, "updated weight");
+    check_reachable(t, log2, *FloatColumn::find("log", t), "updated log");
+    check_reachable(t, degree2, *FloatColumn::find("degree", t), "updated degree");
+    check_reachable(t, sqrt2, *FloatColumn::find("sqrt", t), "updated sqrt");
+    check_reachable(t, depth2, *FloatColumn::find("depth", t), "updated depth");
+    t.build_from_parents(parents);
+  }
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,89 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <FileType.hpp>
+#include <infovis/tree/xml_tree.hpp>
+#include <iostream>
+
+using namespace infovis;
+
+static int errors = 0;
+
+static void
+check(const FileType& ft, const FileTypeTrie& trie, const string& name)
+{
+  FileType::Type expected = ft.fileType(name);
+  FileType::Type got = trie.fileType(name);
+  if (expected.getCode() != got.getCode() ||
+      expected.isDirectory() != got.isDirectory() ||
+      expected.isCompressed() != got.isCompressed()) {
+    if (errors++ < 20)
+      std::cerr << "mismatch for \"" << name << "\": "
+		<< expected.getCode() << " expected, got "
+		<< got.getCode() << std::endl;
+  }
+}
+
+int main(int argc, char * argv[])
+{
+  const char * types = argc > 1 ? argv[1] : "file_types.txt";
+  const char * data = argc > 2 ? argv[2] : "data/www.xml.gz";
+  FileType ft;
+  ft.load(types);
+  if (ft.extensionCount() == 0) {
+    std::cerr << "cannot load " << types << std::endl;
+    return 1;
+  }
+  FileTypeTrie trie(ft);
+
+  static const char * names[] = {
+    "", "/", "dir/", "a", "a.", ".", "..", ".gz", "gz", "Z", "a.Z",
+    "README", "foo.txt", "FOO.TXT", "foo.Txt", "a.b.c", "x.tar.gz",
+    "x.TAR.GZ", "x.gz.gz", "x.unknown.gz", "x.tgz", "dir.d/file",
+    "x.html", "x.htm", "index.html.gz", "a..gz", "archive.zip",
+    "libc.so", "lib.so.6", "x.jpeg", "x.h", "x.c", "x.cpp", "x.ps.Z"
+  };
+  for (const char * n : names)
+    check(ft, trie, n);
+  for (int e = 0; e < ft.extensionCount(); e++) {
+    const string& ext = ft.getExtension(e);
+    check(ft, trie, "name." + ext);
+    check(ft, trie, "name." + ext + ".gz");
+    check(ft, trie, "name.x" + ext);
+    check(ft, trie, ext);
+  }
+
+  tree t;
+  if (xml_tree(data, t) <= 1 || t.find_column("name") == 0) {
+    std::cerr << "cannot load " << data << std::endl;
+    return 1;
+  }
+  const StringColumn& name = *StringColumn::cast(t.find_column("name"));
+  for (unsigned i = 0; i < name.size(); i++)
+    check(ft, trie, name[i]);
+  std::cout << name.size() << " names checked\n";
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
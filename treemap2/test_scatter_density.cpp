@@ -0,0 +1,149 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <ScatterPlotDensity.hpp>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+static float
+frand(float max)
+{
+  return float(rand()) / RAND_MAX * max;
+}
+
+// Bins the points one by one and compares with the density grid.
+static void
+check(const ScatterPlotDensity& d,
+      const FloatColumn& x_axis, const FloatColumn& y_axis,
+      const FloatColumn& color, const UnsignedColumn * filter)
+{
+  const unsigned cells = d.cols() * d.rows();
+  std::vector<unsigned> count(cells, 0);
+  std::vector<double> sum(cells, 0);
+  std::vector<float> max(cells, -FLT_MAX);
+  unsigned long total = 0;
+  for (unsigned i = 0; i < x_axis.size(); i++) {
+    if (filter != 0 && (*filter)[i] != 0)
+      continue;
+    unsigned c = d.cell(x_axis[i], y_axis[i]);
+    if (c >= cells)
+      continue;
+    count[c]++;
+    sum[c] += color[i];
+    max[c] = std::max(max[c], color[i]);
+    total++;
+  }
+  if (d.total() != total)
+    fail("wrong total", unsigned(d.total()));
+  for (unsigned c = 0; c < cells; c++) {
+    if (d.counts()[c] != count[c])
+      fail("wrong count", c);
+    else if (count[c] != 0) {
+      if (d.maxs()[c] != max[c])
+	fail("wrong max", c);
+      if (std::abs(d.sums()[c] - sum[c]) > 1e-3 * std::abs(sum[c]) + 1e-3)
+	fail("wrong sum", c);
+    }
+  }
+}
+
+int main()
+{
+  const unsigned n = 300000;
+  FloatColumn x_axis("x"), y_axis("y"), color("color");
+  UnsignedColumn filter("$filter");
+  for (unsigned i = 0; i < n; i++) {
+    x_axis.add(frand(100));
+    y_axis.add(frand(50) * frand(1));
+    color.add(frand(10));
+    filter.add(i % 7 == 0 ? 1 : 0);
+  }
+  // Points on the domain edges and undefined values.
+  x_axis[0] = 0; y_axis[0] = 0;
+  x_axis[1] = 100; y_axis[1] = 50;
+  x_axis[2] = NAN;
+  y_axis[3] = NAN;
+  x_axis[4] = -3;
+  x_axis[5] = -0.0f;
+  x_axis[6] = -FLT_MAX;
+
+  ScatterPlotDensity d;
+  d.set_grid(64, 32);
+  d.set_domain(0, 100, 0, 50);
+
+  // Single thread and several threads give the same grid.
+  d.compute(x_axis, y_axis, color, &filter, 1);
+  check(d, x_axis, y_axis, color, &filter);
+  if (d.counts()[d.cell(100, 50)] == 0 || d.cell(100, 50) != 64 * 32 - 1)
+    fail("domain max not in the last cell", d.cell(100, 50));
+  d.compute(x_axis, y_axis, color, &filter, 4);
+  check(d, x_axis, y_axis, color, &filter);
+  d.compute(x_axis, y_axis, color, 0, 4);
+  check(d, x_axis, y_axis, color, 0);
+
+  // Zooming with sorted axes only visits the visible rows.
+  d.sort(x_axis, y_axis);
+  d.compute(x_axis, y_axis, color, &filter);
+  check(d, x_axis, y_axis, color, &filter);
+  d.set_domain(10, 12, 5, 40);
+  d.compute(x_axis, y_axis, color, &filter);
+  check(d, x_axis, y_axis, color, &filter);
+  if (d.scanned() >= n / 10)
+    fail("zoom scanned too many rows", d.scanned());
+  d.set_domain(0, 100, 1, 1.5f);
+  d.compute(x_axis, y_axis, color, &filter, 2);
+  check(d, x_axis, y_axis, color, &filter);
+  if (d.scanned() >= n / 10)
+    fail("zoom scanned too many rows", d.scanned());
+  d.set_domain(-5, 5, 0, 50);
+  d.compute(x_axis, y_axis, color, 0);
+  check(d, x_axis, y_axis, color, 0);
+  if (d.counts()[d.cell(-3, y_axis[4])] == 0)
+    fail("negative value not binned", 4);
+  d.set_grid(7, 300);
+  d.compute(x_axis, y_axis, color, &filter);
+  check(d, x_axis, y_axis, color, &filter);
+
+  // Empty domain.
+  d.set_domain(200, 300, 200, 300);
+  d.compute(x_axis, y_axis, color, &filter);
+  if (d.total() != 0 || d.scanned() != 0)
+    fail("points outside the domain counted", unsigned(d.total()));
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
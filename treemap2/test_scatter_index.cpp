@@ -0,0 +1,186 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <ScatterPlotIndex.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace infovis;
+
+static int errors = 0;
+
+static void
+fail(const char * what, unsigned i)
+{
+  if (errors++ < 20)
+    std::cerr << what << " at " << i << std::endl;
+}
+
+static float
+frand(float max)
+{
+  return float(rand()) / RAND_MAX * max;
+}
+
+// Linear reference of the hit test: every unfiltered node whose
+// point, at the size of its bucket, contains pos.
+static void
+brute_pick(const ScatterPlotIndex& index, const Point& pos,
+	   ScatterPlotIndex::HitTable& hits)
+{
+  hits.clear();
+  for (unsigned b = 0; b < index.bucket_count(); b++) {
+    const ScatterPlotIndex::Bucket& bk = index.bucket(b);
+    for (unsigned i = 0; i < bk.vertices.size(); i++) {
+      const ScatterPlotIndex::Vertex& v = bk.vertices[i];
+      Box box(v.x - bk.size, v.y - bk.size, v.x + bk.size, v.y + bk.size);
+      if (inside(box, x(pos), y(pos)))
+	hits.push_back(ScatterPlotIndex::Hit(bk.nodes[i], Point(v.x, v.y)));
+    }
+  }
+  std::sort(hits.begin(), hits.end());
+}
+
+static void
+check_buckets(const ScatterPlotIndex& index,
+	      const FloatColumn& weight,
+	      const UnsignedColumn& filter,
+	      const ScatterPlotGeometry& g)
+{
+  unsigned expected = 0;
+  for (unsigned i = 0; i < filter.size(); i++)
+    if (filter[i] == 0)
+      expected++;
+  if (index.size() != expected)
+    fail("wrong point count", index.size());
+
+  float weight_scale = (g.plot_range-1) / (g.weight_max - g.weight_min);
+  float last_size = 0;
+  for (unsigned b = 0; b < index.bucket_count(); b++) {
+    const ScatterPlotIndex::Bucket& bk = index.bucket(b);
+    if (bk.size <= last_size)
+      fail("buckets not sorted by size", b);
+    last_size = bk.size;
+    if (bk.vertices.empty() || bk.vertices.size() != bk.nodes.size())
+      fail("bad bucket", b);
+    if (bk.items.size() != bk.vertices.size() ||
+	bk.cell_start.back() != bk.items.size())
+      fail("bad grid", b);
+    for (unsigned i = 0; i < bk.nodes.size(); i++) {
+      unsigned n = bk.nodes[i];
+      if (i != 0 && bk.nodes[i-1] <= n)
+	fail("nodes not in backward order", n);
+      if (filter[n] != 0)
+	fail("filtered node indexed", n);
+      float w = 1.0f + (weight[n] - g.weight_min) * weight_scale + g.plot_min;
+      if (std::abs(w - bk.size) > 0.5f)
+	fail("node in wrong bucket", n);
+    }
+  }
+}
+
+static void
+check_picks(const ScatterPlotIndex& index, unsigned count)
+{
+  const Box& bounds = index.geometry().bounds;
+  ScatterPlotIndex::HitTable hits, expected;
+  unsigned total = 0;
+  for (unsigned i = 0; i < count; i++) {
+    // Include positions slightly outside of the bounds.
+    Point pos(xmin(bounds) - 10 + frand(width(bounds) + 20),
+	      ymin(bounds) - 10 + frand(height(bounds) + 20));
+    index.pick(pos, hits);
+    brute_pick(index, pos, expected);
+    total += unsigned(hits.size());
+    if (hits.size() != expected.size()) {
+      fail("wrong hit count", i);
+      continue;
+    }
+    for (unsigned h = 0; h < hits.size(); h++)
+      if (hits[h].node != expected[h].node ||
+	  x(hits[h].center) != x(expected[h].center) ||
+	  y(hits[h].center) != y(expected[h].center))
+	fail("wrong hit", i);
+  }
+  if (total == 0)
+    fail("no hit at all", count);
+}
+
+int main()
+{
+  const unsigned n = 20000;
+  FloatColumn x_axis("x"), y_axis("y"), weight("weight"), color("color");
+  UnsignedColumn filter("$filter");
+  for (unsigned i = 0; i < n; i++) {
+    x_axis.add(frand(100));
+    y_axis.add(frand(50));
+    weight.add(frand(1000));
+    color.add(float(i % 7));
+    filter.add(i % 5 == 0 ? 1 : 0);
+  }
+
+  ScatterPlotGeometry g;
+  g.bounds = Box(10, 20, 810, 620);
+  g.x_min = 0; g.x_max = 100;
+  g.y_min = 0; g.y_max = 50;
+  g.weight_min = 0; g.weight_max = 1000;
+  g.plot_min = 0; g.plot_range = 10;
+
+  ScatterPlotIndex index;
+  index.build(x_axis, y_axis, weight, color, &filter, g);
+  check_buckets(index, weight, filter, g);
+  check_picks(index, 2000);
+
+  // Color values are mapped in place.
+  index.colorize([](float c) { return c * 2; });
+  for (unsigned b = 0; b < index.bucket_count(); b++) {
+    const ScatterPlotIndex::Bucket& bk = index.bucket(b);
+    for (unsigned i = 0; i < bk.nodes.size(); i++)
+      if (bk.vertices[i].tex != color[bk.nodes[i]] * 2)
+	fail("wrong color", bk.nodes[i]);
+  }
+
+  // Larger points, a small window, and a changed filter.
+  g.bounds = Box(0, 0, 200, 100);
+  g.plot_min = 3; g.plot_range = 30;
+  if (! (g != index.geometry()))
+    fail("geometry change not detected", 0);
+  for (unsigned i = 0; i < n; i++)
+    filter[i] = i % 3 == 0 ? 1 : 0;
+  index.build(x_axis, y_axis, weight, color, &filter, g);
+  check_buckets(index, weight, filter, g);
+  check_picks(index, 2000);
+
+  // Constant weight, no filter column.
+  ScatterPlotIndex flat;
+  g.weight_min = g.weight_max = 1;
+  flat.build(x_axis, y_axis, x_axis, color, nullptr, g);
+  if (flat.bucket_count() != 1 || flat.size() != n)
+    fail("constant weight not in a single bucket", flat.bucket_count());
+
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -0,0 +1,156 @@
+/* -*- C++ -*-
+ *
+ * Copyright (C) 2016 Jean-Daniel Fekete
+ * 
+ * This file is part of MillionVis.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <TreeColumns.hpp>
+#include <infovis/tree/dir_tree.hpp>
+#include <infovis/tree/dir_watcher.hpp>
+#include <infovis/tree/sum_weight_visitor.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+using namespace infovis;
+namespace fs = std::filesystem;
+
+static int errors;
+
+static void
+fail(const char * what, const string& path)
+{
+  if (errors++ < 20)
+    std::cerr << what << ": " << path << std::endl;
+}
+
+static void
+write(const fs::path& p, unsigned size)
+{
+  std::ofstream out(p, std::ios::app);
+  out << std::string(size, 'x');
+}
+
+// Returns the node of a path relative to the root, or nil.
+static tree::node_descriptor
+find(const tree& t, const string& path)
+{
+  const StringColumn& name = *StringColumn::find("name", const_cast<tree&>(t));
+  tree::node_descriptor n = tree::root;
+  string::size_type b = 0;
+  while (b < path.size()) {
+    string::size_type e = path.find('/', b);
+    const string part = e == string::npos ? path.substr(b)
+      : path.substr(b, e - b + 1);
+    tree::node_descriptor c = t.child(n);
+    while (c != tree::nil() && name.fast_get(c) != part)
+      c = t.next(c);
+    if (c == tree::nil())
+      return c;
+    n = c;
+    b = e == string::npos ? path.size() : e + 1;
+  }
+  return n;
+}
+
+int
+main()
+{
+  const fs::path dir = fs::temp_directory_path() /
+    ("test_tree_columns_" + std::to_string(getpid()));
+  fs::remove_all(dir);
+  fs::create_directories(dir / "a" / "sub");
+  write(dir / "a" / "f1.txt", 10);
+  write(dir / "a" / "sub" / "f2.c", 20);
+  write(dir / "g", 5);
+
+  FileType ft;
+  ft.setCode("txt", 3);
+  ft.setCode("c", 5);
+  const FileTypeTrie trie(ft);
+
+  // Set up the tree as treemap2 does at startup.
+  tree t;
+  dir_tree(dir.string(), t);
+  FloatColumn& size = *FloatColumn::find("size", t);
+  sum_weights(t, size);
+  if (! compute_file_types(t, trie))
+    fail("no name column", dir.string());
+  t.sort_columns();
+  std::vector<std::vector<bool> > internal;
+  for (unsigned i = 0; i < t.column_count(); i++) {
+    const column * c = t.get_column(i);
+    internal.push_back(std::vector<bool>());
+    for (tree::node_descriptor n = 0; n < c->size(); n++)
+      internal.back().push_back(c->defined(n));
+  }
+  hide_sums(t);
+
+  for (unsigned i = 0; i < t.column_count(); i++) {
+    const column * c = t.get_column(i);
+    if (c->get_name()[0] != table::internal_prefix)
+      continue;
+    for (tree::node_descriptor n = 0; n < c->size(); n++)
+      if (c->defined(n) != internal[i][n])
+	fail("internal column hidden", c->get_name());
+  }
+  if (FloatColumn::find("type", t)->defined(find(t, "a/")))
+    fail("sum not hidden", "type");
+
+  dir_watcher w(t);
+  w.set_coalesce_delay(10);
+  w.set_poll_interval(0);
+  w.set_classifier([&trie](const string& name, bool) {
+      return file_type_code(trie, name);
+    });
+
+  const float before = size[tree::root];
+  write(dir / "a" / "sub" / "new.c", 30);
+  write(dir / "a" / "f1.txt", 50);
+  fs::create_directories(dir / "a" / "n");
+  write(dir / "a" / "n" / "x.txt", 7);
+  const float expected = before + 30 + 50 + 7;
+
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (size[tree::root] != expected
+	 && std::chrono::steady_clock::now() < end)
+    w.update(100);
+  if (size[tree::root] != expected)
+    fail("root sum not updated", dir.string());
+
+  const FloatColumn& type = *FloatColumn::find("type", t);
+  for (const char * p : { "a/sub/new.c", "a/n/x.txt", "a/f1.txt" }) {
+    tree::node_descriptor n = find(t, p);
+    if (n == tree::nil())
+      fail("missing", p);
+    else if (type[n] != file_type_code(trie, p))
+      fail("wrong type", p);
+  }
+  if (file_type_code(trie, "new.c") == file_type_code(trie, "x.txt"))
+    fail("indistinct types", "new.c");
+
+  fs::remove_all(dir);
+  std::cout << (errors == 0 ? "OK" : "FAILED") << std::endl;
+  return errors != 0;
+}
@@ -24,12 +24,14 @@
  */
 #include <infovis/drawing/Font.hpp>
 #include <infovis/drawing/Image.hpp>
+#include <infovis/drawing/StrueTypeFont.hpp>
 #include <infovis/drawing/gl_support.hpp>
 #include <infovis/drawing/inter/Interactor3States.hpp>
 #include <infovis/drawing/inter/KeyCodes.hpp>
 #include <infovis/drawing/inter/KeyboardHandler.hpp>
 #include <infovis/drawing/inter/MouseHandler.hpp>
 #include <infovis/drawing/inter/MouseCodes.hpp>
+#include <infovis/drawing/inter/TimerHandler.hpp>
 #include <infovis/drawing/lite/LiteWindow.hpp>
 #include <infovis/drawing/lite/LiteComboBox.hpp>
 #include <infovis/drawing/lite/LiteSliderExt.hpp>
@@ -37,10 +39,12 @@
 #include <infovis/drawing/notifiers/BoundedRange.hpp>
 #include <ControlsTab.hpp>
 #include <infovis/tree/dir_tree.hpp>
+#include <infovis/tree/dir_watcher.hpp>
 #include <infovis/tree/xmltree_tree.hpp>
 #include <infovis/tree/xml_tree.hpp>
 #include <infovis/tree/algorithm.hpp>
 #include <infovis/tree/sum_weight_visitor.hpp>
+#include <infovis/parallel_for.hpp>
 
 #include <types.hpp>
 #include <ColorRamp.hpp>
@@ -52,8 +56,12 @@
 #include <LiteRangeSliderGraph.hpp>
 #include <LayoutVisu.hpp>
 #include <DynaQueries.hpp>
+#include <DerivedColumns.hpp>
+#include <TreeColumns.hpp>
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <cmath>
 #include <cfloat>
 #include <cstdlib>
@@ -86,11 +94,13 @@ using namespace infovis;
 static Properties * props;
 static string type_prop("type");
 
+static memory_size print_memory_usage(const Tree& t, std::ostream& out);
 
 class TreemapWindow : public LiteWindow,
 		      public Interactor3States,
 		      public MouseHandler,
-		      public KeyboardHandler
+		      public KeyboardHandler,
+		      public TimerHandler
 {
 public:
   TreemapWindow(const string& name,
@@ -98,7 +108,8 @@ public:
 		Tree& t,
 		const string& w_prop,
 		const string& w_prop2,
-		const string& color_prop)
+		const string& color_prop,
+		DerivedColumns * derived = 0)
     : LiteWindow(name, b, cap_double | cap_rgba | cap_stencil),
       tree_(t),
       tree_depth_(depth(tree_)),
@@ -119,7 +130,10 @@ public:
       plot_range_(1, 30, 1, 14),
       color_range_(0.0f, 7.0f, 0.0f, 7.0f),
       speed_(nullptr, Box(0, 0, 100, 12), nullptr),
-      dryrun_(false)
+      derived_(derived),
+      watcher_(0),
+      dryrun_(false),
+      dump_memory_(false)
   {
     label_font_ = props->get_font("label.font",
 				  Font::create("ProFont", "plain", 12));
@@ -145,6 +159,7 @@ public:
 			       transparency_,
 			       plot_range_
 			       );
+    treemap_->setDerivedColumns(derived);
 
     addChild(treemap_);
 
@@ -181,11 +196,55 @@ public:
     drawer_.set_dryrun(d);
   }
 
+  void setDumpMemory(bool d) { dump_memory_ = d; }
+
+  void printMemoryUsage(std::ostream& out) const {
+    memory_size total = print_memory_usage(tree_, out);
+    memory_size save_under = save_under_.memory_usage();
+    memory_size atlas = StrueTypeFont::atlasMemoryUsage();
+    out << "Caches:\n"
+	<< "  window save under: " << save_under << "\n"
+	<< "  font atlas: " << atlas << "\n";
+    total += save_under + atlas + treemap_->printMemoryUsage(out);
+    out << "Total: " << total << "\n";
+  }
+
+  /**
+   * Follow the changes of the loaded directory, polling the watcher
+   * from a timer.
+   */
+  void setWatcher(dir_watcher * w) {
+    watcher_ = w;
+    if (watcher_ != 0)
+      addTimerHandler(watch_delay, this);
+  }
+
+  virtual void timer() {
+    if (watcher_ == 0)
+      return;
+    if (watcher_->update(0) != 0) {
+      if (derived_ != 0)
+	derived_->update(tree_.dirty_nodes());
+      drawer_.update_color_index(tree_.dirty_nodes());
+      hide_sums(tree_, tree_.dirty_nodes());
+      tree_.clear_dirty();
+      treemap_->filterChanged();
+      treemap_->updateMinMax();
+      if (controls_ != 0)
+	controls_->updateColorDistribution();
+      treemap_->enableSaveUnder();
+      repaint();
+    }
+    addTimerHandler(watch_delay, this);
+  }
+
   void doKeyboard(int key, bool down, int x, int y) {
     static bool is_saving = false;
 
     switch(key) {
     case 27:			// escape
+      if (dump_memory_)
+	printMemoryUsage(std::cout);
       exit(0);
     case keycode_return:
       if (! down)
@@ -213,6 +272,8 @@ public:
       break;
     case keycode_space:
       if (down && inter_ == 0) {
+	if (! controls_->isVisible())
+	  controls_->requireQueries();
 	controls_->setVisible(! controls_->isVisible());
       }
       break;
@@ -290,8 +351,12 @@ public:
   ControlsTab * controls_;
 
   LiteSpeed speed_;
+  DerivedColumns * derived_;
+  dir_watcher * watcher_;
+  static const unsigned long watch_delay = 100;
 
   bool dryrun_;
+  bool dump_memory_;
 };
 
 static WeightMap&
@@ -302,80 +367,6 @@ create_sum_weight(Tree& t, const string& prop)
   return *swm;
 }
 
-static bool
-compute_file_types(Tree& t)
-{
-  FileType ft;
-  ft.load("file_types.txt");
-  column * c = t.find_column("name");
-  if (c == nullptr)
-    return false;
-
-  StringColumn& name = *StringColumn::cast(c);
-  FloatColumn& type = *FloatColumn::find("type", t);
-  type.put_metadata(metadata::type, metadata::type_categorical);
-
-  for (int i = 0; i < name.size(); i++) {
-    float code = ft.fileType(name[i]).getCode();
-    if (code != 0)
-      code--;
-    type[i] = code;
-  }
-  return true;
-}
-
-struct log_fn {
-  const WeightMap& wm;
-  log_fn(const WeightMap& w) : wm(w) { }
-  float operator()(int i) const {
-    double d = std::log(wm[i]+1.0);
-    if (std::isnan(d)) {
-      std::cerr << "got a nan for wm[" << i << "] = " << wm[i] << std::endl;
-      return 0;
-    }
-    return d;
-  }
-};
-
-struct degree_fn {
-  const Tree& tree;
-  degree_fn(const Tree& t) : tree(t) { }
-  float operator()(node_descriptor n) const {
-    return is_leaf(n, tree) ? 1 : 0;
-  }
-};
-
-struct sqrt_fn {
-  const WeightMap& wm;
-  sqrt_fn(const WeightMap& w) : wm(w) { }
-  float operator()(node_descriptor n) const {
-    double d = std::sqrt(wm[n]);
-    if (std::isnan(d)) {
-      std::cerr << "got a nan for wm[" << n << "] = " << wm[n] << std::endl;
-      return 0;
-    }
-    return d;
-  }
-};
-
-struct depth_visitor {
-  int depth_;
-  WeightMap& col_;
-
-  depth_visitor(WeightMap& col)
-    : depth_(0), col_(col)
-  { }
-
-  void preorder(node_descriptor n) {
-    col_[n] = depth_++;
-  }
-  void inorder(node_descriptor n) {
-  }
-  void postorder(node_descriptor n) {
-    --depth_;
-  }
-};
-
 static void
 add_metadata(Tree& t)
 {
@@ -443,22 +434,23 @@ static bool is_sum_weights(node_descriptor n,
     return false;
 }
 
-static void hide_sums(const Tree& t, column * c)
+static memory_size print_memory_usage(const Tree& t, std::ostream& out)
 {
-  for (node_descriptor n = 0; n < c->size(); n++) {
-    if (! is_leaf(n, t))
-      c->undefine(n);
-  }
-}
-
-static void hide_sums(const Tree& t)
-{
-  for (int i = 0; i < t.column_count(); i++) {
-    column * c = t.get_column(i);
-    if (c->get_name()[0] == '$')
-      continue;
-    hide_sums(t, c);
+  std::vector<std::pair<memory_size, string> > columns;
+  for (unsigned i = 0; i < t.column_count(); i++) {
+    const column * c = t.get_column(i);
+    columns.push_back(std::make_pair(c->memory_usage(), c->get_name()));
   }
+  std::sort(columns.begin(), columns.end(),
+	    [](const std::pair<memory_size, string>& a,
+	       const std::pair<memory_size, string>& b) {
+	      return a.first.capacity > b.first.capacity;
+	    });
+  memory_size total = t.memory_usage();
+  out << "Tree of " << t.num_nodes() << " nodes: " << total << "\n";
+  for (const auto& c : columns)
+    out << "  " << c.second << ": " << c.first << "\n";
+  return total;
 }
 
 
@@ -478,6 +470,8 @@ int main(int argc, char * argv[])
   int width = 720, height = 480;
   bool dryrun = false;
   bool soft_cursor = false;
+  bool live = false;
+  bool dump_memory = false;
 
   for (i = 1; i < argc; i++) {
     if (argv[i][0] == '-') {
@@ -503,9 +497,15 @@ int main(int argc, char * argv[])
       case 'c':
 	soft_cursor = !soft_cursor;
 	break;
+      case 'l':
+	live = true;
+	break;
+      case 'm':
+	dump_memory = true;
+	break;
       default:
 	std::cerr << "syntax: " << argv[0]
-		  << "[-f] [-w <width>] [-h height] [-d] [-c] dir-or-xml-file\n";
+		  << "[-f] [-w <width>] [-h height] [-d] [-c] [-l] [-m] dir-or-xml-file\n";
 	exit(1);
       }
     }
@@ -513,6 +513,7 @@ int main(int argc, char * argv[])
       toload = argv[i];
     }
   }
+  bool is_dir = true;
   if (toload == 0) {
     std::cout << "Loading current directory\n";
     dir_tree(".", t);
@@ -524,12 +525,16 @@ int main(int argc, char * argv[])
       std::cout << "Not XML, trying as a directory\n";
       dir_tree(toload, t);
     }
+    else
+      is_dir = false;
   }
   std::cout << "Loaded\n";
+  t.shrink_to_fit();		// the loaders grow the columns as they go
 
   (*names)[root(t)] = toload;
   string prop;
   FloatColumn * weight = 0;
+  bool sum_weight = false;
 
   for (Tree::names_iterator n = t.begin_names();
        n != t.end_names(); n++) {
@@ -555,35 +560,28 @@ int main(int argc, char * argv[])
       return 1;
     }
     else {
-      sum_weights(t, *weight);
+      sum_weight = true;
       weight->put_metadata(metadata::aggregate, metadata::aggregate_sum);
     }
   }
 
-  FloatColumn * log = FloatColumn::find(subprop("log", prop), t);
-  fill_column(*log, log_fn(*FloatColumn::cast(weight)));
-  sum_weights(t, *log);
-  log->put_metadata(metadata::aggregate, metadata::aggregate_sum);
-  WeightMap& sw = *log;
-
-  FloatColumn * degree = FloatColumn::find("degree", t);
-  fill_column(*degree, degree_fn(t));
-  sum_weights(t, *degree);
-  degree->put_metadata(metadata::aggregate, metadata::aggregate_sum);
-
-  FloatColumn * sqrt = FloatColumn::find(subprop("sqrt", prop), t);
-  fill_column(*sqrt, sqrt_fn(*FloatColumn::cast(weight)));
-  sum_weights(t, *sqrt);
-  sqrt->put_metadata(metadata::aggregate, metadata::aggregate_sum);
-
-  FloatColumn * depth = FloatColumn::find("depth", t);
-  
-  depth_visitor visitor(*depth);
-  traverse_tree(root(t), t, visitor);
+  // The log weight is displayed first, the other derived columns are
+  // filled the first time they are selected.
+  DerivedColumns derived(t, *weight);
+  if (sum_weight)
+    derived.sumWeight();
+  derived.declare(subprop("log", prop), DerivedColumns::log_weight);
+  derived.declare("degree", DerivedColumns::leaf_count);
+  derived.declare(subprop("sqrt", prop), DerivedColumns::sqrt_weight);
+  derived.declare("depth", DerivedColumns::depth);
+  derived.require(subprop("log", prop));
 
   FilterColumn::find("$filter", t); // create a filter
   
-  if (! compute_file_types(t))
+  FileType ft;
+  ft.load("file_types.txt");
+  const FileTypeTrie trie(ft);
+  if (! compute_file_types(t, trie))
     type_prop = prop;
   t.sort_columns();
   hide_sums(t);
@@ -592,7 +590,8 @@ int main(int argc, char * argv[])
 		    t,
 		    subprop("log", prop),
 		    prop,
-		    type_prop);
+		    type_prop,
+		    &derived);
 #ifdef USE_FOG
   glEnable(GL_FOG);
   glFogi(GL_FOG_MODE, GL_LINEAR);
@@ -615,6 +614,19 @@ int main(int argc, char * argv[])
   win.setColor(props->get_color("background.color",
 				color_black));
   win.setDryRun(dryrun);
+  win.setDumpMemory(dump_memory);
+  if (dump_memory)
+    print_memory_usage(t, std::cout);
+  std::unique_ptr<dir_watcher> watcher;
+  if (live && is_dir) {
+    watcher.reset(new dir_watcher(t));
+    watcher->set_classifier([&trie](const string& name, bool) {
+	return file_type_code(trie, name);
+      });
+    std::cout << "Watching " << watcher->watched() << " directories, polling "
+	      << watcher->polled() << "\n";
+    win.setWatcher(watcher.get());
+  }
 
   if (fullscreen)
     win.setFullscreen();